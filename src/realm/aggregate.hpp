@@ -45,8 +45,9 @@ inline bool is_null<double>(const double& v)
     return null::is_null_float(v);
 }
 
+// Element by element search, for leaves without a specialized search
 template <class LeafType>
-struct FindInLeaf {
+struct FindInLeafScalar {
 
     template <Action action, class Condition, class T, class R>
     static bool find(const LeafType& leaf, T target, QueryState<R>& state)
@@ -65,6 +66,10 @@ struct FindInLeaf {
     }
 };
 
+template <class LeafType>
+struct FindInLeaf : FindInLeafScalar<LeafType> {
+};
+
 template <>
 struct FindInLeaf<ArrayInteger> {
 
@@ -87,6 +92,36 @@ struct FindInLeaf<ArrayIntNull> {
     }
 };
 
+template <class T>
+struct FindInLeaf<BasicArray<T>> {
+
+    template <Action action, class Condition, class U, class R>
+    static bool find(const BasicArray<T>& leaf, U target, QueryState<R>& state)
+    {
+        // Sum, min and max over all non-null values have vectorized kernels
+        constexpr bool all_not_null = std::is_same_v<Condition, None> || std::is_same_v<Condition, NotNull>;
+        if constexpr (all_not_null && action == act_Sum) {
+            size_t count = 0;
+            state.m_state += leaf.sum_not_null(0, leaf.size(), count);
+            state.m_match_count += count;
+            return state.m_limit > state.m_match_count;
+        }
+        else if constexpr (all_not_null && (action == act_Min || action == act_Max)) {
+            size_t count = 0;
+            size_t ndx = leaf.template minmax_not_null<action == act_Max>(0, leaf.size(), count);
+            state.m_match_count += count;
+            if (ndx == npos)
+                return state.m_limit > state.m_match_count;
+            // Let the query state record the result and its key, counting it only once
+            --state.m_match_count;
+            return state.template match<action, false>(ndx, 0, leaf.get(ndx));
+        }
+        else {
+            return FindInLeafScalar<BasicArray<T>>::template find<action, Condition>(leaf, target, state);
+        }
+    }
+};
+
 } // namespace _aggr
 
 template <Action action, typename T>
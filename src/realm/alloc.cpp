@@ -125,6 +125,36 @@ Allocator& Allocator::get_default() noexcept
     return default_alloc;
 }
 
+void Allocator::prefetch_children(ref_type ref) const noexcept
+{
+    const char* header = translate_for_prefetch(ref);
+    if (!header || !NodeHeader::get_hasrefs_from_header(header))
+        return;
+    // The elements are read without going through translate(), so the array
+    // must be entirely within the primary mapping of its section
+    size_t offset = ref - get_section_base(get_section_index(ref));
+    if (offset + NodeHeader::get_byte_size_from_header(header) > (size_t(1) << section_shift))
+        return;
+    size_t sz = NodeHeader::get_size_from_header(header);
+    for (size_t i = 0; i < sz; ++i) {
+        int64_t v = Array::get(header, i);
+        if (v != 0 && (v & 1) == 0)
+            prefetch(ref_type(v));
+    }
+}
+
+void Allocator::advise_will_need(ref_type begin, ref_type end) const noexcept
+{
+    // Only the file mapping benefits, the slab memory is already resident
+    if (m_read_ahead == 0 || end <= begin || !is_read_only(end - 1))
+        return;
+    // The sections are mapped separately, so the range must be clamped to the one holding 'begin'
+    size_t idx = get_section_index(begin);
+    end = std::min(end, ref_type(get_section_base(idx + 1)));
+    if (char* addr = translate_for_prefetch(begin))
+        util::madvise_will_need(addr, end - begin);
+}
+
 // This function is called to handle translation of a ref which is above the limit for its
 // memory mapping. This requires one of three:
 // * bumping the limit of the mapping. (if the entire array is inside the mapping)
@@ -125,6 +125,33 @@ public:
     {
         m_is_read_only = ro;
     }
+
+    /// Prefetch the cache line holding the header of the node at the
+    /// specified 'ref', as a hint that the node will be read soon. Does
+    /// nothing for encrypted files, where the memory is only valid once it
+    /// has been decrypted.
+    void prefetch(ref_type) const noexcept;
+
+    /// Prefetch the headers of the nodes referenced by the array at the
+    /// specified 'ref'. The array itself should have been prefetched
+    /// beforehand, as it is read right away.
+    void prefetch_children(ref_type) const noexcept;
+
+    /// Advise the operating system that the file pages backing the refs in
+    /// [begin, end) will be read soon. Does nothing unless read ahead is
+    /// enabled, or if the range is not part of an unencrypted file mapping.
+    void advise_will_need(ref_type begin, ref_type end) const noexcept;
+
+    /// The number of clusters ahead of a table traversal for which
+    /// advise_will_need() is called. Zero disables read ahead.
+    size_t get_read_ahead() const noexcept
+    {
+        return m_read_ahead;
+    }
+    void set_read_ahead(size_t num_clusters) noexcept
+    {
+        m_read_ahead = num_clusters;
+    }
     /// Returns a simple allocator that can be used with free-standing
     /// Realm objects (such as a free-standing table). A
     /// free-standing object is one that is not part of a Group, and
@@ -238,6 +265,9 @@ protected:
     virtual char* do_translate(ref_type ref) const noexcept = 0;
     char* translate_critical(RefTranslation*, ref_type ref) const noexcept;
     char* translate_less_critical(RefTranslation*, ref_type ref) const noexcept;
+    // Returns the address of 'ref' without any read barrier, or nullptr if it
+    // is in an encrypted mapping. Only for use as a hint.
+    char* translate_for_prefetch(ref_type ref) const noexcept;
     virtual void get_or_add_xover_mapping(RefTranslation&, size_t, size_t, size_t) = 0;
     Allocator() noexcept;
     size_t get_section_index(size_t pos) const noexcept;
@@ -304,6 +334,7 @@ protected:
 
 private:
     bool m_is_read_only = false; // prevent any alloc or free operations
+    size_t m_read_ahead = 0;
 
     friend class Table;
     friend class ClusterTree;
@@ -323,6 +354,7 @@ public:
         m_baseline.store(m_alloc->m_baseline, std::memory_order_relaxed);
         m_debug_watch = 0;
         m_ref_translation_ptr.store(m_alloc->m_ref_translation_ptr);
+        set_read_ahead(m_alloc->get_read_ahead());
     }
 
     ~WrappedAllocator()
@@ -335,6 +367,7 @@ public:
         m_baseline.store(m_alloc->m_baseline, std::memory_order_relaxed);
         m_debug_watch = 0;
         m_ref_translation_ptr.store(m_alloc->m_ref_translation_ptr);
+        set_read_ahead(m_alloc->get_read_ahead());
     }
 
     void update_from_underlying_allocator(bool writable)
@@ -569,6 +602,34 @@ inline char* Allocator::translate_critical(RefTranslation* ref_translation_ptr,
     }
 }
 
+inline char* Allocator::translate_for_prefetch(ref_type ref) const noexcept
+{
+    auto ref_translation_ptr = m_ref_translation_ptr.load(std::memory_order_acquire);
+    if (!ref_translation_ptr)
+        return nullptr;
+    size_t idx = get_section_index(ref);
+    RefTranslation& txl = ref_translation_ptr[idx];
+#if REALM_ENABLE_ENCRYPTION
+    if (txl.encrypted_mapping)
+        return nullptr;
+#endif
+    if (!txl.mapping_addr)
+        return nullptr;
+    // A node crossing the end of the section continues in a separate mapping, but its start is always in the
+    // primary one, which is all a hint needs
+    return txl.mapping_addr + (ref - get_section_base(idx));
+}
+
+inline void Allocator::prefetch(ref_type ref) const noexcept
+{
+#if defined(__GNUC__)
+    if (const char* addr = translate_for_prefetch(ref))
+        __builtin_prefetch(addr);
+#else
+    static_cast<void>(ref);
+#endif
+}
+
 inline char* Allocator::translate(ref_type ref) const noexcept
 {
     auto ref_translation_ptr = m_ref_translation_ptr.load(std::memory_order_acquire);
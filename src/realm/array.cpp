@@ -73,6 +73,17 @@
 //        0    |  number of bits      |  ceil(width * size / 8)
 //        1    |  number of bytes     |  width * size
 //        2    |  ignored             |  size
+//        3    |  number of bits      |  ceil(width * size / 8) + 8
+//
+//      With width scheme 3 (offset encoding) the elements are the offsets of
+//      the values from a 64 bit base value, which is stored after the offsets
+//      (8-byte aligned). The offsets use the same representation as width
+//      scheme 0.
+//
+//      If the context flag is set as well, the array is run length encoded.
+//      'size' is then the number of runs. The value of every run is stored
+//      like an element of width scheme 0, and the values are followed by the
+//      32 bit index one past the last element of every run (8-byte aligned).
 //
 //  5: 'width_ndx' (3 bits)
 //
@@ -286,7 +297,10 @@ ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
     // Write flat array
     const char* header = get_header_from_data(m_data);
     size_t byte_size = get_byte_size();
-    uint32_t dummy_checksum = 0x41414141UL;                                // "AAAA" in ASCII
+    uint32_t dummy_checksum = 0x41414141UL; // "AAAA" in ASCII
+    // Encoded arrays keep their encoding, and the byte size held in the capacity field, in the file
+    if (get_encoding_from_header(header) != encoding_None)
+        std::memcpy(&dummy_checksum, header, sizeof(dummy_checksum));
     ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
     REALM_ASSERT_3(new_ref % 8, ==, 0);                                    // 8-byte alignment
     return new_ref;
@@ -300,6 +314,7 @@ ref_type Array::do_write_deep(_impl::ArrayWriterBase& out, bool only_if_modified
     Type type = m_is_inner_bptree_node ? type_InnerBptreeNode : type_HasRefs;
     new_array.create(type, m_context_flag); // Throws
     _impl::ShallowArrayDestroyGuard dg(&new_array);
+    set_encoding_in_header(get_encoding_from_header(get_header()), new_array.get_header());
 
     // First write out all sub-arrays
     size_t n = size();
@@ -353,6 +368,7 @@ void Array::move(size_t begin, size_t end, size_t dest_begin)
 
 void Array::move(Array& dst, size_t ndx)
 {
+    copy_on_write(); // Throws
     size_t dest_begin = dst.m_size;
     size_t nb_to_move = m_size - ndx;
     dst.copy_on_write();
@@ -385,7 +401,7 @@ void Array::add_to_column(KeyColumn* column, int64_t value)
 void Array::set(size_t ndx, int64_t value)
 {
     REALM_ASSERT_3(ndx, <, m_size);
-    if ((this->*(m_vtable->getter))(ndx) == value)
+    if ((this->*m_getter)(ndx) == value)
         return;
 
     // Check if we need to copy before modifying
@@ -443,6 +459,8 @@ void Array::insert(size_t ndx, int_fast64_t value)
 {
     REALM_ASSERT_DEBUG(ndx <= m_size);
 
+    copy_on_write(); // Throws
+
     const auto old_width = m_width;
     const auto old_size = m_size;
     const Getter old_getter = m_getter; // Save old getter before potential width expansion
@@ -561,6 +579,15 @@ void Array::truncate_and_destroy_children(size_t new_size)
 
 void Array::do_ensure_minimum_width(int_fast64_t value)
 {
+    if (m_offset_encoded) {
+        expand_offsets(); // Throws
+        return;           // 64 bit elements can hold any value
+    }
+    if (m_run_encoded) {
+        expand_runs(); // Throws
+        if (value >= m_lbound && value <= m_ubound)
+            return;
+    }
 
     // Make room for the new value
     const size_t width = bit_width(value);
@@ -720,11 +747,114 @@ size_t find_zero(uint64_t v)
 } // namespace
 
 
+#ifdef REALM_COMPILER_AVX
 template <bool find_max, size_t w>
-bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+REALM_TARGET_AVX2 int64_t Array::minmax_avx2(const __m256i* data, size_t items, int64_t init,
+                                             const int64_t* skip) const
+{
+    // Lanes equal to 'skip' are replaced by 'init', which is a real element value and thus never changes the result
+    __m256i state;
+    __m256i skip_value;
+    if (w == 8) {
+        state = _mm256_set1_epi8(static_cast<char>(init));
+        skip_value = _mm256_set1_epi8(static_cast<char>(skip ? *skip : 0));
+    }
+    else if (w == 16) {
+        state = _mm256_set1_epi16(static_cast<short int>(init));
+        skip_value = _mm256_set1_epi16(static_cast<short int>(skip ? *skip : 0));
+    }
+    else if (w == 32) {
+        state = _mm256_set1_epi32(static_cast<int>(init));
+        skip_value = _mm256_set1_epi32(static_cast<int>(skip ? *skip : 0));
+    }
+    else {
+        state = _mm256_set1_epi64x(init);
+        skip_value = _mm256_set1_epi64x(skip ? *skip : 0);
+    }
+    const __m256i neutral = state;
+
+    for (size_t t = 0; t < items; ++t) {
+        __m256i v = _mm256_load_si256(data + t);
+        if (skip) {
+            __m256i is_skip;
+            if (w == 8)
+                is_skip = _mm256_cmpeq_epi8(v, skip_value);
+            else if (w == 16)
+                is_skip = _mm256_cmpeq_epi16(v, skip_value);
+            else if (w == 32)
+                is_skip = _mm256_cmpeq_epi32(v, skip_value);
+            else
+                is_skip = _mm256_cmpeq_epi64(v, skip_value);
+            v = _mm256_blendv_epi8(v, neutral, is_skip);
+        }
+
+        if (w == 8)
+            state = find_max ? _mm256_max_epi8(v, state) : _mm256_min_epi8(v, state);
+        else if (w == 16)
+            state = find_max ? _mm256_max_epi16(v, state) : _mm256_min_epi16(v, state);
+        else if (w == 32)
+            state = find_max ? _mm256_max_epi32(v, state) : _mm256_min_epi32(v, state);
+        else {
+            // There is no 64 bit min/max in AVX2, so select with a compare
+            __m256i v_greater = _mm256_cmpgt_epi64(v, state);
+            state = _mm256_blendv_epi8(find_max ? state : v, find_max ? v : state, v_greater);
+        }
+    }
+
+    // Reduce the lanes. Go through a char buffer to avoid aliasing problems, see get_universal().
+    char lanes[sizeof(__m256i)];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), state);
+    int64_t m = init;
+    for (size_t t = 0; t < sizeof(__m256i) * 8 / no0(w); ++t) {
+        int64_t v = get_universal<w>(lanes, t);
+        if (find_max ? v > m : v < m)
+            m = v;
+    }
+    return m;
+}
+
+template <size_t w>
+REALM_TARGET_AVX2 int64_t Array::sum_avx2(const __m256i* data, size_t items) const
 {
-    size_t best_index = 0;
+    // All widths are accumulated in 64 bit lanes, so no intermediate sum can overflow regardless of the array size
+    __m256i sum_result = _mm256_setzero_si256();
+    const __m256i sign_bias = _mm256_set1_epi8(-128);
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    for (size_t t = 0; t < items; ++t) {
+        __m256i v = _mm256_load_si256(data + t);
+        if (w == 8) {
+            // Bias the signed bytes into the unsigned range and let the sum of absolute differences against zero
+            // add up each group of 8 bytes into a 64 bit lane. The bias is subtracted again below.
+            v = _mm256_xor_si256(v, sign_bias);
+            sum_result = _mm256_add_epi64(sum_result, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+        }
+        else if (w == 16 || w == 32) {
+            // Pairwise add 16 bit elements into 32 bit lanes first, then sign extend 32 -> 64
+            if (w == 16)
+                v = _mm256_madd_epi16(v, ones);
+            __m256i lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v));
+            __m256i hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1));
+            sum_result = _mm256_add_epi64(sum_result, _mm256_add_epi64(lo, hi));
+        }
+        else {
+            sum_result = _mm256_add_epi64(sum_result, v);
+        }
+    }
+
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum_result);
+    // 64 bit element sums wrap around exactly like the scalar loop
+    uint64_t s = uint64_t(lanes[0]) + uint64_t(lanes[1]) + uint64_t(lanes[2]) + uint64_t(lanes[3]);
+    if (w == 8)
+        s -= uint64_t(128) * items * sizeof(__m256i);
+    return int64_t(s);
+}
+#endif // REALM_COMPILER_AVX
 
+template <bool find_max, size_t w>
+bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx, const int64_t* skip) const
+{
     if (end == size_t(-1))
         end = m_size;
     REALM_ASSERT_11(start, <, m_size, &&, end, <=, m_size, &&, start, <, end);
@@ -732,6 +862,15 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
     if (m_size == 0)
         return false;
 
+    if (skip) {
+        // Start out with the first element that is not skipped
+        start = find_first_stored<NotEqual, w>(*skip, start, end);
+        if (start == not_found)
+            return false;
+    }
+
+    size_t best_index = start;
+
     if (w == 0) {
         if (return_ndx)
             *return_ndx = best_index;
@@ -742,56 +881,36 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
     int64_t m = get<w>(start);
     ++start;
 
-#if 0 // We must now return both value AND index of result. SSE does not support finding index, so we've disabled it
-#ifdef REALM_COMPILER_SSE
-    if (sseavx<42>()) {
-        // Test manually until 128 bit aligned
-        for (; (start < end) && (((size_t(m_data) & 0xf) * 8 + start * w) % (128) != 0); start++) {
-            if (find_max ? get<w>(start) > m : get<w>(start) < m) {
-                m = get<w>(start);
+#ifdef REALM_COMPILER_AVX
+    if (w >= 8 && sseavx<2>() && (end - start) * w >= 4 * 256) {
+        // Test manually until 256 bit aligned
+        char* const a = static_cast<char*>(round_up(m_data + start * w / 8, sizeof(__m256i)));
+        char* const b = static_cast<char*>(round_down(m_data + end * w / 8, sizeof(__m256i)));
+        const size_t a_ndx = (a - m_data) * 8 / no0(w);
+        const size_t b_ndx = (b - m_data) * 8 / no0(w);
+        for (; start < a_ndx; ++start) {
+            const int64_t v = get<w>(start);
+            if ((find_max ? v > m : v < m) && !(skip && v == *skip)) {
+                m = v;
                 best_index = start;
             }
         }
 
-        if ((w == 8 || w == 16 || w == 32) && end - start > 2 * sizeof (__m128i) * 8 / no0(w)) {
-            __m128i* data = reinterpret_cast<__m128i*>(m_data + start * w / 8);
-            __m128i state = data[0];
-            char state2[sizeof (state)];
-
-            size_t chunks = (end - start) * w / 8 / sizeof (__m128i);
-            for (size_t t = 0; t < chunks; t++) {
-                if (w == 8)
-                    state = find_max ? _mm_max_epi8(data[t], state) : _mm_min_epi8(data[t], state);
-                else if (w == 16)
-                    state = find_max ? _mm_max_epi16(data[t], state) : _mm_min_epi16(data[t], state);
-                else if (w == 32)
-                    state = find_max ? _mm_max_epi32(data[t], state) : _mm_min_epi32(data[t], state);
-
-                start += sizeof (__m128i) * 8 / no0(w);
-            }
-
-            // Todo: prevent taking address of 'state' to make the compiler keep it in SSE register in above loop (vc2010/gcc4.6)
-
-            // We originally had declared '__m128i state2' and did an 'state2 = state' assignment. When we read from state2 through int16_t, int32_t or int64_t in GetUniversal(),
-            // the compiler thinks it cannot alias state2 and hence reorders the read and assignment.
-
-            // In this fixed version using memcpy, we have char-read-access from __m128i (OK aliasing) and char-write-access to char-array, and finally int8/16/32/64
-            // read access from char-array (OK aliasing).
-            memcpy(&state2, &state, sizeof state);
-            for (size_t t = 0; t < sizeof (__m128i) * 8 / no0(w); ++t) {
-                int64_t v = get_universal<w>(reinterpret_cast<char*>(&state2), t);
-                if (find_max ? v > m : v < m) {
-                    m = v;
-                }
-            }
+        // The vector kernel only yields the value, so find its first occurrence afterwards if it improved the result
+        int64_t vm =
+            minmax_avx2<find_max, w>(reinterpret_cast<const __m256i*>(a), (b - a) / sizeof(__m256i), m, skip);
+        if (find_max ? vm > m : vm < m) {
+            m = vm;
+            if (return_ndx)
+                best_index = find_first_stored<Equal, w>(vm, a_ndx, b_ndx);
         }
+        start = b_ndx;
     }
-#endif
 #endif
 
     for (; start < end; ++start) {
         const int64_t v = get<w>(start);
-        if (find_max ? v > m : v < m) {
+        if ((find_max ? v > m : v < m) && !(skip && v == *skip)) {
             m = v;
             best_index = start;
         }
@@ -803,18 +922,24 @@ bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx
     return true;
 }
 
-bool Array::maximum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+bool Array::maximum(int64_t& result, size_t start, size_t end, size_t* return_ndx, const int64_t* skip) const
 {
-    REALM_TEMPEX2(return minmax, true, m_width, (result, start, end, return_ndx));
+    if (REALM_UNLIKELY(m_run_encoded))
+        return minmax_runs<true>(result, start, end, return_ndx, skip);
+    REALM_TEMPEX2(return minmax, true, m_width, (result, start, end, return_ndx, skip));
 }
 
-bool Array::minimum(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+bool Array::minimum(int64_t& result, size_t start, size_t end, size_t* return_ndx, const int64_t* skip) const
 {
-    REALM_TEMPEX2(return minmax, false, m_width, (result, start, end, return_ndx));
+    if (REALM_UNLIKELY(m_run_encoded))
+        return minmax_runs<false>(result, start, end, return_ndx, skip);
+    REALM_TEMPEX2(return minmax, false, m_width, (result, start, end, return_ndx, skip));
 }
 
 int64_t Array::sum(size_t start, size_t end) const
 {
+    if (REALM_UNLIKELY(m_run_encoded))
+        return sum_runs(start, end);
     REALM_TEMPEX(return sum, m_width, (start, end));
 }
 
@@ -887,6 +1012,19 @@ int64_t Array::sum(size_t start, size_t end) const
         start += sizeof(int64_t) * 8 / no0(w) * chunks;
     }
 
+#ifdef REALM_COMPILER_AVX
+    if (w >= 8 && sseavx<2>() && (end - start) * w >= 2 * 256) {
+        // Sum manually until 256 bit aligned
+        for (; (start < end) && (((size_t(m_data) & 0x1f) * 8 + start * w) % 256 != 0); start++) {
+            s += get<w>(start);
+        }
+
+        size_t chunks = (end - start) * w / 256;
+        s += sum_avx2<w>(reinterpret_cast<const __m256i*>(m_data + start * w / 8), chunks);
+        start += 256 / no0(w) * chunks;
+    }
+#endif
+
 #ifdef REALM_COMPILER_SSE
     if (sseavx<42>()) {
 
@@ -986,6 +1124,15 @@ int64_t Array::sum(size_t start, size_t end) const
 
 size_t Array::count(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_run_encoded)) {
+        size_t value_count = 0;
+        for (size_t run = 0; run < m_run_count; ++run) {
+            if (get_run_value(run) == value)
+                value_count += m_run_ends[run] - run_begin(run);
+        }
+        return value_count;
+    }
+
     const uint64_t* next = reinterpret_cast<uint64_t*>(m_data);
     size_t value_count = 0;
     const size_t end = m_size;
@@ -1225,6 +1372,7 @@ MemRef Array::clone(MemRef mem, Allocator& alloc, Allocator& target_alloc)
     Type type = get_type_from_header(header);
     bool context_flag = get_context_flag_from_header(header);
     new_array.create(type, context_flag); // Throws
+    set_encoding_in_header(get_encoding_from_header(header), new_array.get_header());
 
     _impl::DeepArrayRefDestroyGuard dg_2(target_alloc);
     size_t n = array.size();
@@ -1379,7 +1527,8 @@ const typename Array::VTableForWidth<width>::PopulatedVTable Array::VTableForWid
 
 void Array::update_width_cache_from_header() noexcept
 {
-    auto width = get_width_from_header(get_header());
+    const char* header = get_header();
+    auto width = get_width_from_header(header);
     m_lbound = lbound_for_width(width);
     m_ubound = ubound_for_width(width);
 
@@ -1387,6 +1536,241 @@ void Array::update_width_cache_from_header() noexcept
 
     REALM_TEMPEX(m_vtable = &VTableForWidth, width, ::vtable);
     m_getter = m_vtable->getter;
+
+    // The vtable of a run length encoded array works on the values of the runs
+    m_run_encoded = get_is_run_encoded_from_header(header);
+    if (m_run_encoded) {
+        m_offset_encoded = false;
+        m_run_count = get_run_count_from_header(header);
+        m_run_ends = reinterpret_cast<const uint32_t*>(header + calc_byte_size(wtype_Bits, m_run_count, width));
+        m_getter = &Array::get_from_runs;
+        return;
+    }
+
+    // The vtable of an offset encoded array works on the offsets. Only the getter adds the base.
+    m_offset_encoded = get_wtype_from_header(header) == wtype_Offset;
+    if (m_offset_encoded) {
+        m_offset_base = get_offset_base_from_header(header);
+        REALM_TEMPEX(m_getter = &Array::get_with_offset_base, width, );
+    }
+}
+
+void Array::encode_offsets()
+{
+    REALM_ASSERT(is_attached());
+    REALM_ASSERT(!m_has_refs);
+    if (m_offset_encoded || m_run_encoded || m_size == 0)
+        return;
+
+    int64_t min_value;
+    int64_t max_value;
+    minimum(min_value);
+    maximum(max_value);
+
+    const size_t width = offset_width(uint64_t(max_value) - uint64_t(min_value));
+
+    size_t byte_size = calc_byte_size(wtype_Offset, m_size, uint_least8_t(width));
+    if (width == 64 || byte_size >= calc_byte_size(wtype_Bits, m_size, m_width))
+        return;
+
+    const int64_t base = int64_t(uint64_t(min_value) - uint64_t(lbound_for_width(width)));
+    MemRef mem = create_node(m_size, m_alloc, m_context_flag, type_Normal, wtype_Offset, int(width)); // Throws
+    char* header = mem.get_addr();
+    char* data = get_data_from_header(header);
+    for (size_t i = 0; i < m_size; ++i)
+        set_direct(data, width, i, int64_t(uint64_t(get(i)) - uint64_t(base)));
+    *reinterpret_cast<int64_t*>(header + calc_byte_size(wtype_Bits, m_size, uint_least8_t(width))) = base;
+
+    ref_type old_ref = m_ref;
+    const char* old_header = get_header();
+    Array::init_from_mem(mem);
+    update_parent(); // Throws
+    m_alloc.free_(old_ref, old_header);
+}
+
+size_t Array::offset_width(uint64_t range) noexcept
+{
+    // Find the smallest width able to hold all the offsets. The offsets use the same representation as elements of
+    // that width, i.e. they are unsigned below 8 bits and signed from 8 bits, so the base is chosen such that the
+    // smallest value maps to the lower bound of the width.
+    size_t width = 0;
+    while (width < 64 && range > uint64_t(ubound_for_width(width) - lbound_for_width(width)))
+        width = width ? width * 2 : 1;
+    return width;
+}
+
+void Array::encode_runs()
+{
+    REALM_ASSERT(is_attached());
+    REALM_ASSERT(!m_has_refs);
+    if (m_offset_encoded || m_run_encoded || m_size == 0)
+        return;
+
+    // Every run takes up at least 32 bits for its end, so give up as soon as there are too many of them
+    const size_t byte_size = calc_byte_size(wtype_Bits, m_size, m_width);
+    const size_t max_runs = (byte_size - header_size) / sizeof(uint32_t);
+    size_t num_runs = 1;
+    int64_t prev = get(0);
+    int64_t min_value = prev;
+    int64_t max_value = prev;
+    for (size_t i = 1; i < m_size; ++i) {
+        int64_t v = get(i);
+        if (v != prev) {
+            if (++num_runs > max_runs)
+                return;
+            min_value = std::min(min_value, v);
+            max_value = std::max(max_value, v);
+            prev = v;
+        }
+    }
+
+    const size_t runs_byte_size = calc_run_encoded_byte_size(num_runs, m_width);
+    if (runs_byte_size >= byte_size)
+        return;
+    const size_t width = offset_width(uint64_t(max_value) - uint64_t(min_value));
+    if (width < 64 && runs_byte_size >= calc_byte_size(wtype_Offset, m_size, uint_least8_t(width)))
+        return;
+
+    // The array is allocated with its exact byte size, which the capacity field then holds
+    MemRef mem = m_alloc.alloc(runs_byte_size); // Throws
+    char* header = mem.get_addr();
+    init_header(header, false, false, m_context_flag, wtype_Bits, int(m_width), m_size, runs_byte_size);
+    set_encoding_in_header(encoding_Runs, header);
+    *reinterpret_cast<uint64_t*>(header + runs_byte_size - 8) = num_runs;
+    char* data = get_data_from_header(header);
+    uint32_t* ends = reinterpret_cast<uint32_t*>(header + calc_byte_size(wtype_Bits, num_runs, m_width));
+    size_t run = 0;
+    prev = get(0);
+    for (size_t i = 1; i < m_size; ++i) {
+        int64_t v = get(i);
+        if (v != prev) {
+            set_direct(data, m_width, run, prev);
+            ends[run++] = uint32_t(i);
+            prev = v;
+        }
+    }
+    set_direct(data, m_width, run, prev);
+    ends[run] = uint32_t(m_size);
+
+    ref_type old_ref = m_ref;
+    const char* old_header = get_header();
+    Array::init_from_mem(mem);
+    update_parent(); // Throws
+    m_alloc.free_(old_ref, old_header);
+}
+
+void Array::expand_runs()
+{
+    REALM_ASSERT(m_run_encoded);
+
+    MemRef mem = create_node(m_size, m_alloc, m_context_flag, type_Normal, wtype_Bits, m_width); // Throws
+    char* data = get_data_from_header(mem.get_addr());
+    for (size_t run = 0; run < m_run_count; ++run) {
+        int64_t v = get_run_value(run);
+        for (size_t i = run_begin(run); i < m_run_ends[run]; ++i)
+            set_direct(data, m_width, i, v);
+    }
+
+    ref_type old_ref = m_ref;
+    const char* old_header = get_header();
+    Array::init_from_mem(mem);
+    update_parent(); // Throws
+    m_alloc.free_(old_ref, old_header);
+}
+
+template <bool find_max>
+bool Array::minmax_runs(int64_t& result, size_t start, size_t end, size_t* return_ndx, const int64_t* skip) const
+{
+    if (end == size_t(-1))
+        end = m_size;
+
+    bool found = false;
+    for (size_t run = run_of(start); start < end; ++run) {
+        const int64_t v = get_run_value(run);
+        if (!(skip && v == *skip) && (!found || (find_max ? v > result : v < result))) {
+            result = v;
+            if (return_ndx)
+                *return_ndx = start;
+            found = true;
+        }
+        start = m_run_ends[run];
+    }
+    return found;
+}
+
+int64_t Array::sum_runs(size_t start, size_t end) const noexcept
+{
+    if (end == size_t(-1))
+        end = m_size;
+
+    uint64_t s = 0;
+    for (size_t run = run_of(start); start < end; ++run) {
+        const size_t run_end = std::min(size_t(m_run_ends[run]), end);
+        s += uint64_t(get_run_value(run)) * (run_end - start);
+        start = run_end;
+    }
+    return int64_t(s);
+}
+
+// The values of a sorted array are sorted runs
+size_t Array::bound_runs(int64_t value, bool upper) const noexcept
+{
+    size_t lo = 0;
+    size_t hi = m_run_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int64_t v = get_run_value(mid);
+        if (upper ? v <= value : v < value)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return run_begin(lo);
+}
+
+void Array::expand_offsets()
+{
+    REALM_ASSERT(m_offset_encoded);
+
+    MemRef mem = create_node(m_size, m_alloc, m_context_flag, type_Normal, wtype_Bits, 64); // Throws
+    char* data = get_data_from_header(mem.get_addr());
+    for (size_t i = 0; i < m_size; ++i)
+        set_direct<64>(data, i, get(i));
+
+    ref_type old_ref = m_ref;
+    const char* old_header = get_header();
+    Array::init_from_mem(mem);
+    update_parent(); // Throws
+    m_alloc.free_(old_ref, old_header);
+}
+
+void Array::get_range(size_t begin, size_t end, int64_t* dest) const noexcept
+{
+    REALM_ASSERT_DEBUG(begin <= end && end <= m_size);
+    if (REALM_UNLIKELY(m_run_encoded)) {
+        for (size_t run = run_of(begin); begin < end; ++run) {
+            const size_t run_end = std::min(size_t(m_run_ends[run]), end);
+            dest = std::fill_n(dest, run_end - begin, get_run_value(run));
+            begin = run_end;
+        }
+        return;
+    }
+    REALM_TEMPEX(get_range, m_width, (begin, end, dest));
+    if (REALM_UNLIKELY(m_offset_encoded)) {
+        for (size_t i = 0; i < end - begin; ++i)
+            dest[i] = int64_t(uint64_t(dest[i]) + uint64_t(m_offset_base));
+    }
+}
+
+template <size_t w>
+void Array::get_range(size_t begin, size_t end, int64_t* dest) const noexcept
+{
+    if (w == 64) {
+        std::memcpy(dest, m_data + begin * sizeof(int64_t), (end - begin) * sizeof(int64_t));
+        return;
+    }
+    for (size_t i = begin; i < end; ++i)
+        *dest++ = get<w>(i);
 }
 
 // This method reads 8 concecutive values into res[8], starting from index 'ndx'. It's allowed for the 8 values to
@@ -1573,11 +1957,19 @@ void Array::verify() const
 
 size_t Array::lower_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_run_encoded))
+        return bound_runs(value, false);
+    if (m_offset_encoded)
+        value = to_offset(value);
     REALM_TEMPEX(return lower_bound, m_width, (m_data, m_size, value));
 }
 
 size_t Array::upper_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_run_encoded))
+        return bound_runs(value, true);
+    if (m_offset_encoded)
+        value = to_offset(value);
     REALM_TEMPEX(return upper_bound, m_width, (m_data, m_size, value));
 }
 
@@ -1632,15 +2024,29 @@ int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 {
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
-    return get_direct(data, width, ndx);
+    if (REALM_UNLIKELY(get_is_run_encoded_from_header(header))) {
+        size_t num_runs = get_run_count_from_header(header);
+        auto ends = reinterpret_cast<const uint32_t*>(header + calc_byte_size(wtype_Bits, num_runs, width));
+        return get_direct(data, width, size_t(std::upper_bound(ends, ends + num_runs, uint32_t(ndx)) - ends));
+    }
+    int64_t v = get_direct(data, width, ndx);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Offset))
+        return int64_t(uint64_t(v) + uint64_t(get_offset_base_from_header(header)));
+    return v;
 }
 
 
 std::pair<int64_t, int64_t> Array::get_two(const char* header, size_t ndx) noexcept
 {
+    if (REALM_UNLIKELY(get_is_run_encoded_from_header(header)))
+        return std::make_pair(get(header, ndx), get(header, ndx + 1));
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     std::pair<int64_t, int64_t> p = ::get_two(data, width, ndx);
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Offset)) {
+        uint64_t base = uint64_t(get_offset_base_from_header(header));
+        return std::make_pair(int64_t(uint64_t(p.first) + base), int64_t(uint64_t(p.second) + base));
+    }
     return std::make_pair(p.first, p.second);
 }
 
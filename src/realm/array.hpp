@@ -68,11 +68,15 @@ Searching: The main finding function is:
     SSE4A: ammintrin.h
     SSE4.1: smmintrin.h
     SSE4.2: nmmintrin.h
+    AVX, AVX2, AVX-512: immintrin.h
 */
 #ifdef REALM_COMPILER_SSE
 #include <emmintrin.h>             // SSE2
 #include <realm/realm_nmmintrin.h> // SSE42
 #endif
+#ifdef REALM_COMPILER_AVX
+#include <immintrin.h> // AVX2 and AVX-512, only used from functions carrying a REALM_TARGET_* attribute
+#endif
 
 namespace realm {
 
@@ -246,6 +250,13 @@ public:
     template <size_t w>
     void get_chunk(size_t ndx, int64_t res[8]) const noexcept;
 
+    /// Read the elements in [begin, end) into 'dest'. Much faster than
+    /// calling get() for each of them, as the width is only resolved once.
+    void get_range(size_t begin, size_t end, int64_t* dest) const noexcept;
+
+    template <size_t w>
+    void get_range(size_t begin, size_t end, int64_t* dest) const noexcept;
+
     ref_type get_as_ref(size_t ndx) const noexcept;
 
     RefOrTagged get_as_ref_or_tagged(size_t ndx) const noexcept;
@@ -335,6 +346,40 @@ public:
     /// you call it after ensure_minimum_width().
     void set_all_to_zero();
 
+    /// Change the representation of this array to a frame of reference
+    /// encoding (wtype_Offset) if that takes up less space. Every element is
+    /// then stored as the bit packed offset from a common 64 bit base value,
+    /// so for example timestamps or increasing ids that are close to each
+    /// other use only a fraction of the 64 bits per element that they would
+    /// otherwise need. Only applicable to arrays of integers without refs.
+    ///
+    /// An offset encoded array can be read like any other integer array. It
+    /// is expanded to 64 bit elements before it is modified.
+    void encode_offsets();
+
+    bool is_offset_encoded() const noexcept
+    {
+        return m_offset_encoded;
+    }
+
+    /// Change the representation of this array to a run length encoding if
+    /// that takes up less space than both the current representation and the
+    /// one encode_offsets() would choose. Every run of equal consecutive
+    /// elements is then stored as its value and the index where it ends, so
+    /// for example a column that is sorted or that holds the same value for
+    /// long stretches of objects shrinks to a handful of runs. Only
+    /// applicable to arrays of integers without refs.
+    ///
+    /// A run length encoded array can be read like any other integer array.
+    /// Searches and aggregates handle a whole run at a time. It is decoded
+    /// before it is modified.
+    void encode_runs();
+
+    bool is_run_encoded() const noexcept
+    {
+        return m_run_encoded;
+    }
+
     /// Add \a diff to the element at the specified index.
     void adjust(size_t ndx, int_fast64_t diff);
 
@@ -390,6 +435,11 @@ public:
 
     int64_t get_sum(size_t start = 0, size_t end = size_t(-1)) const
     {
+        if (REALM_UNLIKELY(m_offset_encoded)) {
+            if (end == size_t(-1))
+                end = m_size;
+            return int64_t(uint64_t(sum(start, end)) + uint64_t(m_offset_base) * (end - start));
+        }
         return sum(start, end);
     }
 
@@ -580,6 +630,23 @@ public:
 
 #endif
 
+// AVX2 (256 bit) and AVX-512 (512 bit) find for the four functions Equal/NotEqual/Less/Greater
+#ifdef REALM_COMPILER_AVX
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX2 bool find_avx2(int64_t value, __m256i* data, size_t items, QueryState<int64_t>* state,
+                                     size_t baseindex, Callback callback) const;
+
+    template <class cond, Action action, size_t width, class Callback>
+    REALM_TARGET_AVX512 bool find_avx512(int64_t value, __m512i* data, size_t items, QueryState<int64_t>* state,
+                                         size_t baseindex, Callback callback) const;
+
+    // Searches the range [start, end) by comparing the unaligned head and tail with compare() and the vector aligned
+    // middle part with find_avx2() or find_avx512() depending on 'vector_bits' (256 or 512)
+    template <class cond, Action action, size_t width, class Callback, size_t vector_bits>
+    bool find_wide(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                   Callback callback) const;
+#endif
+
     template <size_t width>
     inline bool test_zero(uint64_t value) const; // Tests value for 0-elements
 
@@ -676,18 +743,98 @@ private:
 
     void do_ensure_minimum_width(int_fast64_t);
 
+    // Offset encoded arrays store the base value after the offsets
+    static int64_t get_offset_base_from_header(const char* header) noexcept;
+
+    template <size_t w>
+    int64_t get_with_offset_base(size_t ndx) const noexcept;
+
+    // Converts a value to the domain of the offsets. Values that cannot be represented saturate, which is safe as the
+    // offsets never need all 64 bits.
+    int64_t to_offset(int64_t value) const noexcept;
+
+    // Replaces an offset encoded array by a plain one with 64 bit elements
+    void expand_offsets();
+
+    // The smallest width of the offsets of values spanning the specified range, or 64 if they need all 64 bits
+    static size_t offset_width(uint64_t range) noexcept;
+
+    // Replaces a run length encoded array by a plain one of the same width
+    void expand_runs();
+
+    // Index of the run holding the element at the specified index
+    size_t run_of(size_t ndx) const noexcept
+    {
+        return size_t(std::upper_bound(m_run_ends, m_run_ends + m_run_count, uint32_t(ndx)) - m_run_ends);
+    }
+    size_t run_begin(size_t run) const noexcept
+    {
+        return run ? m_run_ends[run - 1] : 0;
+    }
+    int64_t get_run_value(size_t run) const noexcept
+    {
+        return (this->*(m_vtable->getter))(run);
+    }
+    int64_t get_from_runs(size_t ndx) const noexcept
+    {
+        return get_run_value(run_of(ndx));
+    }
+
+    template <class cond, Action action, class Callback>
+    bool find_runs(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                   Callback callback, bool nullable_array, bool find_null) const;
+
+    template <bool find_max>
+    bool minmax_runs(int64_t& result, size_t start, size_t end, size_t* return_ndx, const int64_t* skip) const;
+    int64_t sum_runs(size_t start, size_t end) const noexcept;
+    size_t bound_runs(int64_t value, bool upper) const noexcept;
+
+    template <class cond, Action action, size_t bitwidth, class Callback>
+    bool find_offsets(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                      Callback callback, bool nullable_array, bool find_null) const;
+
+    // Like find_first(), but compares with the elements as they are stored, i.e. the offsets of an offset encoded
+    // array. For use by the kernels that work on the stored elements.
+    template <class cond, size_t bitwidth>
+    size_t find_first_stored(int64_t value, size_t start, size_t end) const;
+
     int64_t sum(size_t start, size_t end) const;
     size_t count(int64_t value) const noexcept;
 
-    bool maximum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+    // Elements equal to '*skip' are ignored if 'skip' is given. Returns false if no element was considered.
+    bool maximum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr,
+                 const int64_t* skip = nullptr) const;
 
-    bool minimum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const;
+    bool minimum(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr,
+                 const int64_t* skip = nullptr) const;
 
     template <size_t w>
     int64_t sum(size_t start, size_t end) const;
 
     template <bool max, size_t w>
-    bool minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const;
+    bool minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx, const int64_t* skip) const;
+
+    // Aggregates the non-null elements in [start, end) of a nullable array, where 'start' and 'end' are positions in
+    // the payload, i.e. the null value at position 0 is not included
+    template <Action action, size_t bitwidth, class Callback>
+    bool aggregate_non_null(size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                            Callback callback) const;
+
+    // Searches the payload [start, end) of a nullable array for non-null elements matching 'value'. The elements are
+    // compared 64 at a time into a bitmap of matches, from which the bitmap of null elements is removed.
+    template <class cond, Action action, size_t bitwidth, class Callback>
+    bool find_non_null(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                       Callback callback) const;
+
+#ifdef REALM_COMPILER_AVX
+    // 'items' is the number of 32-byte chunks in 'data'
+    template <bool max, size_t w>
+    REALM_TARGET_AVX2 int64_t minmax_avx2(const __m256i* data, size_t items, int64_t init,
+                                          const int64_t* skip) const;
+
+    template <size_t w>
+    REALM_TARGET_AVX2 int64_t sum_avx2(const __m256i* data, size_t items) const;
+#endif
 
 protected:
     /// It is an error to specify a non-zero value unless the width
@@ -695,6 +842,24 @@ protected:
     /// size if the width type is wtype_Ignore.
     static MemRef create(Type, bool context_flag, WidthType, size_t size, int_fast64_t value, Allocator&);
 
+    // Encoded arrays are expanded before they are modified, see encode_offsets() and encode_runs()
+    void copy_on_write()
+    {
+        if (REALM_UNLIKELY(m_offset_encoded))
+            expand_offsets(); // Throws
+        if (REALM_UNLIKELY(m_run_encoded))
+            expand_runs(); // Throws
+        Node::copy_on_write(); // Throws
+    }
+    void copy_on_write(size_t min_size)
+    {
+        if (REALM_UNLIKELY(m_offset_encoded))
+            expand_offsets(); // Throws
+        if (REALM_UNLIKELY(m_run_encoded))
+            expand_runs(); // Throws
+        Node::copy_on_write(min_size); // Throws
+    }
+
     // Overriding method in ArrayParent
     void update_child_ref(size_t, ref_type) override;
 
@@ -741,10 +906,17 @@ protected:
     bool m_context_flag;         // Meaning depends on context.
 
 private:
+    bool m_offset_encoded = false; // Elements are offsets from m_offset_base (wtype_Offset)
+    int64_t m_offset_base = 0;
+    bool m_run_encoded = false; // Elements are runs of equal values (encoding_Runs)
+    size_t m_run_count = 0;
+    const uint32_t* m_run_ends = nullptr; // One past the last index of every run
+
     ref_type do_write_shallow(_impl::ArrayWriterBase&) const;
     ref_type do_write_deep(_impl::ArrayWriterBase&, bool only_if_modified) const;
 
     friend class Allocator;
+    friend class ArrayDecimal128;
     friend class SlabAlloc;
     friend class GroupWriter;
 };
@@ -764,6 +936,8 @@ template <>
 class QueryState<int64_t> : public QueryStateBase {
 public:
     int64_t m_state = 0;
+    // If set, act_FindAll marks the index of each match in this bitmap instead of adding it to a column
+    uint64_t* m_match_bits = nullptr;
 
     template <Action action>
     bool uses_val()
@@ -828,7 +1002,10 @@ public:
             m_match_count = size_t(m_state);
         }
         else if (action == act_FindAll) {
-            if (m_key_values) {
+            if (m_match_bits) {
+                m_match_bits[index >> 6] |= uint64_t(1) << (index & 63);
+            }
+            else if (m_key_values) {
                 int64_t key_value = m_key_values->get(index) + m_key_offset;
                 Array::add_to_column(reinterpret_cast<KeyColumn*>(m_state), key_value);
             }
@@ -861,7 +1038,10 @@ public:
             m_match_count = size_t(m_state);
         }
         else if (action == act_FindAll) {
-            if (m_key_values) {
+            if (m_match_bits) {
+                m_match_bits[index >> 6] |= uint64_t(1) << (index & 63);
+            }
+            else if (m_key_values) {
                 int64_t key_value = m_key_values->get(index) + m_key_offset;
                 Array::add_to_column(reinterpret_cast<KeyColumn*>(m_state), key_value);
             }
@@ -963,7 +1143,18 @@ inline Array::Type Array::get_type() const noexcept
 inline void Array::get_chunk(size_t ndx, int64_t res[8]) const noexcept
 {
     REALM_ASSERT_DEBUG(ndx < m_size);
+    if (REALM_UNLIKELY(m_run_encoded)) {
+        size_t n = std::min(m_size - ndx, size_t(8));
+        for (size_t i = 0; i < n; ++i)
+            res[i] = get_from_runs(ndx + i);
+        return;
+    }
     (this->*(m_vtable->chunk_getter))(ndx, res);
+    if (REALM_UNLIKELY(m_offset_encoded)) {
+        size_t n = std::min(m_size - ndx, size_t(8));
+        for (size_t i = 0; i < n; ++i)
+            res[i] = int64_t(uint64_t(res[i]) + uint64_t(m_offset_base));
+    }
 }
 
 
@@ -990,6 +1181,27 @@ inline int64_t Array::get(size_t ndx) const noexcept
     */
 }
 
+template <size_t w>
+int64_t Array::get_with_offset_base(size_t ndx) const noexcept
+{
+    return int64_t(uint64_t(get<w>(ndx)) + uint64_t(m_offset_base));
+}
+
+inline int64_t Array::get_offset_base_from_header(const char* header) noexcept
+{
+    // The base follows the 8-byte aligned offsets
+    size_t offsets_size = calc_byte_size(wtype_Bits, get_size_from_header(header), get_width_from_header(header));
+    return *reinterpret_cast<const int64_t*>(header + offsets_size);
+}
+
+inline int64_t Array::to_offset(int64_t value) const noexcept
+{
+    int64_t offset = value;
+    if (util::int_subtract_with_overflow_detect(offset, m_offset_base))
+        return value < 0 ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+    return offset;
+}
+
 inline int64_t Array::front() const noexcept
 {
     return get(0);
@@ -1188,7 +1400,8 @@ inline size_t Array::get_byte_size() const noexcept
 {
     const char* header = get_header_from_data(m_data);
     WidthType wtype = Node::get_wtype_from_header(header);
-    size_t num_bytes = NodeHeader::calc_byte_size(wtype, m_size, m_width);
+    size_t num_bytes = REALM_UNLIKELY(m_run_encoded) ? NodeHeader::calc_run_encoded_byte_size(m_run_count, m_width)
+                                                     : NodeHeader::calc_byte_size(wtype, m_size, m_width);
 
     REALM_ASSERT_7(m_alloc.is_read_only(m_ref), ==, true, ||, num_bytes, <=, get_capacity_from_header(header));
 
@@ -1469,11 +1682,14 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
             // if this is what we are looking for. And we have to adjust the indexes to compensate for the
             // null value at position 0.
             if (find_null) {
-                value = get(0);
+                // Null elements do not contribute to the aggregates of values
+                if (action == act_Sum || action == act_Max || action == act_Min)
+                    return true;
+                value = get<bitwidth>(0);
             }
             else {
                 // If the value to search for is equal to the null value, the value cannot be in the array
-                if (value == get(0)) {
+                if (value == get<bitwidth>(0)) {
                     return true;
                 }
             }
@@ -1482,10 +1698,43 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
             baseindex--;
         }
         else {
+            if (std::is_same<cond, NotNull>::value &&
+                (action == act_Sum || action == act_Max || action == act_Min || action == act_Count) &&
+                end - start2 <= state->m_limit - state->m_match_count) {
+                // Aggregating all non-null values, which can be done on the whole payload at once
+                return aggregate_non_null<action, bitwidth, Callback>(start2 + 1, end + 1, baseindex - 1, state,
+                                                                      callback);
+            }
+
+            // The search kernels for non-nullable arrays support these conditions
+            constexpr bool has_kernel = std::is_same<cond, Greater>::value || std::is_same<cond, Less>::value ||
+                                        std::is_same<cond, NotEqual>::value;
+            constexpr bool ordered = std::is_same<cond, GreaterEqual>::value || std::is_same<cond, LessEqual>::value;
+            auto null_value = get<bitwidth>(0);
+            if ((has_kernel || ordered) && !find_null && value != null_value) {
+                // Null elements hold the null value. When comparing the null value with 'value' gives the same result
+                // as comparing null does, the payload can be searched like a non-nullable array. That does not work
+                // for aggregates of values, but null matches contribute nothing to those anyway.
+                constexpr bool null_matches = std::is_same<cond, NotEqual>::value;
+                constexpr bool aggregate = action == act_Sum || action == act_Max || action == act_Min;
+                if (has_kernel && c(null_value, value) == null_matches && !(null_matches && aggregate)) {
+                    start2++;
+                    end++;
+                    baseindex--;
+                    nullable_array = false;
+                }
+                else {
+                    return find_non_null<cond, action, bitwidth, Callback>(value, start2 + 1, end + 1, baseindex - 1,
+                                                                           state, callback);
+                }
+            }
+        }
+    }
+
+    if (nullable_array) {
+        if (!std::is_same<cond, Equal>::value) {
             // We were called by find() of a nullable array. So skip first entry, take nulls in count, etc, etc.
-            // Fixme:
-            // Huge speed optimizations are possible here! This is a very simple generic method.
-            auto null_value = get(0);
+            auto null_value = get<bitwidth>(0);
             for (; start2 < end; start2++) {
                 int64_t v = get<bitwidth>(start2 + 1);
                 bool value_is_null = (v == null_value);
@@ -1570,6 +1819,7 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
         }
         else if (action == act_Count) {
             state->m_state += end2 - start2;
+            state->m_match_count = size_t(state->m_state);
         }
         else {
             for (; start2 < end2; start2++)
@@ -1582,6 +1832,15 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_width, !=, 0);
 
+#if defined(REALM_COMPILER_AVX)
+    // Prefer the widest vector registers the CPU has. Unlike SSE, both AVX2 and AVX-512 can evaluate all four
+    // conditions for every byte aligned width, but only pay off if the payload spans a few vectors.
+    if (m_width >= 8 && (end - start2) * m_width >= 2 * 512 && sseavx<512>())
+        return find_wide<cond, action, bitwidth, Callback, 512>(value, start2, end, baseindex, state, callback);
+    if (m_width >= 8 && (end - start2) * m_width >= 2 * 256 && sseavx<2>())
+        return find_wide<cond, action, bitwidth, Callback, 256>(value, start2, end, baseindex, state, callback);
+#endif
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -1628,6 +1887,79 @@ bool Array::find_optimized(int64_t value, size_t start, size_t end, size_t basei
 #endif
 }
 
+template <class cond, Action action, size_t bitwidth, class Callback>
+bool Array::find_non_null(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                          Callback callback) const
+{
+    const int64_t null_value = get<bitwidth>(0);
+    cond c;
+    while (start < end) {
+        size_t block_size = std::min<size_t>(64, end - start);
+        uint64_t matches = 0;
+        uint64_t nulls = 0;
+        for (size_t i = 0; i < block_size; ++i) {
+            int64_t v = get<bitwidth>(start + i);
+            matches |= uint64_t(c(v, value)) << i;
+            nulls |= uint64_t(v == null_value) << i;
+        }
+        matches &= ~nulls;
+
+        if (action == act_Count && state->m_match_count + 64 < state->m_limit) {
+            state->m_state += fast_popcount64(matches);
+            state->m_match_count = size_t(state->m_state);
+        }
+        else {
+            while (matches) {
+                size_t i = first_set_bit64(matches);
+                if (!find_action<action, Callback>(start + i + baseindex, get<bitwidth>(start + i), state, callback))
+                    return false;
+                matches &= matches - 1;
+            }
+        }
+        start += block_size;
+    }
+    return true;
+}
+
+template <Action action, size_t bitwidth, class Callback>
+bool Array::aggregate_non_null(size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                               Callback callback) const
+{
+    const int64_t null_value = get<bitwidth>(0);
+    QueryState<int64_t> nulls(act_Count);
+    find_optimized<Equal, act_Count, bitwidth, Callback>(null_value, start, end, 0, &nulls, callback);
+    const size_t null_count = size_t(nulls.m_state);
+    const size_t value_count = end - start - null_count;
+    if (value_count == 0)
+        return true;
+
+    if (action == act_Count) {
+        state->m_state += value_count;
+        state->m_match_count = size_t(state->m_state);
+        return true;
+    }
+
+    int64_t res;
+    size_t res_ndx = 0;
+    if (action == act_Sum) {
+        // Each null entry contributed 'null_value' to the sum of the payload. Use unsigned arithmetic so that the
+        // correction is well defined even if the intermediate sum wraps around.
+        res = int64_t(uint64_t(sum(start, end)) - uint64_t(null_value) * null_count);
+    }
+    else {
+        const int64_t* skip = null_count ? &null_value : nullptr;
+        if (action == act_Max)
+            maximum(res, start, end, &res_ndx, skip);
+        else
+            minimum(res, start, end, &res_ndx, skip);
+    }
+
+    find_action<action, Callback>(res_ndx + baseindex, res, state, callback);
+    // find_action will increment match count by 1, so only add the remaining matches
+    state->m_match_count += value_count - 1;
+    return true;
+}
+
 template <size_t width>
 inline int64_t Array::lower_bits() const
 {
@@ -2009,10 +2341,122 @@ template <class cond, Action action, size_t bitwidth, class Callback>
 bool Array::find(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
                  Callback callback, bool nullable_array, bool find_null) const
 {
+    if (REALM_UNLIKELY(m_run_encoded))
+        return find_runs<cond, action, Callback>(value, start, end, baseindex, state, callback, nullable_array,
+                                                 find_null);
+    if (REALM_UNLIKELY(m_offset_encoded))
+        return find_offsets<cond, action, bitwidth, Callback>(value, start, end, baseindex, state, callback,
+                                                              nullable_array, find_null);
     return find_optimized<cond, action, bitwidth, Callback>(value, start, end, baseindex, state, callback,
                                                             nullable_array, find_null);
 }
 
+// The search itself is done on the offsets. Actions that depend on the values found are collected in a separate state
+// which is then translated back and merged into 'state'.
+template <class cond, Action action, size_t bitwidth, class Callback>
+bool Array::find_offsets(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                         Callback callback, bool nullable_array, bool find_null) const
+{
+    value = to_offset(value);
+    if (action != act_Sum && action != act_Max && action != act_Min)
+        return find_optimized<cond, action, bitwidth, Callback>(value, start, end, baseindex, state, callback,
+                                                                nullable_array, find_null);
+
+    QueryState<int64_t> offsets_state(action, state->m_limit - state->m_match_count);
+    bool cont = find_optimized<cond, action, bitwidth, Callback>(value, start, end, baseindex, &offsets_state,
+                                                                 callback, nullable_array, find_null);
+    size_t matches = offsets_state.m_match_count;
+    if (matches == 0)
+        return cont;
+
+    if (action == act_Sum) {
+        state->m_state = int64_t(uint64_t(state->m_state) + uint64_t(offsets_state.m_state) +
+                                 uint64_t(m_offset_base) * matches);
+        state->m_match_count += matches;
+    }
+    else {
+        int64_t res = int64_t(uint64_t(offsets_state.m_state) + uint64_t(m_offset_base));
+        state->template match<action, false>(offsets_state.m_minmax_index, 0, res);
+        // match() has incremented the match count by 1, so only add the remaining matches
+        state->m_match_count += matches - 1;
+    }
+    return cont && state->m_limit > state->m_match_count;
+}
+
+template <class cond, size_t bitwidth>
+size_t Array::find_first_stored(int64_t value, size_t start, size_t end) const
+{
+    QueryState<int64_t> state(act_ReturnFirst, 1);
+    find_optimized<cond, act_ReturnFirst, bitwidth, CallbackDummy>(value, start, end, 0, &state, CallbackDummy());
+    return static_cast<size_t>(state.m_state);
+}
+
+// The condition is evaluated once per run. Counts and aggregates of a matching run are computed from its length and
+// value, while the other actions are reported for every element of the run.
+template <class cond, Action action, class Callback>
+bool Array::find_runs(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                      Callback callback, bool nullable_array, bool find_null) const
+{
+    REALM_ASSERT(!(find_null && !nullable_array));
+    cond c;
+
+    if (end == npos)
+        end = nullable_array ? m_size - 1 : m_size;
+
+    // The null value of a nullable array is stored in front of the elements
+    int64_t null_value = 0;
+    if (nullable_array) {
+        null_value = get_from_runs(0);
+        start++;
+        end++;
+        baseindex--;
+    }
+
+    for (size_t run = run_of(start); start < end; ++run) {
+        const size_t run_end = std::min(size_t(m_run_ends[run]), end);
+        const int64_t v = get_run_value(run);
+        const bool value_is_null = nullable_array && v == null_value;
+        const bool match = nullable_array ? c(v, value, value_is_null, find_null) : c(v, value);
+        if (!match) {
+            start = run_end;
+            continue;
+        }
+
+        if (action == act_Count || action == act_Sum || action == act_Max || action == act_Min) {
+            // Null elements do not contribute to the aggregates of values
+            if (action != act_Count && value_is_null) {
+                start = run_end;
+                continue;
+            }
+            size_t n = std::min(run_end - start, state->m_limit - state->m_match_count);
+            if (action == act_Count) {
+                state->m_state += n;
+                state->m_match_count = size_t(state->m_state);
+            }
+            else if (action == act_Sum) {
+                state->m_state = int64_t(uint64_t(state->m_state) + uint64_t(v) * n);
+                state->m_match_count += n;
+            }
+            else {
+                state->template match<action, false>(start + baseindex, 0, v);
+                // match() has incremented the match count by 1, so only add the remaining matches
+                state->m_match_count += n - 1;
+            }
+            if (state->m_match_count >= state->m_limit)
+                return false;
+        }
+        else {
+            util::Optional<int64_t> v2(value_is_null ? util::none : util::make_optional(v));
+            for (; start < run_end; ++start) {
+                if (!find_action<action, Callback>(start + baseindex, v2, state, callback))
+                    return false;
+            }
+        }
+        start = run_end;
+    }
+    return true;
+}
+
 #ifdef REALM_COMPILER_SSE
 // 'items' is the number of 16-byte SSE chunks. Returns index of packed element relative to first integer of first
 // chunk
@@ -2116,6 +2560,187 @@ REALM_FORCEINLINE bool Array::find_sse_intern(__m128i* action_data, __m128i* dat
 }
 #endif // REALM_COMPILER_SSE
 
+#ifdef REALM_COMPILER_AVX
+template <class cond, Action action, size_t width, class Callback, size_t vector_bits>
+bool Array::find_wide(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                      Callback callback) const
+{
+    // find_avx2() and find_avx512() must start at a vector boundary, so search area before that using compare()
+    char* const a = static_cast<char*>(round_up(m_data + start * width / 8, vector_bits / 8));
+    char* const b = static_cast<char*>(round_down(m_data + end * width / 8, vector_bits / 8));
+    size_t a_ndx = (a - m_data) * 8 / no0(width);
+    size_t b_ndx = (b - m_data) * 8 / no0(width);
+
+    if (!compare<cond, action, width, Callback>(value, start, a_ndx, baseindex, state, callback))
+        return false;
+
+    if (b > a) {
+        bool cont;
+        size_t items = (b - a) / (vector_bits / 8);
+        if (vector_bits == 512)
+            cont = find_avx512<cond, action, width, Callback>(value, reinterpret_cast<__m512i*>(a), items, state,
+                                                              baseindex + a_ndx, callback);
+        else
+            cont = find_avx2<cond, action, width, Callback>(value, reinterpret_cast<__m256i*>(a), items, state,
+                                                            baseindex + a_ndx, callback);
+        if (!cont)
+            return false;
+    }
+
+    return compare<cond, action, width, Callback>(value, b_ndx, end, baseindex, state, callback);
+}
+
+// 'items' is the number of 32-byte AVX2 chunks. Returns index of packed element relative to first integer of first
+// chunk
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX2 bool Array::find_avx2(int64_t value, __m256i* data, size_t items, QueryState<int64_t>* state,
+                                        size_t baseindex, Callback callback) const
+{
+    __m256i search;
+    if (width == 8)
+        search = _mm256_set1_epi8(static_cast<char>(value));
+    else if (width == 16)
+        search = _mm256_set1_epi16(static_cast<short int>(value));
+    else if (width == 32)
+        search = _mm256_set1_epi32(static_cast<int>(value));
+    else
+        search = _mm256_set1_epi64x(value);
+
+    // _mm256_movemask_epi8() yields one bit per byte. Keep only the bit of the most significant byte of each
+    // element so that every set bit in 'resmask' corresponds to exactly one matching element.
+    constexpr size_t bytes = width < 8 ? 1 : width / 8;
+    const uint32_t element_bits = uint32_t(lower_bits<bytes>() << (bytes - 1));
+
+    for (size_t i = 0; i < items; ++i) {
+        __m256i chunk = _mm256_load_si256(data + i);
+        __m256i compare_result;
+
+        if (std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value) {
+            if (width == 8)
+                compare_result = _mm256_cmpeq_epi8(chunk, search);
+            else if (width == 16)
+                compare_result = _mm256_cmpeq_epi16(chunk, search);
+            else if (width == 32)
+                compare_result = _mm256_cmpeq_epi32(chunk, search);
+            else
+                compare_result = _mm256_cmpeq_epi64(chunk, search);
+        }
+        else {
+            // AVX2 only has signed greater-than, so less-than is done by swapping the operands
+            __m256i lhs = std::is_same<cond, Greater>::value ? chunk : search;
+            __m256i rhs = std::is_same<cond, Greater>::value ? search : chunk;
+            if (width == 8)
+                compare_result = _mm256_cmpgt_epi8(lhs, rhs);
+            else if (width == 16)
+                compare_result = _mm256_cmpgt_epi16(lhs, rhs);
+            else if (width == 32)
+                compare_result = _mm256_cmpgt_epi32(lhs, rhs);
+            else
+                compare_result = _mm256_cmpgt_epi64(lhs, rhs);
+        }
+
+        uint32_t resmask = uint32_t(_mm256_movemask_epi8(compare_result));
+        if (std::is_same<cond, NotEqual>::value)
+            resmask = ~resmask;
+        resmask &= element_bits;
+
+        size_t s = i * sizeof(__m256i) / bytes;
+
+        if (resmask != 0 && find_action_pattern<action, Callback>(s + baseindex, resmask, state, callback))
+            continue;
+
+        while (resmask != 0) {
+            size_t idx = s + first_set_bit(resmask) / bytes;
+            if (!find_action<action, Callback>(
+                    idx + baseindex, get_universal<width>(reinterpret_cast<char*>(data), idx), state, callback))
+                return false;
+            resmask &= resmask - 1;
+        }
+    }
+
+    return true;
+}
+
+// 'items' is the number of 64-byte AVX-512 chunks. Returns index of packed element relative to first integer of
+// first chunk
+template <class cond, Action action, size_t width, class Callback>
+REALM_TARGET_AVX512 bool Array::find_avx512(int64_t value, __m512i* data, size_t items, QueryState<int64_t>* state,
+                                            size_t baseindex, Callback callback) const
+{
+    __m512i search;
+    if (width == 8)
+        search = _mm512_set1_epi8(static_cast<char>(value));
+    else if (width == 16)
+        search = _mm512_set1_epi16(static_cast<short int>(value));
+    else if (width == 32)
+        search = _mm512_set1_epi32(static_cast<int>(value));
+    else
+        search = _mm512_set1_epi64(value);
+
+    // AVX-512 comparisons write a mask register with one bit per element, so no post processing is needed
+    for (size_t i = 0; i < items; ++i) {
+        __m512i chunk = _mm512_load_si512(data + i);
+        uint64_t resmask;
+
+        if (std::is_same<cond, Equal>::value) {
+            if (width == 8)
+                resmask = _mm512_cmpeq_epi8_mask(chunk, search);
+            else if (width == 16)
+                resmask = _mm512_cmpeq_epi16_mask(chunk, search);
+            else if (width == 32)
+                resmask = _mm512_cmpeq_epi32_mask(chunk, search);
+            else
+                resmask = _mm512_cmpeq_epi64_mask(chunk, search);
+        }
+        else if (std::is_same<cond, NotEqual>::value) {
+            if (width == 8)
+                resmask = _mm512_cmpneq_epi8_mask(chunk, search);
+            else if (width == 16)
+                resmask = _mm512_cmpneq_epi16_mask(chunk, search);
+            else if (width == 32)
+                resmask = _mm512_cmpneq_epi32_mask(chunk, search);
+            else
+                resmask = _mm512_cmpneq_epi64_mask(chunk, search);
+        }
+        else if (std::is_same<cond, Greater>::value) {
+            if (width == 8)
+                resmask = _mm512_cmpgt_epi8_mask(chunk, search);
+            else if (width == 16)
+                resmask = _mm512_cmpgt_epi16_mask(chunk, search);
+            else if (width == 32)
+                resmask = _mm512_cmpgt_epi32_mask(chunk, search);
+            else
+                resmask = _mm512_cmpgt_epi64_mask(chunk, search);
+        }
+        else {
+            if (width == 8)
+                resmask = _mm512_cmplt_epi8_mask(chunk, search);
+            else if (width == 16)
+                resmask = _mm512_cmplt_epi16_mask(chunk, search);
+            else if (width == 32)
+                resmask = _mm512_cmplt_epi32_mask(chunk, search);
+            else
+                resmask = _mm512_cmplt_epi64_mask(chunk, search);
+        }
+
+        size_t s = i * sizeof(__m512i) * 8 / no0(width);
+
+        if (resmask != 0 && find_action_pattern<action, Callback>(s + baseindex, resmask, state, callback))
+            continue;
+
+        while (resmask != 0) {
+            size_t idx = s + first_set_bit64(resmask);
+            if (!find_action<action, Callback>(
+                    idx + baseindex, get_universal<width>(reinterpret_cast<char*>(data), idx), state, callback))
+                return false;
+            resmask &= resmask - 1;
+        }
+    }
+
+    return true;
+}
+#endif // REALM_COMPILER_AVX
+
 template <class cond, Action action, class Callback>
 bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t baseindex,
                           QueryState<int64_t>* state, Callback callback) const
@@ -2128,6 +2753,18 @@ bool Array::compare_leafs(const Array* foreign, size_t start, size_t end, size_t
 
     int64_t v;
 
+    // The bit width specialized comparisons below work on the raw elements
+    if (REALM_UNLIKELY(m_offset_encoded || foreign->m_offset_encoded || m_run_encoded || foreign->m_run_encoded)) {
+        for (; start < end; ++start) {
+            v = get(start);
+            if (c(v, foreign->get(start))) {
+                if (!find_action<action, Callback>(start + baseindex, v, state, callback))
+                    return false;
+            }
+        }
+        return true;
+    }
+
     // We can compare first element without checking for out-of-range
     v = get(start);
     if (c(v, foreign->get(start))) {
@@ -22,8 +22,44 @@
 #include <realm/group.hpp>
 #include <realm/list.hpp>
 
+#include <algorithm>
+
 using namespace realm;
 
+namespace {
+
+// Sorted lists have the context flag set
+inline bool is_sorted_list(const Array& backlink_list) noexcept
+{
+    return backlink_list.get_context_flag();
+}
+
+// Lists written by earlier versions are in the order the backlinks were added
+void ensure_sorted(Array& backlink_list)
+{
+    if (is_sorted_list(backlink_list))
+        return;
+    size_t sz = backlink_list.size();
+    std::vector<int64_t> keys(sz);
+    backlink_list.get_range(0, sz, keys.data());
+    std::sort(keys.begin(), keys.end());
+    for (size_t i = 0; i < sz; i++)
+        backlink_list.set(i, keys[i]); // Throws
+    backlink_list.set_context_flag(true);
+}
+
+size_t find_in_list(const Array& backlink_list, int64_t key) noexcept
+{
+    if (!is_sorted_list(backlink_list))
+        return backlink_list.find_first(key);
+    size_t pos = backlink_list.lower_bound_int(key);
+    if (pos < backlink_list.size() && backlink_list.get(pos) == key)
+        return pos;
+    return realm::npos;
+}
+
+} // anonymous namespace
+
 // nullify forward links corresponding to any backward links at index 'ndx'.
 void ArrayBacklink::nullify_fwd_links(size_t ndx, CascadeState& state)
 {
@@ -82,15 +118,17 @@ void ArrayBacklink::add(size_t ndx, ObjKey key)
     Array backlink_list(m_alloc);
     if ((value & 1) != 0) {
         // Create new column to hold backlinks
-        backlink_list.create(Array::type_Normal);
+        backlink_list.create(Array::type_Normal, true);
         set_as_ref(ndx, backlink_list.get_ref());
+        backlink_list.set_parent(this, ndx);
         backlink_list.add(value >> 1);
     }
     else {
         backlink_list.init_from_ref(to_ref(value));
         backlink_list.set_parent(this, ndx);
+        ensure_sorted(backlink_list); // Throws
     }
-    backlink_list.add(key.value); // Throws
+    backlink_list.insert(backlink_list.upper_bound_int(key.value), key.value); // Throws
 }
 
 // Return true if the last link was removed
@@ -113,12 +151,11 @@ bool ArrayBacklink::remove(size_t ndx, ObjKey key)
     backlink_list.init_from_ref(ref_type(value));
     backlink_list.set_parent(this, ndx);
 
+    ensure_sorted(backlink_list); // Throws
     size_t last_ndx = backlink_list.size() - 1;
-    size_t backlink_ndx = backlink_list.find_first(key.value);
+    size_t backlink_ndx = find_in_list(backlink_list, key.value);
     REALM_ASSERT_3(backlink_ndx, !=, not_found);
-    if (backlink_ndx != last_ndx)
-        backlink_list.set(backlink_ndx, backlink_list.get(last_ndx));
-    backlink_list.truncate(last_ndx); // Throws
+    backlink_list.erase(backlink_ndx); // Throws
 
     // If there is only one backlink left we can inline it as tagged value
     if (last_ndx == 1) {
@@ -177,6 +214,41 @@ ObjKey ArrayBacklink::get_backlink(size_t ndx, size_t index) const
     return ObjKey(backlink_list.get(index));
 }
 
+size_t ArrayBacklink::find_backlink(size_t ndx, ObjKey key) const
+{
+    uint64_t value = Array::get(ndx);
+    if (value == 0)
+        return realm::npos;
+
+    if ((value & 1) != 0)
+        return int64_t(value >> 1) == key.value ? 0 : realm::npos;
+
+    Array backlink_list(m_alloc);
+    backlink_list.init_from_ref(ref_type(value));
+    return find_in_list(backlink_list, key.value);
+}
+
+void ArrayBacklink::encode_lists()
+{
+    size_t sz = size();
+    for (size_t i = 0; i < sz; i++) {
+        uint64_t value = Array::get(i);
+        if (value == 0 || (value & 1) != 0)
+            continue;
+        ref_type ref = to_ref(value);
+        if (m_alloc.is_read_only(ref))
+            continue;
+        // Sorted keys are often close to each other, so their offsets from the
+        // smallest key take up fewer bits than the keys themselves
+        Array backlink_list(m_alloc);
+        backlink_list.init_from_ref(ref);
+        backlink_list.set_parent(this, i);
+        if (!is_sorted_list(backlink_list))
+            continue;
+        backlink_list.encode_offsets(); // Throws
+    }
+}
+
 void ArrayBacklink::verify() const
 {
 #ifdef REALM_DEBUG
@@ -195,6 +267,12 @@ void ArrayBacklink::verify() const
     for (size_t i = 0; i < size(); ++i) {
         ObjKey target_key = cluster->get_real_key(i);
         auto cnt = get_backlink_count(i);
+        if (cnt > 1) {
+            Array backlink_list(m_alloc);
+            backlink_list.init_from_ref(ref_type(Array::get(i)));
+            for (size_t j = 1; is_sorted_list(backlink_list) && j < cnt; ++j)
+                REALM_ASSERT(backlink_list.get(j - 1) <= backlink_list.get(j));
+        }
         for (size_t j = 0; j < cnt; ++j) {
             Obj src_obj = src_table->get_object(get_backlink(i, j));
             if (src_attr.test(col_attr_List)) {
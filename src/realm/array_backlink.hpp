@@ -22,6 +22,11 @@
 #include <realm/cluster.hpp>
 
 namespace realm {
+// Each element holds the backlinks of one object: 0 if there are none, a
+// single key tagged in the lowest bit, or the ref of a list of keys. Lists
+// are kept sorted, which is indicated by the context flag of the list, so
+// that a backlink can be found with a binary search. Lists written by
+// earlier versions are sorted the first time they are modified.
 class ArrayBacklink : public ArrayPayload, private Array {
 public:
     using Array::Array;
@@ -71,6 +76,10 @@ public:
     void erase(size_t ndx);
     size_t get_backlink_count(size_t ndx) const;
     ObjKey get_backlink(size_t ndx, size_t index) const;
+    // Index of a backlink from 'key' at index 'ndx', or npos if there is none
+    size_t find_backlink(size_t ndx, ObjKey key) const;
+    // Frame of reference encode the lists modified in this transaction
+    void encode_lists();
     void move(ArrayBacklink& dst, size_t ndx)
     {
         Array::move(dst, ndx);
@@ -55,6 +55,12 @@ public:
     BasicArray(const BasicArray&) = delete;
 
     T get(size_t ndx) const noexcept;
+    /// Copy the elements in [begin, end) to 'dest'.
+    void get_range(size_t begin, size_t end, T* dest) const noexcept
+    {
+        REALM_ASSERT_DEBUG(begin <= end && end <= m_size);
+        std::copy_n(reinterpret_cast<const T*>(m_data) + begin, end - begin, dest);
+    }
     bool is_null(size_t ndx) const noexcept
     {
         // FIXME: This assumes BasicArray will only ever be instantiated for float-like T.
@@ -83,6 +89,26 @@ public:
     bool maximum(T& result, size_t begin = 0, size_t end = npos) const;
     bool minimum(T& result, size_t begin = 0, size_t end = npos) const;
 
+    /// Find the first element in [begin, end) for which `cond` holds against
+    /// `value`. Elements holding the null value are passed to the condition
+    /// as nulls.
+    template <class cond>
+    size_t find_first(T value, size_t begin, size_t end) const;
+
+    /// Find the first element in [begin, end) that lies within the closed
+    /// range [from, to]. Null and NaN elements never match.
+    size_t find_first_between(T from, T to, size_t begin, size_t end) const;
+
+    /// Sum of the non-null elements in [begin, end). The number of non-null
+    /// elements is added to `count`.
+    double sum_not_null(size_t begin, size_t end, size_t& count) const;
+
+    /// Index of the first smallest (largest if `find_max`) element in [begin,
+    /// end), ignoring nulls and NaNs, or `npos` if there is none. The number
+    /// of non-null elements is added to `count`.
+    template <bool find_max>
+    size_t minmax_not_null(size_t begin, size_t end, size_t& count) const;
+
     /// Compare two arrays for equality.
     bool compare(const BasicArray<T>&) const;
 
@@ -113,6 +139,17 @@ public:
 private:
     size_t find(T target, size_t begin, size_t end) const;
 
+#ifdef REALM_COMPILER_AVX
+    // The AVX2 kernels process whole vectors from 'begin' on, and leave 'begin' at the first element they have not
+    // looked at
+    template <class cond>
+    REALM_TARGET_AVX2 size_t find_first_avx2(T value, size_t& begin, size_t end) const;
+    REALM_TARGET_AVX2 size_t find_first_between_avx2(T from, T to, size_t& begin, size_t end) const;
+    REALM_TARGET_AVX2 double sum_not_null_avx2(size_t& begin, size_t end, size_t& null_count) const;
+    template <bool find_max>
+    REALM_TARGET_AVX2 T minmax_not_null_avx2(size_t& begin, size_t end, size_t& null_count) const;
+#endif
+
     size_t calc_byte_len(size_t count, size_t width) const override;
     virtual size_t calc_item_count(size_t bytes, size_t width) const noexcept override;
 
@@ -20,6 +20,7 @@
 #define REALM_ARRAY_BASIC_TPL_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <stdexcept>
 #include <iomanip>
@@ -342,6 +343,253 @@ bool BasicArray<T>::minimum(T& result, size_t begin, size_t end) const
     return minmax<false>(result, begin, end);
 }
 
+template <class T>
+template <class cond>
+size_t BasicArray<T>::find_first(T value, size_t begin, size_t end) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+    bool value_is_null = null::is_null_float(value);
+
+#ifdef REALM_COMPILER_AVX
+    // Nulls are NaNs, so the ordered vector comparisons never match them, and the unordered not-equal always does.
+    // That is what the conditions prescribe, unless we are searching for null.
+    if (!value_is_null && sseavx<2>()) {
+        size_t res = find_first_avx2<cond>(value, begin, end);
+        if (res != not_found)
+            return res;
+    }
+#endif
+
+    cond c;
+    for (; begin < end; ++begin) {
+        T v = data[begin];
+        if (c(v, value, null::is_null_float(v), value_is_null))
+            return begin;
+    }
+    return not_found;
+}
+
+template <class T>
+size_t BasicArray<T>::find_first_between(T from, T to, size_t begin, size_t end) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>()) {
+        size_t res = find_first_between_avx2(from, to, begin, end);
+        if (res != not_found)
+            return res;
+    }
+#endif
+
+    // Comparisons with NaN, and so with null, are false
+    for (; begin < end; ++begin) {
+        T v = data[begin];
+        if (v >= from && v <= to)
+            return begin;
+    }
+    return not_found;
+}
+
+template <class T>
+double BasicArray<T>::sum_not_null(size_t begin, size_t end, size_t& count) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+    size_t null_count = 0;
+    size_t sz = end - begin;
+    double sum = 0;
+
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>())
+        sum = sum_not_null_avx2(begin, end, null_count);
+#endif
+
+    for (; begin < end; ++begin) {
+        T v = data[begin];
+        if (null::is_null_float(v))
+            ++null_count;
+        else
+            sum += v;
+    }
+    count += sz - null_count;
+    return sum;
+}
+
+template <class T>
+template <bool find_max>
+size_t BasicArray<T>::minmax_not_null(size_t begin, size_t end, size_t& count) const
+{
+    if (end == npos)
+        end = m_size;
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+    size_t null_count = 0;
+    size_t sz = end - begin;
+    size_t first = begin;
+    T best = find_max ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>())
+        best = minmax_not_null_avx2<find_max>(begin, end, null_count);
+#endif
+
+    for (; begin < end; ++begin) {
+        T v = data[begin];
+        if (null::is_null_float(v))
+            ++null_count;
+        else if (find_max ? v > best : v < best)
+            best = v;
+    }
+    count += sz - null_count;
+
+    // NaNs are never equal to the result, and neither is anything if all elements are null or NaN
+    for (size_t i = first; i < end; ++i) {
+        if (data[i] == best)
+            return i;
+    }
+    return npos;
+}
+
+#ifdef REALM_COMPILER_AVX
+template <class T>
+template <class cond>
+REALM_TARGET_AVX2 size_t BasicArray<T>::find_first_avx2(T value, size_t& begin, size_t end) const
+{
+    const T* data = reinterpret_cast<const T*>(m_data);
+    if constexpr (std::is_same_v<T, double>) {
+        __m256d search = _mm256_set1_pd(value);
+        for (; begin + 4 <= end; begin += 4) {
+            __m256d chunk = _mm256_loadu_pd(data + begin);
+            int mask = _mm256_movemask_pd(_mm256_cmp_pd(chunk, search, cond::avx));
+            if (mask)
+                return begin + first_set_bit(unsigned(mask));
+        }
+    }
+    else {
+        __m256 search = _mm256_set1_ps(value);
+        for (; begin + 8 <= end; begin += 8) {
+            __m256 chunk = _mm256_loadu_ps(data + begin);
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(chunk, search, cond::avx));
+            if (mask)
+                return begin + first_set_bit(unsigned(mask));
+        }
+    }
+    return not_found;
+}
+
+template <class T>
+REALM_TARGET_AVX2 size_t BasicArray<T>::find_first_between_avx2(T from, T to, size_t& begin, size_t end) const
+{
+    const T* data = reinterpret_cast<const T*>(m_data);
+    if constexpr (std::is_same_v<T, double>) {
+        __m256d lower = _mm256_set1_pd(from);
+        __m256d upper = _mm256_set1_pd(to);
+        for (; begin + 4 <= end; begin += 4) {
+            __m256d chunk = _mm256_loadu_pd(data + begin);
+            __m256d in_range = _mm256_and_pd(_mm256_cmp_pd(chunk, lower, _CMP_GE_OQ),
+                                             _mm256_cmp_pd(chunk, upper, _CMP_LE_OQ));
+            int mask = _mm256_movemask_pd(in_range);
+            if (mask)
+                return begin + first_set_bit(unsigned(mask));
+        }
+    }
+    else {
+        __m256 lower = _mm256_set1_ps(from);
+        __m256 upper = _mm256_set1_ps(to);
+        for (; begin + 8 <= end; begin += 8) {
+            __m256 chunk = _mm256_loadu_ps(data + begin);
+            __m256 in_range =
+                _mm256_and_ps(_mm256_cmp_ps(chunk, lower, _CMP_GE_OQ), _mm256_cmp_ps(chunk, upper, _CMP_LE_OQ));
+            int mask = _mm256_movemask_ps(in_range);
+            if (mask)
+                return begin + first_set_bit(unsigned(mask));
+        }
+    }
+    return not_found;
+}
+
+template <class T>
+REALM_TARGET_AVX2 double BasicArray<T>::sum_not_null_avx2(size_t& begin, size_t end, size_t& null_count) const
+{
+    // Null elements are found by their bit pattern and replaced by zero. Floats are summed as doubles.
+    const T* data = reinterpret_cast<const T*>(m_data);
+    __m256d sum = _mm256_setzero_pd();
+    if constexpr (std::is_same_v<T, double>) {
+        __m256i null_bits = _mm256_set1_epi64x(type_punning<int64_t>(null::get_null_float<double>()));
+        for (; begin + 4 <= end; begin += 4) {
+            __m256d chunk = _mm256_loadu_pd(data + begin);
+            __m256d is_null = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_castpd_si256(chunk), null_bits));
+            null_count += fast_popcount32(_mm256_movemask_pd(is_null));
+            sum = _mm256_add_pd(sum, _mm256_andnot_pd(is_null, chunk));
+        }
+    }
+    else {
+        __m128i null_bits = _mm_set1_epi32(type_punning<int32_t>(null::get_null_float<float>()));
+        for (; begin + 4 <= end; begin += 4) {
+            __m128 chunk = _mm_loadu_ps(data + begin);
+            __m128 is_null = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_castps_si128(chunk), null_bits));
+            null_count += fast_popcount32(_mm_movemask_ps(is_null));
+            sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm_andnot_ps(is_null, chunk)));
+        }
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+template <class T>
+template <bool find_max>
+REALM_TARGET_AVX2 T BasicArray<T>::minmax_not_null_avx2(size_t& begin, size_t end, size_t& null_count) const
+{
+    // NaN lanes, including nulls, are replaced by the starting value, which can never win
+    const T* data = reinterpret_cast<const T*>(m_data);
+    const T start = find_max ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+    T result = start;
+    if constexpr (std::is_same_v<T, double>) {
+        __m256i null_bits = _mm256_set1_epi64x(type_punning<int64_t>(null::get_null_float<double>()));
+        __m256d init = _mm256_set1_pd(start);
+        __m256d best = init;
+        for (; begin + 4 <= end; begin += 4) {
+            __m256d chunk = _mm256_loadu_pd(data + begin);
+            __m256d is_null = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_castpd_si256(chunk), null_bits));
+            null_count += fast_popcount32(_mm256_movemask_pd(is_null));
+            chunk = _mm256_blendv_pd(init, chunk, _mm256_cmp_pd(chunk, chunk, _CMP_ORD_Q));
+            best = find_max ? _mm256_max_pd(best, chunk) : _mm256_min_pd(best, chunk);
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, best);
+        for (double v : lanes)
+            result = find_max ? std::max(result, v) : std::min(result, v);
+    }
+    else {
+        __m256i null_bits = _mm256_set1_epi32(type_punning<int32_t>(null::get_null_float<float>()));
+        __m256 init = _mm256_set1_ps(start);
+        __m256 best = init;
+        for (; begin + 8 <= end; begin += 8) {
+            __m256 chunk = _mm256_loadu_ps(data + begin);
+            __m256 is_null = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_castps_si256(chunk), null_bits));
+            null_count += fast_popcount32(_mm256_movemask_ps(is_null));
+            chunk = _mm256_blendv_ps(init, chunk, _mm256_cmp_ps(chunk, chunk, _CMP_ORD_Q));
+            best = find_max ? _mm256_max_ps(best, chunk) : _mm256_min_ps(best, chunk);
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, best);
+        for (float v : lanes)
+            result = find_max ? std::max(result, v) : std::min(result, v);
+    }
+    return result;
+}
+#endif // REALM_COMPILER_AVX
+
 
 template <class T>
 inline size_t BasicArray<T>::lower_bound(T value) const noexcept
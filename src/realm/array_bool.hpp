@@ -88,6 +88,19 @@ public:
         }
     }
 
+    template <class cond>
+    size_t find_first(util::Optional<bool> value, size_t begin = 0, size_t end = npos) const noexcept
+    {
+        return Array::find_first<cond>(value ? int64_t(*value) : null_value, begin, end);
+    }
+
+    // Calls 'callback' with the index of each element in [begin, end) that matches 'value' under 'cond'
+    template <class cond, class Callback>
+    void find_matches(util::Optional<bool> value, size_t begin, size_t end, Callback callback) const
+    {
+        Array::find<cond, act_CallbackIdx>(value ? int64_t(*value) : null_value, begin, end, 0, nullptr, callback);
+    }
+
 protected:
     // We can still be in two bits as small values are considered unsigned
     static constexpr int null_value = 3;
@@ -17,11 +17,174 @@
  **************************************************************************/
 
 #include <realm/array_decimal128.hpp>
+#include <realm/util/safe_int_ops.hpp>
+
+#include <limits>
+#include <vector>
 
 namespace realm {
 
+namespace {
+
+constexpr int exponent_bias = 6176;
+
+// Leaves smaller than this take up less space unpacked
+constexpr size_t min_packed_size = 16;
+
+constexpr int64_t int64_min = std::numeric_limits<int64_t>::min();
+constexpr int64_t int64_max = std::numeric_limits<int64_t>::max();
+
+constexpr int64_t powers_of_ten[] = {1,
+                                     10,
+                                     100,
+                                     1000,
+                                     10000,
+                                     100000,
+                                     1000000,
+                                     10000000,
+                                     100000000,
+                                     1000000000,
+                                     10000000000,
+                                     100000000000,
+                                     1000000000000,
+                                     10000000000000,
+                                     100000000000000,
+                                     1000000000000000,
+                                     10000000000000000,
+                                     100000000000000000,
+                                     1000000000000000000};
+
+Decimal128 make_decimal(int64_t coefficient, int exponent)
+{
+    Decimal128::Bid128 bid;
+    bid.w[0] = coefficient < 0 ? uint64_t(0) - uint64_t(coefficient) : uint64_t(coefficient);
+    bid.w[1] = 0;
+    return Decimal128(bid, exponent, coefficient < 0);
+}
+
+} // anonymous namespace
+
+void ArrayDecimal128::init_packed() noexcept
+{
+    m_is_packed = Array::has_refs();
+    if (!m_is_packed) {
+        m_coefficients.detach();
+        m_exponents.detach();
+        return;
+    }
+    m_coefficients.init_from_ref(Array::get_as_ref(s_coefficients_ndx));
+    if (ref_type ref = Array::get_as_ref(s_exponents_ndx))
+        m_exponents.init_from_ref(ref);
+    else
+        m_exponents.detach();
+    m_min_exponent = int(Array::get_as_ref_or_tagged(s_min_exponent_ndx).get_as_int()) - exponent_bias;
+    m_max_exponent = int(Array::get_as_ref_or_tagged(s_max_exponent_ndx).get_as_int()) - exponent_bias;
+}
+
+bool ArrayDecimal128::to_packed(Decimal128 value, int64_t& coefficient, int& exponent) noexcept
+{
+    const Decimal128::Bid128& bid = *value.raw();
+    // Infinity, NaN (and so null) and very large coefficients have the two bits after the sign set
+    if ((bid.w[1] & 0x6000000000000000ull) == 0x6000000000000000ull)
+        return false;
+    // The high part of the coefficient is in the lower 49 bits
+    if ((bid.w[1] & 0x0001ffffffffffffull) != 0 || bid.w[0] > uint64_t(int64_max))
+        return false;
+    exponent = int((bid.w[1] >> 49) & 0x3fff) - exponent_bias;
+    bool sign = (bid.w[1] & 0x8000000000000000ull) != 0;
+    coefficient = sign ? -int64_t(bid.w[0]) : int64_t(bid.w[0]);
+    return true;
+}
+
+Decimal128 ArrayDecimal128::get_packed(size_t ndx) const
+{
+    int64_t exponent = m_exponents.is_attached() ? m_exponents.get(ndx) : 1;
+    if (exponent == 0)
+        return Decimal128(realm::null());
+    return make_decimal(m_coefficients.get(ndx), m_min_exponent + int(exponent) - 1);
+}
+
+void ArrayDecimal128::pack()
+{
+    if (m_is_packed || get_width() != sizeof(Decimal128) || m_size < min_packed_size)
+        return;
+
+    const size_t sz = m_size;
+    auto values = reinterpret_cast<const Decimal128*>(m_data);
+    std::vector<int64_t> coefficients(sz);
+    std::vector<int> exponents(sz);
+    std::vector<bool> nulls(sz);
+    bool has_null = false;
+    int min_exponent = std::numeric_limits<int>::max();
+    int max_exponent = std::numeric_limits<int>::min();
+    for (size_t i = 0; i < sz; ++i) {
+        if (values[i].is_null()) {
+            nulls[i] = true;
+            has_null = true;
+            continue;
+        }
+        if (!to_packed(values[i], coefficients[i], exponents[i]))
+            return;
+        // A negative zero cannot be told apart from a positive one
+        if (coefficients[i] == 0 && (values[i].raw()->w[1] & 0x8000000000000000ull))
+            return;
+        min_exponent = std::min(min_exponent, exponents[i]);
+        max_exponent = std::max(max_exponent, exponents[i]);
+    }
+    if (min_exponent > max_exponent)
+        min_exponent = max_exponent = 0;
+    if (max_exponent - min_exponent > s_max_exponent_range)
+        return;
+
+    Array top(m_alloc);
+    top.create(type_HasRefs); // Throws
+    Array packed_coefficients(m_alloc);
+    packed_coefficients.create(type_Normal); // Throws
+    for (size_t i = 0; i < sz; ++i)
+        packed_coefficients.add(coefficients[i]); // Throws
+    top.add(from_ref(packed_coefficients.get_ref())); // Throws
+    if (has_null || min_exponent != max_exponent) {
+        Array packed_exponents(m_alloc);
+        packed_exponents.create(type_Normal); // Throws
+        for (size_t i = 0; i < sz; ++i)
+            packed_exponents.add(nulls[i] ? 0 : exponents[i] - min_exponent + 1); // Throws
+        top.add(from_ref(packed_exponents.get_ref())); // Throws
+    }
+    else {
+        top.add(0); // Throws
+    }
+    top.add(RefOrTagged::make_tagged(uint64_t(min_exponent + exponent_bias))); // Throws
+    top.add(RefOrTagged::make_tagged(uint64_t(max_exponent + exponent_bias))); // Throws
+
+    ref_type old_ref = get_ref();
+    init_from_mem(top.get_mem());
+    update_parent(); // Throws
+    Array::destroy(old_ref, m_alloc);
+}
+
+void ArrayDecimal128::unpack()
+{
+    REALM_ASSERT(m_is_packed);
+    const size_t sz = size();
+    std::vector<Decimal128> values;
+    values.reserve(sz);
+    for (size_t i = 0; i < sz; ++i)
+        values.push_back(get_packed(i));
+
+    ref_type old_ref = get_ref();
+    create(); // Throws
+    if (sz) {
+        alloc(sz, sizeof(Decimal128)); // Throws
+        memcpy(m_data, values.data(), sz * sizeof(Decimal128));
+    }
+    update_parent(); // Throws
+    Array::destroy_deep(old_ref, m_alloc);
+}
+
 void ArrayDecimal128::set(size_t ndx, Decimal128 value)
 {
+    if (m_is_packed)
+        unpack(); // Throws
     REALM_ASSERT(ndx < m_size);
     copy_on_write();
     auto values = reinterpret_cast<Decimal128*>(m_data);
@@ -30,6 +193,8 @@ void ArrayDecimal128::set(size_t ndx, Decimal128 value)
 
 void ArrayDecimal128::insert(size_t ndx, Decimal128 value)
 {
+    if (m_is_packed)
+        unpack(); // Throws
     REALM_ASSERT(ndx <= m_size);
     // Allocate room for the new value
     alloc(m_size + 1, sizeof(Decimal128)); // Throws
@@ -46,6 +211,8 @@ void ArrayDecimal128::insert(size_t ndx, Decimal128 value)
 
 void ArrayDecimal128::erase(size_t ndx)
 {
+    if (m_is_packed)
+        unpack(); // Throws
     REALM_ASSERT(ndx < m_size);
 
     copy_on_write();
@@ -62,6 +229,10 @@ void ArrayDecimal128::erase(size_t ndx)
 
 void ArrayDecimal128::move(ArrayDecimal128& dst_arr, size_t ndx)
 {
+    if (m_is_packed)
+        unpack(); // Throws
+    if (dst_arr.m_is_packed)
+        dst_arr.unpack(); // Throws
     size_t elements_to_move = m_size - ndx;
     if (elements_to_move) {
         const auto old_dst_size = dst_arr.m_size;
@@ -73,19 +244,223 @@ void ArrayDecimal128::move(ArrayDecimal128& dst_arr, size_t ndx)
     truncate(ndx);
 }
 
-size_t ArrayDecimal128::find_first(Decimal128 value, size_t start, size_t end) const noexcept
+void ArrayDecimal128::truncate(size_t ndx)
 {
-    auto sz = size();
-    if (end == size_t(-1))
-        end = sz;
-    REALM_ASSERT(start <= sz && end <= sz && start <= end);
+    if (m_is_packed)
+        unpack(); // Throws
+    Array::truncate(ndx);
+}
 
-    auto values = reinterpret_cast<Decimal128*>(this->m_data);
-    for (size_t i = start; i < end; i++) {
-        if (values[i] == value)
-            return i;
+auto ArrayDecimal128::coefficient_range(Compare kind, int64_t coefficient, int value_exponent, int exponent) noexcept
+    -> CoefficientRange
+{
+    // Express the value in units of 10^exponent. It is then either exactly 'units', between 'units' and
+    // 'units + 1', or out of the range of the coefficients.
+    enum { exact, between, above, below } where = exact;
+    int64_t units = coefficient;
+    int scale = value_exponent - exponent;
+    if (scale >= 0) {
+        for (int i = 0; i < scale && units != 0; ++i) {
+            if (util::int_multiply_with_overflow_detect(units, 10)) {
+                where = coefficient > 0 ? above : below;
+                break;
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < -scale && units != 0; ++i) {
+            if (units % 10 != 0)
+                where = between;
+            units /= 10;
+        }
+        // Division truncates towards zero
+        if (where == between && coefficient < 0)
+            units -= 1;
+    }
+
+    const CoefficientRange all{int64_min, int64_max, false};
+    const CoefficientRange no_match{1, 0, false};
+    switch (kind) {
+        case Compare::Equal:
+            return where == exact ? CoefficientRange{units, units, false} : no_match;
+        case Compare::NotEqual:
+            return where == exact ? CoefficientRange{units, units, true} : all;
+        case Compare::Less:
+        case Compare::LessEqual:
+            if (where == above)
+                return all;
+            if (where == below)
+                return no_match;
+            if (where == exact && kind == Compare::Less)
+                return units == int64_min ? no_match : CoefficientRange{int64_min, units - 1, false};
+            return {int64_min, units, false};
+        case Compare::Greater:
+        case Compare::GreaterEqual:
+            if (where == above)
+                return no_match;
+            if (where == below)
+                return all;
+            if (where == exact && kind == Compare::GreaterEqual)
+                return {units, int64_max, false};
+            return units == int64_max ? no_match : CoefficientRange{units + 1, int64_max, false};
+        case Compare::Other:
+            break;
+    }
+    REALM_UNREACHABLE();
+}
+
+size_t ArrayDecimal128::find_first_coefficient(const CoefficientRange& range, size_t begin, size_t end) const
+{
+    if (begin >= end || range.lo > range.hi)
+        return realm::npos;
+    if (range.negate)
+        return m_coefficients.find_first<NotEqual>(range.lo, begin, end);
+    if (range.lo == range.hi)
+        return m_coefficients.find_first<Equal>(range.lo, begin, end);
+    if (range.lo == int64_min)
+        return range.hi == int64_max ? begin : m_coefficients.find_first<Less>(range.hi + 1, begin, end);
+    REALM_ASSERT_DEBUG(range.hi == int64_max);
+    return m_coefficients.find_first<Greater>(range.lo - 1, begin, end);
+}
+
+bool ArrayDecimal128::find_first_packed(Compare kind, Decimal128 value, size_t begin, size_t end,
+                                        size_t& result) const
+{
+    int64_t coefficient;
+    int exponent;
+    if (!to_packed(value, coefficient, exponent))
+        return false;
+
+    // Null only differs from values that are not null
+    const bool null_matches = kind == Compare::NotEqual;
+
+    if (m_min_exponent == m_max_exponent) {
+        // Search the coefficients with the integer kernels, skipping any nulls that do not match
+        auto range = coefficient_range(kind, coefficient, exponent, m_min_exponent);
+        size_t first_null = realm::npos;
+        if (null_matches && m_exponents.is_attached())
+            first_null = m_exponents.find_first(0, begin, end);
+        for (;;) {
+            size_t ndx = find_first_coefficient(range, begin, end);
+            if (ndx == realm::npos || null_matches || !is_null(ndx)) {
+                result = std::min(ndx, first_null);
+                return true;
+            }
+            begin = ndx + 1;
+        }
+    }
+
+    CoefficientRange ranges[s_max_exponent_range + 1];
+    for (int e = m_min_exponent; e <= m_max_exponent; ++e)
+        ranges[e - m_min_exponent] = coefficient_range(kind, coefficient, exponent, e);
+    for (size_t i = begin; i < end; ++i) {
+        int64_t e = m_exponents.get(i);
+        if (e == 0 ? null_matches : ranges[e - 1].matches(m_coefficients.get(i))) {
+            result = i;
+            return true;
+        }
+    }
+    result = realm::npos;
+    return true;
+}
+
+Decimal128 ArrayDecimal128::sum(size_t& count) const
+{
+    const size_t sz = size();
+    if (m_is_packed && sz) {
+        size_t nulls = m_exponents.is_attached() ? m_exponents.count(0) : 0;
+        if (m_min_exponent == m_max_exponent) {
+            // Nulls have a zero coefficient. The sum of less than 2^31 coefficients of 32 bits cannot overflow.
+            if (m_coefficients.get_width() <= 32) {
+                count = sz - nulls;
+                return make_decimal(m_coefficients.sum(0, sz), m_min_exponent);
+            }
+        }
+        // Add up the coefficients of each exponent separately
+        int64_t sums[s_max_exponent_range + 1] = {};
+        bool overflow = false;
+        for (size_t i = 0; i < sz && !overflow; ++i) {
+            int64_t e = m_exponents.is_attached() ? m_exponents.get(i) : 1;
+            if (e != 0)
+                overflow = util::int_add_with_overflow_detect(sums[e - 1], m_coefficients.get(i));
+        }
+        if (!overflow) {
+            Decimal128 result(0);
+            for (int e = 0; e <= m_max_exponent - m_min_exponent; ++e)
+                result += make_decimal(sums[e], m_min_exponent + e);
+            count = sz - nulls;
+            return result;
+        }
+    }
+
+    Decimal128 result(0);
+    count = 0;
+    for (size_t i = 0; i < sz; ++i) {
+        Decimal128 val = get(i);
+        if (!val.is_null()) {
+            result += val;
+            ++count;
+        }
+    }
+    return result;
+}
+
+template <bool find_max>
+size_t ArrayDecimal128::find_minmax() const
+{
+    const size_t sz = size();
+    if (sz == 0)
+        return realm::npos;
+
+    if (m_is_packed) {
+        size_t best = realm::npos;
+        if (!m_exponents.is_attached()) {
+            int64_t value;
+            if (find_max)
+                m_coefficients.maximum(value, 0, sz, &best);
+            else
+                m_coefficients.minimum(value, 0, sz, &best);
+            return best;
+        }
+        // Compare the coefficients scaled to the smallest exponent
+        int64_t best_value = 0;
+        bool overflow = false;
+        for (size_t i = 0; i < sz && !overflow; ++i) {
+            int64_t e = m_exponents.get(i);
+            if (e == 0)
+                continue;
+            int64_t value = m_coefficients.get(i);
+            overflow = util::int_multiply_with_overflow_detect(value, powers_of_ten[e - 1]);
+            if (best == realm::npos || (find_max ? value > best_value : value < best_value)) {
+                best = i;
+                best_value = value;
+            }
+        }
+        if (!overflow)
+            return best;
     }
-    return realm::npos;
+
+    // NaN, and so null, does not compare to anything
+    size_t best = realm::npos;
+    Decimal128 best_value;
+    for (size_t i = 0; i < sz; ++i) {
+        Decimal128 val = get(i);
+        if (!val.is_nan() && (best == realm::npos || (find_max ? val > best_value : val < best_value))) {
+            best = i;
+            best_value = val;
+        }
+    }
+    return best;
+}
+
+size_t ArrayDecimal128::find_min() const
+{
+    return find_minmax<false>();
+}
+
+size_t ArrayDecimal128::find_max() const
+{
+    return find_minmax<true>();
 }
 
 } // namespace realm
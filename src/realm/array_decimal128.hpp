@@ -24,17 +24,28 @@
 
 namespace realm {
 
+/// A leaf of Decimal128 values, normally stored as 16 bytes each. When the
+/// leaf is committed, it is packed if every value is null or has a
+/// coefficient below 2^63, and the exponents are close to each other. The
+/// signed coefficients are then kept in an integer array and the exponents
+/// as small offsets from the smallest one. Comparisons and aggregates on a
+/// packed leaf use integer math instead of the BID library, and leaves with
+/// a single exponent are searched by the integer search kernels. A packed
+/// leaf is unpacked before it is modified.
 class ArrayDecimal128 : public ArrayPayload, private Array {
 public:
     using value_type = Decimal128;
 
-    using Array::Array;
-    using Array::destroy;
+    explicit ArrayDecimal128(Allocator& alloc)
+        : Array(alloc)
+        , m_coefficients(alloc)
+        , m_exponents(alloc)
+    {
+        m_coefficients.set_parent(this, s_coefficients_ndx);
+        m_exponents.set_parent(this, s_exponents_ndx);
+    }
+
     using Array::get_ref;
-    using Array::init_from_mem;
-    using Array::init_from_parent;
-    using Array::size;
-    using Array::truncate;
     using Array::update_parent;
     using Array::verify;
 
@@ -46,12 +57,31 @@ public:
     void create()
     {
         auto mem = Array::create(type_Normal, false, wtype_Multiply, 0, 0, m_alloc); // Throws
+        init_from_mem(mem);
+    }
+
+    void destroy() noexcept
+    {
+        if (m_is_packed)
+            Array::destroy_deep();
+        else
+            Array::destroy();
+    }
+
+    void init_from_mem(MemRef mem) noexcept
+    {
         Array::init_from_mem(mem);
+        init_packed();
     }
 
     void init_from_ref(ref_type ref) noexcept override
     {
-        Array::init_from_ref(ref);
+        init_from_mem(MemRef(ref, m_alloc));
+    }
+
+    void init_from_parent() noexcept
+    {
+        init_from_ref(get_ref_from_parent());
     }
 
     void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept override
@@ -59,13 +89,22 @@ public:
         Array::set_parent(parent, ndx_in_parent);
     }
 
+    size_t size() const noexcept
+    {
+        return m_is_packed ? m_coefficients.size() : Array::size();
+    }
+
     bool is_null(size_t ndx) const
     {
+        if (m_is_packed)
+            return m_exponents.is_attached() && m_exponents.get(ndx) == 0;
         return this->get_width() == 0 || get(ndx).is_null();
     }
 
     Decimal128 get(size_t ndx) const
     {
+        if (m_is_packed)
+            return get_packed(ndx);
         REALM_ASSERT(ndx < m_size);
         auto values = reinterpret_cast<Decimal128*>(this->m_data);
         return values[ndx];
@@ -85,20 +124,130 @@ public:
     void insert(size_t ndx, Decimal128 value);
     void erase(size_t ndx);
     void move(ArrayDecimal128& dst, size_t ndx);
+    void truncate(size_t ndx);
     void clear()
     {
         truncate(0);
     }
 
-    size_t find_first(Decimal128 value, size_t begin = 0, size_t end = npos) const noexcept;
+    size_t find_first(Decimal128 value, size_t begin = 0, size_t end = npos) const noexcept
+    {
+        return find_first<Equal>(value, begin, end);
+    }
+
+    template <class Condition>
+    size_t find_first(Decimal128 value, size_t begin, size_t end) const noexcept;
+
+    /// Sum of the values that are not null, whose number is returned in
+    /// 'count'.
+    Decimal128 sum(size_t& count) const;
+
+    /// Index of the first occurrence of the smallest or largest value that is
+    /// not null, or npos if all values are null.
+    size_t find_min() const;
+    size_t find_max() const;
+
+    /// Pack the values if they all allow it. Called when the leaf is
+    /// committed, see Cluster::encode_leaves().
+    void pack();
+    bool is_packed() const noexcept
+    {
+        return m_is_packed;
+    }
+
+    enum class Compare { Other, Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
 
 protected:
     size_t calc_byte_len(size_t num_items, size_t) const override
     {
         return num_items * sizeof(Decimal128) + header_size;
     }
+
+private:
+    static constexpr size_t s_coefficients_ndx = 0;
+    static constexpr size_t s_exponents_ndx = 1;
+    static constexpr size_t s_min_exponent_ndx = 2;
+    static constexpr size_t s_max_exponent_ndx = 3;
+    // Coefficients of different exponents can be brought to the smallest
+    // exponent with a multiplication by at most 10^18
+    static constexpr int s_max_exponent_range = 18;
+
+    // Coefficient ranges are inclusive. An empty range has 'lo' > 'hi'.
+    struct CoefficientRange {
+        int64_t lo;
+        int64_t hi;
+        bool negate; // Coefficients outside of the range match
+        bool matches(int64_t coefficient) const noexcept
+        {
+            return (lo <= coefficient && coefficient <= hi) != negate;
+        }
+    };
+
+    // Signed coefficients, 0 for nulls
+    Array m_coefficients;
+    // Exponents as 1 + the offset from m_min_exponent, 0 for nulls. Not
+    // attached if all the values have the same exponent and none is null.
+    Array m_exponents;
+    int m_min_exponent = 0;
+    int m_max_exponent = 0;
+    bool m_is_packed = false;
+
+    template <class Condition>
+    static constexpr Compare compare_kind() noexcept
+    {
+        if constexpr (std::is_same_v<Condition, Equal>)
+            return Compare::Equal;
+        else if constexpr (std::is_same_v<Condition, NotEqual>)
+            return Compare::NotEqual;
+        else if constexpr (std::is_same_v<Condition, Less>)
+            return Compare::Less;
+        else if constexpr (std::is_same_v<Condition, LessEqual>)
+            return Compare::LessEqual;
+        else if constexpr (std::is_same_v<Condition, Greater>)
+            return Compare::Greater;
+        else if constexpr (std::is_same_v<Condition, GreaterEqual>)
+            return Compare::GreaterEqual;
+        else
+            return Compare::Other;
+    }
+
+    static bool to_packed(Decimal128 value, int64_t& coefficient, int& exponent) noexcept;
+    static CoefficientRange coefficient_range(Compare kind, int64_t coefficient, int value_exponent,
+                                              int exponent) noexcept;
+
+    void init_packed() noexcept;
+    void unpack();
+    Decimal128 get_packed(size_t ndx) const;
+    bool find_first_packed(Compare kind, Decimal128 value, size_t begin, size_t end, size_t& result) const;
+    size_t find_first_coefficient(const CoefficientRange& range, size_t begin, size_t end) const;
+    template <bool find_max>
+    size_t find_minmax() const;
 };
 
+template <class Condition>
+size_t ArrayDecimal128::find_first(Decimal128 value, size_t begin, size_t end) const noexcept
+{
+    if (end == npos)
+        end = size();
+    REALM_ASSERT(begin <= end && end <= size());
+
+    constexpr Compare kind = compare_kind<Condition>();
+    if (kind != Compare::Other && m_is_packed) {
+        size_t result;
+        if (find_first_packed(kind, value, begin, end, result))
+            return result;
+    }
+
+    Condition cond;
+    bool value_is_null = value.is_null();
+    for (size_t i = begin; i < end; i++) {
+        Decimal128 val = get(i);
+        if (cond(val, value, val.is_null(), value_is_null))
+            return i;
+    }
+    return realm::npos;
+}
+
 template <>
 class QueryState<Decimal128> : public QueryStateBase {
 public:
@@ -43,6 +43,16 @@ void ArrayIntNull::init_from_mem(MemRef mem) noexcept
 {
     Array::init_from_mem(mem);
 
+    if (m_has_refs) {
+        // The values and the validity bitmap, see encode_validity()
+        m_values.init_from_ref(get_as_ref(0));
+        if (ref_type validity_ref = get_as_ref(1))
+            m_validity.init_from_ref(validity_ref);
+        else
+            m_validity.detach();
+        return;
+    }
+
     // We always have the null value stored at position 0
     REALM_ASSERT(m_size > 0);
 }
@@ -106,6 +116,10 @@ void ArrayIntNull::replace_nulls_with(int64_t new_null)
 
 void ArrayIntNull::avoid_null_collision(int64_t value)
 {
+    // The null value of an offset encoded array is not tied to the width
+    if (is_offset_encoded())
+        copy_on_write(); // Throws
+
     if (m_width == 64) {
         if (value == null_value()) {
             int_fast64_t new_null = choose_random_null(value);
@@ -139,6 +153,165 @@ void ArrayIntNull::avoid_null_collision(int64_t value)
     }
 }
 
+void ArrayIntNull::encode_offsets()
+{
+    if (m_has_refs || is_offset_encoded() || is_run_encoded())
+        return;
+
+    if (m_width == 64) {
+        // A random null value would make the range of the elements span most of the 64 bits
+        const int64_t null = null_value();
+        const size_t sz = Array::size();
+        int64_t min_value = std::numeric_limits<int64_t>::max();
+        int64_t max_value = std::numeric_limits<int64_t>::min();
+        for (size_t i = 1; i < sz; ++i) {
+            int64_t v = Array::get(i);
+            if (v != null) {
+                min_value = std::min(min_value, v);
+                max_value = std::max(max_value, v);
+            }
+        }
+        int64_t new_null = 0;
+        if (min_value <= max_value) {
+            if (max_value < std::numeric_limits<int64_t>::max())
+                new_null = max_value + 1;
+            else if (min_value > std::numeric_limits<int64_t>::min())
+                new_null = min_value - 1;
+            else
+                return; // All 64 bits are in use anyway
+        }
+        if (new_null != null)
+            replace_nulls_with(new_null); // Throws
+    }
+
+    Array::encode_offsets(); // Throws
+}
+
+void ArrayIntNull::encode_validity()
+{
+    size_t sz = size();
+    if (m_has_refs || sz == 0)
+        return;
+
+    Array top(m_alloc);
+    _impl::DeepArrayDestroyGuard dg(&top);
+    top.create(type_HasRefs, false, 2); // Throws
+    Array values(m_alloc);
+    values.set_parent(&top, 0);
+    values.create(type_Normal); // Throws
+    values.update_parent();     // Throws
+
+    // A null element repeats the value before it, or the first value, so it neither widens the values nor breaks
+    // their runs
+    const int64_t null = null_value();
+    size_t null_count = 0;
+    int64_t previous = 0;
+    for (size_t i = 1; i <= sz; ++i) {
+        int64_t v = Array::get(i);
+        if (v != null) {
+            previous = v;
+            break;
+        }
+    }
+    for (size_t i = 1; i <= sz; ++i) {
+        int64_t v = Array::get(i);
+        if (v == null)
+            ++null_count;
+        else
+            previous = v;
+        values.add(previous); // Throws
+    }
+    values.encode_runs();    // Throws
+    values.encode_offsets(); // Throws
+
+    if (null_count) {
+        Array validity(m_alloc);
+        validity.set_parent(&top, 1);
+        validity.create(type_Normal, false, sz, 1); // Throws
+        validity.update_parent();                   // Throws
+        for (size_t i = 0; i < sz; ++i) {
+            if (Array::get(i + 1) == null)
+                validity.set(i, 0); // Throws
+        }
+    }
+    dg.release();
+
+    Array::destroy_deep();
+    init_from_mem(top.get_mem());
+    Array::update_parent(); // Throws
+}
+
+void ArrayIntNull::expand_validity()
+{
+    REALM_ASSERT_DEBUG(m_has_refs);
+    ArrayIntNull plain(m_alloc);
+    plain.create(); // Throws
+    _impl::DeepArrayRefDestroyGuard dg(plain.get_ref(), m_alloc);
+    size_t sz = size();
+    for (size_t i = 0; i < sz; ++i)
+        plain.add(get(i)); // Throws
+    dg.release();
+
+    Array::destroy_deep();
+    init_from_mem(plain.get_mem());
+    Array::update_parent(); // Throws
+}
+
+size_t ArrayIntNull::get_range(size_t begin, size_t end, int64_t* dest) const noexcept
+{
+    size_t null_count = 0;
+    if (m_has_refs) {
+        m_values.get_range(begin, end, dest);
+        if (!m_validity.is_attached())
+            return 0;
+        while (begin < end) {
+            const size_t block = begin / 64;
+            const size_t block_end = std::min(block * 64 + 64, end);
+            const uint64_t valid = get_validity_block(block);
+            if (valid != ~uint64_t(0)) {
+                for (size_t i = begin; i < block_end; ++i) {
+                    if (!((valid >> (i - block * 64)) & 1)) {
+                        dest[i - begin] = 0;
+                        ++null_count;
+                    }
+                }
+            }
+            dest += block_end - begin;
+            begin = block_end;
+        }
+        return null_count;
+    }
+
+    // The payload follows the null value
+    Array::get_range(begin + 1, end + 1, dest);
+    int64_t null = null_value();
+    for (size_t i = 0; i < end - begin; ++i) {
+        if (dest[i] == null) {
+            dest[i] = 0;
+            ++null_count;
+        }
+    }
+    return null_count;
+}
+
+void ArrayIntNull::verify() const
+{
+#ifdef REALM_DEBUG
+    if (m_has_refs) {
+        REALM_ASSERT(Array::size() == 2);
+        m_values.verify();
+        REALM_ASSERT(!m_values.has_refs());
+        if (m_validity.is_attached()) {
+            m_validity.verify();
+            REALM_ASSERT(m_validity.get_width() == 1);
+            REALM_ASSERT(m_validity.size() == m_values.size());
+        }
+        return;
+    }
+    Array::verify();
+#endif
+}
+
 void ArrayIntNull::find_all(IntegerColumn* result, value_type value, size_t col_offset, size_t begin,
                             size_t end) const
 {
@@ -161,6 +334,12 @@ void ArrayIntNull::find_all(IntegerColumn* result, value_type value, size_t col_
 
 void ArrayIntNull::get_chunk(size_t ndx, value_type res[8]) const noexcept
 {
+    if (m_has_refs) {
+        size_t sz = size();
+        for (size_t i = 0; i < 8; ++i)
+            res[i] = ndx + i < sz ? get(ndx + i) : util::none;
+        return;
+    }
     // FIXME: Optimize this
     int64_t tmp[8];
     Array::get_chunk(ndx + 1, tmp);
@@ -172,6 +351,8 @@ void ArrayIntNull::get_chunk(size_t ndx, value_type res[8]) const noexcept
 
 void ArrayIntNull::move(ArrayIntNull& dst, size_t ndx)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     size_t sz = size();
     for (size_t i = ndx; i < sz; i++) {
         dst.add(get(i));
@@ -19,6 +19,8 @@
 #ifndef REALM_ARRAY_INTEGER_HPP
 #define REALM_ARRAY_INTEGER_HPP
 
+#include <cstring>
+
 #include <realm/array.hpp>
 #include <realm/util/safe_int_ops.hpp>
 #include <realm/util/optional.hpp>
@@ -156,13 +158,52 @@ public:
 
     size_t find_first(value_type value, size_t begin = 0, size_t end = npos) const;
 
+    /// Read the elements in [begin, end) into 'dest', with 0 in place of the
+    /// null elements, and return the number of null elements.
+    size_t get_range(size_t begin, size_t end, int64_t* dest) const noexcept;
+
+    /// See Array::encode_offsets(). The null value is moved next to the
+    /// range of the other values first, so it does not widen the offsets.
+    void encode_offsets();
+
+    /// Replace the null value in front of the elements by a bitmap with a set
+    /// bit for every element that is not null. The leaf then refers to an
+    /// array of the values, where a null element holds the value before it,
+    /// and to the bitmap, which is left out if no element is null. The values
+    /// are run length or offset encoded if that makes them smaller. Searches
+    /// combine the matches of 64 elements at a time with a word of the
+    /// bitmap. The leaf is expanded again before it is modified. Called when
+    /// the leaf is committed, see Cluster::encode_leaves().
+    void encode_validity();
+    bool is_validity_encoded() const noexcept
+    {
+        return m_has_refs;
+    }
+
+    void verify() const;
+
 protected:
     void avoid_null_collision(int64_t value);
 
 private:
+    // The values and the bitmap of a leaf with encoded validity
+    Array m_values;
+    Array m_validity;
+
     int_fast64_t choose_random_null(int64_t incoming) const;
     void replace_nulls_with(int64_t new_null);
     bool can_use_as_null(int64_t value) const;
+
+    void expand_validity();
+    // The bits of the elements [64 * block, 64 * block + 64), of which those past the end are undefined
+    uint64_t get_validity_block(size_t block) const noexcept;
+
+    template <class cond>
+    bool find_validity(Action action, value_type value, size_t start, size_t end, size_t baseindex,
+                       QueryState<int64_t>* state) const;
+    template <class cond, Action action, class Callback>
+    bool find_validity(value_type value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
+                       Callback callback) const;
 };
 
 
@@ -176,14 +217,18 @@ inline ArrayInteger::ArrayInteger(Allocator& allocator) noexcept
 
 inline ArrayIntNull::ArrayIntNull(Allocator& allocator) noexcept
     : Array(allocator)
+    , m_values(allocator)
+    , m_validity(allocator)
 {
+    m_values.set_parent(this, 0);
+    m_validity.set_parent(this, 1);
 }
 
 inline ArrayIntNull::~ArrayIntNull() noexcept {}
 
 inline size_t ArrayIntNull::size() const noexcept
 {
-    return Array::size() - 1;
+    return m_has_refs ? m_values.size() : Array::size() - 1;
 }
 
 inline bool ArrayIntNull::is_empty() const noexcept
@@ -193,6 +238,8 @@ inline bool ArrayIntNull::is_empty() const noexcept
 
 inline void ArrayIntNull::insert(size_t ndx, value_type value)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     if (value) {
         avoid_null_collision(*value);
         Array::insert(ndx + 1, *value);
@@ -204,6 +251,8 @@ inline void ArrayIntNull::insert(size_t ndx, value_type value)
 
 inline void ArrayIntNull::add(value_type value)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     if (value) {
         avoid_null_collision(*value);
         Array::add(*value);
@@ -215,6 +264,8 @@ inline void ArrayIntNull::add(value_type value)
 
 inline void ArrayIntNull::set(size_t ndx, value_type value)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     if (value) {
         avoid_null_collision(*value);
         Array::set(ndx + 1, *value);
@@ -226,11 +277,18 @@ inline void ArrayIntNull::set(size_t ndx, value_type value)
 
 inline void ArrayIntNull::set_null(size_t ndx)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     Array::set(ndx + 1, null_value());
 }
 
 inline ArrayIntNull::value_type ArrayIntNull::get(size_t ndx) const noexcept
 {
+    if (m_has_refs) {
+        if (m_validity.is_attached() && m_validity.get(ndx) == 0)
+            return util::none;
+        return util::some<int64_t>(m_values.get(ndx));
+    }
     int64_t value = Array::get(ndx + 1);
     if (value == null_value()) {
         return util::none;
@@ -240,6 +298,8 @@ inline ArrayIntNull::value_type ArrayIntNull::get(size_t ndx) const noexcept
 
 inline ArrayIntNull::value_type ArrayIntNull::get(const char* header, size_t ndx) noexcept
 {
+    // The children of a leaf with encoded validity cannot be reached without the allocator
+    REALM_ASSERT_DEBUG(!get_hasrefs_from_header(header));
     int64_t null_value = Array::get(header, 0);
     int64_t value = Array::get(header, ndx + 1);
     if (value == null_value) {
@@ -257,33 +317,67 @@ inline bool ArrayIntNull::is_null(size_t ndx) const noexcept
 
 inline int64_t ArrayIntNull::null_value() const noexcept
 {
+    REALM_ASSERT_DEBUG(!m_has_refs);
     return Array::get(0);
 }
 
 inline void ArrayIntNull::erase(size_t ndx)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     Array::erase(ndx + 1);
 }
 
 inline void ArrayIntNull::erase(size_t begin, size_t end)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     Array::erase(begin + 1, end + 1);
 }
 
 inline void ArrayIntNull::clear()
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     Array::truncate(0);
     Array::add(0);
 }
 
 inline void ArrayIntNull::move(size_t begin, size_t end, size_t dest_begin)
 {
+    if (m_has_refs)
+        expand_validity(); // Throws
     Array::move(begin + 1, end + 1, dest_begin + 1);
 }
 
+inline uint64_t ArrayIntNull::get_validity_block(size_t block) const noexcept
+{
+    // The bitmap has a width of 1, so its data holds the bits in the order of the elements, and it is padded to a
+    // multiple of 8 bytes
+    uint64_t bits;
+    std::memcpy(&bits, get_data_from_header(m_validity.get_header()) + block * 8, sizeof(bits));
+    return bits;
+}
+
 inline bool ArrayIntNull::find(int cond, Action action, value_type value, size_t start, size_t end, size_t baseindex,
                                QueryState<int64_t>* state) const
 {
+    if (m_has_refs) {
+        if (cond == cond_Equal)
+            return find_validity<Equal>(action, value, start, end, baseindex, state);
+        if (cond == cond_NotEqual)
+            return find_validity<NotEqual>(action, value, start, end, baseindex, state);
+        if (cond == cond_Greater)
+            return find_validity<Greater>(action, value, start, end, baseindex, state);
+        if (cond == cond_Less)
+            return find_validity<Less>(action, value, start, end, baseindex, state);
+        if (cond == cond_None)
+            return find_validity<None>(action, value, start, end, baseindex, state);
+        if (cond == cond_LeftNotNull)
+            return find_validity<NotNull>(action, value, start, end, baseindex, state);
+        REALM_ASSERT_DEBUG(false);
+        return false;
+    }
     if (value) {
         return Array::find(cond, action, *value, start, end, baseindex, state, true /*treat as nullable array*/,
                            false /*search parameter given in 'value' argument*/);
@@ -298,6 +392,8 @@ template <class cond, Action action, size_t bitwidth, class Callback>
 bool ArrayIntNull::find(value_type value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
                         Callback callback) const
 {
+    if (m_has_refs)
+        return find_validity<cond, action, Callback>(value, start, end, baseindex, state, callback);
     if (value) {
         return Array::find<cond, action>(*value, start, end, baseindex, state, std::forward<Callback>(callback),
                                          true /*treat as nullable array*/,
@@ -314,6 +410,8 @@ bool ArrayIntNull::find(value_type value, size_t start, size_t end, size_t basei
 template <class cond, Action action, size_t bitwidth>
 bool ArrayIntNull::find(int64_t value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state) const
 {
+    if (m_has_refs)
+        return find_validity<cond, action, CallbackDummy>(value, start, end, baseindex, state, CallbackDummy());
     return Array::find<cond, action>(value, start, end, baseindex, state, true /*treat as nullable array*/,
                                      false /*search parameter given in 'value' argument*/);
 }
@@ -323,6 +421,8 @@ template <class cond, Action action, class Callback>
 bool ArrayIntNull::find(value_type value, size_t start, size_t end, size_t baseindex, QueryState<int64_t>* state,
                         Callback callback) const
 {
+    if (m_has_refs)
+        return find_validity<cond, action, Callback>(value, start, end, baseindex, state, callback);
     if (value) {
         return Array::find<cond, action>(*value, start, end, baseindex, state, std::forward<Callback>(callback),
                                          true /*treat as nullable array*/,
@@ -365,7 +465,10 @@ template <class cond>
 size_t ArrayIntNull::find_first(value_type value, size_t start, size_t end) const
 {
     QueryState<int64_t> state(act_ReturnFirst, 1);
-    if (value) {
+    if (m_has_refs) {
+        find_validity<cond, act_ReturnFirst>(value, start, end, 0, &state, CallbackDummy());
+    }
+    else if (value) {
         Array::find<cond, act_ReturnFirst>(*value, start, end, 0, &state, Array::CallbackDummy(),
                                            true /*treat as nullable array*/,
                                            false /*search parameter given in 'value' argument*/);
@@ -386,6 +489,98 @@ inline size_t ArrayIntNull::find_first(value_type value, size_t begin, size_t en
 {
     return find_first<Equal>(value, begin, end);
 }
+
+template <class cond>
+bool ArrayIntNull::find_validity(Action action, value_type value, size_t start, size_t end, size_t baseindex,
+                                 QueryState<int64_t>* state) const
+{
+    if (action == act_ReturnFirst)
+        return find_validity<cond, act_ReturnFirst>(value, start, end, baseindex, state, CallbackDummy());
+    if (action == act_Sum)
+        return find_validity<cond, act_Sum>(value, start, end, baseindex, state, CallbackDummy());
+    if (action == act_Min)
+        return find_validity<cond, act_Min>(value, start, end, baseindex, state, CallbackDummy());
+    if (action == act_Max)
+        return find_validity<cond, act_Max>(value, start, end, baseindex, state, CallbackDummy());
+    if (action == act_Count)
+        return find_validity<cond, act_Count>(value, start, end, baseindex, state, CallbackDummy());
+    if (action == act_FindAll)
+        return find_validity<cond, act_FindAll>(value, start, end, baseindex, state, CallbackDummy());
+    if (action == act_CallbackIdx)
+        return find_validity<cond, act_CallbackIdx>(value, start, end, baseindex, state, CallbackDummy());
+    REALM_ASSERT_DEBUG(false);
+    return false;
+}
+
+template <class cond, Action action, class Callback>
+bool ArrayIntNull::find_validity(value_type value, size_t start, size_t end, size_t baseindex,
+                                 QueryState<int64_t>* state, Callback callback) const
+{
+    cond c;
+    if (end == npos)
+        end = size();
+    const bool find_null = !value;
+    const int64_t v = value ? *value : 0;
+
+    // When searching for null, an element that is not null either matches or not regardless of its value
+    const bool null_matches = c(int64_t(0), v, true, find_null);
+    const bool others_match = find_null && c(int64_t(0), v, false, true);
+
+    // The search kernels for non-nullable arrays support these conditions
+    constexpr bool has_kernel = std::is_same<cond, Equal>::value || std::is_same<cond, NotEqual>::value ||
+                                std::is_same<cond, Greater>::value || std::is_same<cond, Less>::value;
+    if (!m_validity.is_attached()) {
+        // No element is null, so the values can be searched like a non-nullable array
+        if (has_kernel && !find_null)
+            return m_values.find<cond, action>(v, start, end, baseindex, state, callback);
+        if (find_null && !others_match)
+            return true;
+    }
+
+    int64_t values[64];
+    while (start < end) {
+        const size_t block = start / 64;
+        const size_t block_begin = block * 64;
+        const size_t block_end = std::min(block_begin + 64, end);
+        const uint64_t valid = m_validity.is_attached() ? get_validity_block(block) : ~uint64_t(0);
+        m_values.get_range(start, block_end, values);
+
+        uint64_t matches = 0;
+        if (find_null) {
+            if (others_match)
+                matches = valid;
+        }
+        else {
+            for (size_t i = start; i < block_end; ++i)
+                matches |= uint64_t(c(values[i - start], v)) << (i - block_begin);
+            matches &= valid;
+        }
+        if (null_matches)
+            matches |= ~valid;
+        // Only the elements in [start, block_end)
+        matches &= ~uint64_t(0) << (start - block_begin);
+        if (block_end - block_begin < 64)
+            matches &= (uint64_t(1) << (block_end - block_begin)) - 1;
+
+        if (action == act_Count && state->m_match_count + 64 < state->m_limit) {
+            state->m_state += fast_popcount64(matches);
+            state->m_match_count = size_t(state->m_state);
+        }
+        else {
+            while (matches) {
+                const size_t i = first_set_bit64(matches);
+                util::Optional<int64_t> v2;
+                if ((valid >> i) & 1)
+                    v2 = values[block_begin + i - start];
+                if (!Array::find_action<action, Callback>(block_begin + i + baseindex, v2, state, callback))
+                    return false;
+                matches &= matches - 1;
+            }
+        }
+        start = block_end;
+    }
+    return true;
+}
 } // namespace realm
 
 #endif // REALM_ARRAY_INTEGER_HPP
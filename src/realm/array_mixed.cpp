@@ -19,6 +19,9 @@
 #include <realm/array_mixed.hpp>
 #include <realm/array_basic.hpp>
 
+#include <cmath>
+#include <vector>
+
 using namespace realm;
 
 ArrayMixed::ArrayMixed(Allocator& a)
@@ -198,6 +201,41 @@ size_t ArrayMixed::find_first(Mixed value, size_t begin, size_t end) const noexc
     DataType type = value.get_type();
     if (end == realm::npos)
         end = size();
+
+    // Values stored in the composite array or in the int payload array are
+    // searched for with the integer search, as their encoding is unique
+    switch (type) {
+        case type_Int: {
+            int64_t int_val = value.get_int();
+            if (std::numeric_limits<int32_t>::min() <= int_val && int_val <= std::numeric_limits<int32_t>::max())
+                return m_composite.find_first((int_val << s_data_shift) + type_Int + 1, begin, end);
+            return find_payload(int_val, type, begin, end);
+        }
+        case type_Bool:
+            return m_composite.find_first((int64_t(value.get_bool()) << s_data_shift) + type_Bool + 1, begin, end);
+        case type_Float: {
+            float val = value.get_float();
+            if (std::isnan(val))
+                break;
+            size_t res = find_payload(type_punning<int64_t>(val), type, begin, end);
+            // 0 and -0 compare equal
+            if (val == 0)
+                res = std::min(res, find_payload(type_punning<int64_t>(-val), type, begin, end));
+            return res;
+        }
+        case type_Double: {
+            double val = value.get_double();
+            if (std::isnan(val))
+                break;
+            size_t res = find_payload(type_punning<int64_t>(val), type, begin, end);
+            if (val == 0)
+                res = std::min(res, find_payload(type_punning<int64_t>(-val), type, begin, end));
+            return res;
+        }
+        default:
+            break;
+    }
+
     for (size_t i = begin; i < end; i++) {
         if (this->get_type(i) == type && get(i) == value) {
             return i;
@@ -206,6 +244,27 @@ size_t ArrayMixed::find_first(Mixed value, size_t begin, size_t end) const noexc
     return realm::npos;
 }
 
+size_t ArrayMixed::find_payload(int64_t payload, DataType type, size_t begin, size_t end) const
+{
+    if (!Array::get_as_ref(payload_idx_int))
+        return realm::npos;
+    ensure_int_array();
+
+    // Each payload entry is referenced by exactly one element, but equal
+    // values may be stored more than once, in any order. The reference to
+    // each entry holding the value is searched for before the first match
+    // found so far.
+    const int64_t tag = (payload_idx_int << s_payload_idx_shift) + type + 1;
+    size_t res = realm::npos;
+    for (size_t payload_ndx = m_ints.find_first(payload); payload_ndx != realm::npos && begin < end;
+         payload_ndx = m_ints.find_first(payload, payload_ndx + 1)) {
+        size_t i = m_composite.find_first((int64_t(payload_ndx) << s_data_shift) + tag, begin, end);
+        if (i != realm::npos)
+            res = end = i;
+    }
+    return res;
+}
+
 void ArrayMixed::verify() const
 {
     // TODO: Implement
@@ -126,6 +126,8 @@ private:
     void ensure_int_array() const;
     void ensure_int_pair_array() const;
     void ensure_string_array() const;
+    // Find the first element in [begin, end) holding a value of 'type' that is stored as 'payload' in m_ints
+    size_t find_payload(int64_t payload, DataType type, size_t begin, size_t end) const;
     void replace_index(size_t old_ndx, size_t new_ndx, size_t payload_index);
     void erase_linked_payload(size_t ndx);
 };
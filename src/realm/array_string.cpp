@@ -17,8 +17,12 @@
  **************************************************************************/
 
 #include <realm/array_string.hpp>
+#include <realm/array_blob.hpp>
+#include <realm/impl/destroy_guard.hpp>
 #include <realm/spec.hpp>
 
+#include <unordered_map>
+
 using namespace realm;
 
 ArrayString::ArrayString(Allocator& a)
@@ -61,6 +65,30 @@ void ArrayString::init_from_mem(MemRef mem) noexcept
             m_type = Type::enum_strings;
         }
     }
+    else if (is_compressed(header)) {
+        auto arr = new (&m_storage.m_enum) Array(m_alloc);
+        arr->init_from_mem(mem);
+        ArrayBlob symbols(m_alloc);
+        symbols.init_from_ref(arr->get_as_ref(0));
+        m_compressor = std::make_unique<StringCompressor>(symbols.get(0), symbols.size());
+        m_compressed_values = std::make_unique<ArraySmallBlobs>(m_alloc);
+        m_compressed_values->set_parent(arr, 1);
+        m_compressed_values->init_from_parent();
+        m_decompressed.clear();
+        m_decompressed_ends.clear();
+        m_type = Type::compressed_strings;
+    }
+    else if (has_dictionary(header)) {
+        auto arr = new (&m_storage.m_enum) Array(m_alloc);
+        arr->init_from_mem(mem);
+        m_string_enum_values = std::make_unique<ArrayString>(m_alloc);
+        m_string_enum_values->set_parent(arr, 0);
+        m_string_enum_values->init_from_parent();
+        m_dict_indexes = std::make_unique<Array>(m_alloc);
+        m_dict_indexes->set_parent(arr, 1);
+        m_dict_indexes->init_from_parent();
+        m_type = Type::dict_strings;
+    }
     else {
         bool is_big = Array::get_context_flag_from_header(header);
         if (!is_big) {
@@ -104,8 +132,11 @@ size_t ArrayString::size() const
             return static_cast<ArraySmallBlobs*>(m_arr)->size();
         case Type::big_strings:
             return static_cast<ArrayBigBlobs*>(m_arr)->size();
+        case Type::dict_strings:
         case Type::enum_strings:
-            return static_cast<Array*>(m_arr)->size();
+            return get_indexes()->size();
+        case Type::compressed_strings:
+            return m_compressed_values->size();
     }
     return {};
 }
@@ -122,13 +153,16 @@ void ArrayString::add(StringData value)
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->add_string(value);
             break;
+        case Type::dict_strings:
         case Type::enum_strings: {
-            auto a = static_cast<Array*>(m_arr);
+            auto a = get_indexes();
             size_t ndx = a->size();
             a->add(0);
             set(ndx, value);
             break;
         }
+        case Type::compressed_strings:
+            REALM_UNREACHABLE();
     }
 }
 
@@ -144,6 +178,7 @@ void ArrayString::set(size_t ndx, StringData value)
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->set_string(ndx, value);
             break;
+        case Type::dict_strings:
         case Type::enum_strings: {
             size_t sz = m_string_enum_values->size();
             size_t res = m_string_enum_values->find_first(value, 0, sz);
@@ -151,9 +186,11 @@ void ArrayString::set(size_t ndx, StringData value)
                 m_string_enum_values->add(value);
                 res = sz;
             }
-            static_cast<Array*>(m_arr)->set(ndx, res);
+            get_indexes()->set(ndx, res);
             break;
         }
+        case Type::compressed_strings:
+            REALM_UNREACHABLE();
     }
 }
 
@@ -169,10 +206,14 @@ void ArrayString::insert(size_t ndx, StringData value)
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->insert_string(ndx, value);
             break;
+        case Type::dict_strings:
         case Type::enum_strings: {
-            static_cast<Array*>(m_arr)->insert(ndx, 0);
+            get_indexes()->insert(ndx, 0);
             set(ndx, value);
+            break;
         }
+        case Type::compressed_strings:
+            REALM_UNREACHABLE();
     }
 }
 
@@ -185,10 +226,13 @@ StringData ArrayString::get(size_t ndx) const
             return static_cast<ArraySmallBlobs*>(m_arr)->get_string(ndx);
         case Type::big_strings:
             return static_cast<ArrayBigBlobs*>(m_arr)->get_string(ndx);
+        case Type::dict_strings:
         case Type::enum_strings: {
-            size_t index = size_t(static_cast<Array*>(m_arr)->get(ndx));
+            size_t index = size_t(get_indexes()->get(ndx));
             return m_string_enum_values->get(index);
         }
+        case Type::compressed_strings:
+            return get_decompressed(ndx);
     }
     return {};
 }
@@ -202,10 +246,13 @@ StringData ArrayString::get_legacy(size_t ndx) const
             return static_cast<ArraySmallBlobs*>(m_arr)->get_string_legacy(ndx);
         case Type::big_strings:
             return static_cast<ArrayBigBlobs*>(m_arr)->get_string(ndx);
+        case Type::dict_strings:
         case Type::enum_strings: {
-            size_t index = size_t(static_cast<Array*>(m_arr)->get(ndx));
+            size_t index = size_t(get_indexes()->get(ndx));
             return m_string_enum_values->get(index);
         }
+        case Type::compressed_strings:
+            return get_decompressed(ndx);
     }
     return {};
 }
@@ -219,16 +266,21 @@ bool ArrayString::is_null(size_t ndx) const
             return static_cast<ArraySmallBlobs*>(m_arr)->is_null(ndx);
         case Type::big_strings:
             return static_cast<ArrayBigBlobs*>(m_arr)->is_null(ndx);
+        case Type::dict_strings:
         case Type::enum_strings: {
-            size_t index = size_t(static_cast<Array*>(m_arr)->get(ndx));
+            size_t index = size_t(get_indexes()->get(ndx));
             return m_string_enum_values->is_null(index);
         }
+        case Type::compressed_strings:
+            return m_compressed_values->is_null(ndx);
     }
     return {};
 }
 
 void ArrayString::erase(size_t ndx)
 {
+    if (m_type == Type::compressed_strings)
+        decompress(); // Throws
     switch (m_type) {
         case Type::small_strings:
             static_cast<ArrayStringShort*>(m_arr)->erase(ndx);
@@ -239,14 +291,20 @@ void ArrayString::erase(size_t ndx)
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->erase(ndx);
             break;
+        case Type::dict_strings:
         case Type::enum_strings:
-            static_cast<Array*>(m_arr)->erase(ndx);
+            get_indexes()->erase(ndx);
             break;
+        case Type::compressed_strings:
+            REALM_UNREACHABLE();
     }
 }
 
 void ArrayString::move(ArrayString& dst, size_t ndx)
 {
+    if (m_type == Type::compressed_strings)
+        decompress(); // Throws
+
     size_t sz = size();
     for (size_t i = ndx; i < sz; i++) {
         dst.add(get(i));
@@ -262,8 +320,12 @@ void ArrayString::move(ArrayString& dst, size_t ndx)
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->truncate(ndx);
             break;
+        case Type::dict_strings:
+            m_dict_indexes->truncate(ndx);
+            break;
         case Type::enum_strings:
             // this operation will never be called for enumerated columns
+        case Type::compressed_strings:
             REALM_UNREACHABLE();
             break;
     }
@@ -271,6 +333,8 @@ void ArrayString::move(ArrayString& dst, size_t ndx)
 
 void ArrayString::clear()
 {
+    if (m_type == Type::compressed_strings)
+        decompress(); // Throws
     switch (m_type) {
         case Type::small_strings:
             static_cast<ArrayStringShort*>(m_arr)->clear();
@@ -281,9 +345,12 @@ void ArrayString::clear()
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->clear();
             break;
+        case Type::dict_strings:
         case Type::enum_strings:
-            static_cast<Array*>(m_arr)->clear();
+            get_indexes()->clear();
             break;
+        case Type::compressed_strings:
+            REALM_UNREACHABLE();
     }
 }
 
@@ -302,14 +369,24 @@ size_t ArrayString::find_first(StringData value, size_t begin, size_t end) const
             return static_cast<ArrayBigBlobs*>(m_arr)->find_first(as_binary, true, begin, end);
             break;
         }
+        case Type::dict_strings:
         case Type::enum_strings: {
             size_t sz = m_string_enum_values->size();
             size_t res = m_string_enum_values->find_first(value, 0, sz);
             if (res != realm::not_found) {
-                return static_cast<Array*>(m_arr)->find_first(res, begin, end);
+                return get_indexes()->find_first(res, begin, end);
             }
             break;
         }
+        case Type::compressed_strings: {
+            // Equal strings have equal compressed forms
+            if (value.is_null())
+                return m_compressed_values->find_first(BinaryData(), false, begin, end);
+            std::string compressed;
+            m_compressor->compress(value, compressed);
+            return m_compressed_values->find_first(BinaryData(compressed.data(), compressed.size()), false, begin,
+                                                   end);
+        }
     }
     return not_found;
 }
@@ -358,19 +435,202 @@ size_t ArrayString::lower_bound(StringData value)
             return lower_bound_string(static_cast<ArraySmallBlobs*>(m_arr), value);
         case Type::big_strings:
             return lower_bound_string(static_cast<ArrayBigBlobs*>(m_arr), value);
+        case Type::dict_strings:
         case Type::enum_strings:
+        case Type::compressed_strings:
             break;
     }
     return realm::npos;
 }
 
+void ArrayString::encode_dictionary()
+{
+    if (m_type == Type::enum_strings || m_type == Type::compressed_strings)
+        return;
+
+    size_t sz = size();
+    if (sz == 0)
+        return;
+
+    // Number the distinct values in the order they first appear
+    std::unordered_map<StringData, size_t> key_ndx;
+    std::vector<StringData> keys;
+    std::vector<size_t> indexes;
+    indexes.reserve(sz);
+    for (size_t i = 0; i < sz; ++i) {
+        auto res = key_ndx.emplace(get(i), keys.size());
+        if (res.second)
+            keys.push_back(res.first->first);
+        indexes.push_back(res.first->second);
+    }
+
+    if (m_type == Type::dict_strings && keys.size() == m_string_enum_values->size())
+        return; // All the values of the dictionary are in use
+
+    // Only bother when each value is repeated at least once on average
+    if (keys.size() * 2 > sz) {
+        if (m_type == Type::dict_strings) {
+            ArrayString plain(m_alloc);
+            plain.create(); // Throws
+            for (size_t i = 0; i < sz; ++i)
+                plain.add(keys[indexes[i]]); // Throws
+            replace_leaf(MemRef(plain.get_ref(), m_alloc));
+        }
+        return;
+    }
+
+    ArrayString dict_keys(m_alloc);
+    dict_keys.create(); // Throws
+    for (StringData key : keys)
+        dict_keys.add(key); // Throws
+    Array dict_indexes(m_alloc);
+    dict_indexes.create(Array::type_Normal, false, sz, 0); // Throws
+    dict_indexes.ensure_minimum_width(keys.size() - 1);    // Throws
+    for (size_t i = 0; i < sz; ++i)
+        dict_indexes.set(i, indexes[i]);
+    Array top(m_alloc);
+    top.create(Array::type_HasRefs); // Throws
+    Array::set_encoding_in_header(Array::encoding_Dictionary, top.get_header());
+    top.add(from_ref(dict_keys.get_ref()));    // Throws
+    top.add(from_ref(dict_indexes.get_ref())); // Throws
+
+    if (m_type != Type::dict_strings) {
+        MemStats old_stats;
+        MemStats new_stats;
+        m_arr->stats(old_stats);
+        top.stats(new_stats);
+        if (new_stats.used >= old_stats.used) {
+            top.destroy_deep();
+            return;
+        }
+    }
+    replace_leaf(top.get_mem());
+}
+
+size_t ArrayString::find_dictionary_key(StringData value) const
+{
+    REALM_ASSERT_DEBUG(m_type == Type::dict_strings);
+    return m_string_enum_values->find_first(value, 0, m_string_enum_values->size());
+}
+
+size_t ArrayString::find_first_dictionary_key(size_t key_ndx, size_t begin, size_t end) const
+{
+    REALM_ASSERT_DEBUG(m_type == Type::dict_strings);
+    return m_dict_indexes->find_first(int64_t(key_ndx), begin, end);
+}
+
+void ArrayString::replace_leaf(MemRef mem)
+{
+    Array::destroy_deep(m_arr->get_ref(), m_alloc);
+    init_from_mem(mem);
+    m_arr->update_parent(); // Throws
+}
+
+void ArrayString::compress()
+{
+    if (m_type != Type::medium_strings && m_type != Type::big_strings)
+        return;
+
+    size_t sz = size();
+    std::vector<StringData> values;
+    values.reserve(sz);
+    for (size_t i = 0; i < sz; ++i)
+        values.push_back(get(i));
+
+    StringCompressor compressor(values);
+    if (compressor.get_num_symbols() == 0)
+        return;
+
+    std::string compressed;
+    std::vector<size_t> ends;
+    ends.reserve(sz);
+    for (StringData value : values) {
+        compressor.compress(value, compressed);
+        ends.push_back(compressed.size());
+    }
+    // All the compressed values must fit in a single blob
+    if (compressed.size() > max_compressed_leaf_size)
+        return;
+
+    Array top(m_alloc);
+    _impl::DeepArrayDestroyGuard dg(&top);
+    top.create(Array::type_HasRefs); // Throws
+    Array::set_encoding_in_header(Array::encoding_Compressed, top.get_header());
+    {
+        ArrayBlob symbols(m_alloc);
+        symbols.create(); // Throws
+        symbols.set_parent(&top, 0);
+        top.add(from_ref(symbols.get_ref())); // Throws
+        std::string table = compressor.serialize();
+        symbols.add(table.data(), table.size()); // Throws
+    }
+    {
+        ArraySmallBlobs blobs(m_alloc);
+        blobs.create(); // Throws
+        blobs.set_parent(&top, 1);
+        top.add(from_ref(blobs.get_ref())); // Throws
+        size_t begin = 0;
+        for (size_t i = 0; i < sz; ++i) {
+            if (values[i].is_null())
+                blobs.add(BinaryData()); // Throws
+            else
+                blobs.add(BinaryData(compressed.data() + begin, ends[i] - begin)); // Throws
+            begin = ends[i];
+        }
+    }
+
+    // Decompressing on access is not free, so the compressed leaf must be considerably smaller
+    MemStats old_stats;
+    MemStats new_stats;
+    m_arr->stats(old_stats);
+    top.stats(new_stats);
+    if (new_stats.used > old_stats.used - old_stats.used / 4)
+        return;
+
+    dg.release();
+    replace_leaf(top.get_mem());
+}
+
+void ArrayString::decompress()
+{
+    REALM_ASSERT_DEBUG(m_type == Type::compressed_strings);
+    ArrayString plain(m_alloc);
+    plain.create(); // Throws
+    _impl::DeepArrayRefDestroyGuard dg(plain.get_ref(), m_alloc);
+    size_t sz = size();
+    for (size_t i = 0; i < sz; ++i)
+        plain.add(get(i)); // Throws
+    dg.release();
+    replace_leaf(MemRef(plain.get_ref(), m_alloc));
+}
+
+StringData ArrayString::get_decompressed(size_t ndx) const
+{
+    if (m_compressed_values->is_null(ndx))
+        return {};
+    if (m_decompressed_ends.empty()) {
+        size_t sz = m_compressed_values->size();
+        m_decompressed_ends.reserve(sz);
+        for (size_t i = 0; i < sz; ++i) {
+            BinaryData compressed = m_compressed_values->get(i);
+            m_compressor->decompress(compressed.data(), compressed.size(), m_decompressed);
+            m_decompressed_ends.push_back(m_decompressed.size());
+        }
+    }
+    size_t begin = ndx ? m_decompressed_ends[ndx - 1] : 0;
+    return StringData(m_decompressed.data() + begin, m_decompressed_ends[ndx] - begin);
+}
+
 ArrayString::Type ArrayString::upgrade_leaf(size_t value_size)
 {
+    if (m_type == Type::compressed_strings)
+        decompress(); // Throws
+
     if (m_type == Type::big_strings)
         return Type::big_strings;
 
-    if (m_type == Type::enum_strings)
-        return Type::enum_strings;
+    if (m_type == Type::enum_strings || m_type == Type::dict_strings)
+        return m_type;
 
     if (m_type == Type::medium_strings) {
         if (value_size <= medium_string_max_size)
@@ -461,8 +721,17 @@ void ArrayString::verify() const
         case Type::big_strings:
             static_cast<ArrayBigBlobs*>(m_arr)->verify();
             break;
+        case Type::dict_strings:
+            m_arr->verify();
+            m_string_enum_values->verify();
+            m_dict_indexes->verify();
+            break;
         case Type::enum_strings:
-            static_cast<Array*>(m_arr)->verify();
+            m_arr->verify();
+            break;
+        case Type::compressed_strings:
+            m_arr->verify();
+            m_compressed_values->verify();
             break;
     }
 #endif
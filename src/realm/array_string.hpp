@@ -22,6 +22,7 @@
 #include <realm/array_string_short.hpp>
 #include <realm/array_blobs_small.hpp>
 #include <realm/array_blobs_big.hpp>
+#include <realm/string_compressor.hpp>
 
 namespace realm {
 
@@ -114,10 +115,52 @@ public:
 
     size_t lower_bound(StringData value);
 
+    /// Store every distinct value of this leaf once, and the values as
+    /// indexes into those, if that takes up less space. A leaf that already
+    /// has such a dictionary is rebuilt to drop values no longer in use, or
+    /// converted back if the values are no longer repetitive enough. Has no
+    /// effect on leaves of enumerated columns, which use a dictionary shared
+    /// by the whole column.
+    void encode_dictionary();
+
+    bool has_dictionary() const
+    {
+        return m_type == Type::dict_strings;
+    }
+
+    static bool has_dictionary(const char* header) noexcept
+    {
+        return Array::get_encoding_from_header(header) == Array::encoding_Dictionary;
+    }
+
+    /// Only for leaves with a dictionary: Return the index of \a value in
+    /// the dictionary or not_found, and find the first element that refers
+    /// to the dictionary entry at \a key_ndx.
+    size_t find_dictionary_key(StringData value) const;
+    size_t find_first_dictionary_key(size_t key_ndx, size_t begin, size_t end) const;
+
+    /// Compress the values of this leaf with a table of frequent substrings,
+    /// if that takes up considerably less space. Only leaves holding strings
+    /// longer than small_string_max_size are considered. A compressed leaf
+    /// is decompressed as a whole when first read through this accessor, and
+    /// converted back to an ordinary leaf when modified. Searching for a
+    /// value does not require decompression.
+    void compress();
+
+    bool is_compressed() const
+    {
+        return m_type == Type::compressed_strings;
+    }
+
+    static bool is_compressed(const char* header) noexcept
+    {
+        return Array::get_encoding_from_header(header) == Array::encoding_Compressed;
+    }
+
     /// Get the specified element without the cost of constructing an
     /// array instance. If an array instance is already available, or
     /// you need to get multiple values, then this method will be
-    /// slower.
+    /// slower. Not available for compressed leaves.
     static StringData get(const char* header, size_t ndx, Allocator& alloc) noexcept;
 
     void verify() const;
@@ -125,13 +168,17 @@ public:
 private:
     static constexpr size_t small_string_max_size = 15;  // ArrayStringShort
     static constexpr size_t medium_string_max_size = 63; // ArrayStringLong
+    static constexpr size_t max_compressed_leaf_size = 0x100000;
     union Storage {
         std::aligned_storage<sizeof(ArrayStringShort), alignof(ArrayStringShort)>::type m_string_short;
         std::aligned_storage<sizeof(ArraySmallBlobs), alignof(ArraySmallBlobs)>::type m_string_long;
         std::aligned_storage<sizeof(ArrayBigBlobs), alignof(ArrayBigBlobs)>::type m_big_blobs;
         std::aligned_storage<sizeof(Array), alignof(Array)>::type m_enum;
     };
-    enum class Type { small_strings, medium_strings, big_strings, enum_strings };
+    // A leaf with a dictionary of its own (dict_strings) is an array of two refs, to the distinct values and to the
+    // indexes into those, with encoding_Dictionary in its header. A compressed leaf (compressed_strings) is an array
+    // of two refs, to the symbol table and to the compressed values, with encoding_Compressed in its header.
+    enum class Type { small_strings, medium_strings, big_strings, enum_strings, dict_strings, compressed_strings };
 
     Type m_type = Type::small_strings;
 
@@ -143,8 +190,24 @@ private:
     bool m_nullable = true;
 
     std::unique_ptr<ArrayString> m_string_enum_values;
+    std::unique_ptr<Array> m_dict_indexes;
+
+    std::unique_ptr<StringCompressor> m_compressor;
+    std::unique_ptr<ArraySmallBlobs> m_compressed_values;
+    // The values of a compressed leaf, decompressed on first access, and where each of them ends
+    mutable std::string m_decompressed;
+    mutable std::vector<size_t> m_decompressed_ends;
 
     Type upgrade_leaf(size_t value_size);
+    void replace_leaf(MemRef mem);
+    void decompress();
+    StringData get_decompressed(size_t ndx) const;
+
+    // The indexes into the values of enumerated columns and leaves with a dictionary
+    Array* get_indexes() const
+    {
+        return m_type == Type::dict_strings ? m_dict_indexes.get() : static_cast<Array*>(m_arr);
+    }
 };
 
 inline StringData ArrayString::get(const char* header, size_t ndx, Allocator& alloc) noexcept
@@ -153,7 +216,14 @@ inline StringData ArrayString::get(const char* header, size_t ndx, Allocator& al
     if (!long_strings) {
         return ArrayStringShort::get(header, ndx, true);
     }
+    else if (has_dictionary(header)) {
+        ref_type indexes_ref = to_ref(Array::get(header, 1));
+        size_t key_ndx = size_t(Array::get(alloc.translate(indexes_ref), ndx));
+        ref_type keys_ref = to_ref(Array::get(header, 0));
+        return get(alloc.translate(keys_ref), key_ndx, alloc);
+    }
     else {
+        REALM_ASSERT_DEBUG(!is_compressed(header));
         bool is_big = Array::get_context_flag_from_header(header);
         if (!is_big) {
             return ArraySmallBlobs::get_string(header, ndx, alloc);
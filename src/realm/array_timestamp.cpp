@@ -17,6 +17,7 @@
  **************************************************************************/
 
 #include <realm/array_timestamp.hpp>
+#include <realm/impl/destroy_guard.hpp>
 
 using namespace realm;
 
@@ -24,9 +25,11 @@ ArrayTimestamp::ArrayTimestamp(Allocator& a)
     : Array(a)
     , m_seconds(a)
     , m_nanoseconds(a)
+    , m_packed(a)
 {
     m_seconds.set_parent(this, 0);
     m_nanoseconds.set_parent(this, 1);
+    m_packed.set_parent(this, 0);
 }
 
 void ArrayTimestamp::create()
@@ -40,13 +43,21 @@ void ArrayTimestamp::create()
 
     m_seconds.init_from_parent();
     m_nanoseconds.init_from_parent();
+    m_is_packed = false;
 }
 
 void ArrayTimestamp::init_from_mem(MemRef mem) noexcept
 {
     Array::init_from_mem(mem);
-    m_seconds.init_from_parent();
-    m_nanoseconds.init_from_parent();
+    // The context flag marks a packed leaf
+    m_is_packed = Array::get_context_flag();
+    if (m_is_packed) {
+        m_packed.init_from_parent();
+    }
+    else {
+        m_seconds.init_from_parent();
+        m_nanoseconds.init_from_parent();
+    }
 }
 
 void ArrayTimestamp::set(size_t ndx, Timestamp value)
@@ -54,6 +65,13 @@ void ArrayTimestamp::set(size_t ndx, Timestamp value)
     if (value.is_null()) {
         return set_null(ndx);
     }
+    if (m_is_packed) {
+        if (fits_packed(value)) {
+            m_packed.set(ndx, to_packed(value)); // Throws
+            return;
+        }
+        unpack(); // Throws
+    }
 
     util::Optional<int64_t> seconds = util::make_optional(value.get_seconds());
     int32_t nanoseconds = value.get_nanoseconds();
@@ -64,6 +82,17 @@ void ArrayTimestamp::set(size_t ndx, Timestamp value)
 
 void ArrayTimestamp::insert(size_t ndx, Timestamp value)
 {
+    if (m_is_packed) {
+        if (value.is_null()) {
+            m_packed.insert(ndx, util::none); // Throws
+            return;
+        }
+        if (fits_packed(value)) {
+            m_packed.insert(ndx, to_packed(value)); // Throws
+            return;
+        }
+        unpack(); // Throws
+    }
     if (value.is_null()) {
         m_seconds.insert(ndx, util::none);
         m_nanoseconds.insert(ndx, 0); // Throws
@@ -77,10 +106,65 @@ void ArrayTimestamp::insert(size_t ndx, Timestamp value)
     }
 }
 
+void ArrayTimestamp::pack()
+{
+    size_t sz = size();
+    if (sz == 0)
+        return;
+    if (m_is_packed) {
+        // Values written to the leaf since it was packed have expanded the offset encoding
+        if (!m_alloc.is_read_only(m_packed.get_ref()))
+            m_packed.encode_offsets(); // Throws
+        return;
+    }
+    for (size_t i = 0; i < sz; ++i) {
+        if (!m_seconds.is_null(i) && !fits_packed(get(i)))
+            return;
+    }
+
+    Array top(m_alloc);
+    _impl::DeepArrayDestroyGuard dg(&top);
+    top.create(Array::type_HasRefs, true /* context_flag */, 1); // Throws
+    ArrayIntNull packed(m_alloc);
+    packed.set_parent(&top, 0);
+    MemRef mem = ArrayIntNull::create_array(Array::type_Normal, false, 0, m_alloc); // Throws
+    top.set_as_ref(0, mem.get_ref());
+    packed.init_from_parent();
+    for (size_t i = 0; i < sz; ++i) {
+        util::Optional<int64_t> seconds = m_seconds.get(i);
+        if (seconds)
+            packed.add(to_packed(Timestamp(*seconds, int32_t(m_nanoseconds.get(i))))); // Throws
+        else
+            packed.add(util::none); // Throws
+    }
+    packed.encode_offsets(); // Throws
+    dg.release();
+
+    Array::destroy_deep();
+    init_from_mem(top.get_mem());
+    Array::update_parent(); // Throws
+}
+
+void ArrayTimestamp::unpack()
+{
+    REALM_ASSERT_DEBUG(m_is_packed);
+    ArrayTimestamp plain(m_alloc);
+    plain.create(); // Throws
+    _impl::DeepArrayRefDestroyGuard dg(plain.get_ref(), m_alloc);
+    size_t sz = size();
+    for (size_t i = 0; i < sz; ++i)
+        plain.insert(i, get(i)); // Throws
+    dg.release();
+
+    Array::destroy_deep();
+    init_from_mem(MemRef(plain.get_ref(), m_alloc));
+    Array::update_parent(); // Throws
+}
+
 namespace realm {
 
 template <>
-size_t ArrayTimestamp::find_first<Greater>(Timestamp value, size_t begin, size_t end) const noexcept
+size_t ArrayTimestamp::find_first_unpacked<Greater>(Timestamp value, size_t begin, size_t end) const noexcept
 {
     if (value.is_null()) {
         return not_found;
@@ -109,7 +193,7 @@ size_t ArrayTimestamp::find_first<Greater>(Timestamp value, size_t begin, size_t
 }
 
 template <>
-size_t ArrayTimestamp::find_first<Less>(Timestamp value, size_t begin, size_t end) const noexcept
+size_t ArrayTimestamp::find_first_unpacked<Less>(Timestamp value, size_t begin, size_t end) const noexcept
 {
     if (value.is_null()) {
         return not_found;
@@ -138,7 +222,7 @@ size_t ArrayTimestamp::find_first<Less>(Timestamp value, size_t begin, size_t en
 }
 
 template <>
-size_t ArrayTimestamp::find_first<GreaterEqual>(Timestamp value, size_t begin, size_t end) const noexcept
+size_t ArrayTimestamp::find_first_unpacked<GreaterEqual>(Timestamp value, size_t begin, size_t end) const noexcept
 {
     if (value.is_null()) {
         return m_seconds.find_first<Equal>(util::none, begin, end);
@@ -167,7 +251,7 @@ size_t ArrayTimestamp::find_first<GreaterEqual>(Timestamp value, size_t begin, s
 }
 
 template <>
-size_t ArrayTimestamp::find_first<LessEqual>(Timestamp value, size_t begin, size_t end) const noexcept
+size_t ArrayTimestamp::find_first_unpacked<LessEqual>(Timestamp value, size_t begin, size_t end) const noexcept
 {
     if (value.is_null()) {
         return m_seconds.find_first<Equal>(util::none, begin, end);
@@ -196,7 +280,7 @@ size_t ArrayTimestamp::find_first<LessEqual>(Timestamp value, size_t begin, size
 }
 
 template <>
-size_t ArrayTimestamp::find_first<Equal>(Timestamp value, size_t begin, size_t end) const noexcept
+size_t ArrayTimestamp::find_first_unpacked<Equal>(Timestamp value, size_t begin, size_t end) const noexcept
 {
     if (value.is_null()) {
         return m_seconds.find_first<Equal>(util::none, begin, end);
@@ -213,7 +297,7 @@ size_t ArrayTimestamp::find_first<Equal>(Timestamp value, size_t begin, size_t e
 }
 
 template <>
-size_t ArrayTimestamp::find_first<NotEqual>(Timestamp value, size_t begin, size_t end) const noexcept
+size_t ArrayTimestamp::find_first_unpacked<NotEqual>(Timestamp value, size_t begin, size_t end) const noexcept
 {
     if (value.is_null()) {
         return m_seconds.find_first<NotEqual>(util::none, begin, end);
@@ -238,6 +322,11 @@ size_t ArrayTimestamp::find_first<NotEqual>(Timestamp value, size_t begin, size_
 void ArrayTimestamp::verify() const
 {
 #ifdef REALM_DEBUG
+    if (m_is_packed) {
+        REALM_ASSERT(Array::size() == 1);
+        m_packed.verify();
+        return;
+    }
     m_seconds.verify();
     m_nanoseconds.verify();
     REALM_ASSERT(m_seconds.size() == m_nanoseconds.size());
@@ -24,6 +24,11 @@
 
 namespace realm {
 
+/// A leaf of Timestamps. Seconds and nanoseconds are normally kept in two
+/// integer arrays. When the leaf is committed, it is packed into a single
+/// integer array of nanoseconds since the epoch if all the values allow
+/// it. The packed values are ordered like the Timestamps, so comparisons
+/// are done directly by the integer search kernels.
 class ArrayTimestamp : public ArrayPayload, private Array {
 public:
     using value_type = Timestamp;
@@ -58,69 +63,156 @@ public:
 
     size_t size() const
     {
-        return m_seconds.size();
+        return m_is_packed ? m_packed.size() : m_seconds.size();
     }
 
     void add(Timestamp value)
     {
-        insert(m_seconds.size(), value);
+        insert(size(), value);
     }
     void set(size_t ndx, Timestamp value);
     void set_null(size_t ndx)
     {
+        if (m_is_packed) {
+            m_packed.set_null(ndx); // Throws
+            return;
+        }
         // Value in m_nanoseconds is irrelevant if m_seconds is null
         m_seconds.set_null(ndx); // Throws
     }
     void insert(size_t ndx, Timestamp value);
     Timestamp get(size_t ndx) const
     {
+        if (m_is_packed) {
+            util::Optional<int64_t> packed = m_packed.get(ndx);
+            return packed ? from_packed(*packed) : Timestamp{};
+        }
         util::Optional<int64_t> seconds = m_seconds.get(ndx);
         return seconds ? Timestamp(*seconds, int32_t(m_nanoseconds.get(ndx))) : Timestamp{};
     }
     bool is_null(size_t ndx) const
     {
-        return m_seconds.is_null(ndx);
+        return m_is_packed ? m_packed.is_null(ndx) : m_seconds.is_null(ndx);
     }
     void erase(size_t ndx)
     {
+        if (m_is_packed) {
+            m_packed.erase(ndx);
+            return;
+        }
         m_seconds.erase(ndx);
         m_nanoseconds.erase(ndx);
     }
     void move(ArrayTimestamp& dst, size_t ndx)
     {
+        if (m_is_packed)
+            unpack(); // Throws
+        if (dst.m_is_packed)
+            dst.unpack(); // Throws
         m_seconds.move(dst.m_seconds, ndx);
         m_nanoseconds.move(dst.m_nanoseconds, ndx);
     }
     void clear()
     {
+        if (m_is_packed) {
+            m_packed.clear();
+            return;
+        }
         m_seconds.clear();
         m_nanoseconds.clear();
     }
 
     template <class Condition>
-    size_t find_first(Timestamp value, size_t begin, size_t end) const noexcept;
+    size_t find_first(Timestamp value, size_t begin, size_t end) const noexcept
+    {
+        if (m_is_packed)
+            return find_first_packed<Condition>(value, begin, end);
+        return find_first_unpacked<Condition>(value, begin, end);
+    }
 
     size_t find_first(Timestamp value, size_t begin, size_t end) const noexcept;
 
+    /// Pack the values into a single integer array, if they are all within
+    /// the range of packed values. Called when the leaf is committed, see
+    /// Cluster::encode_leaves(). The leaf is unpacked again if a value
+    /// outside of the range is stored in it. A leaf that is already packed
+    /// has the encoding of its values renewed if they were modified.
+    void pack();
+    bool is_packed() const noexcept
+    {
+        return m_is_packed;
+    }
+
     void verify() const;
 
 private:
+    // Nanoseconds since the epoch must fit in 64 bits
+    static constexpr int64_t nanoseconds_per_second = Timestamp::nanoseconds_per_second;
+    static constexpr int64_t max_packed_seconds = std::numeric_limits<int64_t>::max() / nanoseconds_per_second - 1;
+
     ArrayIntNull m_seconds;
     ArrayInteger m_nanoseconds;
+    ArrayIntNull m_packed;
+    bool m_is_packed = false;
+
+    static bool fits_packed(Timestamp value) noexcept
+    {
+        int64_t seconds = value.get_seconds();
+        return seconds <= max_packed_seconds && seconds >= -max_packed_seconds;
+    }
+    static int64_t to_packed(Timestamp value) noexcept
+    {
+        return value.get_seconds() * nanoseconds_per_second + value.get_nanoseconds();
+    }
+    static Timestamp from_packed(int64_t value) noexcept
+    {
+        // Division truncates towards zero, so seconds and nanoseconds get the same sign
+        return Timestamp(value / nanoseconds_per_second, int32_t(value % nanoseconds_per_second));
+    }
+
+    void unpack();
+
+    template <class Condition>
+    size_t find_first_packed(Timestamp value, size_t begin, size_t end) const noexcept;
+    template <class Condition>
+    size_t find_first_unpacked(Timestamp value, size_t begin, size_t end) const noexcept;
 };
 
 template <>
-size_t ArrayTimestamp::find_first<Equal>(Timestamp value, size_t begin, size_t end) const noexcept;
+size_t ArrayTimestamp::find_first_unpacked<Equal>(Timestamp value, size_t begin, size_t end) const noexcept;
 template <>
-size_t ArrayTimestamp::find_first<NotEqual>(Timestamp value, size_t begin, size_t end) const noexcept;
+size_t ArrayTimestamp::find_first_unpacked<NotEqual>(Timestamp value, size_t begin, size_t end) const noexcept;
 template <>
-size_t ArrayTimestamp::find_first<Less>(Timestamp value, size_t begin, size_t end) const noexcept;
+size_t ArrayTimestamp::find_first_unpacked<Less>(Timestamp value, size_t begin, size_t end) const noexcept;
 template <>
-size_t ArrayTimestamp::find_first<LessEqual>(Timestamp value, size_t begin, size_t end) const noexcept;
+size_t ArrayTimestamp::find_first_unpacked<LessEqual>(Timestamp value, size_t begin, size_t end) const noexcept;
 template <>
-size_t ArrayTimestamp::find_first<GreaterEqual>(Timestamp value, size_t begin, size_t end) const noexcept;
+size_t ArrayTimestamp::find_first_unpacked<GreaterEqual>(Timestamp value, size_t begin, size_t end) const noexcept;
 template <>
-size_t ArrayTimestamp::find_first<Greater>(Timestamp value, size_t begin, size_t end) const noexcept;
+size_t ArrayTimestamp::find_first_unpacked<Greater>(Timestamp value, size_t begin, size_t end) const noexcept;
+
+template <class Condition>
+size_t ArrayTimestamp::find_first_packed(Timestamp value, size_t begin, size_t end) const noexcept
+{
+    if (value.is_null()) {
+        // Only the conditions that include equality match null with null
+        if (std::is_same_v<Condition, NotEqual>)
+            return m_packed.find_first<NotEqual>(util::none, begin, end);
+        if (std::is_same_v<Condition, Equal> || std::is_same_v<Condition, LessEqual> ||
+            std::is_same_v<Condition, GreaterEqual>)
+            return m_packed.find_first<Equal>(util::none, begin, end);
+        return not_found;
+    }
+    if (fits_packed(value))
+        return m_packed.find_first<Condition>(to_packed(value), begin, end);
+
+    Condition cond;
+    for (; begin < end; ++begin) {
+        if (cond(get(begin), value, is_null(begin), false))
+            return begin;
+    }
+    return not_found;
+}
 
 inline size_t ArrayTimestamp::find_first(Timestamp value, size_t begin, size_t end) const noexcept
 {
@@ -19,9 +19,140 @@
 #include <realm/array_unsigned.hpp>
 #include <realm/array_direct.hpp>
 #include <algorithm>
+#include <limits>
+
+#ifdef REALM_COMPILER_SSE
+#include <emmintrin.h> // SSE2
+#endif
+#ifdef REALM_COMPILER_AVX
+#include <immintrin.h> // AVX2, only used from functions carrying a REALM_TARGET_* attribute
+#endif
 
 namespace realm {
 
+namespace {
+
+// Key searches narrow the range with a branch free binary search until the remaining candidates fit in one cache
+// line, and then count the elements in front of the searched value in that line. As everything before the window
+// is known to be in front of the value and everything after it is not, the count gives the position directly.
+template <class T>
+constexpr size_t search_window = 64 / sizeof(T);
+
+// Returns the number of elements in the window starting at 'data' that are less than 'value' (not greater than
+// 'value' if 'upper' is set)
+template <class T, bool upper>
+inline size_t count_in_window(const T* data, T value) noexcept
+{
+    size_t count = 0;
+    for (size_t i = 0; i < search_window<T>; ++i)
+        count += upper ? data[i] <= value : data[i] < value;
+    return count;
+}
+
+#ifdef REALM_COMPILER_SSE
+template <class T, bool upper>
+inline size_t count_in_window_sse(const T* data, T value) noexcept
+{
+    static_assert(sizeof(T) <= 4, "SSE2 has no 64 bit compare");
+    // SSE2 only has signed compares, so the sign bit is flipped on both sides to compare as unsigned
+    __m128i bias;
+    __m128i needle;
+    if constexpr (sizeof(T) == 1) {
+        bias = _mm_set1_epi8(char(0x80));
+        needle = _mm_set1_epi8(char(value ^ 0x80));
+    }
+    else if constexpr (sizeof(T) == 2) {
+        bias = _mm_set1_epi16(short(0x8000));
+        needle = _mm_set1_epi16(short(value ^ 0x8000));
+    }
+    else {
+        bias = _mm_set1_epi32(int(0x80000000));
+        needle = _mm_set1_epi32(int(value ^ 0x80000000));
+    }
+    uint64_t mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + i), bias);
+        __m128i cmp;
+        if constexpr (sizeof(T) == 1)
+            cmp = upper ? _mm_cmpgt_epi8(v, needle) : _mm_cmpgt_epi8(needle, v);
+        else if constexpr (sizeof(T) == 2)
+            cmp = upper ? _mm_cmpgt_epi16(v, needle) : _mm_cmpgt_epi16(needle, v);
+        else
+            cmp = upper ? _mm_cmpgt_epi32(v, needle) : _mm_cmpgt_epi32(needle, v);
+        mask |= uint64_t(uint32_t(_mm_movemask_epi8(cmp))) << (16 * i);
+    }
+    // movemask yields one bit per byte
+    size_t count = size_t(fast_popcount64(int64_t(mask))) / sizeof(T);
+    return upper ? search_window<T> - count : count;
+}
+#endif
+
+#ifdef REALM_COMPILER_AVX
+template <bool upper>
+REALM_TARGET_AVX2 size_t count_in_window_avx2(const uint64_t* data, uint64_t value) noexcept
+{
+    const __m256i bias = _mm256_set1_epi64x(int64_t(0x8000000000000000ULL));
+    const __m256i needle = _mm256_set1_epi64x(int64_t(value ^ 0x8000000000000000ULL));
+    uint32_t mask = 0;
+    for (int i = 0; i < 2; ++i) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data) + i), bias);
+        __m256i cmp = upper ? _mm256_cmpgt_epi64(v, needle) : _mm256_cmpgt_epi64(needle, v);
+        mask |= uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(cmp))) << (4 * i);
+    }
+    size_t count = size_t(fast_popcount32(int32_t(mask)));
+    return upper ? search_window<uint64_t> - count : count;
+}
+#endif
+
+// Semantically identical to std::lower_bound() ('upper' not set) and std::upper_bound() ('upper' set). See
+// realm::lower_bound() in array_direct.hpp for the idea behind the branch free narrowing.
+template <class T, bool upper>
+size_t search_keys(const T* arr, size_t size, uint64_t value) noexcept
+{
+    if (value > std::numeric_limits<T>::max())
+        return size;
+    const T v = T(value);
+    constexpr size_t window = search_window<T>;
+
+    if (size < window) {
+        size_t count = 0;
+        for (size_t i = 0; i < size; ++i)
+            count += upper ? arr[i] <= v : arr[i] < v;
+        return count;
+    }
+
+    size_t low = 0;
+    size_t n = size;
+    while (n > window) {
+        size_t half = n / 2;
+        size_t other_half = n - half;
+        size_t probe = low + half;
+        size_t other_low = low + other_half;
+        T probe_value = arr[probe];
+        n = half;
+        low = (upper ? probe_value <= v : probe_value < v) ? other_low : low;
+    }
+
+    // The result is now in [low, low + n]. Slide the window back if it would extend past the end of the array.
+    // Elements in front of 'low' all precede the result and are counted along.
+    size_t start = std::min(low, size - window);
+    const T* data = arr + start;
+#ifdef REALM_COMPILER_SSE
+    if constexpr (sizeof(T) <= 4) {
+        return start + count_in_window_sse<T, upper>(data, v);
+    }
+#endif
+#ifdef REALM_COMPILER_AVX
+    if constexpr (sizeof(T) == 8) {
+        if (sseavx<2>())
+            return start + count_in_window_avx2<upper>(data, v);
+    }
+#endif
+    return start + count_in_window<T, upper>(data, v);
+}
+
+} // anonymous namespace
+
 void ArrayUnsigned::set_width(uint8_t width)
 {
     REALM_ASSERT_DEBUG(width > 0 || m_size == 0);
@@ -92,19 +223,13 @@ void ArrayUnsigned::update_from_parent() noexcept
 size_t ArrayUnsigned::lower_bound(uint64_t value) const noexcept
 {
     if (m_width == 8) {
-        uint8_t* arr = reinterpret_cast<uint8_t*>(m_data);
-        uint8_t* pos = std::lower_bound(arr, arr + m_size, value);
-        return pos - arr;
+        return search_keys<uint8_t, false>(reinterpret_cast<const uint8_t*>(m_data), m_size, value);
     }
     else if (m_width == 16) {
-        uint16_t* arr = reinterpret_cast<uint16_t*>(m_data);
-        uint16_t* pos = std::lower_bound(arr, arr + m_size, value);
-        return pos - arr;
+        return search_keys<uint16_t, false>(reinterpret_cast<const uint16_t*>(m_data), m_size, value);
     }
     else if (m_width == 32) {
-        uint32_t* arr = reinterpret_cast<uint32_t*>(m_data);
-        uint32_t* pos = std::lower_bound(arr, arr + m_size, value);
-        return pos - arr;
+        return search_keys<uint32_t, false>(reinterpret_cast<const uint32_t*>(m_data), m_size, value);
     }
     else if (m_width < 8) {
         switch (m_width) {
@@ -122,27 +247,19 @@ size_t ArrayUnsigned::lower_bound(uint64_t value) const noexcept
         }
         return npos;
     }
-    uint64_t* arr = reinterpret_cast<uint64_t*>(m_data);
-    uint64_t* pos = std::lower_bound(arr, arr + m_size, value);
-    return pos - arr;
+    return search_keys<uint64_t, false>(reinterpret_cast<const uint64_t*>(m_data), m_size, value);
 }
 
 size_t ArrayUnsigned::upper_bound(uint64_t value) const noexcept
 {
     if (m_width == 8) {
-        uint8_t* arr = reinterpret_cast<uint8_t*>(m_data);
-        uint8_t* pos = std::upper_bound(arr, arr + m_size, value);
-        return pos - arr;
+        return search_keys<uint8_t, true>(reinterpret_cast<const uint8_t*>(m_data), m_size, value);
     }
     else if (m_width == 16) {
-        uint16_t* arr = reinterpret_cast<uint16_t*>(m_data);
-        uint16_t* pos = std::upper_bound(arr, arr + m_size, value);
-        return pos - arr;
+        return search_keys<uint16_t, true>(reinterpret_cast<const uint16_t*>(m_data), m_size, value);
     }
     else if (m_width == 32) {
-        uint32_t* arr = reinterpret_cast<uint32_t*>(m_data);
-        uint32_t* pos = std::upper_bound(arr, arr + m_size, value);
-        return pos - arr;
+        return search_keys<uint32_t, true>(reinterpret_cast<const uint32_t*>(m_data), m_size, value);
     }
     else if (m_width < 8) {
         switch (m_width) {
@@ -160,9 +277,7 @@ size_t ArrayUnsigned::upper_bound(uint64_t value) const noexcept
         }
         return npos;
     }
-    uint64_t* arr = reinterpret_cast<uint64_t*>(m_data);
-    uint64_t* pos = std::upper_bound(arr, arr + m_size, value);
-    return pos - arr;
+    return search_keys<uint64_t, true>(reinterpret_cast<const uint64_t*>(m_data), m_size, value);
 }
 
 void ArrayUnsigned::insert(size_t ndx, uint64_t value)
@@ -33,21 +33,13 @@
 #include "realm/index_string.hpp"
 #include "realm/column_type_traits.hpp"
 #include "realm/replication.hpp"
+#include "realm/impl/destroy_guard.hpp"
 #include <iostream>
 #include <cmath>
+#include <cstring>
 
 using namespace realm;
 
-namespace {
-#if REALM_MAX_BPNODE_SIZE > 256
-constexpr int node_shift_factor = 8;
-#else
-constexpr int node_shift_factor = 2;
-#endif
-
-constexpr size_t cluster_node_size = 1 << node_shift_factor;
-}
-
 /*
  * Node-splitting is done in the way that if the new element comes after all the
  * current elements, then the new element is added to the new node as the only
@@ -88,8 +80,13 @@ public:
         return m_sub_tree_depth;
     }
 
-    bool traverse(ClusterTree::TraverseFunction func, int64_t) const;
+    // If 'ndx' is given, the leaves before the one holding the object at index *ndx are skipped, see
+    // ClusterTree::traverse(size_t&, TraverseFunction)
+    bool traverse(ClusterTree::TraverseFunction func, int64_t, size_t* ndx = nullptr) const;
+    // Append the children of this node, where 'key_offset' is the key offset of the node itself
+    void get_subtrees(int64_t key_offset, std::vector<ClusterTree::Subtree>& subtrees) const;
     void update(ClusterTree::UpdateFunction func, int64_t);
+    void update_modified(ClusterTree::UpdateFunction func, int64_t);
 
     size_t node_size() const override
     {
@@ -192,6 +189,11 @@ private:
     }
     void move(size_t ndx, ClusterNode* new_node, int64_t key_adj) override;
 
+    // Hint the memory system about the children that a traversal currently at child 'ndx' will visit next
+    void prefetch_after(size_t ndx) const noexcept;
+    // Advise the OS about the file pages of child 'ndx' if read ahead is enabled
+    void read_ahead(size_t ndx) const noexcept;
+
     template <class T, class F>
     T recurse(ObjKey key, F func);
 
@@ -248,7 +250,7 @@ void ClusterNodeInner::create(int sub_tree_depth)
     Array::set(s_sub_tree_depth_index, RefOrTagged::make_tagged(sub_tree_depth));
     Array::set(s_sub_tree_size, 1); // sub_tree_size = 0 (as tagged value)
     m_sub_tree_depth = sub_tree_depth;
-    m_shift_factor = m_sub_tree_depth * node_shift_factor;
+    m_shift_factor = m_sub_tree_depth * m_tree_top.get_node_shift_factor();
 }
 
 void ClusterNodeInner::init(MemRef mem)
@@ -263,7 +265,7 @@ void ClusterNodeInner::init(MemRef mem)
         m_keys.detach();
     }
     m_sub_tree_depth = int(Array::get(s_sub_tree_depth_index)) >> 1;
-    m_shift_factor = m_sub_tree_depth * node_shift_factor;
+    m_shift_factor = m_sub_tree_depth * m_tree_top.get_node_shift_factor();
 }
 
 void ClusterNodeInner::update_from_parent() noexcept
@@ -326,7 +328,7 @@ ref_type ClusterNodeInner::insert(ObjKey key, const FieldValues& init_values, Cl
 
         int64_t split_key_value = state.split_key + child_info.offset;
         size_t sz = node_size();
-        if (sz < cluster_node_size) {
+        if (sz < m_tree_top.get_node_size()) {
             if (m_keys.is_attached()) {
                 m_keys.insert(new_ref_ndx, split_key_value);
             }
@@ -491,7 +493,7 @@ size_t ClusterNodeInner::erase(ObjKey key, CascadeState& state)
                 adjust_keys_first_child(first_offset);
             }
         }
-        else if (erase_node_size < cluster_node_size / 2 && child_info.ndx < (node_size() - 1)) {
+        else if (erase_node_size < m_tree_top.get_node_size() / 2 && child_info.ndx < (node_size() - 1)) {
             // Candidate for merge. First calculate if the combined size of current and
             // next sibling is small enough.
             size_t sibling_ndx = child_info.ndx + 1;
@@ -503,7 +505,7 @@ size_t ClusterNodeInner::erase(ObjKey key, CascadeState& state)
 
             size_t combined_size = sibling_node->node_size() + erase_node_size;
 
-            if (combined_size < cluster_node_size * 3 / 4) {
+            if (combined_size < m_tree_top.get_node_size() * 3 / 4) {
                 // Calculate value that must be subtracted from the moved keys
                 // (will be negative as the sibling has bigger keys)
                 int64_t key_adj = m_keys.is_attached() ? (m_keys.get(child_info.ndx) - m_keys.get(sibling_ndx))
@@ -614,6 +616,7 @@ bool ClusterNodeInner::get_leaf(ObjKey key, ClusterNode::IteratorState& state) c
         char* child_header = m_alloc.translate(child_ref);
         bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(child_header);
         if (child_is_leaf) {
+            prefetch_after(child_ndx);
             state.m_current_leaf.init(MemRef(child_header, child_ref, m_alloc));
             state.m_current_leaf.set_offset(state.m_key_offset);
             state.m_current_index = state.m_current_leaf.lower_bound_key(new_key);
@@ -688,12 +691,64 @@ size_t ClusterNodeInner::update_sub_tree_size()
     return sub_tree_size;
 }
 
-bool ClusterNodeInner::traverse(ClusterTree::TraverseFunction func, int64_t key_offset) const
+void ClusterNodeInner::prefetch_after(size_t ndx) const noexcept
+{
+    size_t sz = node_size();
+    // The header of the next child was prefetched on the previous step, so the
+    // headers of its own arrays can be requested now
+    if (ndx + 1 < sz)
+        m_alloc.prefetch_children(_get_child_ref(ndx + 1));
+    if (ndx + 2 < sz)
+        m_alloc.prefetch(_get_child_ref(ndx + 2));
+    read_ahead(ndx + m_alloc.get_read_ahead());
+}
+
+void ClusterNodeInner::read_ahead(size_t ndx) const noexcept
+{
+    // Arrays are written children first on commit, so the arrays of a cluster
+    // usually lie between the previous sibling and the cluster itself. Larger
+    // spans mean that the tree has been modified since, and are skipped.
+    constexpr size_t max_span = 4 * 1024 * 1024;
+    if (m_alloc.get_read_ahead() == 0 || ndx == 0 || ndx >= node_size())
+        return;
+    ref_type begin = _get_child_ref(ndx - 1);
+    ref_type end = _get_child_ref(ndx);
+    if (begin < end && end - begin <= max_span)
+        m_alloc.advise_will_need(begin, end + NodeHeader::header_size);
+}
+
+bool ClusterNodeInner::traverse(ClusterTree::TraverseFunction func, int64_t key_offset, size_t* ndx) const
 {
     auto sz = node_size();
 
-    for (unsigned i = 0; i < sz; i++) {
+    unsigned i = 0;
+    if (ndx) {
+        // Skip the children before the one holding the object, like get(size_t, State&)
+        for (; i < sz; i++) {
+            ref_type ref = _get_child_ref(i);
+            char* header = m_alloc.translate(ref);
+            size_t sub_tree_size;
+            if (Array::get_is_inner_bptree_node_from_header(header)) {
+                ClusterNodeInner node(m_alloc, m_tree_top);
+                node.init(MemRef(header, ref, m_alloc));
+                sub_tree_size = node.get_tree_size();
+            }
+            else {
+                sub_tree_size = Cluster::node_size_from_header(m_alloc, header);
+            }
+            if (*ndx < sub_tree_size)
+                break;
+            *ndx -= sub_tree_size;
+        }
+    }
+
+    // Fill the read ahead window, after which each step extends it by one child
+    for (size_t j = i + 1; j < i + m_alloc.get_read_ahead() && j < sz; j++)
+        read_ahead(j);
+
+    for (; i < sz; i++) {
         ref_type ref = _get_child_ref(i);
+        prefetch_after(i);
         char* header = m_alloc.translate(ref);
         bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(header);
         MemRef mem(header, ref, m_alloc);
@@ -708,14 +763,25 @@ bool ClusterNodeInner::traverse(ClusterTree::TraverseFunction func, int64_t key_
         else {
             ClusterNodeInner node(m_alloc, m_tree_top);
             node.init(mem);
-            if (node.traverse(func, offs)) {
+            if (node.traverse(func, offs, ndx)) {
                 return true;
             }
         }
+        // Only the first leaf visited starts at the object
+        ndx = nullptr;
     }
     return false;
 }
 
+void ClusterNodeInner::get_subtrees(int64_t key_offset, std::vector<ClusterTree::Subtree>& subtrees) const
+{
+    auto sz = node_size();
+    for (unsigned i = 0; i < sz; i++) {
+        int64_t offs = (m_keys.is_attached() ? m_keys.get(i) : i << m_shift_factor) + key_offset;
+        subtrees.push_back({_get_child_ref(i), offs});
+    }
+}
+
 void ClusterNodeInner::update(ClusterTree::UpdateFunction func, int64_t key_offset)
 {
     auto sz = node_size();
@@ -741,6 +807,34 @@ void ClusterNodeInner::update(ClusterTree::UpdateFunction func, int64_t key_offs
     }
 }
 
+void ClusterNodeInner::update_modified(ClusterTree::UpdateFunction func, int64_t key_offset)
+{
+    auto sz = node_size();
+
+    for (unsigned i = 0; i < sz; i++) {
+        ref_type ref = _get_child_ref(i);
+        // Nodes below a read-only node are read-only as well
+        if (m_alloc.is_read_only(ref))
+            continue;
+        char* header = m_alloc.translate(ref);
+        bool child_is_leaf = !Array::get_is_inner_bptree_node_from_header(header);
+        MemRef mem(header, ref, m_alloc);
+        int64_t offs = (m_keys.is_attached() ? m_keys.get(i) : i << m_shift_factor) + key_offset;
+        if (child_is_leaf) {
+            Cluster leaf(offs, m_alloc, m_tree_top);
+            leaf.init(mem);
+            leaf.set_parent(this, i + s_first_node_index);
+            func(&leaf);
+        }
+        else {
+            ClusterNodeInner node(m_alloc, m_tree_top);
+            node.init(mem);
+            node.set_parent(this, i + s_first_node_index);
+            node.update_modified(func, offs);
+        }
+    }
+}
+
 int64_t ClusterNodeInner::get_last_key_value() const
 {
     auto last_ndx = node_size() - 1;
@@ -1187,6 +1281,7 @@ inline void Cluster::do_insert_column(ColKey col_key, bool nullable)
 
 void Cluster::insert_column(ColKey col_key)
 {
+    drop_zone_map(); // Throws
     auto attr = col_key.get_attrs();
     if (attr.test(col_attr_List)) {
         size_t sz = node_size();
@@ -1253,6 +1348,7 @@ void Cluster::insert_column(ColKey col_key)
 
 void Cluster::remove_column(ColKey col_key)
 {
+    drop_zone_map(); // Throws
     auto col_ndx = col_key.get_index();
     unsigned idx = col_ndx.val + s_first_col_index;
     ref_type ref = to_ref(Array::get(idx));
@@ -1288,15 +1384,15 @@ ref_type Cluster::insert(ObjKey k, const FieldValues& init_values, ClusterNode::
         }
         // Key value is bigger than all other values, should be put last
         ndx = sz;
-        if (uint64_t(k.value) > sz && sz < cluster_node_size) {
+        if (uint64_t(k.value) > sz && sz < m_tree_top.get_node_size()) {
             ensure_general_form();
         }
     }
 
     ref_type ret = 0;
 
-    REALM_ASSERT_DEBUG(sz <= cluster_node_size);
-    if (REALM_LIKELY(sz < cluster_node_size)) {
+    REALM_ASSERT_DEBUG(sz <= m_tree_top.get_node_size());
+    if (REALM_LIKELY(sz < m_tree_top.get_node_size())) {
         insert_row(ndx, k, init_values); // Throws
         state.mem = get_mem();
         state.index = ndx;
@@ -1304,7 +1400,7 @@ ref_type Cluster::insert(ObjKey k, const FieldValues& init_values, ClusterNode::
     else {
         // Split leaf node
         Cluster new_leaf(0, m_alloc, m_tree_top);
-        new_leaf.create(size() - 1);
+        new_leaf.create(nb_columns());
         if (ndx == sz) {
             new_leaf.insert_row(0, ObjKey(0), init_values); // Throws
             state.split_key = k.value;
@@ -1571,6 +1667,369 @@ void Cluster::upgrade_string_to_enum(ColKey col_key, ArrayString& keys)
     Array::destroy_deep(ref, m_alloc);
 }
 
+bool Cluster::encode_leaves()
+{
+    bool replaced = false;
+    auto table = m_tree_top.get_owner();
+    auto encode_column = [&](ColKey col_key) {
+        if (col_key.get_attrs().test(col_attr_List))
+            return false;
+        auto type = col_key.get_type();
+        if (type != col_type_Int && type != col_type_Bool && type != col_type_String && type != col_type_Timestamp &&
+            type != col_type_Decimal && type != col_type_BackLink)
+            return false;
+        size_t ndx = col_key.get_index().val + s_first_col_index;
+        ref_type ref = Array::get_as_ref(ndx);
+        if (m_alloc.is_read_only(ref))
+            return false;
+        if (type == col_type_BackLink) {
+            ArrayBacklink leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.encode_lists(); // Throws
+        }
+        else if (type == col_type_String) {
+            // Enumerated columns already share a table wide dictionary
+            if (table->is_enumerated(col_key))
+                return false;
+            ArrayString leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.encode_dictionary(); // Throws
+            if (!leaf.has_dictionary())
+                leaf.compress(); // Throws
+        }
+        else if (type == col_type_Timestamp) {
+            ArrayTimestamp leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.pack(); // Throws
+        }
+        else if (type == col_type_Decimal) {
+            ArrayDecimal128 leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.pack(); // Throws
+        }
+        else if (type == col_type_Bool) {
+            ArrayBool leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.encode_runs(); // Throws
+        }
+        else if (col_key.get_attrs().test(col_attr_Nullable)) {
+            ArrayIntNull leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.encode_validity(); // Throws
+        }
+        else {
+            ArrayInteger leaf(m_alloc);
+            leaf.set_parent(this, ndx);
+            leaf.init_from_ref(ref);
+            leaf.encode_runs();    // Throws
+            leaf.encode_offsets(); // Throws
+        }
+        if (Array::get_as_ref(ndx) != ref)
+            replaced = true;
+        return false;
+    };
+    table->for_each_and_every_column(encode_column);
+    return replaced;
+}
+
+namespace {
+
+template <class T>
+void update_bounds(T value, T& min, T& max, bool& found)
+{
+    if (!found || value < min)
+        min = value;
+    if (!found || max < value)
+        max = value;
+    found = true;
+}
+
+inline int64_t double_bits(double value)
+{
+    int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// With 10 bits per value and 7 probes, about 1% of the lookups of absent values are false positives
+constexpr size_t bloom_filter_bits_per_value = 10;
+constexpr size_t bloom_filter_probes = 7;
+
+inline size_t bloom_filter_bit(uint64_t hash, size_t probe, size_t nb_bits)
+{
+    uint64_t step = (hash >> 32) | 1;
+    return size_t((hash + probe * step) % nb_bits);
+}
+
+void add_to_bloom_filter(std::vector<uint64_t>& filter, uint64_t hash)
+{
+    size_t nb_bits = filter.size() * 64;
+    for (size_t probe = 0; probe < bloom_filter_probes; ++probe) {
+        size_t bit = bloom_filter_bit(hash, probe, nb_bits);
+        filter[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+} // anonymous namespace
+
+bool Cluster::update_zone_map()
+{
+    ref_type old_ref = get_ref();
+    drop_zone_map(); // Throws
+
+    size_t sz = node_size();
+    if (sz == 0)
+        return get_ref() != old_ref;
+
+    auto table = m_tree_top.get_owner();
+    std::vector<int64_t> entries;
+    auto summarize_column = [&](ColKey col_key) {
+        if (col_key.get_attrs().test(col_attr_List))
+            return false;
+        size_t ndx = col_key.get_index().val + s_first_col_index;
+        ref_type ref = Array::get_as_ref(ndx);
+        auto type = col_key.get_type();
+        if (type == col_type_String || type == col_type_ObjectId) {
+            // Enumerated columns are searched by the index of the value in the table wide dictionary
+            if (!table->has_bloom_filter(col_key) || table->is_enumerated(col_key))
+                return false;
+            add_bloom_filter_entry(col_key, entries);
+            return false;
+        }
+        size_t null_count = 0;
+        bool found = false;
+        int64_t min = 0;
+        int64_t max = 0;
+        switch (type) {
+            case col_type_Int:
+                if (col_key.get_attrs().test(col_attr_Nullable)) {
+                    ArrayIntNull leaf(m_alloc);
+                    leaf.init_from_ref(ref);
+                    for (size_t i = 0; i < sz; ++i) {
+                        auto value = leaf.get(i);
+                        if (value)
+                            update_bounds(*value, min, max, found);
+                        else
+                            ++null_count;
+                    }
+                }
+                else {
+                    ArrayInteger leaf(m_alloc);
+                    leaf.init_from_ref(ref);
+                    for (size_t i = 0; i < sz; ++i)
+                        update_bounds(leaf.get(i), min, max, found);
+                }
+                break;
+            case col_type_Float:
+            case col_type_Double: {
+                double dmin = 0;
+                double dmax = 0;
+                auto add_value = [&](double value) {
+                    // NaN is not ordered, so a column holding it cannot be summarized
+                    if (std::isnan(value))
+                        return false;
+                    update_bounds(value, dmin, dmax, found);
+                    return true;
+                };
+                bool ordered = true;
+                if (type == col_type_Float) {
+                    ArrayFloatNull leaf(m_alloc);
+                    leaf.init_from_ref(ref);
+                    for (size_t i = 0; i < sz && ordered; ++i) {
+                        if (leaf.is_null(i))
+                            ++null_count;
+                        else
+                            ordered = add_value(*leaf.get(i));
+                    }
+                }
+                else {
+                    ArrayDoubleNull leaf(m_alloc);
+                    leaf.init_from_ref(ref);
+                    for (size_t i = 0; i < sz && ordered; ++i) {
+                        if (leaf.is_null(i))
+                            ++null_count;
+                        else
+                            ordered = add_value(*leaf.get(i));
+                    }
+                }
+                if (!ordered)
+                    return false;
+                min = double_bits(dmin);
+                max = double_bits(dmax);
+                break;
+            }
+            case col_type_Timestamp: {
+                ArrayTimestamp leaf(m_alloc);
+                leaf.init_from_ref(ref);
+                for (size_t i = 0; i < sz; ++i) {
+                    if (leaf.is_null(i))
+                        ++null_count;
+                    else
+                        update_bounds(leaf.get(i).get_seconds(), min, max, found);
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+        entries.insert(entries.end(), {int64_t(ndx), 3, min, max, int64_t(null_count)});
+        return false;
+    };
+    table->for_each_public_column(summarize_column);
+    if (!entries.empty())
+        add_zone_map(entries); // Throws
+    return get_ref() != old_ref;
+}
+
+bool Cluster::set_bloom_filter(ColKey col_key, bool value)
+{
+    // A cluster modified in this transaction gets all of its zone map when it is committed
+    if (!is_read_only() || node_size() == 0)
+        return false;
+
+    // The other entries of the zone map are kept as they are
+    size_t ndx = col_key.get_index().val + s_first_col_index;
+    std::vector<int64_t> entries;
+    bool found = false;
+    if (has_zone_map()) {
+        const char* zone_map = m_alloc.translate(Array::get_as_ref(size() - 1));
+        size_t sz = Array::get_size_from_header(zone_map);
+        for (size_t i = 0; i < sz;) {
+            size_t end = i + 2 + size_t(Array::get(zone_map, i + 1));
+            if (size_t(Array::get(zone_map, i)) == ndx) {
+                found = true;
+            }
+            else {
+                for (; i < end; ++i)
+                    entries.push_back(Array::get(zone_map, i));
+            }
+            i = end;
+        }
+    }
+    if (!value && !found)
+        return false;
+
+    ref_type old_ref = get_ref();
+    if (value)
+        add_bloom_filter_entry(col_key, entries);
+    drop_zone_map(); // Throws
+    if (!entries.empty())
+        add_zone_map(entries); // Throws
+    return get_ref() != old_ref;
+}
+
+void Cluster::add_bloom_filter_entry(ColKey col_key, std::vector<int64_t>& entries) const
+{
+    size_t sz = node_size();
+    size_t ndx = col_key.get_index().val + s_first_col_index;
+    ref_type ref = Array::get_as_ref(ndx);
+    std::vector<uint64_t> filter((sz * bloom_filter_bits_per_value + 63) / 64, 0);
+    if (col_key.get_type() == col_type_String) {
+        ArrayString leaf(m_alloc);
+        leaf.init_from_ref(ref);
+        for (size_t i = 0; i < sz; ++i)
+            add_to_bloom_filter(filter, get_filter_hash(leaf.get(i)));
+    }
+    else {
+        ArrayObjectIdNull leaf(m_alloc);
+        leaf.init_from_ref(ref);
+        for (size_t i = 0; i < sz; ++i)
+            add_to_bloom_filter(filter, get_filter_hash(leaf.get(i)));
+    }
+    entries.push_back(int64_t(ndx));
+    entries.push_back(int64_t(filter.size()));
+    entries.insert(entries.end(), filter.begin(), filter.end());
+}
+
+void Cluster::add_zone_map(const std::vector<int64_t>& entries)
+{
+    REALM_ASSERT_DEBUG(!has_zone_map());
+    Array zone_map(m_alloc);
+    zone_map.create(type_Normal); // Throws
+    _impl::ShallowArrayDestroyGuard dg(&zone_map);
+    for (auto entry : entries)
+        zone_map.add(entry); // Throws
+    Array::add(from_ref(zone_map.get_ref())); // Throws
+    dg.release();
+    set_context_flag(true);
+}
+
+bool Cluster::get_column_summary(ColKey col, ColumnSummary& summary) const
+{
+    const char* zone_map;
+    size_t pos = find_zone_map_entry(col, zone_map);
+    if (pos == realm::npos)
+        return false;
+    summary.min = Array::get(zone_map, pos);
+    summary.max = Array::get(zone_map, pos + 1);
+    summary.null_count = size_t(Array::get(zone_map, pos + 2));
+    return true;
+}
+
+bool Cluster::may_contain(ColKey col, uint64_t hash) const
+{
+    const char* zone_map;
+    size_t pos = find_zone_map_entry(col, zone_map);
+    if (pos == realm::npos)
+        return true;
+    size_t nb_bits = size_t(Array::get(zone_map, pos - 1)) * 64;
+    for (size_t probe = 0; probe < bloom_filter_probes; ++probe) {
+        size_t bit = bloom_filter_bit(hash, probe, nb_bits);
+        auto word = uint64_t(Array::get(zone_map, pos + bit / 64));
+        if (!((word >> (bit % 64)) & 1))
+            return false;
+    }
+    return true;
+}
+
+uint64_t Cluster::get_filter_hash(StringData value) noexcept
+{
+    if (value.is_null())
+        return 0;
+    return cityhash_64(reinterpret_cast<const unsigned char*>(value.data()), value.size());
+}
+
+uint64_t Cluster::get_filter_hash(util::Optional<ObjectId> value) noexcept
+{
+    if (!value)
+        return 0;
+    auto bytes = value->to_bytes();
+    return cityhash_64(bytes.data(), bytes.size());
+}
+
+size_t Cluster::find_zone_map_entry(ColKey col, const char*& zone_map) const
+{
+    // Every cluster modified in a transaction gets a new zone map when it is committed, so the zone map of a cluster
+    // that is unchanged since the commit is current
+    if (!has_zone_map() || !is_read_only())
+        return realm::npos;
+    size_t ndx = col.get_index().val + s_first_col_index;
+    zone_map = m_alloc.translate(Array::get_as_ref(size() - 1));
+    size_t sz = Array::get_size_from_header(zone_map);
+    for (size_t i = 0; i < sz; i += 2 + size_t(Array::get(zone_map, i + 1))) {
+        if (size_t(Array::get(zone_map, i)) == ndx)
+            return i + 2;
+    }
+    return realm::npos;
+}
+
+void Cluster::drop_zone_map()
+{
+    if (!has_zone_map())
+        return;
+    copy_on_write(); // Throws
+    size_t ndx = size() - 1;
+    Array::destroy(Array::get_as_ref(ndx), m_alloc);
+    Array::erase(ndx);
+    set_context_flag(false);
+}
+
 void Cluster::init_leaf(ColKey col_key, ArrayPayload* leaf) const
 {
     auto col_ndx = col_key.get_index();
@@ -2049,6 +2508,7 @@ void ClusterTree::clear(CascadeState& state)
     bump_content_version();
     bump_storage_version();
 
+    m_owner->count_modified_objects(m_size);
     m_size = 0;
 }
 
@@ -2066,6 +2526,7 @@ void ClusterTree::insert_fast(ObjKey k, const FieldValues& init_values, ClusterN
         replace_root(std::move(new_root));
     }
     m_size++;
+    m_owner->count_modified_objects();
 }
 
 Obj ClusterTree::insert(ObjKey k, const FieldValues& values)
@@ -2144,6 +2605,7 @@ Obj ClusterTree::insert(ObjKey k, const FieldValues& values)
             return false;
         };
         get_owner()->for_each_public_column(insert_in_column);
+        m_owner->insert_in_ordered_indexes(k);
 
         if (Replication* repl = table->get_repl()) {
             auto pk_col = table->get_primary_key_column();
@@ -2222,6 +2684,7 @@ void ClusterTree::erase(ObjKey k, CascadeState& state)
                 index->erase(k);
             }
         }
+        m_owner->erase_from_ordered_indexes(k);
     }
 
     size_t root_size = m_root->erase(k, state);
@@ -2229,6 +2692,7 @@ void ClusterTree::erase(ObjKey k, CascadeState& state)
     bump_content_version();
     bump_storage_version();
     m_size--;
+    m_owner->count_modified_objects();
     while (!m_root->is_leaf() && root_size == 1) {
         ClusterNodeInner* node = static_cast<ClusterNodeInner*>(m_root.get());
 
@@ -2272,6 +2736,56 @@ bool ClusterTree::traverse(TraverseFunction func) const
     }
 }
 
+bool ClusterTree::traverse(size_t& ndx, TraverseFunction func) const
+{
+    REALM_ASSERT(ndx < m_size);
+    if (m_root->is_leaf()) {
+        return func(static_cast<Cluster*>(m_root.get()));
+    }
+    else {
+        return static_cast<ClusterNodeInner*>(m_root.get())->traverse(func, 0, &ndx);
+    }
+}
+
+std::vector<ClusterTree::Subtree> ClusterTree::get_subtrees(size_t min_count) const
+{
+    std::vector<Subtree> subtrees{{m_root->get_ref(), 0}};
+    // Split a whole level at a time, so that the subtrees hold about the same number of leaves
+    bool split = true;
+    while (split && subtrees.size() < min_count) {
+        std::vector<Subtree> children;
+        split = false;
+        for (auto& subtree : subtrees) {
+            char* header = m_alloc.translate(subtree.ref);
+            if (Array::get_is_inner_bptree_node_from_header(header)) {
+                ClusterNodeInner node(m_alloc, *this);
+                node.init(MemRef(header, subtree.ref, m_alloc));
+                node.get_subtrees(subtree.key_offset, children);
+                split = true;
+            }
+            else {
+                children.push_back(subtree);
+            }
+        }
+        subtrees = std::move(children);
+    }
+    return subtrees;
+}
+
+bool ClusterTree::traverse(const Subtree& subtree, TraverseFunction func) const
+{
+    char* header = m_alloc.translate(subtree.ref);
+    MemRef mem(header, subtree.ref, m_alloc);
+    if (Array::get_is_inner_bptree_node_from_header(header)) {
+        ClusterNodeInner node(m_alloc, *this);
+        node.init(mem);
+        return node.traverse(func, subtree.key_offset);
+    }
+    Cluster leaf(subtree.key_offset, m_alloc, *this);
+    leaf.init(mem);
+    return func(&leaf);
+}
+
 void ClusterTree::update(UpdateFunction func)
 {
     if (m_root->is_leaf()) {
@@ -2282,6 +2796,19 @@ void ClusterTree::update(UpdateFunction func)
     }
 }
 
+void ClusterTree::update_modified(UpdateFunction func)
+{
+    if (m_root->is_read_only())
+        return;
+
+    if (m_root->is_leaf()) {
+        func(static_cast<Cluster*>(m_root.get()));
+    }
+    else {
+        static_cast<ClusterNodeInner*>(m_root.get())->update_modified(func, 0);
+    }
+}
+
 void ClusterTree::enumerate_string_column(ColKey col_key)
 {
     Allocator& alloc = get_alloc();
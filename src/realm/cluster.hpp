@@ -172,6 +172,14 @@ protected:
 
 class Cluster : public ClusterNode {
 public:
+    // Summary of the values of a column in a cluster. The values of floating point columns are stored as the bits
+    // of a double, and those of Timestamp columns as the seconds.
+    struct ColumnSummary {
+        int64_t min;
+        int64_t max;
+        size_t null_count;
+    };
+
     Cluster(uint64_t offset, Allocator& allocator, const ClusterTree& tree_top)
         : ClusterNode(offset, allocator, tree_top)
     {
@@ -241,7 +249,7 @@ public:
     void remove_column(ColKey col) override; // Does not move columns - may leave a 'hole'
     size_t nb_columns() const override
     {
-        return size() - s_first_col_index;
+        return size() - s_first_col_index - (has_zone_map() ? 1 : 0);
     }
     ref_type insert(ObjKey k, const FieldValues& init_values, State& state) override;
     bool try_get(ObjKey k, State& state) const override;
@@ -250,6 +258,23 @@ public:
     size_t erase(ObjKey k, CascadeState& state) override;
     void nullify_incoming_links(ObjKey key, CascadeState& state) override;
     void upgrade_string_to_enum(ColKey col, ArrayString& keys);
+    // Offset encode the modified leaves of integer columns, and dictionary encode or compress those of string
+    // columns. Returns true if any leaf was replaced.
+    bool encode_leaves();
+    // Record the smallest and largest value and the number of nulls of each integer, floating point and Timestamp
+    // column. Returns true if the cluster was modified.
+    bool update_zone_map();
+    // Add or remove the Bloom filter of a string or ObjectId column in the zone map of a cluster that has not been
+    // modified since it was committed, keeping the rest of the zone map. Returns true if the cluster was replaced.
+    bool set_bloom_filter(ColKey col_key, bool value);
+    // Get the summary of a column recorded when this cluster was committed. Returns false if there is none, or if
+    // the cluster has been modified since.
+    bool get_column_summary(ColKey col, ColumnSummary& summary) const;
+    // Check the Bloom filter recorded for a string or ObjectId column with a bloom filter when this cluster was
+    // committed. Returns false only if no value of the column has the hash given by get_filter_hash().
+    bool may_contain(ColKey col, uint64_t hash) const;
+    static uint64_t get_filter_hash(StringData value) noexcept;
+    static uint64_t get_filter_hash(util::Optional<ObjectId> value) noexcept;
 
     void init_leaf(ColKey col, ArrayPayload* leaf) const;
     void add_leaf(ColKey col, ref_type ref);
@@ -261,6 +286,19 @@ private:
     static constexpr size_t s_key_ref_or_size_index = 0;
     static constexpr size_t s_first_col_index = 1;
 
+    // A cluster with a zone map has the context flag set, and a ref to the zone map after the columns. For each
+    // column summarized, the zone map holds the column index and the number of values recorded, followed by
+    // either the minimum, the maximum and the null count, or the words of a Bloom filter.
+
+    bool has_zone_map() const
+    {
+        return Array::get_context_flag();
+    }
+    void drop_zone_map();
+    void add_zone_map(const std::vector<int64_t>& entries);
+    void add_bloom_filter_entry(ColKey col_key, std::vector<int64_t>& entries) const;
+    size_t find_zone_map_entry(ColKey col, const char*& zone_map) const;
+
     size_t get_size_in_compact_form() const
     {
         return size_t(Array::get(s_key_ref_or_size_index)) >> 1; // Size is stored as tagged value
@@ -31,6 +31,19 @@ public:
     using TraverseFunction = util::FunctionRef<bool(const Cluster*)>;
     using UpdateFunction = util::FunctionRef<void(Cluster*)>;
 
+    // A node of the tree and the offset of its keys, see get_subtrees()
+    struct Subtree {
+        ref_type ref;
+        int64_t key_offset;
+    };
+
+    // Default for the log2 of the maximum number of objects in a leaf, see get_node_shift_factor()
+#if REALM_MAX_BPNODE_SIZE > 256
+    static constexpr int default_node_shift_factor = 8;
+#else
+    static constexpr int default_node_shift_factor = 2;
+#endif
+
     ClusterTree(Table* owner, Allocator& alloc, size_t top_position_for_cluster_tree);
     static MemRef create_empty_cluster(Allocator& alloc);
 
@@ -63,6 +76,21 @@ public:
     {
         return m_size;
     }
+    // A leaf holds at most 2^get_node_shift_factor() objects, and an inner
+    // node has at most as many children. Must be set before the tree is
+    // initialized, and can only change while the tree is empty.
+    int get_node_shift_factor() const noexcept
+    {
+        return m_node_shift_factor;
+    }
+    size_t get_node_size() const noexcept
+    {
+        return size_t(1) << m_node_shift_factor;
+    }
+    void set_node_shift_factor(int shift_factor) noexcept
+    {
+        m_node_shift_factor = shift_factor;
+    }
     void clear(CascadeState&);
     void destroy()
     {
@@ -142,8 +170,18 @@ public:
     // Visit all leaves and call the supplied function. Stop when function returns true.
     // Not allowed to modify the tree
     bool traverse(TraverseFunction func) const;
+    // Like traverse(), but starts at the leaf holding the object at index 'ndx'. Before that leaf is visited,
+    // 'ndx' is set to the index of the object within it.
+    bool traverse(size_t& ndx, TraverseFunction func) const;
+    // Split the tree into at least 'min_count' subtrees, or into all its leaves if it has fewer. The subtrees are
+    // returned in key order, and can be traversed by separate threads as long as the tree is not modified.
+    std::vector<Subtree> get_subtrees(size_t min_count) const;
+    // Like traverse(), but only visits the leaves of 'subtree'
+    bool traverse(const Subtree& subtree, TraverseFunction func) const;
     // Visit all leaves and call the supplied function. The function can modify the leaf.
     void update(UpdateFunction func);
+    // Like update(), but only visits the leaves that have been modified in the current transaction
+    void update_modified(UpdateFunction func);
 
     void enumerate_string_column(ColKey col_key);
     void dump_objects()
@@ -162,6 +200,7 @@ private:
     std::unique_ptr<ClusterNode> m_root;
     size_t m_top_position_for_cluster_tree;
     size_t m_size = 0;
+    int m_node_shift_factor = default_node_shift_factor;
 
     void replace_root(std::unique_ptr<ClusterNode> leaf);
 
@@ -0,0 +1,216 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/column_statistics.hpp>
+#include <realm/cluster.hpp>
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+using namespace realm;
+
+namespace {
+
+inline uint64_t double_bits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double bits_to_double(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // anonymous namespace
+
+bool ColumnStatistics::compute(const Table& table, ColKey col_key)
+{
+    if (col_key.get_attrs().test(col_attr_List))
+        return false;
+    auto type = col_key.get_type();
+    switch (type) {
+        case col_type_Int:
+        case col_type_Bool:
+        case col_type_Float:
+        case col_type_Double:
+        case col_type_Timestamp:
+        case col_type_String:
+        case col_type_ObjectId:
+            break;
+        default:
+            return false;
+    }
+
+    size_t num_objects = table.size();
+    size_t sample_size = std::min(num_objects, max_sample_size);
+    size_t nulls = 0;
+    std::vector<double> numbers;
+    // Each distinct value is counted by a hash of it
+    std::unordered_map<uint64_t, size_t> counts;
+    for (size_t i = 0; i < sample_size; ++i) {
+        // Objects are sampled at regular intervals through the table
+        ConstObj obj = table.get_object(i * num_objects / sample_size);
+        Mixed value = obj.get_any(col_key);
+        if (value.is_null()) {
+            ++nulls;
+            continue;
+        }
+        uint64_t hash = 0;
+        switch (type) {
+            case col_type_Int:
+                hash = uint64_t(value.get_int());
+                numbers.push_back(double(value.get_int()));
+                break;
+            case col_type_Bool:
+                hash = value.get_bool();
+                numbers.push_back(value.get_bool() ? 1.0 : 0.0);
+                break;
+            case col_type_Float:
+            case col_type_Double: {
+                double d = type == col_type_Float ? double(value.get_float()) : value.get_double();
+                hash = double_bits(d);
+                // NaN is not ordered, so it is left out of the histogram
+                if (!std::isnan(d))
+                    numbers.push_back(d);
+                break;
+            }
+            case col_type_Timestamp: {
+                Timestamp ts = value.get_timestamp();
+                hash = uint64_t(ts.get_seconds()) * 1000000007 + uint64_t(ts.get_nanoseconds());
+                numbers.push_back(double(ts.get_seconds()) + ts.get_nanoseconds() * 1e-9);
+                break;
+            }
+            case col_type_String:
+                hash = Cluster::get_filter_hash(value.get_string());
+                break;
+            case col_type_ObjectId:
+                hash = Cluster::get_filter_hash(util::Optional<ObjectId>(value.get<ObjectId>()));
+                break;
+            default:
+                REALM_UNREACHABLE();
+        }
+        ++counts[hash];
+    }
+
+    m_num_objects = num_objects;
+    m_num_nulls = sample_size ? size_t(std::round(double(nulls) * num_objects / sample_size)) : 0;
+
+    // The Guaranteed-Error Estimator of Charikar et al. scales up the values seen once in the sample, as most values
+    // of the table that were not sampled are like those, and counts values seen more than once as they are.
+    size_t singles = 0;
+    for (auto& count : counts) {
+        if (count.second == 1)
+            ++singles;
+    }
+    double scale = sample_size ? std::sqrt(double(num_objects) / sample_size) : 1.0;
+    double distinct = scale * singles + double(counts.size() - singles);
+    size_t num_values = num_objects - std::min(m_num_nulls, num_objects);
+    m_num_distinct = std::max(counts.size(), std::min(size_t(std::round(distinct)), num_values));
+
+    m_bounds.clear();
+    if (!numbers.empty()) {
+        std::sort(numbers.begin(), numbers.end());
+        size_t num_buckets = std::min(max_buckets, numbers.size());
+        for (size_t i = 0; i <= num_buckets; ++i)
+            m_bounds.push_back(numbers[i * (numbers.size() - 1) / num_buckets]);
+    }
+    return true;
+}
+
+void ColumnStatistics::serialize(std::vector<int64_t>& values) const
+{
+    values.push_back(int64_t(m_num_objects));
+    values.push_back(int64_t(m_num_nulls));
+    values.push_back(int64_t(m_num_distinct));
+    for (auto bound : m_bounds)
+        values.push_back(int64_t(double_bits(bound)));
+}
+
+void ColumnStatistics::deserialize(const std::vector<int64_t>& values)
+{
+    REALM_ASSERT(values.size() >= 3);
+    m_num_objects = size_t(values[0]);
+    m_num_nulls = size_t(values[1]);
+    m_num_distinct = size_t(values[2]);
+    m_bounds.clear();
+    for (size_t i = 3; i < values.size(); ++i)
+        m_bounds.push_back(bits_to_double(uint64_t(values[i])));
+}
+
+double ColumnStatistics::null_fraction() const noexcept
+{
+    return m_num_objects ? std::min(1.0, double(m_num_nulls) / m_num_objects) : 0.0;
+}
+
+double ColumnStatistics::equal_fraction() const noexcept
+{
+    return (1.0 - null_fraction()) / std::max(m_num_distinct, size_t(1));
+}
+
+double ColumnStatistics::equal_fraction(double value) const noexcept
+{
+    if (m_bounds.empty() || std::isnan(value))
+        return equal_fraction();
+    if (value < m_bounds.front() || m_bounds.back() < value)
+        return 0.0;
+    // A value that is both bounds of a bucket fills that bucket
+    size_t num_buckets = m_bounds.size() - 1;
+    size_t full_buckets = 0;
+    for (size_t i = 0; i < num_buckets; ++i) {
+        if (m_bounds[i] == value && m_bounds[i + 1] == value)
+            ++full_buckets;
+    }
+    // and the buckets on either side of them hold some more of it
+    if (full_buckets)
+        return (1.0 - null_fraction()) * std::min(full_buckets + 1, num_buckets) / num_buckets;
+    // Otherwise the value holds less than a bucket
+    return std::min(equal_fraction(), (1.0 - null_fraction()) / num_buckets);
+}
+
+double ColumnStatistics::less_fraction(double value, bool or_equal) const noexcept
+{
+    if (m_bounds.empty() || std::isnan(value))
+        return -1.0;
+    // Values are assumed to be spread evenly within each bucket
+    size_t num_buckets = m_bounds.size() - 1;
+    double buckets = 0;
+    for (size_t i = 0; i < num_buckets; ++i) {
+        double low = m_bounds[i];
+        double high = m_bounds[i + 1];
+        if (or_equal ? !(value < high) : high < value)
+            buckets += 1;
+        else if (low < value && value < high)
+            buckets += (value - low) / (high - low);
+    }
+    return (1.0 - null_fraction()) * buckets / num_buckets;
+}
+
+double ColumnStatistics::greater_fraction(double value, bool or_equal) const noexcept
+{
+    double less = less_fraction(value, !or_equal);
+    if (less < 0)
+        return less;
+    return std::max(0.0, 1.0 - null_fraction() - less);
+}
@@ -0,0 +1,104 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_COLUMN_STATISTICS_HPP
+#define REALM_COLUMN_STATISTICS_HPP
+
+#include <realm/keys.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace realm {
+
+class Table;
+
+/// Estimates of the distribution of the values of a column, computed from a
+/// sample of the objects of its table by Table::update_statistics(). The
+/// query engine uses them to choose the order in which to evaluate the
+/// conditions of a query before it has measured them, and to decide whether
+/// a search index is worth using.
+///
+/// Integer, bool, float, double and Timestamp values are mapped to doubles,
+/// Timestamps as seconds since the epoch, and summarized by an equi-depth
+/// histogram: the bounds of its buckets are chosen so that each bucket holds
+/// the same number of sampled values. A value that fills several buckets on
+/// its own is therefore known to be frequent. String and ObjectId columns
+/// only get the null fraction and the number of distinct values.
+///
+/// All fractions returned are fractions of all the objects of the table.
+class ColumnStatistics {
+public:
+    /// The number of objects sampled from a table
+    static constexpr size_t max_sample_size = 10000;
+    /// The number of buckets of a histogram
+    static constexpr size_t max_buckets = 32;
+
+    /// Sample the values of the column \a col_key of \a table. Returns false
+    /// if statistics are not kept for columns of its type.
+    bool compute(const Table& table, ColKey col_key);
+
+    /// Write the statistics to \a values, and read them back again.
+    void serialize(std::vector<int64_t>& values) const;
+    void deserialize(const std::vector<int64_t>& values);
+
+    size_t get_num_objects() const noexcept
+    {
+        return m_num_objects;
+    }
+    size_t get_num_nulls() const noexcept
+    {
+        return m_num_nulls;
+    }
+    size_t get_num_distinct() const noexcept
+    {
+        return m_num_distinct;
+    }
+    bool has_histogram() const noexcept
+    {
+        return !m_bounds.empty();
+    }
+    const std::vector<double>& get_histogram_bounds() const noexcept
+    {
+        return m_bounds;
+    }
+
+    double null_fraction() const noexcept;
+    /// The estimated fraction of objects holding any single non-null value
+    double equal_fraction() const noexcept;
+    /// The estimated fraction of objects holding \a value
+    double equal_fraction(double value) const noexcept;
+    /// The estimated fraction of objects holding a value less than \a value,
+    /// or less than or equal to it if \a or_equal is true. Returns a negative
+    /// value if the column has no histogram.
+    double less_fraction(double value, bool or_equal) const noexcept;
+    /// The estimated fraction of objects holding a value greater than \a
+    /// value, or greater than or equal to it if \a or_equal is true. Returns a
+    /// negative value if the column has no histogram.
+    double greater_fraction(double value, bool or_equal) const noexcept;
+
+private:
+    size_t m_num_objects = 0;
+    size_t m_num_nulls = 0;
+    size_t m_num_distinct = 0;
+    std::vector<double> m_bounds;
+};
+
+} // namespace realm
+
+#endif // REALM_COLUMN_STATISTICS_HPP
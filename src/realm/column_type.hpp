@@ -65,7 +65,12 @@ enum ColumnAttr {
     col_attr_Nullable = 16,
 
     /// Each element is a list of values
-    col_attr_List = 32
+    col_attr_List = 32,
+
+    /// Specifies that each cluster keeps a Bloom filter of the values in this
+    /// column. Applies only to string and ObjectId columns. It is only
+    /// recorded in the spec, never in the column key.
+    col_attr_BloomFilter = 64
 };
 
 class ColumnAttrMask {
@@ -761,6 +761,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
     m_lockfile_prefix = m_coordination_dir + "/access_control";
     SlabAlloc& alloc = m_alloc;
     m_alloc.set_read_only(false);
+    m_alloc.set_read_ahead(options.read_ahead_clusters);
 
 #if REALM_METRICS
     if (options.enable_metrics) {
@@ -1065,6 +1066,7 @@ void DB::do_open(const std::string& path, bool no_create_file, bool is_backend,
                 case 10:
                 case 11:
                 case 20:
+                case 21:
                     file_format_ok = true;
                     break;
             }
@@ -46,6 +46,7 @@ struct DBOptions {
         , temp_dir(temp_directory)
         , enable_metrics(track_metrics)
         , metrics_buffer_size(metrics_history_size)
+        , read_ahead_clusters(0)
 
     {
     }
@@ -58,6 +59,7 @@ struct DBOptions {
         , temp_dir(sys_tmp_dir)
         , enable_metrics(false)
         , metrics_buffer_size(10000)
+        , read_ahead_clusters(0)
     {
     }
 
@@ -101,6 +103,13 @@ struct DBOptions {
     /// is exceeded without being consumed, only the most recent entries will be stored.
     size_t metrics_buffer_size;
 
+    /// The number of clusters ahead of a full table traversal, such as a query
+    /// without an index, for which the operating system is advised that their
+    /// pages will be needed. This hides the page fault latency of scans over
+    /// files that are not in the page cache, at the cost of a system call per
+    /// cluster. Zero disables read ahead. Has no effect on encrypted files.
+    size_t read_ahead_clusters;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating DBOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
@@ -321,7 +321,7 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
         return 11;
     }
 
-    return 20;
+    return 21;
 }
 
 void Group::get_version_and_history_info(const Array& top, _impl::History::version_type& version, int& history_type,
@@ -379,7 +379,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 20, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 21, target_file_format_version);
 
     int current_file_format_version = get_file_format_version();
     REALM_ASSERT(current_file_format_version < target_file_format_version);
@@ -387,7 +387,8 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // DB::do_open() must ensure this. Be sure to revisit the
     // following upgrade logic when DB::do_open() is changed (or
     // vice versa).
-    REALM_ASSERT_EX(current_file_format_version >= 5 && current_file_format_version <= 11,
+    REALM_ASSERT_EX((current_file_format_version >= 5 && current_file_format_version <= 11) ||
+                        current_file_format_version == 20,
                     current_file_format_version);
 
 
@@ -525,6 +526,9 @@ void Transaction::upgrade_file_format(int target_file_format_version)
         }
     }
 
+    // Format 21 only adds encodings of leaves and optional data of tables and clusters, which are written when a
+    // write transaction is committed, so there is nothing to convert when upgrading from format 20.
+
     // NOTE: Additional future upgrade steps go here.
 }
 
@@ -547,6 +551,7 @@ void Group::open(ref_type top_ref, const std::string& file_path)
             break;
         case 11:
         case 20:
+        case 21:
             file_format_ok = true;
             break;
     }
@@ -561,8 +566,10 @@ void Group::open(ref_type top_ref, const std::string& file_path)
     else {
         // From a technical point of view, we could upgrade the Realm file
         // format in memory here, but since upgrading can be expensive, it is
-        // currently disallowed.
-        REALM_ASSERT(target_file_format_version == m_file_format_version);
+        // currently disallowed. A file of format 20 can be used as is, as
+        // long as none of the additions of format 21 are written to it, see
+        // Table::uses_file_format_21().
+        REALM_ASSERT(target_file_format_version == m_file_format_version || m_file_format_version == 20);
     }
 
     // Make all dynamically allocated memory (space beyond the attached file) as
@@ -819,6 +819,27 @@ private:
     ///
     ///  20 New data types: Decimal128 and ObjectId. Embedded tables.
     ///
+    ///  21 Additions, none of which are written to a file of format 20 (see
+    ///     Table::uses_file_format_21()):
+    ///      - Frame of reference encoded integer leaves (new width type).
+    ///      - Dictionary encoded string leaves.
+    ///      - String leaves compressed with a symbol table.
+    ///      - Zone maps at the end of clusters.
+    ///      - Bloom filters in the zone maps, and the column attribute that
+    ///        requests them.
+    ///      - Packed Timestamp leaves.
+    ///      - Run length encoded integer and bool leaves (encoding byte of
+    ///        the header).
+    ///      - Cluster size in the top array of tables.
+    ///      - Offset encoded backlink lists.
+    ///      - Packed Decimal128 leaves.
+    ///      - Nullable integer leaves with a validity bitmap.
+    ///      - Column statistics in the top array of tables.
+    ///      - Ordered indexes in the top array of tables.
+    ///     A file of format 20 is a valid file of format 21, so the upgrade
+    ///     only changes the version number. A file of format 20 opened by
+    ///     Group::open() is not upgraded.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and DB::do_open, the file
     /// format selection logic in
@@ -0,0 +1,243 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_ordered.hpp>
+#include <realm/table.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace realm;
+
+void ValueRange::set_lower(Mixed value, bool inclusive)
+{
+    if (m_has_lower) {
+        int cmp = OrderedIndex::compare(value, m_lower);
+        if (cmp < 0 || (cmp == 0 && (inclusive || !m_lower_inclusive)))
+            return;
+    }
+    m_lower = value;
+    m_lower_inclusive = inclusive;
+    m_has_lower = true;
+}
+
+void ValueRange::set_upper(Mixed value, bool inclusive)
+{
+    if (m_has_upper) {
+        int cmp = OrderedIndex::compare(value, m_upper);
+        if (cmp > 0 || (cmp == 0 && (inclusive || !m_upper_inclusive)))
+            return;
+    }
+    m_upper = value;
+    m_upper_inclusive = inclusive;
+    m_has_upper = true;
+}
+
+void ValueRange::set_prefix(StringData prefix)
+{
+    // Of two prefixes, one must begin with the other for any string to match both
+    if (m_has_prefix && prefix.size() <= m_prefix.size())
+        return;
+    m_prefix = prefix;
+    m_has_prefix = true;
+}
+
+
+OrderedIndex::OrderedIndex(const Table& table, ColKey col_key, size_t ndx)
+    : m_table(table)
+    , m_col_key(col_key)
+    , m_indexes(table.get_alloc())
+    , m_keys(table.get_alloc())
+{
+    // The accessor only ever modifies the list through the table's own top array
+    m_indexes.set_parent(const_cast<Array*>(&table.m_top), Table::top_position_for_ordered_indexes);
+    m_indexes.init_from_parent();
+    m_keys.set_parent(&m_indexes, ndx);
+    m_keys.init_from_parent();
+}
+
+bool OrderedIndex::is_supported(ColKey col_key) noexcept
+{
+    if (col_key.get_attrs().test(col_attr_List))
+        return false;
+    switch (col_key.get_type()) {
+        case col_type_Int:
+        case col_type_Timestamp:
+        case col_type_Double:
+        case col_type_String:
+        case col_type_ObjectId:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int OrderedIndex::compare(const Mixed& a, const Mixed& b) noexcept
+{
+    if (a.is_null() || b.is_null())
+        return int(!a.is_null()) - int(!b.is_null());
+    if (a.get_type() != type_String)
+        return a.compare(b);
+    StringData s1 = a.get<StringData>();
+    StringData s2 = b.get<StringData>();
+    size_t n = std::min(s1.size(), s2.size());
+    if (int cmp = n ? std::memcmp(s1.data(), s2.data(), n) : 0)
+        return cmp < 0 ? -1 : 1;
+    return s1.size() < s2.size() ? -1 : s1.size() > s2.size() ? 1 : 0;
+}
+
+Mixed OrderedIndex::get_value(size_t ndx) const
+{
+    return get_object_value(m_keys.get(ndx));
+}
+
+Mixed OrderedIndex::get_object_value(ObjKey key) const
+{
+    return m_table.get_object(key).get_any(m_col_key);
+}
+
+Mixed OrderedIndex::get_object_value(ObjKey key, std::string& buffer) const
+{
+    Mixed value = get_object_value(key);
+    if (value.is_null() || value.get_type() != type_String)
+        return value;
+    StringData str = value.get<StringData>();
+    buffer.assign(str.data(), str.size());
+    return Mixed(StringData(buffer));
+}
+
+template <class Pred>
+size_t OrderedIndex::partition_point(size_t begin, size_t end, Pred pred) const
+{
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        ObjKey key = m_keys.get(mid);
+        if (pred(get_object_value(key), key))
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+    return begin;
+}
+
+size_t OrderedIndex::lower_bound(const Mixed& value) const
+{
+    return partition_point(0, size(), [&](const Mixed& v, ObjKey) {
+        return compare(v, value) < 0;
+    });
+}
+
+size_t OrderedIndex::upper_bound(const Mixed& value) const
+{
+    return partition_point(0, size(), [&](const Mixed& v, ObjKey) {
+        return compare(v, value) <= 0;
+    });
+}
+
+std::pair<size_t, size_t> OrderedIndex::find_range(const ValueRange& range) const
+{
+    size_t begin = 0;
+    size_t end = size();
+    if (range.m_has_lower)
+        begin = range.m_lower_inclusive ? lower_bound(range.m_lower) : upper_bound(range.m_lower);
+    if (range.m_has_upper)
+        end = range.m_upper_inclusive ? upper_bound(range.m_upper) : lower_bound(range.m_upper);
+    if (range.m_has_prefix) {
+        Mixed prefix(range.m_prefix);
+        begin = std::max(begin, lower_bound(prefix));
+        end = std::min(end, partition_point(begin, std::max(begin, end), [&](const Mixed& v, ObjKey) {
+                                return compare(v, prefix) < 0 || v.get<StringData>().begins_with(range.m_prefix);
+                            }));
+    }
+    return {begin, std::max(begin, end)};
+}
+
+void OrderedIndex::insert(ObjKey key)
+{
+    std::string buffer;
+    Mixed value = get_object_value(key, buffer);
+    auto before = [&](const Mixed& v, ObjKey k) {
+        int cmp = compare(v, value);
+        return cmp < 0 || (cmp == 0 && k < key);
+    };
+    // Objects are often created in the order of the column, e.g. of a creation time, which takes a single probe
+    size_t sz = size();
+    size_t ndx = sz;
+    if (sz > 0 && !before(get_value(sz - 1), m_keys.get(sz - 1)))
+        ndx = partition_point(0, sz - 1, before);
+    m_keys.insert(ndx, key); // Throws
+}
+
+void OrderedIndex::erase(ObjKey key)
+{
+    std::string buffer;
+    Mixed value = get_object_value(key, buffer);
+    size_t ndx = partition_point(0, size(), [&](const Mixed& v, ObjKey k) {
+        int cmp = compare(v, value);
+        return cmp < 0 || (cmp == 0 && k < key);
+    });
+    REALM_ASSERT(ndx < size() && m_keys.get(ndx) == key);
+    m_keys.erase(ndx);
+}
+
+void OrderedIndex::populate()
+{
+    REALM_ASSERT(m_keys.size() == 0);
+    size_t sz = m_table.size();
+    std::vector<std::pair<Mixed, ObjKey>> entries;
+    entries.reserve(sz);
+    // The strings of the entries refer to copies, as strings read from the objects may not outlive the next read.
+    // The copies are reserved up front, so they are never moved.
+    std::vector<std::string> strings;
+    if (m_col_key.get_type() == col_type_String)
+        strings.reserve(sz);
+    for (auto& obj : m_table) {
+        Mixed value = obj.get_any(m_col_key);
+        if (!value.is_null() && value.get_type() == type_String) {
+            StringData str = value.get<StringData>();
+            strings.emplace_back(str.data(), str.size());
+            value = Mixed(StringData(strings.back()));
+        }
+        entries.emplace_back(value, obj.get_key());
+    }
+    // Objects are visited in key order, so a stable sort orders equal values by key
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return compare(a.first, b.first) < 0;
+    });
+
+    for (auto& entry : entries)
+        m_keys.add(entry.second); // Throws
+}
+
+void OrderedIndex::clear()
+{
+    m_keys.clear();
+}
+
+void OrderedIndex::verify() const
+{
+    REALM_ASSERT(m_keys.size() == m_table.size());
+    for (size_t i = 1; i < m_keys.size(); ++i) {
+        ObjKey prev = m_keys.get(i - 1);
+        ObjKey key = m_keys.get(i);
+        int cmp = compare(get_object_value(prev), get_object_value(key));
+        REALM_ASSERT(cmp < 0 || (cmp == 0 && prev < key));
+    }
+}
@@ -0,0 +1,142 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_ORDERED_HPP
+#define REALM_INDEX_ORDERED_HPP
+
+#include <realm/array.hpp>
+#include <realm/array_key.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/mixed.hpp>
+
+#include <string>
+#include <utility>
+
+namespace realm {
+
+class Table;
+
+/// The values of a column matched by a set of conditions ANDed together, as
+/// bounds in the order of an OrderedIndex. A range with no bounds holds all
+/// values, including null.
+class ValueRange {
+public:
+    /// Raise the lower bound to \a value if that narrows the range
+    void set_lower(Mixed value, bool inclusive);
+    /// Lower the upper bound to \a value if that narrows the range
+    void set_upper(Mixed value, bool inclusive);
+    /// Restrict the range to the strings beginning with \a prefix. The
+    /// string data must outlive the range.
+    void set_prefix(StringData prefix);
+
+    bool is_bounded() const noexcept
+    {
+        return m_has_lower || m_has_upper || m_has_prefix;
+    }
+
+private:
+    Mixed m_lower;
+    Mixed m_upper;
+    StringData m_prefix;
+    bool m_has_lower = false;
+    bool m_has_upper = false;
+    bool m_has_prefix = false;
+    bool m_lower_inclusive = false;
+    bool m_upper_inclusive = false;
+
+    friend class OrderedIndex;
+};
+
+/// An index of a column that keeps the keys of all the objects of a table
+/// sorted by their value in the column, and by key among equal values. The
+/// keys are held in a B+tree of its own, while the values are read from the
+/// objects, so the index takes up a single integer per object.
+///
+/// Null sorts before all other values. Strings are ordered by their bytes,
+/// rather than by the collation StringData::operator<() and sorted views use,
+/// so that the order does not depend on the string compare method in effect
+/// and the strings beginning with a given prefix are next to each other.
+///
+/// The indexes of a table are listed in a slot of the table's top array, and
+/// an OrderedIndex is a short lived accessor of one of them, which must not be
+/// used after an index is added to or removed from the table.
+class OrderedIndex {
+public:
+    /// Attach to the index of \a col_key, whose B+tree is at position \a ndx
+    /// of the list of ordered indexes of \a table
+    OrderedIndex(const Table& table, ColKey col_key, size_t ndx);
+    OrderedIndex(const OrderedIndex&) = delete;
+    OrderedIndex& operator=(const OrderedIndex&) = delete;
+
+    /// True if the values of columns of the type of \a col_key can be kept in
+    /// an ordered index
+    static bool is_supported(ColKey col_key) noexcept;
+    /// Compare two values of a column in the order of the index
+    static int compare(const Mixed& a, const Mixed& b) noexcept;
+
+    ColKey get_column_key() const noexcept
+    {
+        return m_col_key;
+    }
+    size_t size() const
+    {
+        return m_keys.size();
+    }
+    ObjKey get(size_t ndx) const
+    {
+        return m_keys.get(ndx);
+    }
+    Mixed get_value(size_t ndx) const;
+
+    /// The position of the first object whose value is not less than \a value
+    size_t lower_bound(const Mixed& value) const;
+    /// The position of the first object whose value is greater than \a value
+    size_t upper_bound(const Mixed& value) const;
+    /// The positions [begin, end) of the objects whose value is in \a range
+    std::pair<size_t, size_t> find_range(const ValueRange& range) const;
+
+    /// Add the object \a key with its current value in the column
+    void insert(ObjKey key);
+    /// Remove the object \a key, whose value in the column must be unchanged
+    /// since it was inserted
+    void erase(ObjKey key);
+    /// Add all the objects of the table, which must not be in the index
+    void populate();
+    void clear();
+
+    void verify() const;
+
+private:
+    const Table& m_table;
+    ColKey m_col_key;
+    Array m_indexes;
+    BPlusTree<ObjKey> m_keys;
+
+    Mixed get_object_value(ObjKey key) const;
+    /// The value of the object \a key, with a string copied to \a buffer
+    Mixed get_object_value(ObjKey key, std::string& buffer) const;
+    /// The first position in [begin, end) for which \a pred returns false,
+    /// given the value and key at the position. \a pred must be true for a
+    /// prefix of the positions only.
+    template <class Pred>
+    size_t partition_point(size_t begin, size_t end, Pred pred) const;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_ORDERED_HPP
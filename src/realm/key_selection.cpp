@@ -0,0 +1,158 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/key_selection.hpp>
+#include <realm/array_key.hpp>
+#include <realm/bplustree.hpp>
+
+using namespace realm;
+
+namespace {
+
+template <class F>
+void for_each_bit(const uint64_t* bits, size_t num_words, F func)
+{
+    for (size_t w = 0; w < num_words; ++w) {
+        uint64_t word = bits[w];
+        while (word) {
+            func(w * 64 + size_t(ctz(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+inline size_t popcount(uint64_t word)
+{
+    return size_t(fast_popcount64(int64_t(word)));
+}
+
+} // anonymous namespace
+
+void KeySelection::add(const Cluster* cluster, const uint64_t* row_bits)
+{
+    size_t num_words = (cluster->node_size() + 63) / 64;
+    size_t count = 0;
+    size_t first_row = npos;
+    size_t last_row = 0;
+    for (size_t w = 0; w < num_words; ++w) {
+        if (uint64_t word = row_bits[w]) {
+            if (first_row == npos)
+                first_row = w * 64 + size_t(ctz(word));
+            last_row = w * 64 + size_t(realm::log2(size_t(word)));
+            count += popcount(word);
+        }
+    }
+    if (count == 0)
+        return;
+
+    Segment seg;
+    seg.first_key = cluster->get_real_key(first_row).value;
+    seg.last_key = cluster->get_real_key(last_row).value;
+    seg.rank = m_size;
+    REALM_ASSERT(m_segments.empty() || m_segments.back().last_key < seg.first_key);
+
+    // A bitmap takes a bit per key in the range, and a list 64 bits per selected key
+    size_t range_words = size_t(seg.last_key - seg.first_key) / 64 + 1;
+    if (range_words <= count) {
+        seg.bits.resize(range_words);
+        for_each_bit(row_bits, num_words, [&](size_t row) {
+            uint64_t n = uint64_t(cluster->get_real_key(row).value - seg.first_key);
+            seg.bits[n >> 6] |= uint64_t(1) << (n & 63);
+        });
+        seg.word_ranks.resize(range_words);
+        size_t rank = 0;
+        for (size_t w = 0; w < range_words; ++w) {
+            seg.word_ranks[w] = uint32_t(rank);
+            rank += popcount(seg.bits[w]);
+        }
+    }
+    else {
+        seg.keys.reserve(count);
+        for_each_bit(row_bits, num_words, [&](size_t row) {
+            seg.keys.push_back(cluster->get_real_key(row).value);
+        });
+    }
+    m_segments.push_back(std::move(seg));
+    m_size += count;
+}
+
+void KeySelection::append(KeySelection&& other)
+{
+    REALM_ASSERT(m_segments.empty() || other.m_segments.empty() ||
+                 m_segments.back().last_key < other.m_segments.front().first_key);
+    for (auto& seg : other.m_segments) {
+        seg.rank += m_size;
+        m_segments.push_back(std::move(seg));
+    }
+    m_size += other.m_size;
+    other.clear();
+}
+
+ObjKey KeySelection::get(size_t ndx) const noexcept
+{
+    REALM_ASSERT_DEBUG(ndx < m_size);
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), ndx, [](size_t n, const Segment& seg) {
+        return n < seg.rank;
+    });
+    const Segment& seg = *(it - 1);
+    size_t n = ndx - seg.rank;
+    if (seg.bits.empty())
+        return ObjKey(seg.keys[n]);
+    // The last word with fewer set bits before it than n + 1 holds the key
+    auto word_it = std::upper_bound(seg.word_ranks.begin(), seg.word_ranks.end(), n);
+    size_t w = size_t(word_it - seg.word_ranks.begin()) - 1;
+    uint64_t word = seg.bits[w];
+    for (n -= seg.word_ranks[w]; n; --n)
+        word &= word - 1;
+    return ObjKey(seg.first_key + int64_t(w * 64 + size_t(ctz(word))));
+}
+
+size_t KeySelection::find(ObjKey key) const noexcept
+{
+    size_t s = find_segment(key.value);
+    if (s == m_segments.size() || !m_segments[s].contains(key.value))
+        return npos;
+    const Segment& seg = m_segments[s];
+    if (seg.bits.empty())
+        return seg.rank + size_t(std::lower_bound(seg.keys.begin(), seg.keys.end(), key.value) - seg.keys.begin());
+    uint64_t n = uint64_t(key.value - seg.first_key);
+    return seg.rank + seg.word_ranks[n >> 6] + popcount(seg.bits[n >> 6] & ((uint64_t(1) << (n & 63)) - 1));
+}
+
+void KeySelection::get_keys(KeyColumn& keys) const
+{
+    for (auto& seg : m_segments) {
+        if (seg.bits.empty()) {
+            for (auto key : seg.keys)
+                keys.add(ObjKey(key));
+        }
+        else {
+            for_each_bit(seg.bits.data(), seg.bits.size(), [&](size_t n) {
+                keys.add(ObjKey(seg.first_key + int64_t(n)));
+            });
+        }
+    }
+}
+
+size_t KeySelection::find_segment(int64_t key) const noexcept
+{
+    auto it = std::lower_bound(m_segments.begin(), m_segments.end(), key, [](const Segment& seg, int64_t k) {
+        return seg.last_key < k;
+    });
+    return size_t(it - m_segments.begin());
+}
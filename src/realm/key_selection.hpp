@@ -0,0 +1,163 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_KEY_SELECTION_HPP
+#define REALM_KEY_SELECTION_HPP
+
+#include <realm/cluster.hpp>
+#include <realm/utilities.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace realm {
+
+/// An ordered set of object keys found in the clusters of a table, kept as
+/// one segment per cluster that had a match. A segment is a bitmap over the
+/// range of keys from its first to its last match when the matches are dense
+/// enough for that to be smaller than the keys themselves, and the sorted list
+/// of keys otherwise. This is how a ConstTableView holds the result of a query
+/// that selects a large part of a table without building an ObjKey per match.
+///
+/// The keys must be added in ascending order, which is the order in which the
+/// clusters of a table are traversed. As the set holds keys, not positions, it
+/// stays valid when objects are later inserted in or removed from the table.
+class KeySelection {
+public:
+    bool is_empty() const noexcept
+    {
+        return m_size == 0;
+    }
+    size_t size() const noexcept
+    {
+        return m_size;
+    }
+    void clear() noexcept
+    {
+        m_segments.clear();
+        m_size = 0;
+    }
+
+    /// Add the objects of \a cluster whose row index is set in \a row_bits,
+    /// a bitmap of (node_size() + 63) / 64 words.
+    void add(const Cluster* cluster, const uint64_t* row_bits);
+    /// Add all the keys of \a other, which must be greater than those of this
+    /// selection.
+    void append(KeySelection&& other);
+
+    /// The key at position \a ndx of the selection
+    ObjKey get(size_t ndx) const noexcept;
+    /// The position of \a key in the selection, or realm::npos
+    size_t find(ObjKey key) const noexcept;
+    /// Add all the keys in order to \a keys
+    void get_keys(KeyColumn& keys) const;
+
+    /// Call \a func with the row index of each object of \a cluster that is
+    /// in the selection, in ascending order.
+    template <class F>
+    void for_each_in_cluster(const Cluster* cluster, F func) const;
+
+private:
+    struct Segment {
+        int64_t first_key;
+        int64_t last_key;
+        /// The number of keys in the segments before this one
+        size_t rank;
+        /// Bit n is set if the key first_key + n is selected. Empty if the
+        /// keys are listed in 'keys' instead.
+        std::vector<uint64_t> bits;
+        /// The number of bits set in the words of 'bits' before each word
+        std::vector<uint32_t> word_ranks;
+        std::vector<int64_t> keys;
+
+        bool contains(int64_t key) const noexcept;
+    };
+
+    std::vector<Segment> m_segments;
+    size_t m_size = 0;
+
+    /// The first segment whose last key is not less than \a key
+    size_t find_segment(int64_t key) const noexcept;
+};
+
+inline bool KeySelection::Segment::contains(int64_t key) const noexcept
+{
+    if (key < first_key || key > last_key)
+        return false;
+    if (bits.empty())
+        return std::binary_search(keys.begin(), keys.end(), key);
+    uint64_t n = uint64_t(key - first_key);
+    return (bits[n >> 6] >> (n & 63)) & 1;
+}
+
+template <class F>
+void KeySelection::for_each_in_cluster(const Cluster* cluster, F func) const
+{
+    size_t sz = cluster->node_size();
+    if (sz == 0)
+        return;
+    int64_t cluster_first = cluster->get_real_key(0).value;
+    int64_t cluster_last = cluster->get_real_key(sz - 1).value;
+    size_t s = find_segment(cluster_first);
+    if (s == m_segments.size() || m_segments[s].first_key > cluster_last)
+        return;
+
+    // If the keys of the cluster are consecutive, which they are unless objects have been removed, the set bits of
+    // a bitmap segment map directly to rows
+    if (size_t(cluster_last - cluster_first) == sz - 1) {
+        for (; s < m_segments.size() && m_segments[s].first_key <= cluster_last; ++s) {
+            const Segment& seg = m_segments[s];
+            int64_t begin = std::max(seg.first_key, cluster_first);
+            int64_t end = std::min(seg.last_key, cluster_last) + 1;
+            if (seg.bits.empty()) {
+                auto it = std::lower_bound(seg.keys.begin(), seg.keys.end(), begin);
+                for (; it != seg.keys.end() && *it < end; ++it)
+                    func(size_t(*it - cluster_first));
+                continue;
+            }
+            size_t n = size_t(begin - seg.first_key);
+            size_t n_end = size_t(end - seg.first_key);
+            while (n < n_end) {
+                uint64_t word = seg.bits[n >> 6] >> (n & 63);
+                if (word == 0) {
+                    n = (n | 63) + 1;
+                    continue;
+                }
+                n += ctz(word);
+                if (n >= n_end)
+                    break;
+                func(size_t(seg.first_key + int64_t(n) - cluster_first));
+                ++n;
+            }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < sz && s < m_segments.size(); ++i) {
+        int64_t key = cluster->get_real_key(i).value;
+        while (s < m_segments.size() && m_segments[s].last_key < key)
+            ++s;
+        if (s < m_segments.size() && m_segments[s].contains(key))
+            func(i);
+    }
+}
+
+} // namespace realm
+
+#endif // REALM_KEY_SELECTION_HPP
@@ -52,6 +52,17 @@ public:
         wtype_Bits = 0,     // width indicates how many bits every element occupies
         wtype_Multiply = 1, // width indicates how many bytes every element occupies
         wtype_Ignore = 2,   // each element is 1 byte
+        wtype_Offset = 3,   // width indicates how many bits every offset from a 64 bit base value occupies
+    };
+
+    // The encoding of an array whose layout is not described by the width type alone. It is kept in the fourth
+    // byte of the header, which is not part of the capacity. Other arrays hold zero there, or the 'A' of the dummy
+    // checksum once written to the file.
+    enum Encoding {
+        encoding_None = 0,
+        encoding_Runs = 1,       // runs of equal integers, see Array::encode_runs()
+        encoding_Dictionary = 2, // string leaf with a dictionary of its own, see ArrayString::encode_dictionary()
+        encoding_Compressed = 3, // string leaf compressed with a symbol table, see ArrayString::compress()
     };
 
     static const int header_size = 8; // Number of bytes used by header
@@ -123,6 +134,24 @@ public:
         return (size_t(h[0]) << 19) + (size_t(h[1]) << 11) + (h[2] << 3);
     }
 
+    static Encoding get_encoding_from_header(const char* header) noexcept
+    {
+        typedef unsigned char uchar;
+        const uchar* h = reinterpret_cast<const uchar*>(header);
+        return h[3] <= encoding_Compressed ? Encoding(h[3]) : encoding_None;
+    }
+
+    static bool get_is_run_encoded_from_header(const char* header) noexcept
+    {
+        return get_encoding_from_header(header) == encoding_Runs;
+    }
+
+    // The number of runs follows the end indexes of the runs, see calc_run_encoded_byte_size()
+    static size_t get_run_count_from_header(const char* header) noexcept
+    {
+        return size_t(*reinterpret_cast<const uint64_t*>(header + get_capacity_from_header(header) - 8));
+    }
+
     static Type get_type_from_header(const char* header) noexcept
     {
         if (get_is_inner_bptree_node_from_header(header))
@@ -153,12 +182,20 @@ public:
         h[4] = uchar((int(h[4]) & ~0x20) | int(value) << 5);
     }
 
+    static void set_encoding_in_header(Encoding value, char* header) noexcept
+    {
+        typedef unsigned char uchar;
+        uchar* h = reinterpret_cast<uchar*>(header);
+        h[3] = uchar(value);
+    }
+
     static void set_wtype_in_header(WidthType value, char* header) noexcept
     {
         // Indicates how to calculate size in bytes based on width
         // 0: bits      (width/8) * size
         // 1: multiply  width * size
         // 2: ignore    1 * size
+        // 3: offset    (width/8) * size + 8
         typedef unsigned char uchar;
         uchar* h = reinterpret_cast<uchar*>(header);
         h[4] = uchar((int(h[4]) & ~0x18) | int(value) << 3);
@@ -202,6 +239,9 @@ public:
 
     static size_t get_byte_size_from_header(const char* header) noexcept
     {
+        // A run length encoded array is never resized, so its capacity is its byte size
+        if (REALM_UNLIKELY(get_is_run_encoded_from_header(header)))
+            return get_capacity_from_header(header);
         size_t size = get_size_from_header(header);
         uint_least8_t width = get_width_from_header(header);
         WidthType wtype = get_wtype_from_header(header);
@@ -210,11 +250,20 @@ public:
         return num_bytes;
     }
 
+    // The size of a run length encoded array is the number of elements. The values of the runs are stored like the
+    // elements of a wtype_Bits array, followed by the 32 bit end index of every run and by the 64 bit number of runs
+    // (each 8-byte aligned).
+    static size_t calc_run_encoded_byte_size(size_t num_runs, uint_least8_t width) noexcept
+    {
+        return calc_byte_size(wtype_Bits, num_runs, width) + ((num_runs * sizeof(uint32_t) + 7) & ~size_t(7)) + 8;
+    }
+
     static size_t calc_byte_size(WidthType wtype, size_t size, uint_least8_t width) noexcept
     {
         size_t num_bytes = 0;
         switch (wtype) {
-            case wtype_Bits: {
+            case wtype_Bits:
+            case wtype_Offset: {
                 // Current assumption is that size is at most 2^24 and that width is at most 64.
                 // In that case the following will never overflow. (Assuming that size_t is at least 32 bits)
                 REALM_ASSERT_3(size, <, 0x1000000);
@@ -234,6 +283,10 @@ public:
         // Ensure 8-byte alignment
         num_bytes = (num_bytes + 7) & ~size_t(7);
 
+        // The base value of an offset encoded array is stored after the offsets
+        if (wtype == wtype_Offset)
+            num_bytes += 8;
+
         num_bytes += header_size;
 
         return num_bytes;
@@ -315,6 +315,9 @@ int64_t ConstObj::_get<int64_t>(ColKey::Idx col_ndx) const
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
     char* header = alloc.translate(ref);
+    if (REALM_UNLIKELY(Array::get_wtype_from_header(header) == Array::wtype_Offset ||
+                       Array::get_is_run_encoded_from_header(header)))
+        return Array::get(header, m_row_ndx);
     int width = Array::get_width_from_header(header);
     char* data = Array::get_data_from_header(header);
     REALM_TEMPEX(return get_direct, width, (data, m_row_ndx));
@@ -379,7 +382,10 @@ StringData ConstObj::_get<StringData>(ColKey::Idx col_ndx) const
         return values.get(m_row_ndx);
     }
     else {
-        return ArrayString::get(alloc.translate(ref), m_row_ndx, alloc);
+        const char* header = alloc.translate(ref);
+        if (ArrayString::is_compressed(header))
+            return m_table.unchecked_ptr()->get_compressed_string(ref, m_row_ndx);
+        return ArrayString::get(header, m_row_ndx, alloc);
     }
 }
 
@@ -958,10 +964,15 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
         throw LogicError(LogicError::illegal_type);
 
     ensure_writeable();
+    get_table()->count_modified_objects();
 
     if (StringIndex* index = m_table->get_search_index(col_key)) {
         index->set<int64_t>(m_key, value);
     }
+    // The object is moved to the position of its new value in an ordered index
+    auto ordered_index = m_table->get_ordered_index(col_key);
+    if (ordered_index)
+        ordered_index->erase(m_key);
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -983,6 +994,8 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
     }
 
     REALM_ASSERT(!fields.has_missing_parent_update());
+    if (ordered_index)
+        ordered_index->insert(m_key);
 
     if (Replication* repl = get_replication()) {
         repl->set_int(m_table.unchecked_ptr(), col_key, m_key, value,
@@ -999,6 +1012,7 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
     auto col_ndx = col_key.get_index();
 
     ensure_writeable();
+    get_table()->count_modified_objects();
 
     auto add_wrap = [](int64_t a, int64_t b) -> int64_t {
         uint64_t ua = uint64_t(a);
@@ -1006,6 +1020,7 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
         return int64_t(ua + ub);
     };
 
+    auto ordered_index = m_table->get_ordered_index(col_key);
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
     Array fallback(alloc);
@@ -1022,6 +1037,8 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
             if (StringIndex* index = m_table->get_search_index(col_key)) {
                 index->set<int64_t>(m_key, new_val);
             }
+            if (ordered_index)
+                ordered_index->erase(m_key);
             values.set(m_row_ndx, new_val);
         }
         else {
@@ -1037,10 +1054,14 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
         if (StringIndex* index = m_table->get_search_index(col_key)) {
             index->set<int64_t>(m_key, new_val);
         }
+        if (ordered_index)
+            ordered_index->erase(m_key);
         values.set(m_row_ndx, new_val);
     }
 
     REALM_ASSERT(!fields.has_missing_parent_update());
+    if (ordered_index)
+        ordered_index->insert(m_key);
 
     if (Replication* repl = get_replication()) {
         repl->add_int(m_table.unchecked_ptr(), col_key, m_key, value); // Throws
@@ -1074,6 +1095,7 @@ Obj& Obj::set<ObjKey>(ColKey col_key, ObjKey target_key, bool is_default)
         CascadeState state(CascadeState::Mode::Strong);
 
         ensure_writeable();
+        get_table()->count_modified_objects();
         bool recurse = replace_backlink(col_key, old_key, target_key, state);
 
         Allocator& alloc = get_alloc();
@@ -1119,6 +1141,7 @@ Obj Obj::create_and_set_linked_object(ColKey col_key, bool is_default)
         CascadeState state;
 
         ensure_writeable();
+        get_table()->count_modified_objects();
         bool recurse = replace_backlink(col_key, old_key, target_key, state);
 
         Allocator& alloc = get_alloc();
@@ -1194,10 +1217,14 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
     check_range(value);
 
     ensure_writeable();
+    get_table()->count_modified_objects();
 
     if (StringIndex* index = m_table->get_search_index(col_key)) {
         index->set<T>(m_key, value);
     }
+    auto ordered_index = m_table->get_ordered_index(col_key);
+    if (ordered_index)
+        ordered_index->erase(m_key);
 
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
@@ -1212,6 +1239,8 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
     values.set(m_row_ndx, value);
 
     REALM_ASSERT(!fields.has_missing_parent_update());
+    if (ordered_index)
+        ordered_index->insert(m_key);
 
     if (Replication* repl = get_replication())
         repl->set<T>(m_table.unchecked_ptr(), col_key, m_key, value,
@@ -1538,10 +1567,14 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
 
         update_if_needed();
         ensure_writeable();
+        get_table()->count_modified_objects();
 
         if (StringIndex* index = m_table->get_search_index(col_key)) {
             index->set(m_key, null{});
         }
+        auto ordered_index = m_table->get_ordered_index(col_key);
+        if (ordered_index)
+            ordered_index->erase(m_key);
 
         switch (col_type) {
             case col_type_Int:
@@ -1574,6 +1607,8 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
             default:
                 REALM_UNREACHABLE();
         }
+        if (ordered_index)
+            ordered_index->insert(m_key);
     }
 
     if (Replication* repl = get_replication())
@@ -25,6 +25,8 @@
 #include <realm/query_expression.hpp>
 #include <realm/table_view.hpp>
 #include <realm/table_tpl.hpp>
+#include <realm/util/scope_exit.hpp>
+#include <realm/util/thread_pool.hpp>
 
 #include <algorithm>
 
@@ -81,6 +83,8 @@ Query::Query(const Query& source)
     : error_code(source.error_code)
     , m_groups(source.m_groups)
     , m_table(source.m_table)
+    , m_thread_pool(source.m_thread_pool)
+    , m_profile(source.m_profile)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -105,6 +109,8 @@ Query& Query::operator=(const Query& source)
     if (this != &source) {
         m_groups = source.m_groups;
         m_table = source.m_table;
+        m_thread_pool = source.m_thread_pool;
+        m_profile = source.m_profile;
 
         if (source.m_owned_source_table_view) {
             m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -150,6 +156,7 @@ Query::Query(const Query* source, Transaction* tr, PayloadPolicy policy)
         m_view = m_source_link_list.get();
     }
     m_groups = source->m_groups;
+    m_thread_pool = source->m_thread_pool;
     if (source->m_table)
         set_table(tr->import_copy_of(source->m_table));
     // otherwise: empty query.
@@ -314,6 +321,20 @@ struct MakeConditionNode<StringNode<Cond>> {
     }
 };
 
+template <class Cond>
+struct MakeConditionNode<MixedNode<Cond>> {
+    template <class T>
+    static std::unique_ptr<ParentNode> make(ColKey col_key, T value)
+    {
+        if constexpr (std::is_same_v<T, null> || std::is_constructible_v<Mixed, T>) {
+            return std::unique_ptr<ParentNode>{new MixedNode<Cond>(std::move(value), col_key)};
+        }
+        else {
+            throw_type_mismatch_error();
+        }
+    }
+};
+
 template <class Cond, class T>
 std::unique_ptr<ParentNode> make_condition_node(const Table& table, ColKey column_key, T value)
 {
@@ -352,6 +373,12 @@ std::unique_ptr<ParentNode> make_condition_node(const Table& table, ColKey colum
         case type_ObjectId: {
             return MakeConditionNode<ObjectIdNode<Cond>>::make(column_key, value);
         }
+        case type_OldMixed: {
+            if constexpr (std::is_same_v<Cond, Equal> || std::is_same_v<Cond, NotEqual>) {
+                return MakeConditionNode<MixedNode<Cond>>::make(column_key, value);
+            }
+            throw_type_mismatch_error();
+        }
         default: {
             throw_type_mismatch_error();
         }
@@ -408,6 +435,17 @@ std::unique_ptr<ParentNode> make_size_condition_node(const Table& table, ColKey
     }
 }
 
+template <class LeafType>
+std::unique_ptr<ParentNode> make_between_node(const Table& table, ColKey column_key,
+                                              typename LeafType::value_type from, typename LeafType::value_type to)
+{
+    table.check_column(column_key);
+    if (column_key.get_type() != ColumnTypeTraits<typename LeafType::value_type>::column_id ||
+        column_key.get_attrs().test(col_attr_List))
+        throw_type_mismatch_error();
+    return std::unique_ptr<ParentNode>{new FloatDoubleBetweenNode<LeafType>(from, to, column_key)};
+}
+
 } // anonymous namespace
 
 template <typename TConditionFunction, class T>
@@ -703,6 +741,10 @@ Query& Query::less(ColKey column_key, float value)
 }
 Query& Query::between(ColKey column_key, float from, float to)
 {
+    if (!null::is_null_float(from) && !null::is_null_float(to)) {
+        add_node(make_between_node<ArrayFloat>(*m_table, column_key, from, to));
+        return *this;
+    }
     group();
     greater_equal(column_key, from);
     less_equal(column_key, to);
@@ -738,6 +780,10 @@ Query& Query::less(ColKey column_key, double value)
 }
 Query& Query::between(ColKey column_key, double from, double to)
 {
+    if (!null::is_null_float(from) && !null::is_null_float(to)) {
+        add_node(make_between_node<ArrayDouble>(*m_table, column_key, from, to));
+        return *this;
+    }
     group();
     greater_equal(column_key, from);
     less_equal(column_key, to);
@@ -918,6 +964,65 @@ Query& Query::like(ColKey column_key, StringData value, bool case_sensitive)
 }
 
 
+namespace {
+
+// A table is split into this many ranges of keys per thread, so that threads that finish early can take over ranges
+// from the others
+constexpr size_t ranges_per_thread = 4;
+
+// Splits the table into ranges of keys to search on 'pool'. Returns nothing if the search has to run on the calling
+// thread, because there is no pool, the table is too small to split, or a condition uses a search index, as those
+// cannot be shared between threads.
+std::vector<ClusterTree::Subtree> split_for_pool(const util::ThreadPool* pool, const Table& table,
+                                                 const ParentNode& root)
+{
+    if (!pool)
+        return {};
+    for (auto child : root.m_children) {
+        if (child->has_search_index())
+            return {};
+    }
+    auto ranges = table.get_cluster_subtrees(pool->get_num_threads() * ranges_per_thread);
+    if (ranges.size() < 2)
+        ranges.clear();
+    return ranges;
+}
+
+// Adds the aggregate of a range of keys to the aggregate of the ranges before it
+template <Action action, class R>
+void merge_state(QueryState<R>& total, const QueryState<R>& part)
+{
+    total.m_match_count += part.m_match_count;
+    if constexpr (action == act_Sum) {
+        total.m_state += part.m_state;
+    }
+    else {
+        // A range without matches holds the initial value, which never wins. Of equal values the first one wins, as
+        // when searching on one thread.
+        if (action == act_Max ? part.m_state > total.m_state : part.m_state < total.m_state) {
+            total.m_state = part.m_state;
+            total.m_minmax_index = part.m_minmax_index;
+        }
+    }
+}
+
+// When the table keeps statistics, the costs of the conditions start out as estimates rather than guesses, so when
+// a node has found a match, it tests the others in order of increasing cost. The first condition of a node is
+// always the node itself.
+void order_by_cost(const Table& table, std::vector<ParentNode*>& nodes)
+{
+    if (!table.has_statistics())
+        return;
+    for (auto node : nodes) {
+        std::stable_sort(node->m_children.begin() + 1, node->m_children.end(),
+                         [](const ParentNode* a, const ParentNode* b) {
+                             return a->cost() < b->cost();
+                         });
+    }
+}
+
+} // anonymous namespace
+
 // Aggregates =================================================================================
 
 bool Query::eval_object(ConstObj& obj) const
@@ -936,9 +1041,15 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
     using LeafType = typename ColumnTypeTraits<T>::cluster_leaf_type;
     using ResultType = typename AggregateResultType<T, action>::result_type;
 
+    auto start_time = start_profile(action == act_Sum ? "sum" : action == act_Max ? "maximum" : "minimum");
     if (!has_conditions() && !m_view) {
         // use table aggregate
-        return m_table.unchecked_ptr()->aggregate<action, T, R>(column_key, T{}, resultcount, return_ndx);
+        size_t count = 0;
+        R result = m_table.unchecked_ptr()->aggregate<action, T, R>(column_key, T{}, &count, return_ndx);
+        finish_profile(start_time, count);
+        if (resultcount)
+            *resultcount = count;
+        return result;
     }
     else {
 
@@ -950,6 +1061,7 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
             auto pn = root_node();
             auto node = pn->m_children[find_best_node(pn)];
             if (node->has_search_index()) {
+                profile_index_use(node);
                 node->index_based_aggregate(size_t(-1), [&](ConstObj& obj) -> bool {
                     if (eval_object(obj)) {
                         st.template match<action, false>(size_t(obj.get_key().value), 0, obj.get<T>(column_key));
@@ -963,24 +1075,44 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
             else {
                 // no index, traverse cluster tree
                 node = pn;
-                LeafType leaf(m_table.unchecked_ptr()->get_alloc());
                 bool nullable = m_table->is_nullable(column_key);
 
-                for (size_t c = 0; c < node->m_children.size(); c++)
-                    node->m_children[c]->aggregate_local_prepare(action, ColumnTypeTraits<T>::id, nullable);
-
-                auto f = [column_key, &leaf, &node, &st, this](const Cluster* cluster) {
+                auto search_cluster = [column_key, this](ParentNode* search_node, QueryState<ResultType>& state,
+                                                         LeafType& leaf, const Cluster* cluster) {
+                    if (!cluster_may_match(search_node, cluster))
+                        return false;
                     size_t e = cluster->node_size();
-                    node->set_cluster(cluster);
+                    search_node->set_cluster(cluster);
                     cluster->init_leaf(column_key, &leaf);
-                    st.m_key_offset = cluster->get_offset();
-                    st.m_key_values = cluster->get_key_array();
-                    aggregate_internal(node, &st, 0, e, &leaf);
+                    state.m_key_offset = cluster->get_offset();
+                    state.m_key_values = cluster->get_key_array();
+                    aggregate_internal(search_node, &state, 0, e, &leaf);
                     // Continue
                     return false;
                 };
 
-                m_table.unchecked_ptr()->traverse_clusters(f);
+                auto ranges = split_for_pool(get_search_pool(), *m_table, *node);
+                if (!ranges.empty()) {
+                    std::vector<QueryState<ResultType>> states(ranges.size(), QueryState<ResultType>(action));
+                    run_parallel(ranges.size(), action, ColumnTypeTraits<T>::id, nullable,
+                                 [&](ParentNode* node_copy, size_t ndx) {
+                                     LeafType leaf(m_table.unchecked_ptr()->get_alloc());
+                                     m_table.unchecked_ptr()->traverse_clusters(ranges[ndx], [&](const Cluster* c) {
+                                         return search_cluster(node_copy, states[ndx], leaf, c);
+                                     });
+                                 });
+                    for (auto& part : states)
+                        merge_state<action>(st, part);
+                }
+                else {
+                    LeafType leaf(m_table.unchecked_ptr()->get_alloc());
+                    for (size_t c = 0; c < node->m_children.size(); c++)
+                        node->m_children[c]->aggregate_local_prepare(action, ColumnTypeTraits<T>::id, nullable);
+
+                    m_table.unchecked_ptr()->traverse_clusters([&](const Cluster* cluster) {
+                        return search_cluster(node, st, leaf, cluster);
+                    });
+                }
             }
         }
         else {
@@ -1000,6 +1132,7 @@ R Query::aggregate(ColKey column_key, size_t* resultcount, ObjKey* return_ndx) c
             *return_ndx = st.m_minmax_index;
         }
 
+        finish_profile(start_time, st.m_match_count);
         return st.m_state;
     }
 }
@@ -1012,6 +1145,132 @@ size_t Query::find_best_node(ParentNode* pn) const
     return best;
 }
 
+Query::IndexRange Query::find_index_range(ColKey col_key) const
+{
+    IndexRange result;
+    // An ordered index holds all the objects of the table, not those of a view
+    if (m_view)
+        return result;
+    // The conditions ANDed together, with those combined in a ConjunctionNode listed one by one
+    std::vector<ParentNode*> conditions;
+    if (has_conditions()) {
+        for (auto node : root_node()->m_children) {
+            if (auto conjunction = dynamic_cast<ConjunctionNode*>(node)) {
+                for (auto& condition : conjunction->m_conditions)
+                    conditions.push_back(condition.get());
+            }
+            else {
+                conditions.push_back(node);
+            }
+        }
+    }
+
+    // The range each indexed column is restricted to, and the number of conditions restricting it
+    std::vector<std::pair<ColKey, ValueRange>> ranges;
+    std::vector<size_t> num_conditions;
+    if (col_key) {
+        ranges.emplace_back(col_key, ValueRange());
+        num_conditions.push_back(0);
+    }
+    for (auto node : conditions) {
+        ColKey key = node->m_condition_column_key;
+        if (!key || (col_key && key != col_key))
+            continue;
+        auto it = std::find_if(ranges.begin(), ranges.end(), [&](auto& range) {
+            return range.first == key;
+        });
+        if (it == ranges.end()) {
+            if (!m_table->has_ordered_index(key))
+                continue;
+            ranges.emplace_back(key, ValueRange());
+            num_conditions.push_back(0);
+            it = ranges.end() - 1;
+        }
+        if (node->narrow_range(it->second))
+            ++num_conditions[it - ranges.begin()];
+    }
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (!col_key && !ranges[i].second.is_bounded())
+            continue;
+        auto index = m_table->get_ordered_index(ranges[i].first);
+        if (!index)
+            continue;
+        auto positions = index->find_range(ranges[i].second);
+        if (result.index && positions.second - positions.first >= result.end - result.begin)
+            continue;
+        result.index = std::move(index);
+        result.begin = positions.first;
+        result.end = positions.second;
+        result.covers_conditions = num_conditions[i] == conditions.size();
+    }
+    return result;
+}
+
+bool Query::is_selective(const IndexRange& range) const
+{
+    // Every object in the range is looked up and tested on all conditions, like the matches of a search index
+    return range.index && double(range.end - range.begin) <= double(m_table->size()) * index_scan_threshold;
+}
+
+void Query::for_each_match(const OrderedIndex& index, size_t begin, size_t end,
+                           util::FunctionRef<void(ObjKey)> func) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        ObjKey key = index.get(i);
+        if (has_conditions()) {
+            ConstObj obj = m_table->get_object(key);
+            if (!eval_object(obj))
+                continue;
+        }
+        func(key);
+    }
+}
+
+bool Query::find_all_sorted(ConstTableView& ret, const SortDescriptor& sort) const
+{
+    auto& columns = sort.get_column_keys();
+    if (m_view || columns.size() != 1 || columns[0].size() != 1)
+        return false;
+    // Strings are sorted by collation, not in the order of their bytes, as in the index
+    ColKey col_key = columns[0][0];
+    if (col_key.get_type() == col_type_String || !m_table->has_ordered_index(col_key))
+        return false;
+
+    init();
+    IndexRange range = find_index_range(col_key);
+    // Conditions on other columns may have few matches, which are quicker to sort than to find in the index
+    if (!range.index || (!range.covers_conditions && !is_selective(range)))
+        return false;
+
+    auto start_time = start_profile("find_all");
+    profile_index_use(nullptr);
+    ret.m_selection.clear();
+    ret.m_key_values.clear();
+    const OrderedIndex& index = *range.index;
+    auto add = [&](ObjKey key) {
+        ret.m_key_values.add(key);
+    };
+    if (sort.is_ascending(0).value_or(true)) {
+        for_each_match(index, range.begin, range.end, add);
+    }
+    else {
+        // A sort keeps objects with equal values in the order of the view, so the runs of equal values are added
+        // from the last to the first, but each in key order
+        size_t end = range.end;
+        while (end > range.begin) {
+            Mixed value = index.get_value(end - 1);
+            size_t begin = end - 1;
+            while (begin > range.begin && OrderedIndex::compare(index.get_value(begin - 1), value) == 0)
+                --begin;
+            for_each_match(index, begin, end, add);
+            end = begin;
+        }
+    }
+    finish_profile(start_time, ret.size());
+    return true;
+}
+
 /**************************************************************************************************************
 *                                                                                                             *
 * Main entry point of a query. Schedules calls to aggregate_local                                             *
@@ -1198,6 +1457,8 @@ double Query::average(ColKey column_key, size_t* resultcount) const
     using ResultType = typename AggregateResultType<T, act_Sum>::result_type;
     size_t resultcount2 = 0;
     auto sum1 = aggregate<act_Sum, T, ResultType>(column_key, &resultcount2);
+    if (m_profile)
+        m_profile->operation = "average";
     double avg1 = 0;
     if (resultcount2 != 0)
         avg1 = static_cast<double>(sum1) / resultcount2;
@@ -1312,7 +1573,14 @@ ObjKey Query::find()
 #if REALM_METRICS
     std::unique_ptr<MetricTimer> metric_timer = QueryInfo::track(this, QueryInfo::type_Find);
 #endif
+    auto start_time = start_profile("find");
+    ObjKey key = do_find();
+    finish_profile(start_time, key ? 1 : 0);
+    return key;
+}
 
+ObjKey Query::do_find()
+{
     init();
 
     // User created query with no criteria; return first
@@ -1338,9 +1606,22 @@ ObjKey Query::find()
         return null_key;
     }
     else {
+        IndexRange range = find_index_range();
+        if (is_selective(range)) {
+            // The first match in table order is the one with the lowest key
+            profile_index_use(nullptr);
+            ObjKey first;
+            for_each_match(*range.index, range.begin, range.end, [&](ObjKey key) {
+                if (!first || key < first)
+                    first = key;
+            });
+            return first;
+        }
         auto node = root_node();
         ObjKey key;
-        auto f = [&node, &key](const Cluster* cluster) {
+        auto f = [&node, &key, this](const Cluster* cluster) {
+            if (!cluster_may_match(node, cluster))
+                return false;
             size_t end = cluster->node_size();
             node->set_cluster(cluster);
             size_t res = node->find_first(0, end);
@@ -1359,6 +1640,13 @@ ObjKey Query::find()
 }
 
 void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit) const
+{
+    auto start_time = start_profile("find_all");
+    do_find_all(ret, begin, end, limit);
+    finish_profile(start_time, ret.size());
+}
+
+void Query::do_find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit) const
 {
     if (limit == 0)
         return;
@@ -1380,7 +1668,22 @@ void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit
     else {
         if (end == size_t(-1))
             end = m_table->size();
-        if (!has_conditions()) {
+        // The matches of a scan of the whole table for a view that is not going to be reordered are kept as a
+        // selection of the objects of each cluster, see ConstTableView::uses_selection()
+        bool use_selection = begin == 0 && end == m_table->size() && limit == size_t(-1) && ret.is_empty() &&
+                             ret.m_descriptor_ordering.is_empty();
+        std::vector<uint64_t> bits;
+        if (!has_conditions() && use_selection) {
+            m_table->traverse_clusters([&](const Cluster* cluster) {
+                size_t sz = cluster->node_size();
+                bits.assign((sz + 63) / 64, ~uint64_t(0));
+                if (sz % 64)
+                    bits.back() = (uint64_t(1) << (sz % 64)) - 1;
+                ret.m_selection.add(cluster, bits.data());
+                return false;
+            });
+        }
+        else if (!has_conditions()) {
             KeyColumn& refs = ret.m_key_values;
 
             auto f = [&begin, &end, &limit, &refs](const Cluster* cluster) {
@@ -1411,6 +1714,7 @@ void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit
             auto pn = root_node();
             auto node = pn->m_children[find_best_node(pn)];
             if (node->has_search_index()) {
+                profile_index_use(node);
                 // translate begin/end limiters into corresponding keys
                 auto begin_key = (begin >= m_table->size()) ? ObjKey() : m_table->get_object(begin).get_key();
                 auto end_key = (end >= m_table->size()) ? ObjKey() : m_table->get_object(end).get_key();
@@ -1431,23 +1735,101 @@ void Query::find_all(ConstTableView& ret, size_t begin, size_t end, size_t limit
                 });
                 return;
             }
+            IndexRange range = find_index_range();
+            if (is_selective(range)) {
+                profile_index_use(nullptr);
+                auto begin_key = (begin >= m_table->size()) ? ObjKey() : m_table->get_object(begin).get_key();
+                auto end_key = (end >= m_table->size()) ? ObjKey() : m_table->get_object(end).get_key();
+                std::vector<ObjKey> keys;
+                for_each_match(*range.index, range.begin, range.end, [&](ObjKey key) {
+                    if ((!begin_key || !(key < begin_key)) && (!end_key || key < end_key))
+                        keys.push_back(key);
+                });
+                // The matches are found in the order of the index, but returned in table order like those of a scan
+                std::sort(keys.begin(), keys.end());
+                for (size_t i = 0; i < keys.size() && i < limit; ++i)
+                    ret.m_key_values.add(keys[i]);
+                return;
+            }
             // no index on best node (and likely no index at all), descend B+-tree
             node = pn;
+            if (begin == 0 && end == m_table->size() && limit == size_t(-1)) {
+                auto ranges = split_for_pool(get_search_pool(), *m_table, *node);
+                if (!ranges.empty() && use_selection) {
+                    std::vector<KeySelection> parts(ranges.size());
+                    run_parallel(ranges.size(), act_FindAll, type_Int, false, [&](ParentNode* node_copy, size_t ndx) {
+                        QueryState<int64_t> st(act_FindAll);
+                        std::vector<uint64_t> part_bits;
+                        m_table->traverse_clusters(ranges[ndx], [&](const Cluster* cluster) {
+                            if (node_copy->cluster_may_match(cluster)) {
+                                node_copy->set_cluster(cluster);
+                                part_bits.assign((cluster->node_size() + 63) / 64, 0);
+                                st.m_match_bits = part_bits.data();
+                                st.m_key_offset = cluster->get_offset();
+                                st.m_key_values = cluster->get_key_array();
+                                aggregate_internal(node_copy, &st, 0, cluster->node_size(), nullptr);
+                                parts[ndx].add(cluster, part_bits.data());
+                            }
+                            return false;
+                        });
+                    });
+                    for (auto& part : parts)
+                        ret.m_selection.append(std::move(part));
+                    return;
+                }
+                if (!ranges.empty()) {
+                    // Every range collects its keys in a column of its own, and the columns are appended in order
+                    std::vector<std::unique_ptr<KeyColumn>> parts;
+                    auto destroy_parts = util::make_scope_exit([&]() noexcept {
+                        for (auto& part : parts)
+                            part->destroy();
+                    });
+                    for (size_t i = 0; i < ranges.size(); ++i) {
+                        parts.push_back(std::make_unique<KeyColumn>(Allocator::get_default()));
+                        parts.back()->create(); // Throws
+                    }
+                    run_parallel(ranges.size(), act_FindAll, type_Int, false, [&](ParentNode* node_copy, size_t ndx) {
+                        QueryState<int64_t> st(act_FindAll, parts[ndx].get());
+                        m_table->traverse_clusters(ranges[ndx], [&](const Cluster* cluster) {
+                            if (node_copy->cluster_may_match(cluster)) {
+                                node_copy->set_cluster(cluster);
+                                st.m_key_offset = cluster->get_offset();
+                                st.m_key_values = cluster->get_key_array();
+                                aggregate_internal(node_copy, &st, 0, cluster->node_size(), nullptr);
+                            }
+                            return false;
+                        });
+                    });
+                    for (auto& part : parts) {
+                        for (auto key : part->get_all())
+                            ret.m_key_values.add(key);
+                    }
+                    return;
+                }
+            }
             QueryState<int64_t> st(act_FindAll, &ret.m_key_values, limit);
 
             for (size_t c = 0; c < node->m_children.size(); c++)
                 node->m_children[c]->aggregate_local_prepare(act_FindAll, type_Int, false);
 
-            auto f = [&begin, &end, &node, &st, this](const Cluster* cluster) {
+            auto f = [&begin, &end, &node, &st, &bits, &ret, use_selection, this](const Cluster* cluster) {
                 size_t e = cluster->node_size();
                 if (begin < e) {
                     if (e > end) {
                         e = end;
                     }
-                    node->set_cluster(cluster);
-                    st.m_key_offset = cluster->get_offset();
-                    st.m_key_values = cluster->get_key_array();
-                    aggregate_internal(node, &st, begin, e, nullptr);
+                    if (cluster_may_match(node, cluster)) {
+                        node->set_cluster(cluster);
+                        if (use_selection) {
+                            bits.assign((e + 63) / 64, 0);
+                            st.m_match_bits = bits.data();
+                        }
+                        st.m_key_offset = cluster->get_offset();
+                        st.m_key_values = cluster->get_key_array();
+                        aggregate_internal(node, &st, begin, e, nullptr);
+                        if (use_selection)
+                            ret.m_selection.add(cluster, bits.data());
+                    }
                     begin = 0;
                 }
                 else {
@@ -1507,6 +1889,7 @@ size_t Query::do_count(size_t limit) const
         auto pn = root_node();
         auto node = pn->m_children[find_best_node(pn)];
         if (node->has_search_index()) {
+            profile_index_use(node);
             node->index_based_aggregate(limit, [&](ConstObj& obj) -> bool {
                 if (eval_object(obj)) {
                     ++counter;
@@ -1518,14 +1901,45 @@ size_t Query::do_count(size_t limit) const
             });
             return counter;
         }
+        IndexRange range = find_index_range();
+        if (is_selective(range)) {
+            profile_index_use(nullptr);
+            for_each_match(*range.index, range.begin, range.end, [&](ObjKey) {
+                ++counter;
+            });
+            return std::min(counter, limit);
+        }
         // no index, descend down the B+-tree instead
         node = pn;
+        auto ranges = limit == size_t(-1) ? split_for_pool(get_search_pool(), *m_table, *node)
+                                          : std::vector<ClusterTree::Subtree>();
+        if (!ranges.empty()) {
+            std::vector<size_t> counts(ranges.size());
+            run_parallel(ranges.size(), act_Count, type_Int, false, [&](ParentNode* node_copy, size_t ndx) {
+                QueryState<int64_t> st(act_Count);
+                m_table->traverse_clusters(ranges[ndx], [&](const Cluster* cluster) {
+                    if (node_copy->cluster_may_match(cluster)) {
+                        node_copy->set_cluster(cluster);
+                        st.m_key_offset = cluster->get_offset();
+                        st.m_key_values = cluster->get_key_array();
+                        aggregate_internal(node_copy, &st, 0, cluster->node_size(), nullptr);
+                    }
+                    return false;
+                });
+                counts[ndx] = size_t(st.m_state);
+            });
+            for (auto c : counts)
+                cnt += c;
+            return cnt;
+        }
         QueryState<int64_t> st(act_Count, limit);
 
         for (size_t c = 0; c < node->m_children.size(); c++)
             node->m_children[c]->aggregate_local_prepare(act_Count, type_Int, false);
 
         auto f = [&node, &st, this](const Cluster* cluster) {
+            if (!cluster_may_match(node, cluster))
+                return false;
             size_t e = cluster->node_size();
             node->set_cluster(cluster);
             st.m_key_offset = cluster->get_offset();
@@ -1548,7 +1962,10 @@ size_t Query::count() const
 #if REALM_METRICS
     std::unique_ptr<MetricTimer> metric_timer = QueryInfo::track(this, QueryInfo::type_Count);
 #endif
-    return do_count();
+    auto start_time = start_profile("count");
+    size_t cnt = do_count();
+    finish_profile(start_time, cnt);
+    return cnt;
 }
 
 TableView Query::find_all(const DescriptorOrdering& descriptor)
@@ -1604,7 +2021,10 @@ size_t Query::count(const DescriptorOrdering& descriptor)
         if (bool(min_limit)) {
             limit = *min_limit;
         }
-        return do_count(limit);
+        auto start_time = start_profile("count");
+        size_t cnt = do_count(limit);
+        finish_profile(start_time, cnt);
+        return cnt;
     }
 
     TableView ret(m_table, *this, start, end, limit);
@@ -1621,135 +2041,99 @@ size_t Query::remove()
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
+Query& Query::set_parallel(size_t num_threads)
 {
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
+    m_thread_pool = num_threads > 1 ? std::make_shared<util::ThreadPool>(num_threads) : nullptr; // Throws
+    return *this;
 }
 
-int Query::set_threads(unsigned int threadcount)
+Query& Query::set_parallel(std::shared_ptr<util::ThreadPool> pool)
 {
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
+    m_thread_pool = pool && pool->get_num_threads() > 1 ? std::move(pool) : nullptr;
+    return *this;
+}
 
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
+Query& Query::set_profile(std::shared_ptr<QueryProfile> profile)
+{
+    m_profile = std::move(profile);
+    return *this;
+}
 
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
+std::chrono::steady_clock::time_point Query::start_profile(const char* operation) const
+{
+    if (REALM_LIKELY(!m_profile))
+        return {};
+    *m_profile = QueryProfile();
+    m_profile->operation = operation;
+    m_profile->uses_view = m_view != nullptr;
+    // Queries restricted to a view cannot be serialized, but their conditions can, except a few that are left
+    // without a description
+    try {
+        util::serializer::SerialisationState state;
+        m_profile->description = has_conditions() ? root_node()->describe_expression(state) : "TRUEPREDICATE";
     }
-    m_threadcount = threadcount;
-    return 0;
+    catch (const SerialisationError&) {
+    }
+    return std::chrono::steady_clock::now();
 }
 
-
-void* Query::query_thread(void* arg)
+void Query::finish_profile(std::chrono::steady_clock::time_point start_time, size_t matches) const
 {
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
+    if (REALM_LIKELY(!m_profile))
+        return;
+    m_profile->time = std::chrono::steady_clock::now() - start_time;
+    m_profile->rows_matched = matches;
+    if (has_conditions()) {
+        for (auto child : root_node()->m_children) {
+            if (auto conjunction = dynamic_cast<ConjunctionNode*>(child)) {
+                for (auto& condition : conjunction->m_conditions) {
+                    if (condition->m_profile)
+                        m_profile->conditions.push_back(*condition->m_profile);
                 }
-                res.clear();
             }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
+            else if (child->m_profile) {
+                m_profile->conditions.push_back(*child->m_profile);
+            }
         }
     }
-    return 0;
 }
 
-#endif // REALM_MULTITHREADQUERY
+bool Query::cluster_may_match(ParentNode* node, const Cluster* cluster) const
+{
+    bool may_match = node->cluster_may_match(cluster);
+    if (m_profile)
+        ++(may_match ? m_profile->clusters_visited : m_profile->clusters_skipped);
+    return may_match;
+}
+
+void Query::profile_index_use(ParentNode* node) const
+{
+    if (m_profile) {
+        m_profile->uses_index = true;
+        if (node && node->m_profile)
+            node->m_profile->uses_index = true;
+    }
+}
+
+void Query::run_parallel(size_t num_tasks, Action action, DataType type, bool nullable,
+                         util::FunctionRef<void(ParentNode*, size_t)> func) const
+{
+    // The nodes hold the state of the search, so every thread needs a copy of its own
+    std::vector<std::unique_ptr<ParentNode>> nodes(m_thread_pool->get_num_threads());
+    m_thread_pool->run(num_tasks, [&](size_t task_ndx, size_t thread_ndx) {
+        auto& node = nodes[thread_ndx];
+        if (!node) {
+            node = root_node()->clone();
+            node->init(true);
+            std::vector<ParentNode*> vec;
+            node->gather_children(vec);
+            order_by_cost(*m_table, vec);
+            for (auto child : node->m_children)
+                child->aggregate_local_prepare(action, type, nullable);
+        }
+        func(node.get(), task_ndx);
+    }); // Throws
+}
 
 std::string Query::validate()
 {
@@ -1789,8 +2173,35 @@ void Query::init() const
     m_table.check();
     if (ParentNode* root = root_node()) {
         root->init(m_view == nullptr);
+        // Which conditions are evaluated together depends on the indexes and statistics of the table, so it is
+        // decided here rather than when the conditions are added. Regrouping does not change the result.
+        auto& root_ptr = const_cast<QueryGroup&>(m_groups[0]).m_root_node;
+        ConjunctionNode::regroup(root_ptr, m_table);
+        root = root_ptr.get();
         std::vector<ParentNode*> vec;
         root->gather_children(vec);
+        order_by_cost(*m_table, vec);
+        // The conditions ANDed at the top level count their work while the query is profiled, including each of
+        // those evaluated together by a ConjunctionNode
+        util::serializer::SerialisationState state;
+        auto init_profile = [&](ParentNode* node) {
+            node->m_profile.reset();
+            if (m_profile) {
+                node->m_profile = std::make_unique<QueryProfile::Condition>();
+                try {
+                    node->m_profile->description = node->describe(state);
+                }
+                catch (const SerialisationError&) {
+                }
+            }
+        };
+        for (auto child : root->m_children) {
+            init_profile(child);
+            if (auto conjunction = dynamic_cast<ConjunctionNode*>(child)) {
+                for (auto& condition : conjunction->m_conditions)
+                    init_profile(condition.get());
+            }
+        }
     }
 }
 
@@ -23,22 +23,17 @@
 #include <cstdio>
 #include <climits>
 #include <algorithm>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/obj_list.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/binary_data.hpp>
 #include <realm/timestamp.hpp>
 #include <realm/handover_defs.hpp>
+#include <realm/util/function_ref.hpp>
 #include <realm/util/serializer.hpp>
 
 namespace realm {
@@ -53,11 +48,19 @@ class Array;
 class Expression;
 class Group;
 class Transaction;
+class Cluster;
+class OrderedIndex;
+class SortDescriptor;
+struct QueryProfile;
 
 namespace metrics {
 class QueryInfo;
 }
 
+namespace util {
+class ThreadPool;
+}
+
 struct QueryGroup {
     enum class State {
         Default,
@@ -269,12 +272,34 @@ public:
     // Deletion
     size_t remove();
 
-#if REALM_MULTITHREAD_QUERY
-    // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    ConstTableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+    // Parallel execution
+    //
+    // Run find_all(), count() and the aggregates on 'num_threads' threads, or
+    // on the threads of 'pool', which can be shared by many queries. The table
+    // is split into ranges of keys that are searched with separate copies of
+    // the conditions, and the results are merged in key order, so they are the
+    // same as when run on one thread, apart from the rounding of floating
+    // point sums. Queries restricted by a view, a limit or a range, and
+    // queries served by a search index, still run on the calling thread.
+    // Passing 1 thread or no pool turns parallel execution off.
+    //
+    // The table must not be modified while the query runs, which is always the
+    // case for a read transaction.
+    Query& set_parallel(size_t num_threads);
+    Query& set_parallel(std::shared_ptr<util::ThreadPool> pool);
+
+    // Profiling
+    //
+    // Record how every following find(), find_all(), count() and aggregate
+    // of this query is executed in 'profile': the order in which the
+    // conditions are tested, whether a search index is used, the clusters
+    // searched and skipped, and the rows examined, the rows matched and the
+    // time spent by each condition. Copies of the query, such as the one kept
+    // by a table view, record in the same profile. A profiled query runs on
+    // the calling thread, and counting and timing every condition makes it
+    // slower, so this is meant for investigating slow queries rather than to
+    // be left on. Passing no profile turns profiling off.
+    Query& set_profile(std::shared_ptr<QueryProfile> profile);
 
     ConstTableRef& get_table()
     {
@@ -354,11 +379,50 @@ private:
     R aggregate(ColKey column_key, size_t* resultcount = nullptr, ObjKey* return_ndx = nullptr) const;
 
     size_t find_best_node(ParentNode* pn) const;
+
+    // A range of positions in an ordered index that holds every object matching the query
+    struct IndexRange {
+        std::unique_ptr<OrderedIndex> index;
+        size_t begin = 0;
+        size_t end = 0;
+        // True if all the conditions ANDed at the top level of the query were narrowed to the range
+        bool covers_conditions = false;
+    };
+    // The narrowest range that the conditions ANDed at the top level of the query restrict an ordered index to, or
+    // the range of the index of 'col_key' if given. The index is null if there is none to use.
+    IndexRange find_index_range(ColKey col_key = {}) const;
+    // True if testing the objects in 'range' is expected to be quicker than a scan of the table
+    bool is_selective(const IndexRange& range) const;
+    // Calls 'func' with the key of each object at the positions [begin, end) of 'index' that matches the query
+    void for_each_match(const OrderedIndex& index, size_t begin, size_t end,
+                        util::FunctionRef<void(ObjKey)> func) const;
+    // Finds all the matches of the query in the order given by 'sort', if it sorts on a single column with an ordered
+    // index and the index makes that quicker than a search and a sort. Returns false if the view is left untouched.
+    bool find_all_sorted(ConstTableView& tv, const SortDescriptor& sort) const;
     void aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start, size_t end,
                             ArrayPayload* source_column) const;
 
     void find_all(ConstTableView& tv, size_t start = 0, size_t end = size_t(-1), size_t limit = size_t(-1)) const;
+    void do_find_all(ConstTableView& tv, size_t start, size_t end, size_t limit) const;
+    ObjKey do_find();
+    void run_parallel(size_t num_tasks, Action action, DataType type, bool nullable,
+                      util::FunctionRef<void(ParentNode*, size_t)> func) const;
     size_t do_count(size_t limit = size_t(-1)) const;
+
+    // The pool to search on. A profiled query runs on the calling thread, as the conditions keep their counters.
+    const util::ThreadPool* get_search_pool() const
+    {
+        return m_profile ? nullptr : m_thread_pool.get();
+    }
+    // Resets the profile for 'operation' and returns its start time, if the query is profiled
+    std::chrono::steady_clock::time_point start_profile(const char* operation) const;
+    // Records the time taken, the number of matches and the counters of the conditions, if the query is profiled
+    void finish_profile(std::chrono::steady_clock::time_point start_time, size_t matches) const;
+    // ParentNode::cluster_may_match() that counts the clusters searched and skipped, if the query is profiled
+    bool cluster_may_match(ParentNode* node, const Cluster* cluster) const;
+    // Notes that the matches of 'node' are looked up in its search index, or that the matches of the query are
+    // looked up in an ordered index if 'node' is null, if the query is profiled
+    void profile_index_use(ParentNode* node) const;
     void delete_nodes() noexcept;
 
     bool has_conditions() const
@@ -395,6 +459,9 @@ private:
     LnkLstPtr m_source_link_list;                  // link lists are owned by the query.
     ConstTableView* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<ConstTableView> m_owned_source_table_view; // <--- except when indicated here
+
+    std::shared_ptr<util::ThreadPool> m_thread_pool; // Set for parallel execution
+    std::shared_ptr<QueryProfile> m_profile;         // Set for profiling
 };
 
 // Implementation:
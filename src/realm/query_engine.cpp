@@ -45,7 +45,7 @@ size_t ParentNode::find_first(size_t start, size_t end)
     size_t nb_cond_to_test = sz;
 
     while (REALM_LIKELY(start < end)) {
-        size_t m = m_children[current_cond]->find_first_local(start, end);
+        size_t m = m_children[current_cond]->find_first_counted(start, end);
 
         if (m != start) {
             // Pointer advanced - we will have to check all other conditions
@@ -67,6 +67,66 @@ size_t ParentNode::find_first(size_t start, size_t end)
     return not_found;
 }
 
+void ParentNode::find_all_bits(size_t start, size_t end, size_t base, uint64_t* bits)
+{
+    while (start < end) {
+        size_t m = find_first_local(start, end);
+        if (m == not_found)
+            break;
+        _impl::SetMatchBit{bits, base}(m);
+        start = m + 1;
+    }
+}
+
+double ParentNode::estimate_match_fraction(util::FunctionRef<double(const ColumnStatistics&)> estimate) const
+{
+    ColumnStatistics statistics;
+    if (!m_condition_column_key || !m_table.unchecked_ptr()->get_column_statistics(m_condition_column_key, statistics))
+        return -1.0;
+    return estimate(statistics);
+}
+
+size_t ParentNode::find_first_profiled(size_t start, size_t end)
+{
+    auto start_time = std::chrono::steady_clock::now();
+    size_t m = find_first_local(start, end);
+    m_profile->time += std::chrono::steady_clock::now() - start_time;
+    m_profile->rows_examined += (m == not_found ? end : m + 1) - start;
+    if (m != not_found)
+        m_profile->rows_matched++;
+    return m;
+}
+
+std::chrono::nanoseconds ParentNode::get_children_time() const
+{
+    std::chrono::nanoseconds time{0};
+    for (size_t c = 1; c < m_children.size(); c++) {
+        if (auto& profile = m_children[c]->m_profile)
+            time += profile->time;
+    }
+    return time;
+}
+
+void ParentNode::add_search_to_profile(size_t start, size_t next, size_t matches,
+                                       std::chrono::steady_clock::time_point start_time,
+                                       std::chrono::nanoseconds children_time)
+{
+    auto time = std::chrono::steady_clock::now() - start_time;
+    m_profile->searches++;
+    m_profile->rows_examined += next - start;
+    m_profile->rows_matched += matches;
+    m_profile->time += time - (get_children_time() - children_time);
+}
+
+void ParentNode::set_match_fraction(double fraction)
+{
+    if (fraction < 0)
+        return;
+    // A condition that is estimated never to match still gets a finite distance, longer than the table
+    double size = double(m_table.unchecked_ptr()->size());
+    m_dD = 1.0 / std::max(fraction, 1.0 / (size + 1.0));
+}
+
 bool ParentNode::match(ConstObj& obj)
 {
     auto cb = [this](const Cluster* cluster, size_t row) {
@@ -170,6 +230,8 @@ size_t ParentNode::aggregate_local(QueryStateBase* st, size_t start, size_t end,
 
     m_state = st;
     size_t local_matches = 0;
+    if (m_profile)
+        m_profile->searches++;
 
     size_t r = start - 1;
     for (;;) {
@@ -179,7 +241,7 @@ size_t ParentNode::aggregate_local(QueryStateBase* st, size_t start, size_t end,
         }
 
         // Find first match in this condition node
-        r = find_first_local(r + 1, end);
+        r = find_first_counted(r + 1, end);
         if (r == not_found) {
             m_dD = double(r - start) / (local_matches + 1.1);
             return end;
@@ -191,7 +253,7 @@ size_t ParentNode::aggregate_local(QueryStateBase* st, size_t start, size_t end,
         size_t m = r;
 
         for (size_t c = 1; c < m_children.size(); c++) {
-            m = m_children[c]->find_first_local(r, r + 1);
+            m = m_children[c]->find_first_counted(r, r + 1);
             if (m != r) {
                 break;
             }
@@ -335,6 +397,11 @@ bool StringNode<Equal>::do_consume_condition(ParentNode& node)
 
 size_t StringNode<Equal>::_find_first_local(size_t start, size_t end)
 {
+    if (m_leaf_has_dictionary) {
+        if (m_dictionary_key == realm::not_found)
+            return not_found;
+        return m_leaf_ptr->find_first_dictionary_key(m_dictionary_key, start, end);
+    }
     if (m_needles.empty()) {
         return m_leaf_ptr->find_first(m_value, start, end);
     }
@@ -529,6 +596,176 @@ size_t NotNode::find_first_no_overlap(size_t start, size_t end)
     return result;
 }
 
+namespace {
+
+// Conditions that find their matches in bulk are evaluated together, unless they are better served by an index
+bool can_combine(const ParentNode& node)
+{
+    return node.has_find_all_bits() && !node.has_search_index();
+}
+
+} // anonymous namespace
+
+void ConjunctionNode::regroup(std::unique_ptr<ParentNode>& first, ConstTableRef table)
+{
+    for (auto link = &first; *link; link = &(*link)->m_child) {
+        if (auto conjunction = dynamic_cast<ConjunctionNode*>(link->get())) {
+            std::unique_ptr<ParentNode> chain = std::move(conjunction->m_child);
+            auto conditions = std::move(conjunction->m_conditions);
+            for (auto it = conditions.rbegin(); it != conditions.rend(); ++it) {
+                (*it)->m_child = std::move(chain);
+                chain = std::move(*it);
+            }
+            *link = std::move(chain);
+        }
+    }
+
+    for (auto link = &first; *link; link = &(*link)->m_child) {
+        ParentNode& node = **link;
+        if (!can_combine(node) || !node.m_child || !can_combine(*node.m_child))
+            continue;
+        std::unique_ptr<ParentNode> rest = std::move(node.m_child);
+        auto conjunction = std::make_unique<ConjunctionNode>(std::move(*link));
+        while (rest && can_combine(*rest)) {
+            std::unique_ptr<ParentNode> next = std::move(rest->m_child);
+            conjunction->add_condition(std::move(rest));
+            rest = std::move(next);
+        }
+        conjunction->m_child = std::move(rest);
+        conjunction->set_table(table);
+        // The conditions are initialized already
+        conjunction->estimate();
+        *link = std::move(conjunction);
+    }
+}
+
+void ConjunctionNode::init(bool will_query_ranges)
+{
+    ParentNode::init(will_query_ranges);
+
+    for (auto& condition : m_conditions)
+        condition->init(will_query_ranges);
+    estimate();
+}
+
+void ConjunctionNode::estimate()
+{
+    // The conditions are assumed to be independent, so the distance between the rows matching all of them is the
+    // product of the distances between the rows matching each
+    m_dD = 1.0;
+    m_dT = 0.0;
+    m_order.clear();
+    for (auto& condition : m_conditions) {
+        m_dD *= condition->m_dD;
+        m_dT += condition->m_dT;
+        m_order.push_back(condition.get());
+    }
+    std::stable_sort(m_order.begin(), m_order.end(), [](ParentNode* a, ParentNode* b) {
+        return a->m_dD > b->m_dD;
+    });
+    m_block_start = m_block_end = 0;
+}
+
+size_t ConjunctionNode::find_first_local(size_t start, size_t end)
+{
+    if (end - start == 1) {
+        // Testing a match of another condition, or an object of a view
+        for (auto condition : m_order) {
+            if (condition->find_first_counted(start, end) != start)
+                return not_found;
+        }
+        return start;
+    }
+
+    while (start < end) {
+        if (start < m_block_start || start >= m_block_end) {
+            // Blocks are aligned, so that the search for the next match goes on in the same block
+            size_t block_start = start - start % block_size;
+            evaluate_block(block_start, std::min(block_start + block_size, m_cluster->node_size()));
+        }
+        size_t stop = std::min(end, m_block_end);
+        size_t bit = start - m_block_start;
+        size_t stop_bit = stop - m_block_start;
+        while (bit < stop_bit) {
+            uint64_t word = m_bits[bit / 64] >> (bit % 64);
+            if (word) {
+                size_t match = bit + ctz(word);
+                return match < stop_bit ? m_block_start + match : not_found;
+            }
+            bit = (bit / 64 + 1) * 64;
+        }
+        start = stop;
+    }
+    return not_found;
+}
+
+void ConjunctionNode::evaluate_block(size_t block_start, size_t block_end)
+{
+    REALM_ASSERT_DEBUG(block_end - block_start <= block_size);
+    m_block_start = block_start;
+    m_block_end = block_end;
+    m_bits.fill(0);
+    std::chrono::steady_clock::time_point start_time;
+    if (m_profile)
+        start_time = std::chrono::steady_clock::now();
+    m_order[0]->find_all_bits(block_start, block_end, block_start, m_bits.data());
+    if (m_profile) {
+        m_order[0]->m_profile->searches++;
+        add_block_to_profile(*m_order[0], block_end - block_start, start_time);
+    }
+
+    for (size_t c = 1; c < m_order.size(); ++c) {
+        // The following conditions only need to test the words that still have rows matching
+        size_t first_word = 0;
+        while (first_word < block_words && !m_bits[first_word])
+            ++first_word;
+        if (first_word == block_words)
+            return;
+        size_t last_word = block_words - 1;
+        while (!m_bits[last_word])
+            --last_word;
+        size_t candidates = 0;
+        for (size_t w = first_word; w <= last_word; ++w)
+            candidates += fast_popcount64(int64_t(m_bits[w]));
+
+        ParentNode* condition = m_order[c];
+        if (m_profile)
+            start_time = std::chrono::steady_clock::now();
+        if (candidates * 16 < (last_word + 1 - first_word) * 64) {
+            // Few rows left, so test them one by one
+            for (size_t w = first_word; w <= last_word; ++w) {
+                for (uint64_t word = m_bits[w]; word; word &= word - 1) {
+                    size_t bit = ctz(word);
+                    size_t row = block_start + w * 64 + bit;
+                    if (condition->find_first_local(row, row + 1) != row)
+                        m_bits[w] &= ~(uint64_t(1) << bit);
+                }
+            }
+        }
+        else {
+            std::array<uint64_t, block_words> bits;
+            std::fill(bits.begin() + first_word, bits.begin() + last_word + 1, 0);
+            condition->find_all_bits(block_start + first_word * 64,
+                                     std::min(block_start + (last_word + 1) * 64, block_end), block_start,
+                                     bits.data());
+            for (size_t w = first_word; w <= last_word; ++w)
+                m_bits[w] &= bits[w];
+        }
+        if (m_profile)
+            add_block_to_profile(*condition, candidates, start_time);
+    }
+}
+
+void ConjunctionNode::add_block_to_profile(ParentNode& condition, size_t rows_examined,
+                                           std::chrono::steady_clock::time_point start_time) const
+{
+    auto& profile = *condition.m_profile;
+    profile.time += std::chrono::steady_clock::now() - start_time;
+    profile.rows_examined += rows_examined;
+    for (auto word : m_bits)
+        profile.rows_matched += fast_popcount64(int64_t(word));
+}
+
 ExpressionNode::ExpressionNode(std::unique_ptr<Expression> expression)
 : m_expression(std::move(expression))
 {
@@ -89,6 +89,7 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <sstream>
 #include <string>
 #include <array>
+#include <cstring>
 
 #include <realm/array_basic.hpp>
 #include <realm/array_key.hpp>
@@ -97,14 +98,17 @@ AggregateState      State of the aggregate - contains a state variable that stor
 #include <realm/array_timestamp.hpp>
 #include <realm/array_decimal128.hpp>
 #include <realm/array_object_id.hpp>
+#include <realm/array_mixed.hpp>
 #include <realm/array_list.hpp>
 #include <realm/array_bool.hpp>
 #include <realm/array_backlink.hpp>
 #include <realm/column_type_traits.hpp>
 #include <realm/metrics/query_info.hpp>
 #include <realm/query_conditions.hpp>
+#include <realm/query_profile.hpp>
 #include <realm/table.hpp>
 #include <realm/column_integer.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/unicode.hpp>
 #include <realm/util/miscellaneous.hpp>
 #include <realm/util/serializer.hpp>
@@ -137,6 +141,11 @@ const size_t probe_matches = 4;
 
 const size_t bitwidth_time_unit = 64;
 
+// Fraction of matching objects above which an equality condition is evaluated by scanning its column instead of
+// looking up the matches in a search index, when the statistics of the table can tell. A scan reads the column in
+// order, whereas every match found through the index costs a lookup of its object.
+const double index_scan_threshold = 0.05;
+
 typedef bool (*CallbackDummy)(int64_t);
 using Evaluator = util::FunctionRef<bool(ConstObj& obj)>;
 
@@ -153,6 +162,14 @@ public:
     }
     virtual void index_based_aggregate(size_t, Evaluator) {}
 
+    // Narrows 'range' to the values of the condition column that the node can match, so that its matches can be
+    // looked up in an ordered index of the column. The range may hold values that do not match, as matches are
+    // still tested on the whole query. Returns false if the node matches no range of values.
+    virtual bool narrow_range(ValueRange&) const
+    {
+        return false;
+    }
+
     void gather_children(std::vector<ParentNode*>& v)
     {
         m_children.clear();
@@ -177,6 +194,14 @@ public:
 
     bool match(ConstObj& obj);
 
+    // find_first_local() that updates the counters of this condition if the query is profiled
+    size_t find_first_counted(size_t start, size_t end)
+    {
+        if (REALM_LIKELY(!m_profile))
+            return find_first_local(start, end);
+        return find_first_profiled(start, end);
+    }
+
     virtual void init(bool will_query_ranges)
     {
         if (m_child)
@@ -214,12 +239,27 @@ public:
         cluster_changed();
     }
 
+    // Returns false if the summary kept by the cluster rules out a match of this node or of any node ANDed with it
+    bool cluster_may_match(const Cluster* cluster) const
+    {
+        return may_match(cluster) && (!m_child || m_child->cluster_may_match(cluster));
+    }
+
     virtual void collect_dependencies(std::vector<TableKey>&) const
     {
     }
 
     virtual size_t find_first_local(size_t start, size_t end) = 0;
 
+    // Sets bit 'i - base' of 'bits' for each row 'i' in [start, end) that matches this node, not counting the nodes
+    // ANDed with it. Nodes that can find all matches faster than by repeated calls to find_first_local() override it
+    // and return true from has_find_all_bits(), which lets a ConjunctionNode evaluate them together.
+    virtual void find_all_bits(size_t start, size_t end, size_t base, uint64_t* bits);
+    virtual bool has_find_all_bits() const
+    {
+        return false;
+    }
+
     virtual void aggregate_local_prepare(Action TAction, DataType col_id, bool nullable);
     template <Action action>
     void aggregate_local_prepare(DataType col_id, bool nullable);
@@ -343,6 +383,9 @@ public:
     size_t m_probes = 0;
     size_t m_matches = 0;
 
+    // The counters of this condition while the query is profiled, see Query::set_profile()
+    std::unique_ptr<QueryProfile::Condition> m_profile;
+
 protected:
     typedef bool (ParentNode::*Column_action_specialized)(QueryStateBase*, ArrayPayload*, size_t);
     Column_action_specialized m_column_action_specializer = nullptr;
@@ -356,7 +399,25 @@ protected:
         return m_table.unchecked_ptr()->get_real_column_type(key);
     }
 
+    // The fraction of the objects that match the condition of this node, as estimated by 'estimate' from the
+    // statistics of the condition column. Returns a negative value if the table keeps no statistics for the column,
+    // or if 'estimate' cannot tell.
+    double estimate_match_fraction(util::FunctionRef<double(const ColumnStatistics&)> estimate) const;
+    // Start from the average distance between matches given by an estimated fraction of matching objects, instead
+    // of a fixed guess. Does nothing if the fraction is negative.
+    void set_match_fraction(double fraction);
+
+    // The time the conditions tested on the matches of this one have spent so far, when the query is profiled
+    std::chrono::nanoseconds get_children_time() const;
+    // Adds a search by this condition to its profile: the rows from 'start' up to 'next' were examined, 'matches'
+    // of them matched, and the search started at 'start_time', when the other conditions had spent 'children_time'
+    void add_search_to_profile(size_t start, size_t next, size_t matches,
+                               std::chrono::steady_clock::time_point start_time,
+                               std::chrono::nanoseconds children_time);
+
 private:
+    size_t find_first_profiled(size_t start, size_t end);
+
     virtual void table_changed()
     {
     }
@@ -364,6 +425,10 @@ private:
     {
         // TODO: Should eventually be pure
     }
+    virtual bool may_match(const Cluster*) const
+    {
+        return true;
+    }
     virtual bool do_consume_condition(ParentNode&)
     {
         return false;
@@ -401,6 +466,106 @@ struct CostHeuristic<ArrayIntNull> {
 };
 
 // FIXME: Add AdaptiveStringColumn, BasicColumn, etc.
+
+// The callback of the leaf searches done by ParentNode::find_all_bits(), which sets the bit of each match
+struct SetMatchBit {
+    uint64_t* bits;
+    size_t base;
+
+    bool operator()(size_t i) const
+    {
+        size_t bit = i - base;
+        bits[bit / 64] |= uint64_t(1) << (bit % 64);
+        return true;
+    }
+};
+
+// Returns the fraction of the objects that the statistics of a column estimate to match a condition comparing the
+// column to 'value', or a negative value if they cannot tell. Values are compared as doubles, see ColumnStatistics.
+template <class TConditionFunction>
+double estimate_match_fraction(const ColumnStatistics& statistics, double value, bool value_is_null)
+{
+    if (value_is_null) {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>)
+            return statistics.null_fraction();
+        if constexpr (std::is_same_v<TConditionFunction, NotEqual>)
+            return 1.0 - statistics.null_fraction();
+        return -1.0;
+    }
+    if constexpr (std::is_same_v<TConditionFunction, Equal>)
+        return statistics.equal_fraction(value);
+    if constexpr (std::is_same_v<TConditionFunction, NotEqual>)
+        return 1.0 - statistics.equal_fraction(value);
+    if constexpr (std::is_same_v<TConditionFunction, Greater>)
+        return statistics.greater_fraction(value, false);
+    if constexpr (std::is_same_v<TConditionFunction, GreaterEqual>)
+        return statistics.greater_fraction(value, true);
+    if constexpr (std::is_same_v<TConditionFunction, Less>)
+        return statistics.less_fraction(value, false);
+    if constexpr (std::is_same_v<TConditionFunction, LessEqual>)
+        return statistics.less_fraction(value, true);
+    return -1.0;
+}
+
+// Like above, for columns whose values are not ordered, like strings and ObjectIds
+template <class TConditionFunction>
+double estimate_match_fraction(const ColumnStatistics& statistics, bool value_is_null)
+{
+    double equal = value_is_null ? statistics.null_fraction() : statistics.equal_fraction();
+    if constexpr (std::is_same_v<TConditionFunction, Equal>)
+        return equal;
+    if constexpr (std::is_same_v<TConditionFunction, NotEqual>)
+        return 1.0 - equal;
+    return -1.0;
+}
+
+// Returns false if the condition cannot hold for any value of a cluster where the non-null values lie within
+// [min, max]. A null value in the condition is only understood by Equal.
+template <class TConditionFunction, class T>
+bool may_match_summary(T value, bool value_is_null, T min, T max, size_t null_count, size_t size)
+{
+    if (value_is_null)
+        return !std::is_same_v<TConditionFunction, Equal> || null_count > 0;
+    if constexpr (std::is_same_v<TConditionFunction, NotEqual>)
+        return null_count > 0 || !(min == value && max == value);
+    // Nulls only match the conditions above
+    if (null_count == size)
+        return false;
+    if constexpr (std::is_same_v<TConditionFunction, Equal>)
+        return !(value < min) && !(max < value);
+    if constexpr (std::is_same_v<TConditionFunction, Greater>)
+        return value < max;
+    if constexpr (std::is_same_v<TConditionFunction, GreaterEqual>)
+        return !(max < value);
+    if constexpr (std::is_same_v<TConditionFunction, Less>)
+        return min < value;
+    if constexpr (std::is_same_v<TConditionFunction, LessEqual>)
+        return !(value < min);
+    return true;
+}
+
+// Narrows 'range' to the values matching a condition comparing the column to 'value', see
+// ParentNode::narrow_range(). A null value in the condition is only understood by Equal.
+template <class TConditionFunction>
+bool narrow_range(ValueRange& range, Mixed value)
+{
+    if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+        range.set_lower(value, true);
+        range.set_upper(value, true);
+        return true;
+    }
+    if (value.is_null())
+        return false;
+    if constexpr (std::is_same_v<TConditionFunction, Greater> || std::is_same_v<TConditionFunction, GreaterEqual>) {
+        range.set_lower(value, std::is_same_v<TConditionFunction, GreaterEqual>);
+        return true;
+    }
+    if constexpr (std::is_same_v<TConditionFunction, Less> || std::is_same_v<TConditionFunction, LessEqual>) {
+        range.set_upper(value, std::is_same_v<TConditionFunction, LessEqual>);
+        return true;
+    }
+    return false;
+}
 }
 
 class ColumnNodeBase : public ParentNode {
@@ -439,7 +604,7 @@ protected:
         // it
         for (size_t c = 1; c < m_children.size(); c++) {
             m_children[c]->m_probes++;
-            size_t m = m_children[c]->find_first_local(i, i + 1);
+            size_t m = m_children[c]->find_first_counted(i, i + 1);
             if (m != i)
                 return true;
         }
@@ -498,6 +663,14 @@ protected:
         m_last_local_match = start - 1;
         m_state = st;
 
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::nanoseconds children_time{0};
+        size_t match_count = st->m_match_count;
+        if (m_profile) {
+            start_time = std::chrono::steady_clock::now();
+            children_time = get_children_time();
+        }
+
         // If there are no other nodes than us (m_children.size() == 1) AND the column used for our condition is
         // the same as the column used for the aggregate action, then the entire query can run within scope of that
         // column only, with no references to other columns:
@@ -505,6 +678,10 @@ protected:
         if (fastmode) {
             bool cont;
             cont = m_leaf_ptr->find(c, m_action, m_value, start, end, 0, static_cast<QueryState<int64_t>*>(st));
+            if (m_profile) {
+                // The matches went straight into the state, which stops at the first row past its limit
+                add_search_to_profile(start, end, st->m_match_count - match_count, start_time, children_time);
+            }
             if (!cont)
                 return not_found;
         }
@@ -514,6 +691,10 @@ protected:
         else {
             m_source_column = source_column;
             bool cont = (this->*m_find_callback_specialized)(start, end);
+            if (m_profile) {
+                size_t next = (cont && m_local_matches != m_local_limit) ? end : m_last_local_match + 1;
+                add_search_to_profile(start, next, m_local_matches, start_time, children_time);
+            }
             if (!cont)
                 return not_found;
         }
@@ -562,6 +743,17 @@ protected:
         m_dD = _impl::CostHeuristic<LeafType>::dD();
     }
 
+    template <class TConditionFunction>
+    bool summary_may_match(const Cluster* cluster) const
+    {
+        Cluster::ColumnSummary summary;
+        if (!cluster->get_column_summary(m_condition_column_key, summary))
+            return true;
+        util::Optional<int64_t> value = m_value;
+        return _impl::may_match_summary<TConditionFunction>(value.value_or(0), !value, summary.min, summary.max,
+                                                            summary.null_count, cluster->node_size());
+    }
+
     bool should_run_in_fastmode(ArrayPayload* source_leaf) const
     {
         if (m_children.size() > 1 || m_fastmode_disabled)
@@ -674,6 +866,15 @@ public:
     {
     }
 
+    void init(bool will_query_ranges) override
+    {
+        BaseType::init(will_query_ranges);
+        util::Optional<int64_t> value = this->m_value;
+        this->set_match_fraction(this->estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            return _impl::estimate_match_fraction<TConditionFunction>(statistics, double(value.value_or(0)), !value);
+        }));
+    }
+
     void aggregate_local_prepare(Action action, DataType col_id, bool is_nullable) override
     {
         this->m_fastmode_disabled = (col_id == type_Float || col_id == type_Double);
@@ -695,6 +896,27 @@ public:
         return this->m_leaf_ptr->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
+    void find_all_bits(size_t start, size_t end, size_t base, uint64_t* bits) override
+    {
+        this->m_leaf_ptr->template find<TConditionFunction, act_CallbackIdx>(this->m_value, start, end, 0, nullptr,
+                                                                             _impl::SetMatchBit{bits, base});
+    }
+
+    bool has_find_all_bits() const override
+    {
+        return true;
+    }
+
+    bool may_match(const Cluster* cluster) const override
+    {
+        return this->template summary_may_match<TConditionFunction>(cluster);
+    }
+
+    bool narrow_range(ValueRange& range) const override
+    {
+        return _impl::narrow_range<TConditionFunction>(range, Mixed(this->m_value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         return state.describe_column(ParentNode::m_table, ColumnNodeBase::m_condition_column_key) + " " +
@@ -754,6 +976,20 @@ public:
         BaseType::init(will_query_ranges);
         m_nb_needles = m_needles.size();
 
+        double fraction = this->estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            auto estimate = [&](util::Optional<int64_t> value) {
+                return _impl::estimate_match_fraction<Equal>(statistics, double(value.value_or(0)), !value);
+            };
+            if (m_needles.empty())
+                return estimate(this->m_value);
+            double sum = 0;
+            for (auto& needle : m_needles)
+                sum += estimate(needle);
+            return std::min(sum, 1.0);
+        });
+        this->set_match_fraction(fraction);
+        m_scan_instead_of_index = fraction > index_scan_threshold;
+
         if (has_search_index()) {
             // _search_index_init();
             m_result.clear();
@@ -779,7 +1015,16 @@ public:
 
     bool has_search_index() const override
     {
-        return this->m_table->has_search_index(IntegerNodeBase<LeafType>::m_condition_column_key);
+        return !m_scan_instead_of_index &&
+               this->m_table->has_search_index(IntegerNodeBase<LeafType>::m_condition_column_key);
+    }
+
+    bool may_match(const Cluster* cluster) const override
+    {
+        // The summary is only checked against the value of a single condition
+        if (!m_needles.empty())
+            return true;
+        return this->template summary_may_match<Equal>(cluster);
     }
 
     void index_based_aggregate(size_t limit, Evaluator evaluator) override
@@ -860,6 +1105,27 @@ public:
         return s;
     }
 
+    void find_all_bits(size_t start, size_t end, size_t base, uint64_t* bits) override
+    {
+        if (m_nb_needles) {
+            ParentNode::find_all_bits(start, end, base, bits);
+            return;
+        }
+        // The leaf is scanned even if the column has a search index, as all rows of the range are tested
+        this->m_leaf_ptr->template find<Equal, act_CallbackIdx>(this->m_value, start, end, 0, nullptr,
+                                                                _impl::SetMatchBit{bits, base});
+    }
+
+    bool has_find_all_bits() const override
+    {
+        return m_needles.empty();
+    }
+
+    bool narrow_range(ValueRange& range) const override
+    {
+        return m_needles.empty() && _impl::narrow_range<Equal>(range, Mixed(this->m_value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(this->m_condition_column_key);
@@ -895,10 +1161,12 @@ private:
     size_t m_nb_needles = 0;
     size_t m_result_get = 0;
     ObjKey m_last_start_key;
+    bool m_scan_instead_of_index = false; // Set by init() if the statistics tell that too many objects match
 
     IntegerNode(const IntegerNode<LeafType, Equal>& from)
         : BaseType(from)
         , m_needles(from.m_needles)
+        , m_scan_instead_of_index(from.m_scan_instead_of_index)
     {
     }
 };
@@ -941,28 +1209,36 @@ public:
     {
         ParentNode::init(will_query_ranges);
         m_dD = 100.0;
+        set_match_fraction(estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            return _impl::estimate_match_fraction<TConditionFunction>(statistics, double(m_value),
+                                                                      null::is_null_float(m_value));
+        }));
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
-        TConditionFunction cond;
+        return m_leaf_ptr->template find_first<TConditionFunction>(m_value, start, end);
+    }
 
-        auto find = [&](bool nullability) {
-            bool m_value_nan = nullability ? null::is_null_float(m_value) : false;
-            for (size_t s = start; s < end; ++s) {
-                TConditionValue v = m_leaf_ptr->get(s);
-                REALM_ASSERT(!(null::is_null_float(v) && !nullability));
-                if (cond(v, m_value, nullability ? null::is_null_float<TConditionValue>(v) : false, m_value_nan))
-                    return s;
-            }
-            return not_found;
-        };
+    bool may_match(const Cluster* cluster) const override
+    {
+        Cluster::ColumnSummary summary;
+        if (!cluster->get_column_summary(m_condition_column_key, summary))
+            return true;
+        double min, max;
+        std::memcpy(&min, &summary.min, sizeof(min));
+        std::memcpy(&max, &summary.max, sizeof(max));
+        return _impl::may_match_summary<TConditionFunction>(double(m_value), null::is_null_float(m_value), min, max,
+                                                            summary.null_count, cluster->node_size());
+    }
 
-        // This will inline the second case but no the first. Todo, use templated lambda when switching to c++14
-        if (m_table->is_nullable(m_condition_column_key))
-            return find(true);
-        else
-            return find(false);
+    bool narrow_range(ValueRange& range) const override
+    {
+        if constexpr (std::is_same_v<TConditionValue, double>) {
+            if (!std::isnan(m_value))
+                return _impl::narrow_range<TConditionFunction>(range, Mixed(m_value));
+        }
+        return false;
     }
 
     std::string describe(util::serializer::SerialisationState& state) const override
@@ -997,6 +1273,101 @@ protected:
     const LeafType* m_leaf_ptr = nullptr;
 };
 
+// Matches values in the closed range [from, to], with a single pass over the leaf
+template <class LeafType>
+class FloatDoubleBetweenNode : public ParentNode {
+public:
+    using TConditionValue = typename LeafType::value_type;
+    static const bool special_null_node = false;
+
+    FloatDoubleBetweenNode(TConditionValue from, TConditionValue to, ColKey column_key)
+        : m_from(from)
+        , m_to(to)
+    {
+        m_condition_column_key = column_key;
+        m_dT = 1.0;
+    }
+
+    void cluster_changed() override
+    {
+        m_array_ptr = nullptr;
+        m_array_ptr = LeafPtr(new (&m_leaf_cache_storage) LeafType(m_table.unchecked_ptr()->get_alloc()));
+        m_cluster->init_leaf(this->m_condition_column_key, m_array_ptr.get());
+        m_leaf_ptr = m_array_ptr.get();
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        ParentNode::init(will_query_ranges);
+        m_dD = 100.0;
+        set_match_fraction(estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            double to = statistics.less_fraction(double(m_to), true);
+            double from = statistics.less_fraction(double(m_from), false);
+            return to < 0 || from < 0 ? -1.0 : std::max(0.0, to - from);
+        }));
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        return m_leaf_ptr->find_first_between(m_from, m_to, start, end);
+    }
+
+    bool may_match(const Cluster* cluster) const override
+    {
+        Cluster::ColumnSummary summary;
+        if (!cluster->get_column_summary(m_condition_column_key, summary))
+            return true;
+        double min, max;
+        std::memcpy(&min, &summary.min, sizeof(min));
+        std::memcpy(&max, &summary.max, sizeof(max));
+        size_t sz = cluster->node_size();
+        return _impl::may_match_summary<GreaterEqual>(double(m_from), false, min, max, summary.null_count, sz) &&
+               _impl::may_match_summary<LessEqual>(double(m_to), false, min, max, summary.null_count, sz);
+    }
+
+    bool narrow_range(ValueRange& range) const override
+    {
+        if constexpr (std::is_same_v<TConditionValue, double>) {
+            if (!std::isnan(m_from) && !std::isnan(m_to)) {
+                range.set_lower(Mixed(m_from), true);
+                range.set_upper(Mixed(m_to), true);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column_key);
+        std::string column = state.describe_column(ParentNode::m_table, m_condition_column_key);
+        return "(" + column + " " + GreaterEqual::description() + " " + util::serializer::print_value(m_from) +
+               " and " + column + " " + LessEqual::description() + " " + util::serializer::print_value(m_to) + ")";
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new FloatDoubleBetweenNode(*this));
+    }
+
+    FloatDoubleBetweenNode(const FloatDoubleBetweenNode& from)
+        : ParentNode(from)
+        , m_from(from.m_from)
+        , m_to(from.m_to)
+    {
+    }
+
+private:
+    TConditionValue m_from;
+    TConditionValue m_to;
+    // Leaf cache
+    using LeafCacheStorage = typename std::aligned_storage<sizeof(LeafType), alignof(LeafType)>::type;
+    using LeafPtr = std::unique_ptr<LeafType, PlacementDelete>;
+    LeafCacheStorage m_leaf_cache_storage;
+    LeafPtr m_array_ptr;
+    const LeafType* m_leaf_ptr = nullptr;
+};
+
 template <class T, class TConditionFunction>
 class SizeNode : public ParentNode {
 public:
@@ -1228,10 +1599,18 @@ public:
         ParentNode::init(will_query_ranges);
 
         m_dD = 100.0;
+        set_match_fraction(estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            return _impl::estimate_match_fraction<TConditionFunction>(statistics, m_value.value_or(false) ? 1.0 : 0.0,
+                                                                      !m_value);
+        }));
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        // Null is stored as a value of its own, so equality can be tested on the stored values
+        if constexpr (std::is_same_v<TConditionFunction, Equal> || std::is_same_v<TConditionFunction, NotEqual>) {
+            return m_leaf_ptr->template find_first<TConditionFunction>(m_value, start, end);
+        }
         TConditionFunction condition;
         bool m_value_is_null = !m_value;
         for (size_t s = start; s < end; ++s) {
@@ -1242,6 +1621,22 @@ public:
         return not_found;
     }
 
+    void find_all_bits(size_t start, size_t end, size_t base, uint64_t* bits) override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal> || std::is_same_v<TConditionFunction, NotEqual>) {
+            m_leaf_ptr->template find_matches<TConditionFunction>(m_value, start, end,
+                                                                  _impl::SetMatchBit{bits, base});
+        }
+        else {
+            ParentNode::find_all_bits(start, end, base, bits);
+        }
+    }
+
+    bool has_find_all_bits() const override
+    {
+        return std::is_same_v<TConditionFunction, Equal> || std::is_same_v<TConditionFunction, NotEqual>;
+    }
+
     virtual std::string describe(util::serializer::SerialisationState& state) const override
     {
         return state.describe_column(ParentNode::m_table, m_condition_column_key) + " " +
@@ -1313,11 +1708,43 @@ class TimestampNode : public TimestampNodeBase {
 public:
     using TimestampNodeBase::TimestampNodeBase;
 
+    void init(bool will_query_ranges) override
+    {
+        TimestampNodeBase::init(will_query_ranges);
+        set_match_fraction(estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            if (m_value.is_null())
+                return _impl::estimate_match_fraction<TConditionFunction>(statistics, 0.0, true);
+            double seconds = double(m_value.get_seconds()) + m_value.get_nanoseconds() * 1e-9;
+            return _impl::estimate_match_fraction<TConditionFunction>(statistics, seconds, false);
+        }));
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
         return m_leaf_ptr->find_first<TConditionFunction>(m_value, start, end);
     }
 
+    bool may_match(const Cluster* cluster) const override
+    {
+        // The summary only holds the seconds, so strict conditions must include the bounds, and values with equal
+        // seconds may still differ
+        using SecondsCondition = std::conditional_t<
+            std::is_same_v<TConditionFunction, Greater>, GreaterEqual,
+            std::conditional_t<std::is_same_v<TConditionFunction, Less>, LessEqual, TConditionFunction>>;
+        Cluster::ColumnSummary summary;
+        if (std::is_same_v<TConditionFunction, NotEqual> ||
+            !cluster->get_column_summary(m_condition_column_key, summary))
+            return true;
+        return _impl::may_match_summary<SecondsCondition>(m_value.is_null() ? 0 : m_value.get_seconds(),
+                                                          m_value.is_null(), summary.min, summary.max,
+                                                          summary.null_count, cluster->node_size());
+    }
+
+    bool narrow_range(ValueRange& range) const override
+    {
+        return _impl::narrow_range<TConditionFunction>(range, Mixed(m_value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(m_condition_column_key);
@@ -1390,14 +1817,7 @@ public:
 
     size_t find_first_local(size_t start, size_t end) override
     {
-        TConditionFunction cond;
-        bool value_is_null = m_value.is_null();
-        for (size_t i = start; i < end; i++) {
-            Decimal128 val = m_leaf_ptr->get(i);
-            if (cond(val, m_value, val.is_null(), value_is_null))
-                return i;
-        }
-        return realm::npos;
+        return m_leaf_ptr->find_first<TConditionFunction>(m_value, start, end);
     }
 
     std::string describe(util::serializer::SerialisationState& state) const override
@@ -1474,6 +1894,14 @@ class ObjectIdNode : public ObjectIdNodeBase {
 public:
     using ObjectIdNodeBase::ObjectIdNodeBase;
 
+    void init(bool will_query_ranges) override
+    {
+        ObjectIdNodeBase::init(will_query_ranges);
+        set_match_fraction(estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            return _impl::estimate_match_fraction<TConditionFunction>(statistics, m_value_is_null);
+        }));
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
         TConditionFunction cond;
@@ -1491,6 +1919,22 @@ public:
         return realm::npos;
     }
 
+    bool may_match(const Cluster* cluster) const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            util::Optional<ObjectId> value;
+            if (!m_value_is_null)
+                value = m_value;
+            return cluster->may_contain(m_condition_column_key, Cluster::get_filter_hash(value));
+        }
+        return true;
+    }
+
+    bool narrow_range(ValueRange& range) const override
+    {
+        return _impl::narrow_range<TConditionFunction>(range, m_value_is_null ? Mixed() : Mixed(m_value));
+    }
+
     std::string describe(util::serializer::SerialisationState& state) const override
     {
         REALM_ASSERT(m_condition_column_key);
@@ -1512,6 +1956,112 @@ protected:
     }
 };
 
+// Equality conditions on Mixed columns. Values of a given type can only be
+// equal to values of the same type.
+template <class TConditionFunction>
+class MixedNode : public ParentNode {
+public:
+    using TConditionValue = Mixed;
+    static const bool special_null_node = false;
+    static_assert(std::is_same_v<TConditionFunction, Equal> || std::is_same_v<TConditionFunction, NotEqual>,
+                  "Only Equal and NotEqual are supported on Mixed columns");
+
+    MixedNode(Mixed v, ColKey column)
+        : m_value(v)
+    {
+        m_condition_column_key = column;
+        // Mixed only refers to string and binary data, so keep a copy
+        if (!m_value.is_null() && m_value.get_type() == type_String) {
+            StringData str = m_value.get_string();
+            m_buffer.assign(str.data(), str.size());
+            m_value = StringData(m_buffer);
+        }
+        else if (!m_value.is_null() && m_value.get_type() == type_Binary) {
+            BinaryData bin = m_value.get_binary();
+            m_buffer.assign(bin.data(), bin.size());
+            m_value = BinaryData(m_buffer.data(), m_buffer.size());
+        }
+    }
+
+    MixedNode(null, ColKey column)
+        : MixedNode(Mixed{}, column)
+    {
+    }
+
+    void cluster_changed() override
+    {
+        m_array_ptr = nullptr;
+        m_array_ptr = LeafPtr(new (&m_leaf_cache_storage) ArrayMixed(m_table.unchecked_ptr()->get_alloc()));
+        m_cluster->init_leaf(this->m_condition_column_key, m_array_ptr.get());
+        m_leaf_ptr = m_array_ptr.get();
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        ParentNode::init(will_query_ranges);
+
+        m_dD = 100.0;
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            // Searches the typed payload of the leaf with the integer search where possible
+            return m_leaf_ptr->find_first(m_value, start, end);
+        }
+        else {
+            for (size_t i = start; i < end; i++) {
+                Mixed val = m_leaf_ptr->get(i);
+                bool equal = val.is_null() || m_value.is_null()
+                                 ? val.is_null() == m_value.is_null()
+                                 : val.get_type() == m_value.get_type() && val == m_value;
+                if (!equal)
+                    return i;
+            }
+            return realm::npos;
+        }
+    }
+
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        REALM_ASSERT(m_condition_column_key);
+        std::string value;
+        if (m_value.is_null())
+            value = util::serializer::print_value(realm::null());
+        else if (m_value.get_type() == type_String)
+            value = util::serializer::print_value(m_value.get_string());
+        else
+            value = util::serializer::print_value(m_value);
+        return state.describe_column(ParentNode::m_table, m_condition_column_key) + " " +
+               TConditionFunction::description() + " " + value;
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new MixedNode(*this));
+    }
+
+protected:
+    MixedNode(const MixedNode& from)
+        : ParentNode(from)
+        , m_value(from.m_value)
+        , m_buffer(from.m_buffer)
+    {
+        if (!m_value.is_null() && m_value.get_type() == type_String)
+            m_value = StringData(m_buffer);
+        else if (!m_value.is_null() && m_value.get_type() == type_Binary)
+            m_value = BinaryData(m_buffer.data(), m_buffer.size());
+    }
+
+    Mixed m_value;
+    std::string m_buffer;
+    using LeafCacheStorage = typename std::aligned_storage<sizeof(ArrayMixed), alignof(ArrayMixed)>::type;
+    using LeafPtr = std::unique_ptr<ArrayMixed, PlacementDelete>;
+    LeafCacheStorage m_leaf_cache_storage;
+    LeafPtr m_array_ptr;
+    const ArrayMixed* m_leaf_ptr = nullptr;
+};
+
 class StringNodeBase : public ParentNode {
 public:
     using TConditionValue = StringData;
@@ -1637,6 +2187,18 @@ public:
         return not_found;
     }
 
+    bool narrow_range(ValueRange& range) const override
+    {
+        // An empty prefix also matches null
+        if constexpr (std::is_same_v<TConditionFunction, BeginsWith>) {
+            if (m_value && !m_value->empty()) {
+                range.set_prefix(StringData(*m_value));
+                return true;
+            }
+        }
+        return false;
+    }
+
     virtual std::string describe_condition() const override
     {
         return TConditionFunction::description();
@@ -1877,8 +2439,56 @@ public:
     void table_changed() override
     {
         StringNodeBase::table_changed();
-        m_has_search_index = m_table.unchecked_ptr()->has_search_index(m_condition_column_key) ||
-                             m_table.unchecked_ptr()->get_primary_key_column() == m_condition_column_key;
+        m_has_search_index = has_index_on_column();
+    }
+
+    void cluster_changed() override
+    {
+        StringNodeEqualBase::cluster_changed();
+        // A leaf with a dictionary of its own is searched by the index of the value in that dictionary
+        m_leaf_has_dictionary = !m_has_search_index && m_needles.empty() && m_leaf_ptr->has_dictionary();
+        if (m_leaf_has_dictionary)
+            m_dictionary_key = m_leaf_ptr->find_dictionary_key(m_value);
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        double fraction = estimate_match_fraction([&](const ColumnStatistics& statistics) {
+            if (m_needles.empty())
+                return _impl::estimate_match_fraction<Equal>(statistics, !m_value);
+            double sum = 0;
+            for (auto& needle : m_needles)
+                sum += _impl::estimate_match_fraction<Equal>(statistics, needle.is_null());
+            return std::min(sum, 1.0);
+        });
+        // The choice must be made before the search index is initialized
+        m_has_search_index = has_index_on_column() && !(fraction > index_scan_threshold);
+        StringNodeEqualBase::init(will_query_ranges);
+        set_match_fraction(fraction);
+        m_filter_hashes.clear();
+        if (m_needles.empty()) {
+            m_filter_hashes.push_back(Cluster::get_filter_hash(StringData(m_value)));
+        }
+        else {
+            for (auto& needle : m_needles)
+                m_filter_hashes.push_back(Cluster::get_filter_hash(needle));
+        }
+    }
+
+    bool may_match(const Cluster* cluster) const override
+    {
+        for (auto hash : m_filter_hashes) {
+            if (cluster->may_contain(m_condition_column_key, hash))
+                return true;
+        }
+        return false;
+    }
+
+    bool narrow_range(ValueRange& range) const override
+    {
+        if (!m_needles.empty() || (m_value && m_value->empty()))
+            return false;
+        return _impl::narrow_range<Equal>(range, m_value ? Mixed(StringData(*m_value)) : Mixed());
     }
 
     void _search_index_init() override;
@@ -1929,6 +2539,12 @@ public:
 private:
     std::unique_ptr<IntegerColumn> m_index_matches;
 
+    bool has_index_on_column() const
+    {
+        return m_table.unchecked_ptr()->has_search_index(m_condition_column_key) ||
+               m_table.unchecked_ptr()->get_primary_key_column() == m_condition_column_key;
+    }
+
     ObjKey get_key(size_t ndx) override
     {
         if (IntegerColumn* vec = m_index_matches.get()) {
@@ -1943,6 +2559,9 @@ private:
     size_t _find_first_local(size_t start, size_t end) override;
     std::unordered_set<StringData> m_needles;
     std::vector<std::unique_ptr<char[]>> m_needle_storage;
+    std::vector<uint64_t> m_filter_hashes;
+    bool m_leaf_has_dictionary = false;
+    size_t m_dictionary_key = realm::not_found;
 };
 
 
@@ -2019,6 +2638,100 @@ private:
     size_t _find_first_local(size_t start, size_t end) override;
 };
 
+// A sequence of ANDed conditions that can all find their matches in bulk, see ParentNode::has_find_all_bits(). Rather
+// than testing each match of one condition on the others, the conditions are evaluated together on blocks of rows:
+// the first sets a bit for each row of the block that it matches, and each following condition clears the bits of
+// the rows it does not match. Adjacent integer and bool conditions are grouped in a ConjunctionNode by regroup().
+class ConjunctionNode : public ParentNode {
+public:
+    // Groups the adjacent conditions of the chain starting at 'first' that can find their matches in bulk, and are
+    // not better served by a search index, in ConjunctionNodes. As that depends on the indexes and statistics of
+    // the table, it is done anew after every init() of the chain, starting by undoing the previous grouping.
+    static void regroup(std::unique_ptr<ParentNode>& first, ConstTableRef table);
+
+    ConjunctionNode(std::unique_ptr<ParentNode> condition)
+    {
+        add_condition(std::move(condition));
+    }
+
+    ConjunctionNode(const ConjunctionNode& from)
+        : ParentNode(from)
+    {
+        for (auto& condition : from.m_conditions)
+            m_conditions.emplace_back(condition->clone());
+    }
+
+    void add_condition(std::unique_ptr<ParentNode> condition)
+    {
+        REALM_ASSERT(!condition->m_child);
+        if (m_table)
+            condition->set_table(m_table);
+        m_conditions.emplace_back(std::move(condition));
+    }
+
+    void table_changed() override
+    {
+        for (auto& condition : m_conditions)
+            condition->set_table(m_table);
+    }
+
+    void cluster_changed() override
+    {
+        for (auto& condition : m_conditions)
+            condition->set_cluster(m_cluster);
+        m_block_start = m_block_end = 0;
+    }
+
+    void init(bool will_query_ranges) override;
+
+    size_t find_first_local(size_t start, size_t end) override;
+
+    bool may_match(const Cluster* cluster) const override
+    {
+        for (auto& condition : m_conditions) {
+            if (!condition->cluster_may_match(cluster))
+                return false;
+        }
+        return true;
+    }
+
+    std::string describe(util::serializer::SerialisationState& state) const override
+    {
+        std::string s;
+        for (auto& condition : m_conditions) {
+            if (!s.empty())
+                s += " and ";
+            s += condition->describe(state);
+        }
+        return s;
+    }
+
+    std::unique_ptr<ParentNode> clone() const override
+    {
+        return std::unique_ptr<ParentNode>(new ConjunctionNode(*this));
+    }
+
+    // In the order they were added to the query
+    std::vector<std::unique_ptr<ParentNode>> m_conditions;
+
+private:
+    static constexpr size_t block_size = 1024;
+    static constexpr size_t block_words = block_size / 64;
+
+    // The conditions, the ones expected to match the fewest rows first
+    std::vector<ParentNode*> m_order;
+    // The rows of the cluster in [m_block_start, m_block_end) that match all conditions
+    std::array<uint64_t, block_words> m_bits;
+    size_t m_block_start = 0;
+    size_t m_block_end = 0;
+
+    void estimate();
+    void evaluate_block(size_t block_start, size_t block_end);
+    // Add the rows a condition examined in the block, and those still matching, to the condition's profile
+    void add_block_to_profile(ParentNode& condition, size_t rows_examined,
+                              std::chrono::steady_clock::time_point start_time) const;
+};
+
 // OR node contains at least two node pointers: Two or more conditions to OR
 // together in m_conditions, and the next AND condition (if any) in m_child.
 //
@@ -2110,6 +2823,7 @@ public:
         std::vector<ParentNode*> v;
         for (auto& condition : m_conditions) {
             condition->init(will_query_ranges);
+            ConjunctionNode::regroup(condition, m_table);
             v.clear();
             condition->gather_children(v);
         }
@@ -2234,6 +2948,7 @@ public:
         std::vector<ParentNode*> v;
 
         m_condition->init(false);
+        ConjunctionNode::regroup(m_condition, m_table);
         v.clear();
         m_condition->gather_children(v);
     }
@@ -145,6 +145,7 @@ The Columns class encapsulates all this into a simple class that, for any type T
 #include <realm/util/optional.hpp>
 #include <realm/util/serializer.hpp>
 
+#include <array>
 #include <numeric>
 #include <algorithm>
 
@@ -343,6 +344,8 @@ struct Common<T1, T2, true, false, b> {
 
 struct ValueBase {
     static const size_t chunk_size = 8;
+    // The number of rows evaluated at a time by Subexpr::evaluate_batch()
+    static constexpr size_t batch_size = 256;
     virtual void export_bool(ValueBase& destination) const = 0;
     virtual void export_Timestamp(ValueBase& destination) const = 0;
     virtual void export_ObjectId(ValueBase& destination) const = 0;
@@ -449,6 +452,19 @@ public:
     virtual DataType get_type() const = 0;
 
     virtual void evaluate(size_t index, ValueBase& destination) = 0;
+
+    // Evaluate the 'count' rows of the current cluster starting at 'index' into 'destination' in one go, which
+    // avoids a virtual call and a conversion of the values every ValueBase::chunk_size rows. Only subexpressions that
+    // return true from has_batch_evaluation() produce exactly 'count' values, others fall back to evaluate().
+    virtual void evaluate_batch(size_t index, size_t, ValueBase& destination)
+    {
+        evaluate(index, destination);
+    }
+    virtual bool has_batch_evaluation() const
+    {
+        return false;
+    }
+
     // This function supports SubColumnAggregate
     virtual void evaluate(ObjKey, ValueBase&)
     {
@@ -1403,6 +1419,32 @@ public:
         }
     }
 
+    // Like fun() for a batch of 'count' rows, where an operand holding a single value is a constant used for all
+    // of them
+    template <class TOperator>
+    REALM_FORCEINLINE void fun_batch(const Value* left, const Value* right, size_t count)
+    {
+        REALM_ASSERT_DEBUG(left->m_values == count || left->m_values == 1);
+        REALM_ASSERT_DEBUG(right->m_values == count || right->m_values == 1);
+        init(false, count);
+
+        OperatorOptionalAdapter<TOperator> o;
+        if (left->m_values != count) {
+            auto left_value = left->m_storage.get(0);
+            for (size_t i = 0; i < count; i++)
+                m_storage.set(i, o(left_value, right->m_storage.get(i)));
+        }
+        else if (right->m_values != count) {
+            auto right_value = right->m_storage.get(0);
+            for (size_t i = 0; i < count; i++)
+                m_storage.set(i, o(left->m_storage.get(i), right_value));
+        }
+        else {
+            for (size_t i = 0; i < count; i++)
+                m_storage.set(i, o(left->m_storage.get(i), right->m_storage.get(i)));
+        }
+    }
+
 
     // Below import and export methods are for type conversion between float, double, int64_t, etc.
     template <class D>
@@ -3640,8 +3682,15 @@ public:
             m_link_map.set_cluster(cluster);
         }
         else {
-            // Create new Leaf
-            m_array_ptr = LeafPtr(new (&m_leaf_cache_storage) LeafType(get_base_table()->get_alloc()));
+            // Create new Leaf. The leaves of a nullable integer column may hold a validity bitmap, which only
+            // ArrayIntNull reads.
+            Allocator& alloc = get_base_table()->get_alloc();
+            if constexpr (std::is_same_v<typename LeafType::value_type, int64_t>) {
+                if (m_nullable)
+                    m_array_ptr = LeafPtr(new (&m_leaf_cache_storage) ArrayIntNull(alloc));
+            }
+            if (!m_array_ptr)
+                m_array_ptr = LeafPtr(new (&m_leaf_cache_storage) LeafType(alloc));
             cluster->init_leaf(m_column_key, m_array_ptr.get());
             m_leaf_ptr = m_array_ptr.get();
         }
@@ -3754,6 +3803,54 @@ public:
         }
     }
 
+    template <class LeafType2 = LeafType>
+    void evaluate_batch_internal(size_t index, size_t count, ValueBase& destination)
+    {
+        using U = typename util::RemoveOptional<typename LeafType2::value_type>::type;
+        static_assert(std::is_same_v<U, typename util::RemoveOptional<T>::type>, "");
+
+        REALM_ASSERT(m_leaf_ptr != nullptr);
+        auto leaf = static_cast<const LeafType2*>(m_leaf_ptr);
+        REALM_ASSERT_DEBUG(index + count <= leaf->size());
+
+        // The values are read straight into the destination if it is of their type, and converted otherwise
+        auto direct = dynamic_cast<Value<U>*>(&destination);
+        Value<U>& v = direct ? *direct : m_batch;
+        v.init(false, count);
+        auto& storage = v.m_storage;
+
+        if constexpr (realm::is_any<LeafType2, ArrayInteger, ArrayIntNull>::value) {
+            int64_t* values = storage.m_first;
+            bool has_nulls = false;
+            if constexpr (std::is_same_v<LeafType2, ArrayIntNull>)
+                has_nulls = leaf->get_range(index, index + count, values) != 0;
+            else
+                leaf->get_range(index, index + count, values);
+            if (REALM_UNLIKELY(std::find(values, values + count, storage.m_null) != values + count)) {
+                // A value is the one standing for null in the vector, which set() replaces
+                for (size_t t = 0; t < count; t++)
+                    storage.set(t, leaf->get(index + t));
+            }
+            else if constexpr (std::is_same_v<LeafType2, ArrayIntNull>) {
+                for (size_t t = 0; has_nulls && t < count; t++) {
+                    if (leaf->is_null(index + t))
+                        storage.set_null(t);
+                }
+            }
+        }
+        else if constexpr (realm::is_any<U, float, double>::value) {
+            // Nulls are stored as NaN values that the vector understands too
+            leaf->get_range(index, index + count, storage.m_first);
+        }
+        else {
+            for (size_t t = 0; t < count; t++)
+                storage.set(t, leaf->get(index + t));
+        }
+
+        if (!direct)
+            destination.import(v);
+    }
+
     virtual std::string description(util::serializer::SerialisationState& state) const override
     {
         return state.describe_expression_type(m_comparison_type) + state.describe_columns(m_link_map, m_column_key);
@@ -3773,6 +3870,32 @@ public:
         }
     }
 
+    void evaluate_batch(size_t index, size_t count, ValueBase& destination) override
+    {
+        if (links_exist()) {
+            evaluate(index, destination);
+            return;
+        }
+        if constexpr (std::is_same_v<typename LeafType::value_type, int64_t>) {
+            if (m_nullable) {
+                evaluate_batch_internal<ArrayIntNull>(index, count, destination);
+                return;
+            }
+        }
+        if constexpr (std::is_same_v<typename LeafType::value_type, bool>) {
+            if (m_nullable) {
+                evaluate_batch_internal<ArrayBoolNull>(index, count, destination);
+                return;
+            }
+        }
+        evaluate_batch_internal<LeafType>(index, count, destination);
+    }
+
+    bool has_batch_evaluation() const override
+    {
+        return !links_exist();
+    }
+
     void evaluate(ObjKey key, ValueBase& destination) override
     {
         auto table = m_link_map.get_target_table();
@@ -3828,8 +3951,9 @@ public:
 private:
     LinkMap m_link_map;
 
-    // Leaf cache
-    using LeafCacheStorage = typename std::aligned_storage<sizeof(LeafType), alignof(LeafType)>::type;
+    // Leaf cache, which also fits the leaves of a nullable integer column
+    using LeafCacheStorage = typename std::aligned_storage<std::max(sizeof(LeafType), sizeof(ArrayIntNull)),
+                                                           std::max(alignof(LeafType), alignof(ArrayIntNull))>::type;
     using LeafPtr = std::unique_ptr<ArrayPayload, PlacementDelete>;
     LeafCacheStorage m_leaf_cache_storage;
     LeafPtr m_array_ptr;
@@ -3842,6 +3966,9 @@ private:
     // or column. Call init() to update it or use a constructor that takes table + column index as argument.
     bool m_nullable = false;
     ExpressionComparisonType m_comparison_type = ExpressionComparisonType::Any;
+
+    // Values of a batch that are converted to another type by the destination
+    Value<typename util::RemoveOptional<T>::type> m_batch;
 };
 
 template <typename T, typename Operation>
@@ -4397,6 +4524,24 @@ public:
         destination.import(result);
     }
 
+    void evaluate_batch(size_t index, size_t count, ValueBase& destination) override
+    {
+        // A constant operand evaluates to a single value, which is used for all rows
+        m_left->evaluate_batch(index, count, m_left_values);
+        m_right->evaluate_batch(index, count, m_right_values);
+        auto direct = dynamic_cast<Value<T>*>(&destination);
+        Value<T>& result = direct ? *direct : m_result;
+        result.template fun_batch<oper>(&m_left_values, &m_right_values, count);
+        if (!direct)
+            destination.import(result);
+    }
+
+    bool has_batch_evaluation() const override
+    {
+        return (m_left->has_batch_evaluation() || m_left->has_constant_evaluation()) &&
+               (m_right->has_batch_evaluation() || m_right->has_constant_evaluation());
+    }
+
     virtual std::string description(util::serializer::SerialisationState& state) const override
     {
         std::string s;
@@ -4419,6 +4564,11 @@ private:
     typedef typename oper::type T;
     std::unique_ptr<TLeft> m_left;
     std::unique_ptr<TRight> m_right;
+
+    // The operands and result of the last batch evaluated, kept to reuse their storage
+    Value<T> m_left_values;
+    Value<T> m_right_values;
+    Value<T> m_result;
 };
 
 namespace {
@@ -4457,10 +4607,9 @@ public:
 
     void set_cluster(const Cluster* cluster) override
     {
-        if (m_has_matches) {
-            m_cluster = cluster;
-        }
-        else {
+        m_cluster = cluster;
+        m_batch_start = m_batch_end = 0;
+        if (!m_has_matches) {
             m_left->set_cluster(cluster);
             m_right->set_cluster(cluster);
         }
@@ -4469,6 +4618,10 @@ public:
     double init() override
     {
         double dT = m_left_is_const ? 10.0 : 50.0;
+        // Comparisons of columns of the table, or of arithmetic on them, are evaluated a batch of rows at a time
+        m_batched = m_right->get_comparison_type() == ExpressionComparisonType::Any &&
+                    m_right->has_batch_evaluation() && (m_left_is_const || m_left->has_batch_evaluation());
+        m_batch_start = m_batch_end = 0;
         if (std::is_same_v<TCond, Equal> && m_left_is_const && m_right->has_search_index() &&
             m_right->get_comparison_type() == ExpressionComparisonType::Any) {
             if (m_left_value.m_storage.is_null(0)) {
@@ -4557,6 +4710,9 @@ public:
             return m_cluster->lower_bound_key(ObjKey(actual_key.value - m_cluster->get_offset()));
         }
 
+        if (m_batched)
+            return find_first_batched(start, end);
+
         size_t match;
         Value<T> right;
         const ExpressionComparisonType right_cmp_type = m_right->get_comparison_type();
@@ -4611,6 +4767,57 @@ public:
     }
 
 private:
+    // Compares a batch of rows from 'start', or just that row if it is tested on its own, and remembers which of
+    // them matched so that the search for the next match goes on from there
+    size_t find_first_batched(size_t start, size_t end) const
+    {
+        while (start < end) {
+            if (start < m_batch_start || start >= m_batch_end) {
+                size_t count = end - start == 1 ? 1 : std::min(ValueBase::batch_size, m_cluster->node_size() - start);
+                compare_batch(start, count);
+            }
+            size_t stop = std::min(end, m_batch_end);
+            size_t bit = start - m_batch_start;
+            size_t stop_bit = stop - m_batch_start;
+            while (bit < stop_bit) {
+                uint64_t word = m_batch_matches[bit / 64] >> (bit % 64);
+                if (word) {
+                    size_t match = bit + ctz(word);
+                    return match < stop_bit ? m_batch_start + match : not_found;
+                }
+                bit = (bit / 64 + 1) * 64;
+            }
+            start = stop;
+        }
+        return not_found;
+    }
+
+    void compare_batch(size_t start, size_t count) const
+    {
+        REALM_ASSERT_DEBUG(count <= ValueBase::batch_size);
+        m_right->evaluate_batch(start, count, m_right_values);
+        const Value<T>* left = &m_left_value;
+        if (!m_left_is_const) {
+            m_left->evaluate_batch(start, count, m_left_values);
+            left = &m_left_values;
+        }
+        const Value<T>* right = &m_right_values;
+        // A constant evaluates to a single value
+        size_t left_step = left->m_values == count ? 1 : 0;
+        size_t right_step = right->m_values == count ? 1 : 0;
+        REALM_ASSERT_DEBUG(left_step || left->m_values == 1);
+        REALM_ASSERT_DEBUG(right_step || right->m_values == 1);
+
+        TCond c;
+        m_batch_matches.fill(0);
+        for (size_t m = 0, l = 0, r = 0; m < count; m++, l += left_step, r += right_step) {
+            if (c(left->m_storage[l], right->m_storage[r], left->m_storage.is_null(l), right->m_storage.is_null(r)))
+                m_batch_matches[m / 64] |= uint64_t(1) << (m % 64);
+        }
+        m_batch_start = start;
+        m_batch_end = start + count;
+    }
+
     Compare(const Compare& other)
         : m_left(other.m_left->clone())
         , m_right(other.m_right->clone())
@@ -4630,6 +4837,15 @@ private:
     std::vector<ObjKey> m_matches;
     mutable size_t m_index_get = 0;
     size_t m_index_end = 0;
+
+    // Batch evaluation: the operands of the last batch, and the rows of it in [m_batch_start, m_batch_end) that
+    // matched
+    bool m_batched = false;
+    mutable Value<T> m_left_values;
+    mutable Value<T> m_right_values;
+    mutable std::array<uint64_t, ValueBase::batch_size / 64> m_batch_matches;
+    mutable size_t m_batch_start = 0;
+    mutable size_t m_batch_end = 0;
 };
 }
 #endif // REALM_QUERY_EXPRESSION_HPP
@@ -0,0 +1,44 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/query_profile.hpp>
+
+#include <sstream>
+
+using namespace realm;
+
+std::string QueryProfile::to_string() const
+{
+    std::ostringstream out;
+    out << operation << " '" << description << "': " << rows_matched << " matches in " << time.count() << " ns";
+    if (uses_view)
+        out << ", restricted to a view";
+    else if (uses_index)
+        out << ", using a search index";
+    else
+        out << ", " << clusters_visited << " clusters searched, " << clusters_skipped << " skipped";
+    out << '\n';
+    for (auto& condition : conditions) {
+        out << "  " << condition.description << ": ";
+        if (condition.uses_index)
+            out << "index, ";
+        out << condition.searches << " searches, " << condition.rows_matched << " of " << condition.rows_examined
+            << " rows matched in " << condition.time.count() << " ns\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,83 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_QUERY_PROFILE_HPP
+#define REALM_QUERY_PROFILE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// How the last operation of a query was executed, and the work done by each
+/// of its conditions. A query given a profile with Query::set_profile()
+/// overwrites it every time it runs find(), find_all(), count() or an
+/// aggregate, including when a table view built by the query syncs.
+struct QueryProfile {
+    struct Condition {
+        /// The condition in the query language, as in Query::get_description()
+        std::string description;
+        /// True if the matches of the condition were looked up in a search
+        /// index instead of scanning its column
+        bool uses_index = false;
+        /// The number of times the condition drove the search, i.e. scanned
+        /// for matches that the other conditions were then tested on. The
+        /// query engine picks the condition that has been cheapest so far.
+        size_t searches = 0;
+        /// The number of rows the condition was evaluated on, whether it
+        /// drove the search or tested the matches of another condition
+        size_t rows_examined = 0;
+        /// The number of those rows that matched the condition
+        size_t rows_matched = 0;
+        /// The time spent evaluating the condition, not counting the time the
+        /// other conditions spent testing its matches
+        std::chrono::nanoseconds time{0};
+    };
+
+    /// "find", "find_all", "count", "sum", "average", "minimum" or "maximum"
+    std::string operation;
+    /// The whole query in the query language
+    std::string description;
+    /// True if the objects were looked up in a search index rather than found
+    /// by traversing the clusters of the table
+    bool uses_index = false;
+    /// True if the query was restricted to a view, in which case every object
+    /// of the view is tested against all conditions
+    bool uses_view = false;
+    /// The number of clusters searched, and the number skipped because the
+    /// summaries or Bloom filters kept by them ruled out a match
+    size_t clusters_visited = 0;
+    size_t clusters_skipped = 0;
+    /// The number of objects found, counted or aggregated
+    size_t rows_matched = 0;
+    /// The time the whole operation took
+    std::chrono::nanoseconds time{0};
+    /// The conditions ANDed at the top level of the query, in the order they
+    /// are tested on a match of the one driving the search. A group of
+    /// conditions combined with Or() or Not() counts as one condition.
+    std::vector<Condition> conditions;
+
+    /// A readable summary, one line for the query and one per condition
+    std::string to_string() const;
+};
+
+} // namespace realm
+
+#endif // REALM_QUERY_PROFILE_HPP
@@ -145,6 +145,10 @@ public:
     {
         return !m_column_keys.empty();
     }
+    const std::vector<std::vector<ColKey>>& get_column_keys() const noexcept
+    {
+        return m_column_keys;
+    }
     void collect_dependencies(const Table* table, std::vector<TableKey>& table_keys) const override;
 
 protected:
@@ -0,0 +1,202 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/string_compressor.hpp>
+#include <realm/util/assert.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace realm;
+
+namespace {
+
+// The symbol table is built from roughly this many bytes taken evenly from the values
+constexpr size_t max_sample_size = 4096;
+
+inline uint64_t pack_symbol(const char* data, size_t size)
+{
+    uint64_t v = 0;
+    std::memcpy(&v, data, size);
+    return v;
+}
+
+} // anonymous namespace
+
+StringCompressor::StringCompressor(const std::vector<StringData>& values)
+{
+    size_t total_size = 0;
+    for (auto& value : values)
+        total_size += value.size();
+    size_t step = std::max<size_t>(1, total_size / max_sample_size);
+
+    // Count the occurrences of every substring of up to max_symbol_size bytes in the sample
+    std::array<std::unordered_map<uint64_t, size_t>, max_symbol_size> counts;
+    std::vector<StringData> sample;
+    for (size_t i = 0; i < values.size(); i += step) {
+        StringData value = values[i];
+        if (value.is_null())
+            continue;
+        sample.push_back(value);
+        const char* data = value.data();
+        size_t size = value.size();
+        for (size_t pos = 0; pos < size; ++pos) {
+            size_t max_len = std::min(max_symbol_size, size - pos);
+            for (size_t len = 1; len <= max_len; ++len)
+                ++counts[len - 1][pack_symbol(data + pos, len)];
+        }
+    }
+
+    // A symbol replaces its bytes (or the escape codes for them) by a single code. Symbols of more than one byte
+    // must occur at least twice to pay for their place in the table.
+    struct Candidate {
+        size_t gain;
+        size_t len;
+        uint64_t symbol;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t len = 1; len <= max_symbol_size; ++len) {
+        for (auto& c : counts[len - 1]) {
+            if (len == 1 || c.second > 1)
+                candidates.push_back({c.second * len, len, c.first});
+        }
+    }
+    auto by_gain = [](const Candidate& a, const Candidate& b) {
+        return a.gain > b.gain || (a.gain == b.gain && (a.len > b.len || (a.len == b.len && a.symbol < b.symbol)));
+    };
+    size_t nb_chosen = std::min(candidates.size(), max_symbols);
+    std::partial_sort(candidates.begin(), candidates.begin() + nb_chosen, candidates.end(), by_gain);
+    for (size_t i = 0; i < nb_chosen; ++i) {
+        char symbol[max_symbol_size];
+        std::memcpy(symbol, &candidates[i].symbol, max_symbol_size);
+        add_symbol(symbol, candidates[i].len);
+    }
+    build_lookup();
+
+    // Overlapping candidates are counted more than once, so drop the symbols that the greedy compression of the
+    // sample never ends up using
+    std::array<size_t, max_symbols> uses{};
+    std::string buffer;
+    for (auto& value : sample) {
+        buffer.clear();
+        compress(value, buffer);
+        for (size_t i = 0; i < buffer.size(); ++i) {
+            auto code = static_cast<unsigned char>(buffer[i]);
+            if (code == escape_code)
+                ++i;
+            else
+                ++uses[code];
+        }
+    }
+    auto lengths = m_lengths;
+    auto symbols = m_symbols;
+    size_t nb_symbols = m_num_symbols;
+    m_num_symbols = 0;
+    for (size_t code = 0; code < nb_symbols; ++code) {
+        if (uses[code])
+            add_symbol(symbols[code].data(), lengths[code]);
+    }
+    build_lookup();
+}
+
+StringCompressor::StringCompressor(const char* data, size_t size)
+{
+    REALM_ASSERT(size > 0);
+    size_t nb_symbols = static_cast<unsigned char>(data[0]);
+    const char* lengths = data + 1;
+    const char* symbol = lengths + nb_symbols;
+    for (size_t code = 0; code < nb_symbols; ++code) {
+        size_t len = static_cast<unsigned char>(lengths[code]);
+        add_symbol(symbol, len);
+        symbol += len;
+    }
+    REALM_ASSERT_3(size_t(symbol - data), <=, size);
+    build_lookup();
+}
+
+std::string StringCompressor::serialize() const
+{
+    std::string out;
+    out.push_back(char(m_num_symbols));
+    for (size_t code = 0; code < m_num_symbols; ++code)
+        out.push_back(char(m_lengths[code]));
+    for (size_t code = 0; code < m_num_symbols; ++code)
+        out.append(m_symbols[code].data(), m_lengths[code]);
+    return out;
+}
+
+void StringCompressor::compress(StringData value, std::string& out) const
+{
+    const char* p = value.data();
+    const char* end = p + value.size();
+    while (p < end) {
+        size_t left = size_t(end - p);
+        bool found = false;
+        for (unsigned char code : m_codes_by_first[static_cast<unsigned char>(*p)]) {
+            size_t len = m_lengths[code];
+            if (len <= left && std::memcmp(m_symbols[code].data(), p, len) == 0) {
+                out.push_back(char(code));
+                p += len;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            out.push_back(char(escape_code));
+            out.push_back(*p++);
+        }
+    }
+}
+
+void StringCompressor::decompress(const char* data, size_t size, std::string& out) const
+{
+    const char* end = data + size;
+    while (data < end) {
+        auto code = static_cast<unsigned char>(*data++);
+        if (code == escape_code) {
+            out.push_back(*data++);
+        }
+        else {
+            REALM_ASSERT_DEBUG(code < m_num_symbols);
+            out.append(m_symbols[code].data(), m_lengths[code]);
+        }
+    }
+}
+
+void StringCompressor::add_symbol(const char* data, size_t size)
+{
+    REALM_ASSERT_3(m_num_symbols, <, max_symbols);
+    REALM_ASSERT(size > 0 && size <= max_symbol_size);
+    m_lengths[m_num_symbols] = static_cast<unsigned char>(size);
+    std::copy(data, data + size, m_symbols[m_num_symbols].data());
+    ++m_num_symbols;
+}
+
+void StringCompressor::build_lookup()
+{
+    for (auto& codes : m_codes_by_first)
+        codes.clear();
+    for (size_t code = 0; code < m_num_symbols; ++code)
+        m_codes_by_first[static_cast<unsigned char>(m_symbols[code][0])].push_back(static_cast<unsigned char>(code));
+    for (auto& codes : m_codes_by_first) {
+        std::stable_sort(codes.begin(), codes.end(), [this](unsigned char a, unsigned char b) {
+            return m_lengths[a] > m_lengths[b];
+        });
+    }
+}
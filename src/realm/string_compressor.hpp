@@ -0,0 +1,78 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_STRING_COMPRESSOR_HPP
+#define REALM_STRING_COMPRESSOR_HPP
+
+#include <realm/string_data.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace realm {
+
+/// Compression of strings with a table of up to 255 symbols of 1 to 8 bytes
+/// each, in the style of FSST (Fast Static Symbol Table). A compressed
+/// string is a sequence of codes, each of which is either the index of a
+/// symbol, or an escape code followed by a byte that is not covered by any
+/// symbol.
+///
+/// Strings are compressed greedily using the longest matching symbol, so
+/// equal strings have equal compressed forms and can be compared without
+/// decompressing them.
+class StringCompressor {
+public:
+    static constexpr size_t max_symbols = 255;
+    static constexpr size_t max_symbol_size = 8;
+    static constexpr unsigned char escape_code = 255;
+
+    /// Build a symbol table from the most frequent substrings of \a values.
+    /// Null values are ignored.
+    explicit StringCompressor(const std::vector<StringData>& values);
+
+    /// Load a symbol table previously written by serialize().
+    StringCompressor(const char* data, size_t size);
+
+    std::string serialize() const;
+
+    size_t get_num_symbols() const noexcept
+    {
+        return m_num_symbols;
+    }
+
+    /// Append the compressed form of \a value to \a out.
+    void compress(StringData value, std::string& out) const;
+
+    /// Append the original form of the compressed string at \a data to \a out.
+    void decompress(const char* data, size_t size, std::string& out) const;
+
+private:
+    size_t m_num_symbols = 0;
+    std::array<unsigned char, max_symbols> m_lengths;
+    std::array<std::array<char, max_symbol_size>, max_symbols> m_symbols;
+    // Codes of the symbols starting with a given byte, longest symbols first
+    std::array<std::vector<unsigned char>, 256> m_codes_by_first;
+
+    void add_symbol(const char* data, size_t size);
+    void build_lookup();
+};
+
+} // namespace realm
+
+#endif // REALM_STRING_COMPRESSOR_HPP
@@ -40,6 +40,7 @@
 #include <realm/array_timestamp.hpp>
 #include <realm/array_decimal128.hpp>
 #include <realm/array_object_id.hpp>
+#include <realm/column_statistics.hpp>
 #include <realm/table_tpl.hpp>
 
 /// \page AccessorConsistencyLevels
@@ -464,6 +465,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
         MemRef mem = ClusterTree::create_empty_cluster(m_top.get_alloc()); // Throws
         m_top.set_as_ref(top_position_for_cluster_tree, mem.get_ref());
     }
+    m_clusters.set_node_shift_factor(get_cluster_shift_factor());
     m_clusters.init_from_parent();
 
     RefOrTagged rot = m_top.get_as_ref_or_tagged(top_position_for_key);
@@ -524,6 +526,7 @@ void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bo
         if (!m_tombstones) {
             m_tombstones = std::make_unique<ClusterTree>(this, m_alloc, size_t(top_position_for_tombstones));
         }
+        m_tombstones->set_node_shift_factor(m_clusters.get_node_shift_factor());
         m_tombstones->init_from_parent();
     }
     else {
@@ -670,6 +673,299 @@ void Table::remove_search_index(ColKey col_key)
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
+bool Table::has_bloom_filter(ColKey col_key) const noexcept
+{
+    return m_spec.get_column_attr(colkey2spec_ndx(col_key)).test(col_attr_BloomFilter);
+}
+
+void Table::add_bloom_filter(ColKey col_key)
+{
+    check_column(col_key);
+    if (has_bloom_filter(col_key))
+        return;
+
+    auto type = col_key.get_type();
+    if ((type != col_type_String && type != col_type_ObjectId) || col_key.get_attrs().test(col_attr_List))
+        throw LogicError(LogicError::illegal_combination);
+    // The filters are kept in the zone maps of the clusters
+    if (!uses_file_format_21())
+        throw LogicError(LogicError::illegal_combination);
+
+    set_bloom_filter_attr(col_key, true);
+}
+
+void Table::remove_bloom_filter(ColKey col_key)
+{
+    check_column(col_key);
+    if (!has_bloom_filter(col_key))
+        return;
+
+    set_bloom_filter_attr(col_key, false);
+}
+
+size_t Table::find_ordered_index(ColKey col_key) const noexcept
+{
+    if (m_top.size() <= top_position_for_ordered_indexes)
+        return realm::npos;
+    ref_type ref = m_top.get_as_ref(top_position_for_ordered_indexes);
+    if (!ref)
+        return realm::npos;
+    const char* header = m_alloc.translate(ref);
+    size_t sz = Array::get_size_from_header(header);
+    for (size_t i = 0; i < sz; i += 2) {
+        if (uint64_t(Array::get(header, i)) >> 1 == uint64_t(col_key.value))
+            return i + 1;
+    }
+    return realm::npos;
+}
+
+void Table::add_ordered_index(ColKey col_key)
+{
+    check_column(col_key);
+    if (has_ordered_index(col_key))
+        return;
+    if (!OrderedIndex::is_supported(col_key) || !uses_file_format_21())
+        throw LogicError(LogicError::illegal_combination);
+
+    while (m_top.size() <= top_position_for_ordered_indexes)
+        m_top.add(0); // Throws
+    if (!m_top.get_as_ref(top_position_for_ordered_indexes)) {
+        Array indexes(m_alloc);
+        indexes.create(Array::type_HasRefs); // Throws
+        m_top.set_as_ref(top_position_for_ordered_indexes, indexes.get_ref()); // Throws
+    }
+    Array indexes(m_alloc);
+    indexes.set_parent(&m_top, top_position_for_ordered_indexes);
+    indexes.init_from_parent();
+    BPlusTree<ObjKey> keys(m_alloc);
+    keys.create(); // Throws
+    indexes.add(RefOrTagged::make_tagged(col_key.value)); // Throws
+    indexes.add(from_ref(keys.get_ref()));                // Throws
+
+    OrderedIndex index(*this, col_key, indexes.size() - 1);
+    index.populate(); // Throws
+}
+
+void Table::remove_ordered_index(ColKey col_key)
+{
+    check_column(col_key);
+    do_remove_ordered_index(col_key);
+}
+
+void Table::do_remove_ordered_index(ColKey col_key)
+{
+    size_t ndx = find_ordered_index(col_key);
+    if (ndx == realm::npos)
+        return;
+    Array indexes(m_alloc);
+    indexes.set_parent(&m_top, top_position_for_ordered_indexes);
+    indexes.init_from_parent();
+    Array::destroy_deep(indexes.get_as_ref(ndx), m_alloc);
+    indexes.erase(ndx - 1, ndx + 1);
+    if (indexes.is_empty()) {
+        indexes.destroy();
+        m_top.set(top_position_for_ordered_indexes, 0);
+    }
+}
+
+std::unique_ptr<OrderedIndex> Table::get_ordered_index(ColKey col_key) const
+{
+    size_t ndx = find_ordered_index(col_key);
+    if (ndx == realm::npos)
+        return nullptr;
+    return std::make_unique<OrderedIndex>(*this, col_key, ndx);
+}
+
+void Table::insert_in_ordered_indexes(ObjKey key)
+{
+    if (m_top.size() <= top_position_for_ordered_indexes || !m_top.get_as_ref(top_position_for_ordered_indexes))
+        return;
+    Array indexes(m_alloc);
+    indexes.set_parent(&m_top, top_position_for_ordered_indexes);
+    indexes.init_from_parent();
+    for (size_t i = 0; i < indexes.size(); i += 2) {
+        ColKey col_key(int64_t(indexes.get_as_ref_or_tagged(i).get_as_int()));
+        OrderedIndex(*this, col_key, i + 1).insert(key); // Throws
+    }
+}
+
+void Table::erase_from_ordered_indexes(ObjKey key)
+{
+    if (m_top.size() <= top_position_for_ordered_indexes || !m_top.get_as_ref(top_position_for_ordered_indexes))
+        return;
+    Array indexes(m_alloc);
+    indexes.set_parent(&m_top, top_position_for_ordered_indexes);
+    indexes.init_from_parent();
+    for (size_t i = 0; i < indexes.size(); i += 2) {
+        ColKey col_key(int64_t(indexes.get_as_ref_or_tagged(i).get_as_int()));
+        OrderedIndex(*this, col_key, i + 1).erase(key);
+    }
+}
+
+void Table::clear_ordered_indexes()
+{
+    if (m_top.size() <= top_position_for_ordered_indexes || !m_top.get_as_ref(top_position_for_ordered_indexes))
+        return;
+    Array indexes(m_alloc);
+    indexes.set_parent(&m_top, top_position_for_ordered_indexes);
+    indexes.init_from_parent();
+    for (size_t i = 0; i < indexes.size(); i += 2) {
+        ColKey col_key(int64_t(indexes.get_as_ref_or_tagged(i).get_as_int()));
+        OrderedIndex(*this, col_key, i + 1).clear();
+    }
+}
+
+void Table::set_cluster_size(size_t num_objects)
+{
+    if (num_objects < min_cluster_size || num_objects > max_cluster_size || (num_objects & (num_objects - 1)) != 0)
+        throw LogicError(LogicError::illegal_combination);
+    if (num_objects == get_cluster_size())
+        return;
+    if (!uses_file_format_21())
+        throw LogicError(LogicError::illegal_combination);
+    // The tree must be empty, as the compact form of its nodes derives keys from the node size
+    if (!m_clusters.is_empty() || (m_tombstones && !m_tombstones->is_empty()))
+        throw LogicError(LogicError::illegal_combination);
+
+    int shift_factor = 0;
+    while ((size_t(1) << shift_factor) < num_objects)
+        shift_factor++;
+
+    while (m_top.size() <= top_position_for_cluster_shift)
+        m_top.add(0);
+    m_top.set(top_position_for_cluster_shift, RefOrTagged::make_tagged(shift_factor));
+
+    // Reinitialize the trees so that inner nodes pick up the new shift factor
+    m_clusters.set_node_shift_factor(shift_factor);
+    m_clusters.init_from_parent();
+    if (m_tombstones) {
+        m_tombstones->set_node_shift_factor(shift_factor);
+        m_tombstones->init_from_parent();
+    }
+    bump_storage_version();
+}
+
+int Table::get_cluster_shift_factor() const noexcept
+{
+    if (m_top.size() > top_position_for_cluster_shift) {
+        auto rot = m_top.get_as_ref_or_tagged(top_position_for_cluster_shift);
+        if (rot.is_tagged())
+            return int(rot.get_as_int());
+    }
+    return ClusterTree::default_node_shift_factor;
+}
+
+bool Table::has_statistics() const noexcept
+{
+    return m_top.size() > top_position_for_statistics && m_top.get_as_ref(top_position_for_statistics) != 0;
+}
+
+void Table::update_statistics()
+{
+    if (!uses_file_format_21())
+        throw LogicError(LogicError::illegal_combination);
+
+    Array statistics(m_alloc);
+    statistics.create(Array::type_HasRefs); // Throws
+    _impl::DeepArrayDestroyGuard dg(&statistics);
+    statistics.add(RefOrTagged::make_tagged(0));      // Throws
+    statistics.add(RefOrTagged::make_tagged(size())); // Throws
+    std::vector<int64_t> values;
+    for_each_public_column([&](ColKey col_key) {
+        ColumnStatistics column_statistics;
+        if (!column_statistics.compute(*this, col_key)) // Throws
+            return false;
+        values.clear();
+        values.push_back(col_key.value);
+        column_statistics.serialize(values);
+        Array column(m_alloc);
+        column.create(Array::type_Normal); // Throws
+        _impl::ShallowArrayDestroyGuard column_dg(&column);
+        for (auto value : values)
+            column.add(value); // Throws
+        statistics.add(from_ref(column.get_ref())); // Throws
+        column_dg.release();
+        return false;
+    });
+
+    remove_statistics();
+    while (m_top.size() <= top_position_for_statistics)
+        m_top.add(0); // Throws
+    m_top.set_as_ref(top_position_for_statistics, statistics.get_ref()); // Throws
+    dg.release();
+    // The statistics include the objects modified so far
+    m_num_modified_objects = 0;
+}
+
+void Table::remove_statistics()
+{
+    if (!has_statistics())
+        return;
+    Array::destroy_deep(m_top.get_as_ref(top_position_for_statistics), m_alloc);
+    m_top.set(top_position_for_statistics, 0);
+}
+
+bool Table::get_column_statistics(ColKey col_key, ColumnStatistics& statistics) const
+{
+    if (!has_statistics())
+        return false;
+    const char* header = m_alloc.translate(m_top.get_as_ref(top_position_for_statistics));
+    size_t sz = Array::get_size_from_header(header);
+    for (size_t i = 2; i < sz; ++i) {
+        const char* column = m_alloc.translate(to_ref(Array::get(header, i)));
+        if (Array::get(column, 0) != col_key.value)
+            continue;
+        size_t column_size = Array::get_size_from_header(column);
+        std::vector<int64_t> values;
+        for (size_t j = 1; j < column_size; ++j)
+            values.push_back(Array::get(column, j));
+        statistics.deserialize(values);
+        return true;
+    }
+    return false;
+}
+
+void Table::update_statistics_for_commit(size_t num_modified)
+{
+    Array statistics(m_alloc);
+    statistics.set_parent(&m_top, top_position_for_statistics);
+    statistics.init_from_parent();
+    num_modified += size_t(statistics.get_as_ref_or_tagged(0).get_as_int());
+    size_t num_objects = size_t(statistics.get_as_ref_or_tagged(1).get_as_int());
+    size_t change = size() > num_objects ? size() - num_objects : num_objects - size();
+    if (num_modified * 10 > size() || change * 10 > num_objects) {
+        update_statistics(); // Throws
+    }
+    else if (num_modified) {
+        statistics.set(0, RefOrTagged::make_tagged(num_modified)); // Throws
+    }
+}
+
+void Table::set_bloom_filter_attr(ColKey col_key, bool value)
+{
+    auto spec_ndx = colkey2spec_ndx(col_key);
+    auto attr = m_spec.get_column_attr(spec_ndx);
+    if (value)
+        attr.set(col_attr_BloomFilter);
+    else
+        attr.reset(col_attr_BloomFilter);
+    m_spec.set_column_attr(spec_ndx, attr); // Throws
+
+    // Enumerated columns are searched by the index of the value in the dictionary, so they have no filters
+    if (is_enumerated(col_key))
+        return;
+
+    // Clusters modified in this transaction get their zone map rebuilt on commit. Only the filter of the column is
+    // updated in the others.
+    bool replaced = false;
+    m_clusters.update([&replaced, col_key, value](Cluster* cluster) {
+        if (cluster->set_bloom_filter(col_key, value))
+            replaced = true;
+    });
+    if (replaced)
+        m_clusters.bump_storage_version();
+}
+
 void Table::enumerate_string_column(ColKey col_key)
 {
     check_column(col_key);
@@ -766,6 +1062,7 @@ ColKey Table::do_insert_root_column(ColKey col_key, ColumnType type, StringData
 
 void Table::do_erase_root_column(ColKey col_key)
 {
+    do_remove_ordered_index(col_key);
     size_t col_ndx = col_key.get_index().val;
     // If the column had a source index we have to remove and destroy that as well
     ref_type index_ref = m_index_refs.get_as_ref(col_ndx);
@@ -1685,6 +1982,9 @@ ref_type Table::create_empty_table(Allocator& alloc, TableKey key)
     top.add(0); // pk col key
     top.add(0); // flags
     top.add(0); // tombstones
+    top.add(0); // cluster shift
+    top.add(0); // statistics
+    top.add(0); // ordered indexes
 
     REALM_ASSERT(top.size() == top_array_size);
 
@@ -1700,6 +2000,7 @@ void Table::ensure_graveyard()
         MemRef mem = ClusterTree::create_empty_cluster(m_alloc);
         m_top.set_as_ref(top_position_for_tombstones, mem.get_ref());
         m_tombstones = std::make_unique<ClusterTree>(this, m_alloc, size_t(top_position_for_tombstones));
+        m_tombstones->set_node_shift_factor(m_clusters.get_node_shift_factor());
         m_tombstones->init_from_parent();
         for_each_and_every_column([ts = m_tombstones.get()](ColKey col) {
             ts->insert_column(col);
@@ -1747,6 +2048,7 @@ void Table::clear()
 {
     CascadeState state(CascadeState::Mode::Strong, get_parent_group());
     m_clusters.clear(state);
+    clear_ordered_indexes();
     free_collision_table();
 }
 
@@ -1768,6 +2070,12 @@ inline uint64_t Table::get_sync_file_id() const noexcept
     return g ? g->get_sync_file_id() : 0;
 }
 
+bool Table::uses_file_format_21() const noexcept
+{
+    Group* g = get_parent_group();
+    return !g || g->get_file_format_version() >= 21;
+}
+
 size_t Table::get_index_in_group() const noexcept
 {
     if (!m_top.is_attached())
@@ -1836,15 +2144,12 @@ size_t Table::count_decimal(ColKey col_key, Decimal128 value) const
 {
     ArrayDecimal128 leaf(get_alloc());
     size_t cnt = 0;
-    bool null_value = value.is_null();
-    auto f = [value, &leaf, col_key, null_value, &cnt](const Cluster* cluster) {
+    auto f = [value, &leaf, col_key, &cnt](const Cluster* cluster) {
         // direct aggregate on the leaf
         cluster->init_leaf(col_key, &leaf);
         auto sz = leaf.size();
-        for (size_t i = 0; i < sz; i++) {
-            if ((null_value && leaf.is_null(i)) || (leaf.get(i) == value)) {
-                cnt++;
-            }
+        for (size_t i = leaf.find_first(value, 0, sz); i != realm::npos; i = leaf.find_first(value, i + 1, sz)) {
+            cnt++;
         }
         return false;
     };
@@ -1875,13 +2180,9 @@ Decimal128 Table::aggregate<act_Sum, Decimal128, Decimal128>(ColKey column_key,
     auto f = [&leaf, column_key, &sum, &count](const Cluster* cluster) {
         // direct aggregate on the leaf
         cluster->init_leaf(column_key, &leaf);
-        auto sz = leaf.size();
-        for (size_t i = 0; i < sz; i++) {
-            if (!leaf.is_null(i)) {
-                sum = sum + leaf.get(i);
-                count++;
-            }
-        }
+        size_t leaf_count;
+        sum += leaf.sum(leaf_count);
+        count += leaf_count;
         return false;
     };
 
@@ -1972,12 +2273,12 @@ Decimal128 Table::minimum_decimal(ColKey col_key, ObjKey* return_ndx) const
     auto f = [&min, &ret_key, &leaf, col_key](const Cluster* cluster) {
         // direct aggregate on the leaf
         cluster->init_leaf(col_key, &leaf);
-        auto sz = leaf.size();
-        for (size_t i = 0; i < sz; i++) {
-            auto val = leaf.get(i);
-            if (!val.is_null() && val < min) {
+        size_t ndx = leaf.find_min();
+        if (ndx != realm::npos) {
+            auto val = leaf.get(ndx);
+            if (val < min) {
                 min = val;
-                ret_key = cluster->get_real_key(i);
+                ret_key = cluster->get_real_key(ndx);
             }
         }
         return false;
@@ -2024,12 +2325,12 @@ Decimal128 Table::maximum_decimal(ColKey col_key, ObjKey* return_ndx) const
     auto f = [&max, &ret_key, &leaf, col_key](const Cluster* cluster) {
         // direct aggregate on the leaf
         cluster->init_leaf(col_key, &leaf);
-        auto sz = leaf.size();
-        for (size_t i = 0; i < sz; i++) {
-            auto val = leaf.get(i);
-            if (!val.is_null() && val > max) {
+        size_t ndx = leaf.find_max();
+        if (ndx != realm::npos) {
+            auto val = leaf.get(ndx);
+            if (val > max) {
                 max = val;
-                ret_key = cluster->get_real_key(i);
+                ret_key = cluster->get_real_key(ndx);
             }
         }
         return false;
@@ -2116,6 +2417,114 @@ template ObjKey Table::find_first(ColKey col_key, util::Optional<int64_t>) const
 template ObjKey Table::find_first(ColKey col_key, BinaryData) const;
 template ObjKey Table::find_first(ColKey col_key, util::Optional<ObjectId>) const;
 
+namespace {
+
+inline void set_validity(uint64_t* validity, size_t ndx, bool valid)
+{
+    uint64_t bit = uint64_t(1) << (ndx % 64);
+    if (valid)
+        validity[ndx / 64] |= bit;
+    else
+        validity[ndx / 64] &= ~bit;
+}
+
+template <class LeafType, class T>
+void get_leaf_values(const LeafType& leaf, size_t begin, size_t end, T* values, uint64_t* validity,
+                     size_t validity_ndx)
+{
+    if constexpr (std::is_same_v<LeafType, ArrayInteger>) {
+        leaf.get_range(begin, end, values);
+    }
+    else if constexpr (std::is_same_v<LeafType, ArrayIntNull>) {
+        size_t null_count = leaf.get_range(begin, end, values);
+        if (validity) {
+            for (size_t i = 0; i < end - begin; ++i)
+                set_validity(validity, validity_ndx + i, null_count == 0 || !leaf.is_null(begin + i));
+        }
+        return;
+    }
+    else if constexpr (std::is_same_v<LeafType, BasicArray<T>>) {
+        leaf.get_range(begin, end, values);
+        for (size_t i = 0; i < end - begin; ++i) {
+            bool is_null = null::is_null_float(values[i]);
+            if (is_null)
+                values[i] = T{};
+            if (validity)
+                set_validity(validity, validity_ndx + i, !is_null);
+        }
+        return;
+    }
+    else {
+        for (size_t i = begin; i < end; ++i) {
+            bool is_null = leaf.is_null(i);
+            if (is_null) {
+                *values++ = T{};
+            }
+            else {
+                auto v = leaf.get(i);
+                if constexpr (std::is_same_v<decltype(v), T>)
+                    *values++ = v;
+                else
+                    *values++ = *v;
+            }
+            if (validity)
+                set_validity(validity, validity_ndx + (i - begin), !is_null);
+        }
+        return;
+    }
+    if (validity) {
+        for (size_t i = 0; i < end - begin; ++i)
+            set_validity(validity, validity_ndx + i, true);
+    }
+}
+
+} // anonymous namespace
+
+template <class T>
+void Table::get_values(ColKey col_key, size_t begin, size_t count, T* values, uint64_t* validity) const
+{
+    check_column(col_key);
+    if (col_key.get_type() != ColumnTypeTraits<T>::column_id || col_key.get_attrs().test(col_attr_List))
+        throw LogicError(LogicError::type_mismatch);
+    if (begin + count > size())
+        throw LogicError(LogicError::row_index_out_of_range);
+
+    auto read = [&](auto& leaf) {
+        // Set to the index of 'begin' within the first leaf
+        size_t ndx = begin;
+        size_t done = 0;
+        auto f = [&](const Cluster* cluster) {
+            size_t from = done ? 0 : ndx;
+            size_t to = std::min(cluster->node_size(), from + (count - done));
+            cluster->init_leaf(col_key, &leaf);
+            get_leaf_values(leaf, from, to, values + done, validity, done);
+            done += to - from;
+            return done == count;
+        };
+        if (count)
+            traverse_clusters(ndx, f);
+    };
+    // Floats, doubles, Timestamps and Decimals use the same leaf type whether they are nullable or not
+    constexpr bool has_nullable_leaf = realm::is_any<T, int64_t, bool, ObjectId>::value;
+    if (has_nullable_leaf && is_nullable(col_key)) {
+        using NullableType = std::conditional_t<has_nullable_leaf, util::Optional<T>, T>;
+        typename ColumnTypeTraits<NullableType>::cluster_leaf_type leaf(get_alloc());
+        read(leaf);
+    }
+    else {
+        typename ColumnTypeTraits<T>::cluster_leaf_type leaf(get_alloc());
+        read(leaf);
+    }
+}
+
+template void Table::get_values(ColKey, size_t, size_t, int64_t*, uint64_t*) const;
+template void Table::get_values(ColKey, size_t, size_t, bool*, uint64_t*) const;
+template void Table::get_values(ColKey, size_t, size_t, float*, uint64_t*) const;
+template void Table::get_values(ColKey, size_t, size_t, double*, uint64_t*) const;
+template void Table::get_values(ColKey, size_t, size_t, Timestamp*, uint64_t*) const;
+template void Table::get_values(ColKey, size_t, size_t, ObjectId*, uint64_t*) const;
+template void Table::get_values(ColKey, size_t, size_t, Decimal128*, uint64_t*) const;
+
 ObjKey Table::find_first_int(ColKey col_key, int64_t value) const
 {
     if (is_nullable(col_key))
@@ -2298,6 +2707,7 @@ const Table* Table::get_link_chain_target(const std::vector<ColKey>& link_chain)
 
 void Table::update_from_parent() noexcept
 {
+    clear_decompressed_leaves();
     // There is no top for sub-tables sharing spec
     if (m_top.is_attached()) {
         m_top.update_from_parent();
@@ -2406,6 +2816,51 @@ void Table::flush_for_commit()
             m_top.set(top_position_for_version, rot_version);
         }
     }
+
+    clear_decompressed_leaves();
+
+    // Leaves that have been modified in this transaction are compressed and summarized before they are written to
+    // the file, unless the file is of a format that does not allow it
+    if (m_top.is_attached() && !m_top.is_read_only() && uses_file_format_21()) {
+        bool replaced = false;
+        m_clusters.update_modified([&replaced](Cluster* cluster) {
+            if (cluster->encode_leaves())
+                replaced = true;
+            if (cluster->update_zone_map())
+                replaced = true;
+        });
+        if (replaced)
+            m_clusters.bump_storage_version();
+        if (has_statistics())
+            update_statistics_for_commit(m_num_modified_objects); // Throws
+    }
+    m_num_modified_objects = 0;
+}
+
+StringData Table::get_compressed_string(ref_type ref, size_t ndx) const
+{
+    std::unique_lock<std::mutex> lock(m_decompressed_leaves_mutex, std::defer_lock);
+    if (m_is_frozen)
+        lock.lock();
+
+    auto version = m_alloc.get_storage_version();
+    auto& entry = m_decompressed_leaves[ref];
+    // Memory that is not read-only may have been freed and reused since the leaf was decompressed
+    if (entry.leaf && !m_alloc.is_read_only(ref) && entry.storage_version != version)
+        m_replaced_leaves.push_back(std::move(entry.leaf));
+    if (!entry.leaf) {
+        auto leaf = std::make_shared<ArrayString>(m_alloc);
+        leaf->init_from_ref(ref);
+        entry.leaf = std::move(leaf);
+        entry.storage_version = version;
+    }
+    return entry.leaf->get(ndx);
+}
+
+void Table::clear_decompressed_leaves() noexcept
+{
+    m_decompressed_leaves.clear();
+    m_replaced_leaves.clear();
 }
 
 void Table::refresh_content_version()
@@ -2430,9 +2885,13 @@ void Table::refresh_content_version()
 void Table::refresh_accessor_tree()
 {
     REALM_ASSERT(m_top.is_attached());
+    clear_decompressed_leaves();
+    // The changes of a transaction that is rolled back are not committed
+    m_num_modified_objects = 0;
     m_top.init_from_parent();
     m_spec.init_from_parent();
     REALM_ASSERT(m_top.size() > top_position_for_pk_col);
+    m_clusters.set_node_shift_factor(get_cluster_shift_factor());
     m_clusters.init_from_parent();
     m_index_refs.init_from_parent();
     m_opposite_table.init_from_parent();
@@ -2446,8 +2905,10 @@ void Table::refresh_accessor_tree()
     else {
         m_is_embedded = false;
     }
-    if (m_tombstones)
+    if (m_tombstones) {
+        m_tombstones->set_node_shift_factor(m_clusters.get_node_shift_factor());
         m_tombstones->init_from_parent();
+    }
     refresh_content_version();
     bump_storage_version();
     build_column_mapping();
@@ -2514,6 +2975,11 @@ void Table::verify() const
     m_clusters.verify();
     if (nb_unresolved())
         m_tombstones->verify();
+    for_each_public_column([&](ColKey col_key) {
+        if (auto index = get_ordered_index(col_key))
+            index->verify();
+        return false;
+    });
 #endif
 }
 
@@ -3531,6 +3997,7 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
     check_column(col_key);
 
     bool si = has_search_index(col_key);
+    bool oi = has_ordered_index(col_key);
     std::string column_name(get_column_name(col_key));
     auto type = col_key.get_type();
     auto attr = col_key.get_attrs();
@@ -3559,6 +4026,8 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
 
     if (si)
         add_search_index(new_col);
+    if (oi)
+        add_ordered_index(new_col);
 
     if (is_pk_col) {
         // If we go from non nullable to nullable, no values change,
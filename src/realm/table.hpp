@@ -25,6 +25,7 @@
 #include <typeinfo>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #include <realm/util/features.h>
 #include <realm/util/function_ref.hpp>
@@ -33,6 +34,7 @@
 #include <realm/spec.hpp>
 #include <realm/query.hpp>
 #include <realm/cluster_tree.hpp>
+#include <realm/index_ordered.hpp>
 #include <realm/keys.hpp>
 #include <realm/global_key.hpp>
 
@@ -48,6 +50,7 @@ class BacklinkColumn;
 template <class>
 class BacklinkCount;
 class BinaryColumy;
+class ColumnStatistics;
 class ConstTableView;
 class Group;
 class SortDescriptor;
@@ -168,6 +171,123 @@ public:
 
     //@}
 
+    //@{
+
+    /// has_bloom_filter() returns true if, and only if the clusters of the
+    /// table keep a Bloom filter of the values of the specified column.
+    ///
+    /// add_bloom_filter() makes every cluster of the table keep a small Bloom
+    /// filter of the values of the specified string or ObjectId column, so
+    /// that equality queries on the column can skip the clusters that do not
+    /// hold the value. This is much cheaper to maintain than a search index.
+    /// The filters are brought up to date when a write transaction is
+    /// committed. It has no effect if the column already has Bloom filters.
+    /// It throws LogicError::illegal_combination if the group was opened from
+    /// a file of format 20, which cannot hold Bloom filters.
+    ///
+    /// remove_bloom_filter() removes the Bloom filters of the specified
+    /// column. It has no effect if the column has none.
+    ///
+    /// Bloom filters are local to the file. Adding or removing them is not
+    /// replicated, so they must be set up on each file that wants them.
+    ///
+    /// \param col_key The key of a column of the table.
+
+    bool has_bloom_filter(ColKey col_key) const noexcept;
+    void add_bloom_filter(ColKey col_key);
+    void remove_bloom_filter(ColKey col_key);
+
+    //@}
+
+    //@{
+
+    /// has_ordered_index() returns true if, and only if an ordered index has
+    /// been added to the specified column.
+    ///
+    /// add_ordered_index() adds an index that keeps the objects of the table
+    /// sorted by their value in the specified int, timestamp, double, string
+    /// or ObjectId column, see OrderedIndex. Where a search index only finds
+    /// equal values, an ordered index lets queries find the values in a range
+    /// or the strings beginning with a prefix without scanning the column,
+    /// and lets a view sorted on the column (other than a string column) skip
+    /// the sort. It has no effect if the column already has an ordered index.
+    /// It throws LogicError::illegal_combination if the group was opened from
+    /// a file of format 20, which cannot hold ordered indexes.
+    ///
+    /// remove_ordered_index() removes the ordered index of the specified
+    /// column. It has no effect if the column has none.
+    ///
+    /// get_ordered_index() returns an accessor of the ordered index of the
+    /// specified column, or null if it has none.
+    ///
+    /// \param col_key The key of a column of the table.
+
+    bool has_ordered_index(ColKey col_key) const noexcept
+    {
+        return find_ordered_index(col_key) != realm::npos;
+    }
+    void add_ordered_index(ColKey col_key);
+    void remove_ordered_index(ColKey col_key);
+    std::unique_ptr<OrderedIndex> get_ordered_index(ColKey col_key) const;
+
+    //@}
+
+    //@{
+
+    /// get_cluster_size() returns the maximum number of objects in each
+    /// cluster (leaf) of the table's object tree.
+    ///
+    /// set_cluster_size() chooses the cluster size of an empty table. Large
+    /// clusters make scans of narrow tables cheaper, as each leaf array is
+    /// searched in longer runs. Small clusters make modifications of wide
+    /// tables cheaper, as less has to be copied on write. The size must be a
+    /// power of two between min_cluster_size and max_cluster_size. The size
+    /// is stored with the table, but is not part of the transaction log.
+    ///
+    /// \throw LogicError If the table is not empty, if the size is not
+    /// valid, or if the group was opened from a file of format 20, which
+    /// cannot hold another cluster size.
+
+    static constexpr size_t min_cluster_size = 256;
+    static constexpr size_t max_cluster_size = 16384;
+
+    size_t get_cluster_size() const noexcept
+    {
+        return m_clusters.get_node_size();
+    }
+    void set_cluster_size(size_t num_objects);
+
+    //@}
+
+    //@{
+
+    /// update_statistics() samples the objects of the table, and records for
+    /// each integer, bool, float, double, Timestamp, string and ObjectId
+    /// column the fraction of nulls, the number of distinct values and a
+    /// histogram of the values, see ColumnStatistics. Queries use them to
+    /// choose the order in which to evaluate their conditions, and whether to
+    /// use a search index. From then on, the statistics are brought up to
+    /// date when a write transaction is committed after more objects than a
+    /// tenth of the table have been created, set or removed since they were
+    /// computed, or the number of objects has changed by more than a tenth.
+    /// An object set several times is counted each time. The statistics are
+    /// stored with the table, but are not part of the transaction log. It
+    /// throws LogicError::illegal_combination if the group was opened from a
+    /// file of format 20, which cannot hold statistics.
+    ///
+    /// remove_statistics() discards the statistics of the table, and stops
+    /// keeping them.
+    ///
+    /// get_column_statistics() returns false if there are no statistics for
+    /// the specified column.
+
+    bool has_statistics() const noexcept;
+    void update_statistics();
+    void remove_statistics();
+    bool get_column_statistics(ColKey col_key, ColumnStatistics& statistics) const;
+
+    //@}
+
     /// If the specified column is optimized to store only unique values, then
     /// this function returns the number of unique values currently
     /// stored. Otherwise it returns zero. This function is mainly intended for
@@ -273,6 +393,18 @@ public:
     {
         return m_clusters.traverse(func);
     }
+    bool traverse_clusters(size_t& ndx, ClusterTree::TraverseFunction func) const
+    {
+        return m_clusters.traverse(ndx, func);
+    }
+    std::vector<ClusterTree::Subtree> get_cluster_subtrees(size_t min_count) const
+    {
+        return m_clusters.get_subtrees(min_count);
+    }
+    bool traverse_clusters(const ClusterTree::Subtree& subtree, ClusterTree::TraverseFunction func) const
+    {
+        return m_clusters.traverse(subtree, func);
+    }
 
     /// remove_object() removes the specified object from the table.
     /// Any links from the specified object into objects residing in an embedded
@@ -361,6 +493,22 @@ public:
     double average_double(ColKey col_key, size_t* value_count = nullptr) const;
     Decimal128 average_decimal(ColKey col_key, size_t* value_count = nullptr) const;
 
+    /// Read the values of a column for the objects at positions [begin, begin
+    /// + count) in the table into 'values', decoding one cluster leaf at a
+    /// time. This is much faster than reading the objects one by one. Null
+    /// values are read as `T{}`. If 'validity' is given, bit `i % 64` of
+    /// `validity[i / 64]` is set if value `i` is not null, and cleared if it
+    /// is; it must have room for `(count + 63) / 64` words. T must match the
+    /// column type; it can be int64_t, bool, float, double, Timestamp,
+    /// ObjectId or Decimal128.
+    template <class T>
+    void get_values(ColKey col_key, size_t begin, size_t count, T* values, uint64_t* validity = nullptr) const;
+
+    /// A string read through ConstObj from a compressed string leaf (see
+    /// ArrayString::compress()) refers to a decompressed copy of the leaf kept
+    /// by the table. Like strings that refer directly to the file, it stays
+    /// valid until the transaction is advanced or committed.
+
     // Will return pointer to search index accessor. Will return nullptr if no index
     StringIndex* get_search_index(ColKey col) const noexcept
     {
@@ -619,10 +767,34 @@ private:
     util::Optional<bool> m_has_any_embedded_objects;
     TableRef m_own_ref;
 
+    // Compressed string leaves read through ConstObj in this transaction, by ref. Leaves whose memory has been freed
+    // and reused since they were decompressed are moved to m_replaced_leaves, as strings may still refer to them.
+    struct DecompressedLeaf {
+        std::shared_ptr<ArrayString> leaf;
+        uint_fast64_t storage_version;
+    };
+    mutable std::unordered_map<ref_type, DecompressedLeaf> m_decompressed_leaves;
+    mutable std::vector<std::shared_ptr<ArrayString>> m_replaced_leaves;
+    // Only taken for frozen tables, which may be read from several threads
+    mutable std::mutex m_decompressed_leaves_mutex;
+
+    StringData get_compressed_string(ref_type ref, size_t ndx) const;
+    void clear_decompressed_leaves() noexcept;
+
     void batch_erase_rows(const KeyColumn& keys);
     size_t do_set_link(ColKey col_key, size_t row_ndx, size_t target_row_ndx);
 
     void populate_search_index(ColKey col_key);
+    void set_bloom_filter_attr(ColKey col_key, bool value);
+    // The position of the B+tree of the ordered index of a column in the list of ordered indexes, or npos
+    size_t find_ordered_index(ColKey col_key) const noexcept;
+    void do_remove_ordered_index(ColKey col_key);
+    // Keep the ordered indexes up to date when objects are created or removed
+    void insert_in_ordered_indexes(ObjKey key);
+    void erase_from_ordered_indexes(ObjKey key);
+    void clear_ordered_indexes();
+    int get_cluster_shift_factor() const noexcept;
+    void update_statistics_for_commit(size_t num_modified);
 
     // Migration support
     void migrate_column_info();
@@ -718,6 +890,10 @@ private:
     /// otherwise null is returned.
     Group* get_parent_group() const noexcept;
     uint64_t get_sync_file_id() const noexcept;
+    /// False if the table is in a file of a format earlier than 21, to which
+    /// none of the additions of format 21 may be written. See
+    /// Group::get_file_format_version().
+    bool uses_file_format_21() const noexcept;
 
     static size_t get_size_from_ref(ref_type top_ref, Allocator&) noexcept;
     static size_t get_size_from_ref(ref_type spec_ref, ref_type columns_ref, Allocator&) noexcept;
@@ -754,6 +930,15 @@ private:
     std::vector<size_t> m_leaf_ndx2spec_ndx;
     bool m_is_embedded = false;
     uint64_t m_in_file_version_at_transaction_boundary = 0;
+    // Number of objects created, set or removed since the last commit, see update_statistics_for_commit(). Only
+    // counted for tables that keep column statistics.
+    size_t m_num_modified_objects = 0;
+
+    void count_modified_objects(size_t n = 1) noexcept
+    {
+        if (has_statistics())
+            m_num_modified_objects += n;
+    }
 
     static constexpr int top_position_for_spec = 0;
     static constexpr int top_position_for_columns = 1;
@@ -770,7 +955,16 @@ private:
     static constexpr int top_position_for_flags = 12;
     // flags contents: bit 0 - is table embedded?
     static constexpr int top_position_for_tombstones = 13;
-    static constexpr int top_array_size = 14;
+    // log2 of the cluster size as a tagged value, or zero for the default
+    static constexpr int top_position_for_cluster_shift = 14;
+    // ref to the column statistics, or zero if none are kept. The statistics start with the number of objects
+    // created, set or removed since they were computed and the number of objects then, both tagged, followed by a ref
+    // to an array for each column, holding the column key and the serialized ColumnStatistics.
+    static constexpr int top_position_for_statistics = 15;
+    // ref to the list of ordered indexes, or zero if there are none. The list holds a tagged column key and the ref
+    // to the B+tree of the index for each column.
+    static constexpr int top_position_for_ordered_indexes = 16;
+    static constexpr int top_array_size = 17;
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
@@ -795,6 +989,7 @@ private:
     friend class Cluster;
     friend class ClusterTree;
     friend class ColKeyIterator;
+    friend class OrderedIndex;
     friend class ConstObj;
     friend class Obj;
     friend class LnkLst;
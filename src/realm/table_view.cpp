@@ -63,9 +63,12 @@ ConstTableView::ConstTableView(const ConstTableView& src, Transaction* tr, Paylo
     // don't use methods which throw after this point...or m_table_view_key_values will leak
     if (mode == PayloadPolicy::Copy && src.m_key_values.is_attached()) {
         m_key_values = src.m_key_values;
+        m_selection = src.m_selection;
     }
-    else if (mode == PayloadPolicy::Move && src.m_key_values.is_attached())
+    else if (mode == PayloadPolicy::Move && src.m_key_values.is_attached()) {
         m_key_values = std::move(src.m_key_values);
+        m_selection = std::move(src.m_selection);
+    }
     else {
         m_key_values.create();
     }
@@ -93,86 +96,69 @@ R ConstTableView::aggregate(ColKey column_key, size_t* result_count, ObjKey* ret
     REALM_ASSERT(action == act_Sum || action == act_Max || action == act_Min || action == act_Average);
     REALM_ASSERT(m_table->valid_column(column_key));
 
-    if ((m_key_values.size()) == 0) {
+    if (size() == 0) {
         return {};
     }
 
-    // typedef typename ColTypeTraits::leaf_type ArrType;
-
-    // FIXME: Optimization temporarely removed for stability
-    /*
-        if (m_num_detached_refs == 0 && m_table_view_key_values.size() == column->size()) {
-            // direct aggregate on the column
-            if (action == act_Count)
-                return static_cast<R>(column->count(count_target));
-            else
-                return (column->*aggregateMethod)(0, size_t(-1), size_t(-1), return_ndx); // end == limit == -1
-        }
-    */
-
-    // Array object instantiation must NOT allocate initial memory (capacity)
-    // with 'new' because it will lead to mem leak. The column keeps ownership
-    // of the payload in array and will free it itself later, so we must not call destroy() on array.
-    // ArrType arr(column->get_alloc());
-
-    // FIXME: Speed optimization disabled because we need is_null() which is not available on all leaf types.
-
-/*
-    const ArrType* arrp = nullptr;
-    size_t leaf_start = 0;
-    size_t leaf_end = 0;
-    size_t row_ndx;
-*/
     R res = R{};
     bool is_first = true;
-    for (size_t tv_index = 0; tv_index < m_key_values.size(); ++tv_index) {
+    auto add_value = [&](R unpacked, ObjKey key) {
+        non_nulls++;
 
-        ObjKey key(get_key(tv_index));
+        if (is_first) {
+            if (return_key) {
+                *return_key = key;
+            }
+            res = unpacked;
+            is_first = false;
+        }
+        else if (action == act_Sum || action == act_Average) {
+            res += unpacked;
+        }
+        else if ((action == act_Max && unpacked > res) || non_nulls == 1) {
+            res = unpacked;
+            if (return_key)
+                *return_key = key;
+        }
+        else if ((action == act_Min && unpacked < res) || non_nulls == 1) {
+            res = unpacked;
+            if (return_key)
+                *return_key = key;
+        }
+    };
+
+    if (!m_selection.is_empty()) {
+        // Read the values of the selected objects directly from the leaves of the column
+        using LeafType = typename ColumnTypeTraits<T>::cluster_leaf_type;
+        LeafType leaf(m_table->get_alloc());
+        bool nullable = m_table->is_nullable(column_key);
+        m_table->traverse_clusters([&](const Cluster* cluster) {
+            cluster->init_leaf(column_key, &leaf);
+            m_selection.for_each_in_cluster(cluster, [&](size_t ndx) {
+                if (!(nullable && leaf.is_null(ndx)))
+                    add_value(static_cast<R>(util::unwrap(leaf.get(ndx))), cluster->get_real_key(ndx));
+            });
+            return false;
+        });
+    }
+    else {
+        for (size_t tv_index = 0; tv_index < m_key_values.size(); ++tv_index) {
 
-        // skip detached references:
-        if (key == realm::null_key)
-            continue;
+            ObjKey key(get_key(tv_index));
 
-        // FIXME: Speed optimization disabled because we need is_null() which is not available on all leaf types.
-/*
-        if (row_ndx < leaf_start || row_ndx >= leaf_end) {
-            size_t ndx_in_leaf;
-            typename ColType::LeafInfo leaf{&arrp, &arr};
-            column->get_leaf(row_ndx, ndx_in_leaf, leaf);
-            leaf_start = row_ndx - ndx_in_leaf;
-            leaf_end = leaf_start + arrp->size();
-        }
-*/
-        // aggregation must be robust in the face of stale keys:
-        if (!m_table->is_valid(key))
-            continue;
+            // skip detached references:
+            if (key == realm::null_key)
+                continue;
 
-        ConstObj obj = m_table->get_object(key);
-        auto v = obj.get<T>(column_key);
+            // aggregation must be robust in the face of stale keys:
+            if (!m_table->is_valid(key))
+                continue;
 
-        if (!obj.is_null(column_key)) {
-            non_nulls++;
-            R unpacked = static_cast<R>(util::unwrap(v));
+            ConstObj obj = m_table->get_object(key);
+            auto v = obj.get<T>(column_key);
 
-            if (is_first) {
-                if (return_key) {
-                    *return_key = key;
-                }
-                res = unpacked;
-                is_first = false;
-            }
-            else if (action == act_Sum || action == act_Average) {
-                res += unpacked;
-            }
-            else if ((action == act_Max && unpacked > res) || non_nulls == 1) {
-                res = unpacked;
-                if (return_key)
-                    *return_key = key;
-            }
-            else if ((action == act_Min && unpacked < res) || non_nulls == 1) {
-                res = unpacked;
-                if (return_key)
-                    *return_key = key;
+            if (!obj.is_null(column_key)) {
+                add_value(static_cast<R>(util::unwrap(v)), key);
             }
         }
     }
@@ -191,11 +177,25 @@ size_t ConstTableView::aggregate_count(ColKey column_key, T count_target) const
 {
     REALM_ASSERT(m_table->valid_column(column_key));
 
-    if ((m_key_values.size()) == 0) {
+    if (size() == 0) {
         return {};
     }
 
     size_t cnt = 0;
+    if (!m_selection.is_empty()) {
+        using LeafType = typename ColumnTypeTraits<T>::cluster_leaf_type;
+        LeafType leaf(m_table->get_alloc());
+        m_table->traverse_clusters([&](const Cluster* cluster) {
+            cluster->init_leaf(column_key, &leaf);
+            m_selection.for_each_in_cluster(cluster, [&](size_t ndx) {
+                if (T(leaf.get(ndx)) == count_target)
+                    cnt++;
+            });
+            return false;
+        });
+        return cnt;
+    }
+
     for (size_t tv_index = 0; tv_index < m_key_values.size(); ++tv_index) {
 
         ObjKey key(get_key(tv_index));
@@ -462,6 +462,7 @@ void ConstTableView::sync_if_needed() const
 void TableView::remove(size_t row_ndx)
 {
     m_table.check();
+    materialize_keys();
     REALM_ASSERT(row_ndx < m_key_values.size());
 
     bool sync_to_keep = m_last_seen_versions == get_dependency_versions();
@@ -491,6 +492,7 @@ void TableView::clear()
 
     bool sync_to_keep = m_last_seen_versions == get_dependency_versions();
 
+    materialize_keys();
     _impl::TableFriend::batch_erase_rows(*get_parent(), m_key_values); // Throws
 
     m_key_values.clear();
@@ -558,6 +560,11 @@ void ConstTableView::sort(SortDescriptor order)
     m_descriptor_ordering.append_sort(std::move(order), SortDescriptor::MergeMode::prepend);
     m_descriptor_ordering.collect_dependencies(m_table.unchecked_ptr());
 
+    // The matches of a query sorted on a column with an ordered index are found again in the order of the index
+    // rather than sorted, unless the view has changed since
+    if (!m_linklist_source && !m_source_column_key && m_table && m_descriptor_ordering.size() == 1 && is_in_sync() &&
+        find_all_sorted())
+        return;
     do_sort(m_descriptor_ordering);
 }
 
@@ -572,6 +579,8 @@ void ConstTableView::do_sync()
     // - Table::get_backlink_view()
     // Here we sync with the respective source.
     m_last_seen_versions.clear();
+    m_selection.clear();
+    bool sorted = false;
 
     if (m_linklist_source) {
         m_key_values.clear();
@@ -605,17 +614,31 @@ void ConstTableView::do_sync()
 
         if (m_query.m_view)
             m_query.m_view->sync_if_needed();
-        m_query.find_all(*const_cast<ConstTableView*>(this), m_start, m_end, m_limit);
+        if (find_all_sorted())
+            sorted = true;
+        else
+            m_query.find_all(*const_cast<ConstTableView*>(this), m_start, m_end, m_limit);
     }
 
-    do_sort(m_descriptor_ordering);
+    do_sort(m_descriptor_ordering, sorted ? 1 : 0);
 
     m_last_seen_versions = get_dependency_versions();
 }
 
-void ConstTableView::do_sort(const DescriptorOrdering& ordering)
+bool ConstTableView::find_all_sorted()
+{
+    // The query can find the matches in the order of the first descriptor, if it sorts on a column with an ordered
+    // index
+    if (!m_query.m_table || m_start != 0 || m_end != size_t(-1) || m_limit != size_t(-1) ||
+        m_descriptor_ordering.is_empty() || m_descriptor_ordering.get_type(0) != DescriptorType::Sort)
+        return false;
+    auto sort = static_cast<const SortDescriptor*>(m_descriptor_ordering[0]);
+    return m_query.find_all_sorted(*this, *sort);
+}
+
+void ConstTableView::do_sort(const DescriptorOrdering& ordering, size_t first_descriptor)
 {
-    if (ordering.is_empty())
+    if (ordering.size() <= first_descriptor)
         return;
     size_t sz = size();
     if (sz == 0)
@@ -639,7 +662,7 @@ void ConstTableView::do_sort(const DescriptorOrdering& ordering)
     }
 
     const int num_descriptors = int(ordering.size());
-    for (int desc_ndx = 0; desc_ndx < num_descriptors; ++desc_ndx) {
+    for (int desc_ndx = int(first_descriptor); desc_ndx < num_descriptors; ++desc_ndx) {
         const BaseDescriptor* base_descr = ordering[desc_ndx];
         const BaseDescriptor* next = ((desc_ndx + 1) < num_descriptors) ? ordering[desc_ndx + 1] : nullptr;
         BaseDescriptor::Sorter predicate = base_descr->sorter(*m_table, index_pairs);
@@ -653,6 +676,7 @@ void ConstTableView::do_sort(const DescriptorOrdering& ordering)
     }
     // Apply the results
     m_limit_count = index_pairs.m_removed_by_limit;
+    m_selection.clear();
     m_key_values.clear();
     for (auto& pair : index_pairs) {
         m_key_values.add(pair.key_for_object);
@@ -661,6 +685,14 @@ void ConstTableView::do_sort(const DescriptorOrdering& ordering)
         m_key_values.add(null_key);
 }
 
+void ConstTableView::materialize_keys()
+{
+    if (!m_selection.is_empty()) {
+        m_selection.get_keys(m_key_values); // Throws
+        m_selection.clear();
+    }
+}
+
 bool ConstTableView::is_in_table_order() const
 {
     if (!m_table) {
@@ -21,6 +21,7 @@
 
 #include <realm/sort_descriptor.hpp>
 #include <realm/table.hpp>
+#include <realm/key_selection.hpp>
 #include <realm/util/features.h>
 #include <realm/obj_list.hpp>
 #include <realm/list.hpp>
@@ -196,11 +197,11 @@ public:
     }
     size_t size() const override
     {
-        return m_key_values.size();
+        return m_selection.is_empty() ? m_key_values.size() : m_selection.size();
     }
     bool is_empty() const noexcept
     {
-        return m_key_values.size() == 0;
+        return size() == 0;
     }
 
     // Tells if the table that this TableView points at still exists or has been deleted.
@@ -211,7 +212,7 @@ public:
 
     ObjKey get_key(size_t ndx) const override
     {
-        return m_key_values.get(ndx);
+        return m_selection.is_empty() ? m_key_values.get(ndx) : m_selection.get(ndx);
     }
 
     bool is_obj_valid(size_t ndx) const noexcept override
@@ -282,7 +283,19 @@ public:
     /// within this view is returned, otherwise `realm::not_found` is returned.
     size_t find_by_source_ndx(ObjKey key) const noexcept
     {
-        return m_key_values.find_first(key);
+        return m_selection.is_empty() ? m_key_values.find_first(key) : m_selection.find(key);
+    }
+
+    // Returns whether the view holds its objects as a selection of the objects of
+    // each cluster of the table rather than as a list of keys. Unsorted views
+    // built by a query that scans the whole table do, so that views matching a
+    // large part of a table take little memory. The key of an object is then
+    // only built when asked for, and aggregates read the selected objects
+    // directly from the clusters. Any change to the order or the content of the
+    // view turns the selection into a list of keys.
+    bool uses_selection() const noexcept
+    {
+        return !m_selection.is_empty();
     }
 
     // Conversion
@@ -374,7 +387,12 @@ protected:
     void get_dependencies(TableVersions&) const override;
 
     void do_sync();
-    void do_sort(const DescriptorOrdering&);
+    // Finds all the matches of the query in the order of the first descriptor, see Query::find_all_sorted()
+    bool find_all_sorted();
+    // Applies the descriptors of the ordering from 'first_descriptor' on
+    void do_sort(const DescriptorOrdering&, size_t first_descriptor = 0);
+    // Replace the selection, if any, by the list of its keys
+    void materialize_keys();
 
     mutable ConstTableRef m_table;
     // The source column index that this view contain backlinks for.
@@ -401,6 +419,8 @@ protected:
 
     mutable TableVersions m_last_seen_versions;
     KeyColumn m_key_values;
+    // If not empty, the objects of the view, and m_key_values is empty
+    KeySelection m_selection;
 
 private:
     ObjKey find_first_integer(ColKey column_key, int64_t value) const;
@@ -548,6 +568,7 @@ inline ConstTableView::ConstTableView(const ConstTableView& tv)
     , m_limit(tv.m_limit)
     , m_last_seen_versions(tv.m_last_seen_versions)
     , m_key_values(tv.m_key_values)
+    , m_selection(tv.m_selection)
 {
     m_limit_count = tv.m_limit_count;
 }
@@ -567,6 +588,7 @@ inline ConstTableView::ConstTableView(ConstTableView&& tv) noexcept
     // version number so that we can later trigger a sync if needed.
     , m_last_seen_versions(std::move(tv.m_last_seen_versions))
     , m_key_values(std::move(tv.m_key_values))
+    , m_selection(std::move(tv.m_selection))
 {
     m_limit_count = tv.m_limit_count;
 }
@@ -576,6 +598,7 @@ inline ConstTableView& ConstTableView::operator=(ConstTableView&& tv) noexcept
     m_table = std::move(tv.m_table);
 
     m_key_values = std::move(tv.m_key_values);
+    m_selection = std::move(tv.m_selection);
     m_query = std::move(tv.m_query);
     m_last_seen_versions = tv.m_last_seen_versions;
     m_start = tv.m_start;
@@ -597,6 +620,7 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
         return *this;
 
     m_key_values = tv.m_key_values;
+    m_selection = tv.m_selection;
 
     m_query = tv.m_query;
     m_last_seen_versions = tv.m_last_seen_versions;
@@ -619,7 +643,7 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
 
 #define REALM_ASSERT_ROW(row_ndx)                                                                                    \
     m_table.check();                                                                                                 \
-    REALM_ASSERT(row_ndx < m_key_values.size())
+    REALM_ASSERT(row_ndx < size())
 
 #define REALM_ASSERT_COLUMN_AND_TYPE(column_key, column_type)                                                        \
     REALM_ASSERT_COLUMN(column_key);                                                                                 \
@@ -630,11 +654,11 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
 
 #define REALM_ASSERT_INDEX(column_key, row_ndx)                                                                      \
     REALM_ASSERT_COLUMN(column_key);                                                                                 \
-    REALM_ASSERT(row_ndx < m_key_values.size())
+    REALM_ASSERT(row_ndx < size())
 
 #define REALM_ASSERT_INDEX_AND_TYPE(column_key, row_ndx, column_type)                                                \
     REALM_ASSERT_COLUMN_AND_TYPE(column_key, column_type);                                                           \
-    REALM_ASSERT(row_ndx < m_key_values.size())
+    REALM_ASSERT(row_ndx < size())
 
 #define REALM_ASSERT_INDEX_AND_TYPE_TABLE_OR_MIXED(column_key, row_ndx)                                              \
     REALM_ASSERT_COLUMN(column_key);                                                                                 \
@@ -643,7 +667,7 @@ inline ConstTableView& ConstTableView::operator=(const ConstTableView& tv)
     REALM_ASSERT(m_table->get_column_type(column_key) == type_Table ||                                               \
                  (m_table->get_column_type(column_key) == type_Mixed));                                              \
     REALM_DIAG_POP();                                                                                                \
-    REALM_ASSERT(row_ndx < m_key_values.size())
+    REALM_ASSERT(row_ndx < size())
 
 //-------------------------- TableView, ConstTableView implementation:
 
@@ -686,7 +710,7 @@ inline TableView::TableView(TableRef parent, ConstLnkLstPtr link_list)
 inline Obj TableView::get(size_t row_ndx)
 {
     REALM_ASSERT_ROW(row_ndx);
-    ObjKey key(m_key_values.get(row_ndx));
+    ObjKey key = get_key(row_ndx);
     REALM_ASSERT(key != realm::null_key);
     return get_parent()->get_object(key);
 }
@@ -970,5 +970,18 @@ void msync(FileDesc fd, void* addr, size_t size)
     }
 #endif
 }
+
+void madvise_will_need(void* addr, size_t size) noexcept
+{
+#ifdef _WIN32
+    static_cast<void>(addr);
+    static_cast<void>(size);
+#else
+    // madvise() requires a page aligned address
+    uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~uintptr_t(page_size() - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#endif
+}
 }
 }
@@ -38,6 +38,8 @@ void* mremap(FileDesc fd, size_t file_offset, void* old_addr, size_t old_size, F
              const char* encryption_key);
 void msync(FileDesc fd, void* addr, size_t size);
 void* mmap_anon(size_t size);
+// Advise the OS that the mapped memory at 'addr' will be read soon. This is only a hint, so failures are ignored.
+void madvise_will_need(void* addr, size_t size) noexcept;
 
 // A function which may be given to encryption_read_barrier. If present, the read barrier is a
 // a barrier for a full array. If absent, the read barrier is a barrier only for the address
@@ -0,0 +1,179 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/util/thread_pool.hpp>
+
+#include <algorithm>
+
+using namespace realm::util;
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : m_num_threads(std::max(num_threads, size_t(1)))
+    , m_shares(new Share[m_num_threads])
+{
+    m_threads.reserve(m_num_threads - 1);
+    try {
+        for (size_t i = 1; i < m_num_threads; ++i)
+            m_threads.emplace_back([this, i] {
+                worker(i);
+            }); // Throws
+    }
+    catch (...) {
+        stop();
+        throw;
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    stop();
+}
+
+void ThreadPool::stop() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start_cond.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::run(size_t num_tasks, FunctionRef<void(size_t, size_t)> task)
+{
+    if (num_tasks == 0)
+        return;
+
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+    for (size_t i = 0; i < m_num_threads; ++i) {
+        std::lock_guard<std::mutex> lock(m_shares[i].mutex);
+        m_shares[i].begin = num_tasks * i / m_num_threads;
+        m_shares[i].end = num_tasks * (i + 1) / m_num_threads;
+    }
+    m_failed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_exception = nullptr;
+        m_busy_threads = m_num_threads - 1;
+        ++m_batch;
+    }
+    m_start_cond.notify_all();
+
+    work(0, task);
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done_cond.wait(lock, [this] {
+            return m_busy_threads == 0;
+        });
+        m_task = nullptr;
+        exception = std::move(m_exception);
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void ThreadPool::worker(size_t thread_ndx)
+{
+    uint64_t batch = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_start_cond.wait(lock, [&] {
+            return m_stop || m_batch != batch;
+        });
+        if (m_stop)
+            return;
+        batch = m_batch;
+        FunctionRef<void(size_t, size_t)> task = *m_task;
+        lock.unlock();
+        work(thread_ndx, task);
+        lock.lock();
+        // The batch cannot finish, and no new batch can start, before every thread has got here
+        if (--m_busy_threads == 0)
+            m_done_cond.notify_one();
+    }
+}
+
+void ThreadPool::work(size_t thread_ndx, FunctionRef<void(size_t, size_t)> task)
+{
+    size_t task_ndx;
+    while (!m_failed && (take(thread_ndx, task_ndx) || steal(thread_ndx, task_ndx))) {
+        try {
+            task(task_ndx, thread_ndx); // Throws
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_failed) {
+                m_exception = std::current_exception();
+                m_failed = true;
+            }
+        }
+    }
+}
+
+bool ThreadPool::take(size_t thread_ndx, size_t& task_ndx)
+{
+    Share& share = m_shares[thread_ndx];
+    std::lock_guard<std::mutex> lock(share.mutex);
+    if (share.begin == share.end)
+        return false;
+    task_ndx = share.begin++;
+    return true;
+}
+
+bool ThreadPool::steal(size_t thread_ndx, size_t& task_ndx)
+{
+    for (;;) {
+        size_t victim = thread_ndx;
+        size_t largest = 0;
+        for (size_t i = 0; i < m_num_threads; ++i) {
+            if (i == thread_ndx)
+                continue;
+            std::lock_guard<std::mutex> lock(m_shares[i].mutex);
+            size_t remaining = m_shares[i].end - m_shares[i].begin;
+            if (remaining > largest) {
+                largest = remaining;
+                victim = i;
+            }
+        }
+        if (largest == 0)
+            return false;
+
+        size_t begin, end;
+        {
+            Share& share = m_shares[victim];
+            std::lock_guard<std::mutex> lock(share.mutex);
+            // The owner or another thief may have got there first
+            if (share.begin == share.end)
+                continue;
+            end = share.end;
+            share.end -= (share.end - share.begin + 1) / 2;
+            begin = share.end;
+        }
+        // Only this thread adds to its own share, and it is empty
+        Share& own = m_shares[thread_ndx];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin + 1;
+        own.end = end;
+        task_ndx = begin;
+        return true;
+    }
+}
@@ -0,0 +1,101 @@
+/*************************************************************************
+ *
+ * Copyright 2020 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_THREAD_POOL_HPP
+#define REALM_UTIL_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <realm/util/function_ref.hpp>
+
+namespace realm {
+namespace util {
+
+/// A fixed set of threads running batches of numbered tasks.
+///
+/// run() gives every thread an equal share of consecutive task numbers. A
+/// thread works through its own share from the front, and when that is used
+/// up, it steals the back half of what is left of the largest share of another
+/// thread. Neighbouring tasks therefore mostly run on the same thread.
+///
+/// The thread calling run() takes part in the batch, so a pool created for N
+/// threads starts N - 1 threads of its own. Batches from different threads
+/// are run one at a time.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// The number of threads taking part in a batch, including the calling
+    /// thread.
+    size_t get_num_threads() const noexcept
+    {
+        return m_num_threads;
+    }
+
+    /// Call `task(task_ndx, thread_ndx)` for every `task_ndx` in `[0,
+    /// num_tasks)`, and return when all the tasks have finished. `thread_ndx`
+    /// is less than get_num_threads(), and no two tasks with the same
+    /// `thread_ndx` run at the same time. If a task throws, the tasks that
+    /// have not started yet are skipped, and the first exception is rethrown
+    /// when the others have finished.
+    void run(size_t num_tasks, FunctionRef<void(size_t task_ndx, size_t thread_ndx)> task);
+
+private:
+    struct Share {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    const size_t m_num_threads;
+    std::unique_ptr<Share[]> m_shares; // One per thread taking part in a batch
+    std::vector<std::thread> m_threads;
+    std::atomic<bool> m_failed{false};
+
+    std::mutex m_run_mutex; // Held for the duration of a batch
+    std::mutex m_mutex;     // Protects the members below
+    std::condition_variable m_start_cond;
+    std::condition_variable m_done_cond;
+    FunctionRef<void(size_t, size_t)>* m_task = nullptr;
+    uint64_t m_batch = 0;
+    size_t m_busy_threads = 0;
+    bool m_stop = false;
+    std::exception_ptr m_exception;
+
+    void stop() noexcept;
+    void worker(size_t thread_ndx);
+    void work(size_t thread_ndx, FunctionRef<void(size_t, size_t)> task);
+    bool take(size_t thread_ndx, size_t& task_ndx);
+    bool steal(size_t thread_ndx, size_t& task_ndx);
+};
+
+} // namespace util
+} // namespace realm
+
+#endif // REALM_UTIL_THREAD_POOL_HPP
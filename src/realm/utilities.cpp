@@ -61,6 +61,30 @@ inline unsigned long long _xgetbv(unsigned index)
 }
 
 #endif
+
+// Returns the EBX register of CPUID leaf 7, sub-leaf 0 (structured extended feature flags), or 0 if the CPU does
+// not report that leaf.
+int cpuid_extended_features()
+{
+#ifdef _MSC_VER
+    int CPUInfo[4];
+    __cpuid(CPUInfo, 0);
+    if (CPUInfo[0] < 7)
+        return 0;
+    __cpuidex(CPUInfo, 7, 0);
+    return CPUInfo[1];
+#else
+    int eax = 0, ebx, ecx = 0, edx;
+    __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    if (eax < 7)
+        return 0;
+    eax = 7;
+    ecx = 0;
+    __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return ebx;
+#endif
+}
+
 #endif
 #endif
 
@@ -106,6 +130,8 @@ void cpuid_init()
     }
 
     bool avxSupported = false;
+    bool avx2Supported = false;
+    bool avx512Supported = false;
 
 // seems like in jenkins builds, __GNUC__ is defined for clang?! todo fixme
 #if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
@@ -116,18 +142,30 @@ void cpuid_init()
         // Check if the OS will save the YMM registers
         unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
         avxSupported = (xcrFeatureMask & 0x6) || false;
+
+        if (avxSupported) {
+            int ext = cpuid_extended_features();
+            avx2Supported = ext & (1 << 5) || false;
+            // AVX-512 additionally requires the OS to save the opmask and upper ZMM registers
+            bool osUsesZMM = (xcrFeatureMask & 0xe6) == 0xe6;
+            avx512Supported = avx2Supported && osUsesZMM && (ext & (1 << 16)) && (ext & (1 << 30));
+        }
     }
 #endif
 
-    if (avxSupported) {
+    if (avx512Supported) {
+        avx_support = 2; // AVX-512 F and BW supported
+    }
+    else if (avx2Supported) {
+        avx_support = 1; // AVX2 supported
+    }
+    else if (avxSupported) {
         avx_support = 0; // AVX1 supported
     }
     else {
         avx_support = -1; // No AVX supported
     }
 
-// 1 is reserved for AVX2
-
 #endif
 }
 
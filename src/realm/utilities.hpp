@@ -72,6 +72,16 @@ typedef SSIZE_T ssize_t;
 #define REALM_COMPILER_AVX
 #endif
 
+// Kernels for instruction sets above the build's baseline are compiled with a per-function target attribute and
+// are only called after the corresponding sseavx<>() runtime check has passed.
+#if defined(REALM_COMPILER_AVX) && defined(__GNUC__)
+#define REALM_TARGET_AVX2 __attribute__((target("avx2")))
+#define REALM_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#else
+#define REALM_TARGET_AVX2
+#define REALM_TARGET_AVX512
+#endif
+
 namespace realm {
 
 using StringCompareCallback = std::function<bool(const char* string1, const char* string2)>;
@@ -83,8 +93,8 @@ template <int version>
 REALM_FORCEINLINE bool sseavx()
 {
     /*
-    Return whether or not SSE 3.0 (if version = 30) or 4.2 (for version = 42) is supported. Return value
-    is based on the CPUID instruction.
+    Return whether or not SSE 3.0 (if version = 30) or 4.2 (for version = 42) is supported, or which level of
+    AVX (version = 1, 2 or 512) is supported. Return value is based on the CPUID instruction.
 
     sse_support = -1: No SSE support
     sse_support = 0: SSE3
@@ -92,7 +102,8 @@ REALM_FORCEINLINE bool sseavx()
 
     avx_support = -1: No AVX support
     avx_support = 0: AVX1 supported
-    sse_support = 1: AVX2 supported (not yet implemented for detection in our cpuid_init(), todo)
+    avx_support = 1: AVX2 supported
+    avx_support = 2: AVX-512 supported (the F and BW subsets, which is what the integer search kernels use)
 
     This lets us test very rapidly at runtime because we just need 1 compare instruction (with 0) to test both for
     SSE 3 and 4.2 by caller (compiler optimizes if calls are concecutive), and can decide branch with ja/jl/je because
@@ -101,8 +112,9 @@ REALM_FORCEINLINE bool sseavx()
     We runtime-initialize sse_support in a constructor of a static variable which is not guaranteed to be called
     prior to cpu_sse(). So we compile-time initialize sse_support to -2 as fallback.
     */
-    static_assert(version == 1 || version == 2 || version == 30 || version == 42,
-                  "Only version == 1 (AVX), 2 (AVX2), 30 (SSE 3) and 42 (SSE 4.2) are supported for detection");
+    static_assert(version == 1 || version == 2 || version == 512 || version == 30 || version == 42,
+                  "Only version == 1 (AVX), 2 (AVX2), 512 (AVX-512), 30 (SSE 3) and 42 (SSE 4.2) are supported for "
+                  "detection");
 #ifdef REALM_COMPILER_SSE
     if (version == 30)
         return (sse_support >= 0);
@@ -112,6 +124,8 @@ REALM_FORCEINLINE bool sseavx()
         return (avx_support >= 0);
     else if (version == 2) // avx2
         return (avx_support > 0);
+    else if (version == 512) // avx-512
+        return (avx_support > 1);
     else
         return false;
 #else
@@ -1051,6 +1051,110 @@ struct BenchmarkQueryIntEqualityIndexed : BenchmarkQueryIntEquality {
     }
 };
 
+// Full column scans with each of the four integer conditions. The values are drawn so that the leaves get the
+// requested bit width, which decides the vector lane width used by the search kernels.
+template <size_t width>
+struct BenchmarkQueryIntScan : BenchmarkWithIntsTable {
+    const size_t num_rows = BASE_SIZE * 4;
+    const int64_t pivot = int64_t(1) << (width - 3);
+    const char* name() const
+    {
+        if (width == 8)
+            return "QueryIntScan8";
+        if (width == 16)
+            return "QueryIntScan16";
+        if (width == 32)
+            return "QueryIntScan32";
+        return "QueryIntScan64";
+    }
+
+    void before_all(DBRef group)
+    {
+        BenchmarkWithIntsTable::before_all(group);
+        WrtTrans tr(group);
+        TableRef t = tr.get_table(name());
+        Random r;
+        const int64_t max = int64_t(1) << (width - 2);
+#ifdef REALM_CLUSTER_IF
+        std::vector<ObjKey> keys;
+        t->create_objects(num_rows, keys);
+        for (auto e : *t) {
+            e.set<Int>(m_col, r.draw_int_mod(max));
+        }
+#else
+        t->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            t->set_int(0, i, r.draw_int_mod(max));
+        }
+#endif
+        tr.commit();
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        size_t greater = table->where().greater(m_col, pivot).count();
+        size_t less = table->where().less(m_col, pivot).count();
+        size_t equal = table->where().equal(m_col, pivot).count();
+        size_t not_equal = table->where().not_equal(m_col, pivot).count();
+        REALM_ASSERT_3(greater + less + equal, ==, num_rows);
+        REALM_ASSERT_3(equal + not_equal, ==, num_rows);
+        static_cast<void>(greater);
+        static_cast<void>(less);
+        static_cast<void>(not_equal);
+    }
+};
+
+// Whole table aggregates over a large table. Nearly all of the time is spent in the leaf sum/min/max kernels, for
+// both a plain and a nullable column.
+struct BenchmarkAggregateInts : BenchmarkWithIntsTable {
+    const size_t num_rows = 50000000;
+    ColKey m_col_nullable;
+    const char* name() const
+    {
+        return "AggregateInts50M";
+    }
+
+    void before_all(DBRef group)
+    {
+        BenchmarkWithIntsTable::before_all(group);
+        WrtTrans tr(group);
+        TableRef t = tr.get_table(name());
+        m_col_nullable = t->add_column(type_Int, "nullable_ints", true);
+        Random r;
+#ifdef REALM_CLUSTER_IF
+        for (size_t i = 0; i < num_rows; ++i) {
+            Obj obj = t->create_object();
+            obj.set<Int>(m_col, r.draw_int_mod(100000));
+            if (i % 10 != 0)
+                obj.set<Int>(m_col_nullable, r.draw_int_mod(100000));
+        }
+#else
+        t->add_empty_row(num_rows);
+        for (size_t i = 0; i < num_rows; ++i) {
+            t->set_int(0, i, r.draw_int_mod(100000));
+            if (i % 10 != 0)
+                t->set_int(1, i, r.draw_int_mod(100000));
+        }
+#endif
+        tr.commit();
+    }
+
+    void operator()(DBRef)
+    {
+        ConstTableRef table = m_table;
+        for (ColKey col : {m_col, m_col_nullable}) {
+            int64_t sum = table->sum_int(col);
+            int64_t max = table->maximum_int(col);
+            int64_t min = table->minimum_int(col);
+            REALM_ASSERT_3(min, <=, max);
+            static_cast<void>(sum);
+            static_cast<void>(max);
+            static_cast<void>(min);
+        }
+    }
+};
+
 struct BenchmarkQuery : BenchmarkWithStrings {
     const char* name() const
     {
@@ -1919,6 +2023,11 @@ int benchmark_common_tasks_main()
     BENCH(BenchmarkQueryChainedOrIntsIndexed);
     BENCH(BenchmarkQueryIntEquality);
     BENCH(BenchmarkQueryIntEqualityIndexed);
+    BENCH(BenchmarkQueryIntScan<8>);
+    BENCH(BenchmarkQueryIntScan<16>);
+    BENCH(BenchmarkQueryIntScan<32>);
+    BENCH(BenchmarkQueryIntScan<64>);
+    BENCH(BenchmarkAggregateInts);
     BENCH(BenchmarkIntVsDoubleColumns);
     BENCH(BenchmarkQueryStringOverLinks);
     BENCH(BenchmarkQueryTimestampGreaterOverLinks);
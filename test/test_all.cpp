@@ -281,6 +281,8 @@ void display_build_config()
     const char* cpu_sse = realm::sseavx<42>() ? "4.2" : (realm::sseavx<30>() ? "3.0" : "None");
 
     const char* cpu_avx = realm::sseavx<1>() ? "Yes" : "No";
+    const char* cpu_avx2 = realm::sseavx<2>() ? "Yes" : "No";
+    const char* cpu_avx512 = realm::sseavx<512>() ? "Yes" : "No";
 
     std::cout << std::endl
               << "Realm version: " << Version::get_version() << " with Debug " << with_debug << "\n"
@@ -297,6 +299,8 @@ void display_build_config()
               << "This CPU supports SSE (auto detect):        " << cpu_sse << "\n"
               << "Compiler supported AVX (auto detect):       " << compiler_avx << "\n"
               << "This CPU supports AVX (AVX1) (auto detect): " << cpu_avx << "\n"
+              << "This CPU supports AVX2 (auto detect):       " << cpu_avx2 << "\n"
+              << "This CPU supports AVX-512 (auto detect):    " << cpu_avx512 << "\n"
               << "\n"
               << "Unit test random seed:                      " << unit_test_random_seed << "\n"
               << std::endl;
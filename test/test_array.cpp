@@ -628,6 +628,43 @@ TEST(Array_UpperLowerBound)
 }
 
 
+TEST(Array_UnsignedUpperLowerBound)
+{
+    // Tests ArrayUnsigned::upper_bound() and ArrayUnsigned::lower_bound() for every element width. The values
+    // straddle the sign bit of the element type, and the sizes cover both the short arrays which are scanned in
+    // full and the longer ones which are narrowed down first.
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const uint64_t midpoints[] = {0x80, 0x8000, 0x80000000, 0x8000000000000000};
+    const size_t widths[] = {8, 16, 32, 64};
+    std::vector<uint64_t> v;
+
+    for (size_t w = 0; w < 4; ++w) {
+        for (int i = 0; i < 100; ++i) {
+            ArrayUnsigned a(Allocator::get_default());
+            a.create(0, midpoints[w] + 100);
+            v.clear();
+
+            size_t elements = random.draw_int_mod(200);
+            uint64_t val = midpoints[w] - 100;
+            for (size_t e = 0; e < elements; e++) {
+                a.add(val);
+                v.push_back(val);
+                val += random.draw_int_mod(2);
+            }
+            CHECK_EQUAL(a.get_width(), widths[w]);
+
+            for (uint64_t s = midpoints[w] - 102; s < val + 2; s++) {
+                CHECK_EQUAL(a.upper_bound(s), size_t(std::upper_bound(v.begin(), v.end(), s) - v.begin()));
+                CHECK_EQUAL(a.lower_bound(s), size_t(std::lower_bound(v.begin(), v.end(), s) - v.begin()));
+            }
+            CHECK_EQUAL(a.lower_bound(uint64_t(-1)), elements);
+            CHECK_EQUAL(a.upper_bound(uint64_t(-1)), elements);
+            a.destroy();
+        }
+    }
+}
+
+
 TEST(Array_LowerUpperBound)
 {
     Array a(Allocator::get_default());
@@ -1006,6 +1043,214 @@ TEST(Array_find_sse)
 }
 
 
+namespace {
+
+template <class cond>
+void check_find_against_scan(TestContext& test_context, const Array& a, int64_t value, size_t start, size_t end)
+{
+    cond c;
+    size_t expected_count = 0;
+    size_t expected_first = not_found;
+    for (size_t i = start; i < end; ++i) {
+        if (c(a.get(i), value)) {
+            if (expected_first == not_found)
+                expected_first = i;
+            ++expected_count;
+        }
+    }
+
+    QueryState<int64_t> state(act_Count);
+    a.find<cond>(act_Count, value, start, end, 0, &state);
+    CHECK_EQUAL(expected_count, size_t(state.m_state));
+    CHECK_EQUAL(expected_first, a.find_first<cond>(value, start, end));
+}
+
+} // anonymous namespace
+
+// Compare the SSE, AVX2 and AVX-512 search kernels with a plain scan for every byte aligned width. The start and end
+// offsets make sure that the unaligned head and tail around the vector aligned area are searched too.
+TEST(Array_FindVectorized)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Array a(Allocator::get_default());
+    a.create(Array::type_Normal);
+
+    const signed char detected_avx_support = avx_support;
+    for (int64_t range : {int64_t(100), int64_t(30000), int64_t(2000000000), int64_t(1) << 62}) {
+        a.clear();
+        for (size_t i = 0; i < 700; ++i)
+            a.add(random.draw_int_mod(range) - range / 2);
+
+        // Many equal values, so that the vectors contain more than one match
+        for (size_t i = 0; i < 700; i += 3)
+            a.set(i, a.get(7));
+
+        // Run with every instruction set the CPU supports, widest last
+        for (signed char level = -1; level <= detected_avx_support; ++level) {
+            avx_support = level;
+            for (int64_t value : {a.get(7), a.get(100), int64_t(0), range / 4, -range / 4}) {
+                for (size_t start : {0, 1, 5, 33}) {
+                    for (size_t end : {size_t(700), size_t(697), start + 130}) {
+                        check_find_against_scan<Equal>(test_context, a, value, start, end);
+                        check_find_against_scan<NotEqual>(test_context, a, value, start, end);
+                        check_find_against_scan<Greater>(test_context, a, value, start, end);
+                        check_find_against_scan<Less>(test_context, a, value, start, end);
+                    }
+                }
+            }
+        }
+        avx_support = detected_avx_support;
+    }
+    a.destroy();
+}
+
+
+// Compare the vectorized sum, minimum and maximum with a plain scan for every byte aligned width
+TEST(Array_AggregateVectorized)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Array a(Allocator::get_default());
+    a.create(Array::type_Normal);
+
+    const signed char detected_avx_support = avx_support;
+    for (int64_t range : {int64_t(100), int64_t(30000), int64_t(2000000000), int64_t(1) << 62}) {
+        a.clear();
+        for (size_t i = 0; i < 1000; ++i)
+            a.add(random.draw_int_mod(range) - range / 2);
+
+        for (signed char level = -1; level <= detected_avx_support; ++level) {
+            avx_support = level;
+            for (size_t start : {0, 1, 5, 33}) {
+                for (size_t end : {size_t(1000), size_t(997), start + 150}) {
+                    // Wrap around like the 64 bit accumulator does
+                    uint64_t expected_sum = 0;
+                    int64_t expected_max = a.get(start);
+                    int64_t expected_min = a.get(start);
+                    size_t expected_max_ndx = start;
+                    size_t expected_min_ndx = start;
+                    for (size_t i = start; i < end; ++i) {
+                        int64_t v = a.get(i);
+                        expected_sum += uint64_t(v);
+                        if (v > expected_max) {
+                            expected_max = v;
+                            expected_max_ndx = i;
+                        }
+                        if (v < expected_min) {
+                            expected_min = v;
+                            expected_min_ndx = i;
+                        }
+                    }
+                    CHECK_EQUAL(int64_t(expected_sum), a.get_sum(start, end));
+
+                    QueryState<int64_t> max_state(act_Max);
+                    a.find<None>(act_Max, 0, start, end, 0, &max_state);
+                    CHECK_EQUAL(expected_max, max_state.m_state);
+                    CHECK_EQUAL(expected_max_ndx, max_state.m_minmax_index);
+
+                    QueryState<int64_t> min_state(act_Min);
+                    a.find<None>(act_Min, 0, start, end, 0, &min_state);
+                    CHECK_EQUAL(expected_min, min_state.m_state);
+                    CHECK_EQUAL(expected_min_ndx, min_state.m_minmax_index);
+                }
+            }
+        }
+        avx_support = detected_avx_support;
+    }
+    a.destroy();
+}
+
+
+TEST(Array_OffsetEncoding)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Array a(Allocator::get_default());
+    a.create(Array::type_Normal);
+
+    // Millisecond timestamps need 64 bits, but the offsets from the smallest one fit in 32 bits
+    const int64_t base = 1600000000000;
+    std::vector<int64_t> values;
+    for (size_t i = 0; i < 500; ++i) {
+        values.push_back(base + random.draw_int_mod(int64_t(1000000000)));
+        a.add(values.back());
+    }
+    size_t plain_size = a.get_byte_size();
+    a.encode_offsets();
+    CHECK(a.is_offset_encoded());
+    CHECK_LESS(a.get_byte_size(), plain_size / 2 + 16);
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQUAL(values[i], a.get(i));
+        CHECK_EQUAL(values[i], Array::get(a.get_header(), i));
+    }
+    int64_t chunk[8];
+    a.get_chunk(496, chunk);
+    CHECK_EQUAL(values[499], chunk[3]);
+    CHECK_EQUAL(0, chunk[4]);
+
+    for (int64_t value : {values[7], values[100], base - 1, base + 500000000, int64_t(0), int64_t(-1),
+                          std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()}) {
+        for (size_t start : {0, 1, 33}) {
+            check_find_against_scan<Equal>(test_context, a, value, start, 500);
+            check_find_against_scan<NotEqual>(test_context, a, value, start, 500);
+            check_find_against_scan<Greater>(test_context, a, value, start, 500);
+            check_find_against_scan<Less>(test_context, a, value, start, 500);
+        }
+    }
+
+    int64_t expected_sum = 0;
+    for (int64_t v : values)
+        expected_sum += v;
+    CHECK_EQUAL(expected_sum, a.get_sum());
+
+    QueryState<int64_t> max_state(act_Max);
+    a.find<None>(act_Max, 0, 0, 500, 0, &max_state);
+    CHECK_EQUAL(*std::max_element(values.begin(), values.end()), max_state.m_state);
+    CHECK_EQUAL(values[max_state.m_minmax_index], max_state.m_state);
+
+    QueryState<int64_t> min_state(act_Min);
+    a.find<None>(act_Min, 0, 0, 500, 0, &min_state);
+    CHECK_EQUAL(*std::min_element(values.begin(), values.end()), min_state.m_state);
+    CHECK_EQUAL(values[min_state.m_minmax_index], min_state.m_state);
+
+    // Modifying the array expands it back to 64 bit elements
+    a.set(3, -5);
+    values[3] = -5;
+    CHECK(!a.is_offset_encoded());
+    for (size_t i = 0; i < values.size(); ++i)
+        CHECK_EQUAL(values[i], a.get(i));
+
+    // Sorted arrays can be searched by value
+    values[3] = base;
+    std::sort(values.begin(), values.end());
+    a.clear();
+    for (int64_t v : values)
+        a.add(v);
+    a.encode_offsets();
+    CHECK(a.is_offset_encoded());
+    for (int64_t value : {values[0], values[250], values[499], base - 1, int64_t(0), values[499] + 1}) {
+        size_t expected_lower = std::lower_bound(values.begin(), values.end(), value) - values.begin();
+        size_t expected_upper = std::upper_bound(values.begin(), values.end(), value) - values.begin();
+        CHECK_EQUAL(expected_lower, a.lower_bound_int(value));
+        CHECK_EQUAL(expected_upper, a.upper_bound_int(value));
+    }
+
+    a.insert(0, values[0] - 1);
+    a.erase(500);
+    CHECK(!a.is_offset_encoded());
+    CHECK_EQUAL(values[0] - 1, a.get(0));
+    CHECK_EQUAL(values[498], a.get(499));
+
+    // Values that are spread over the whole range are not encoded
+    a.clear();
+    a.add(std::numeric_limits<int64_t>::min());
+    a.add(std::numeric_limits<int64_t>::max());
+    a.encode_offsets();
+    CHECK(!a.is_offset_encoded());
+
+    a.destroy();
+}
+
+
 TEST(Array_Greater)
 {
     Array a(Allocator::get_default());
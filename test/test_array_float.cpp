@@ -21,6 +21,10 @@
 
 #include <realm/array_basic.hpp>
 #include <realm/column_integer.hpp>
+#include <realm/query_conditions.hpp>
+
+#include <cmath>
+#include <limits>
 
 #include "test.hpp"
 
@@ -555,4 +559,107 @@ TEST(ArrayDouble_Compare)
     BasicArray_Compare<ArrayDouble, double>(test_context);
 }
 
+
+template <class A, typename T, class Cond>
+void BasicArray_CheckFindFirst(TestContext& test_context, const A& f, T value)
+{
+    Cond cond;
+    bool value_is_null = null::is_null_float(value);
+    size_t sz = f.size();
+    for (size_t begin = 0; begin < sz; begin += 3) {
+        for (size_t end = begin; end <= sz; end += 5) {
+            size_t expected = not_found;
+            for (size_t i = begin; i < end; ++i) {
+                T v = f.get(i);
+                if (cond(v, value, null::is_null_float(v), value_is_null)) {
+                    expected = i;
+                    break;
+                }
+            }
+            CHECK_EQUAL(expected, f.template find_first<Cond>(value, begin, end));
+        }
+    }
+}
+
+template <class A, typename T>
+void BasicArray_Kernels(TestContext& test_context)
+{
+    A f(Allocator::get_default());
+    f.create();
+
+    // Long enough for several vectors, with nulls, a NaN that is not null, and infinities
+    const T null_value = null::get_null_float<T>();
+    for (size_t i = 0; i < 45; ++i) {
+        if (i % 7 == 3)
+            f.add(null_value);
+        else if (i == 20)
+            f.add(std::numeric_limits<T>::quiet_NaN());
+        else if (i == 30)
+            f.add(std::numeric_limits<T>::infinity());
+        else
+            f.add(T((int(i * 13) % 17) - 8) / 2);
+    }
+
+    for (T value : {T(-4), T(0), T(1.5), T(100), std::numeric_limits<T>::infinity(), null_value}) {
+        BasicArray_CheckFindFirst<A, T, Equal>(test_context, f, value);
+        BasicArray_CheckFindFirst<A, T, NotEqual>(test_context, f, value);
+        BasicArray_CheckFindFirst<A, T, Greater>(test_context, f, value);
+        BasicArray_CheckFindFirst<A, T, GreaterEqual>(test_context, f, value);
+        BasicArray_CheckFindFirst<A, T, Less>(test_context, f, value);
+        BasicArray_CheckFindFirst<A, T, LessEqual>(test_context, f, value);
+    }
+
+    size_t sz = f.size();
+    for (size_t begin = 0; begin < sz; begin += 3) {
+        for (size_t end = begin; end <= sz; end += 5) {
+            size_t first_between = not_found;
+            size_t count = 0;
+            double sum = 0;
+            size_t min_ndx = npos;
+            size_t max_ndx = npos;
+            for (size_t i = begin; i < end; ++i) {
+                T v = f.get(i);
+                if (first_between == not_found && v >= T(-1) && v <= T(2.5))
+                    first_between = i;
+                if (null::is_null_float(v))
+                    continue;
+                ++count;
+                if (std::isnan(v))
+                    continue;
+                sum += v;
+                if (min_ndx == npos || v < f.get(min_ndx))
+                    min_ndx = i;
+                if (max_ndx == npos || v > f.get(max_ndx))
+                    max_ndx = i;
+            }
+            CHECK_EQUAL(first_between, f.find_first_between(T(-1), T(2.5), begin, end));
+
+            size_t kernel_count = 0;
+            double kernel_sum = f.sum_not_null(begin, end, kernel_count);
+            CHECK_EQUAL(count, kernel_count);
+            if (count > 0 && begin <= 20 && 20 < end)
+                CHECK(std::isnan(kernel_sum));
+            else
+                CHECK_EQUAL(sum, kernel_sum);
+
+            kernel_count = 0;
+            CHECK_EQUAL(min_ndx, f.template minmax_not_null<false>(begin, end, kernel_count));
+            CHECK_EQUAL(count, kernel_count);
+            kernel_count = 0;
+            CHECK_EQUAL(max_ndx, f.template minmax_not_null<true>(begin, end, kernel_count));
+            CHECK_EQUAL(count, kernel_count);
+        }
+    }
+
+    f.destroy(); // cleanup
+}
+TEST(ArrayFloat_Kernels)
+{
+    BasicArray_Kernels<ArrayFloat, float>(test_context);
+}
+TEST(ArrayDouble_Kernels)
+{
+    BasicArray_Kernels<ArrayDouble, double>(test_context);
+}
+
 #endif // TEST_ARRAY_FLOAT
@@ -18,7 +18,10 @@
 
 #include "testsettings.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <numeric>
+#include <vector>
 
 #include <realm/array_integer.hpp>
 #include <realm/array_ref.hpp>
@@ -221,6 +224,471 @@ TEST(ArrayIntNull_Find)
     a.destroy();
 }
 
+TEST(ArrayIntNull_Aggregate)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    ArrayIntNull a(Allocator::get_default());
+    a.create();
+
+    auto check = [&](size_t start, size_t end) {
+        int64_t sum = 0;
+        size_t count = 0;
+        util::Optional<int64_t> max, min;
+        size_t max_ndx = 0, min_ndx = 0;
+        for (size_t i = start; i < end; ++i) {
+            auto v = a.get(i);
+            if (!v)
+                continue;
+            sum += *v;
+            ++count;
+            if (!max || *v > *max) {
+                max = v;
+                max_ndx = i;
+            }
+            if (!min || *v < *min) {
+                min = v;
+                min_ndx = i;
+            }
+        }
+
+        QueryState<int64_t> sum_state(act_Sum);
+        a.find(cond_LeftNotNull, act_Sum, util::none, start, end, 0, &sum_state);
+        CHECK_EQUAL(sum, sum_state.m_state);
+        CHECK_EQUAL(count, sum_state.m_match_count);
+
+        QueryState<int64_t> count_state(act_Count);
+        a.find(cond_LeftNotNull, act_Count, util::none, start, end, 0, &count_state);
+        CHECK_EQUAL(count, size_t(count_state.m_state));
+
+        QueryState<int64_t> max_state(act_Max);
+        a.find(cond_LeftNotNull, act_Max, util::none, start, end, 0, &max_state);
+        CHECK_EQUAL(count, max_state.m_match_count);
+        if (max) {
+            CHECK_EQUAL(*max, max_state.m_state);
+            CHECK_EQUAL(max_ndx, max_state.m_minmax_index);
+        }
+
+        QueryState<int64_t> min_state(act_Min);
+        a.find(cond_LeftNotNull, act_Min, util::none, start, end, 0, &min_state);
+        if (min) {
+            CHECK_EQUAL(*min, min_state.m_state);
+            CHECK_EQUAL(min_ndx, min_state.m_minmax_index);
+        }
+    };
+
+    // Small values use the upper bound of the width as null, large values a random one
+    for (int64_t range : {int64_t(100), int64_t(30000), int64_t(1) << 40}) {
+        a.clear();
+        for (size_t i = 0; i < 1000; ++i) {
+            if (random.draw_int_mod(10) == 0)
+                a.add(util::none);
+            else
+                a.add(random.draw_int_mod(range) - range / 2);
+        }
+        check(0, a.size());
+        check(3, 900);
+        check(17, 18);
+
+        // Only nulls
+        for (size_t i = 100; i < 200; ++i)
+            a.set_null(i);
+        check(100, 200);
+        check(90, 210);
+    }
+
+    a.destroy();
+}
+
+TEST(ArrayIntNull_FindNonNull)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    ArrayIntNull a(Allocator::get_default());
+    a.create();
+
+    auto check = [&](int cond, auto matches, int64_t value) {
+        size_t count = 0;
+        int64_t sum = 0;
+        size_t first = not_found;
+        for (size_t i = 0; i < a.size(); ++i) {
+            auto v = a.get(i);
+            if (!matches(v, value))
+                continue;
+            ++count;
+            sum += v ? *v : 0;
+            if (first == not_found)
+                first = i;
+        }
+        QueryState<int64_t> count_state(act_Count);
+        a.find(cond, act_Count, value, 0, a.size(), 0, &count_state);
+        CHECK_EQUAL(count, size_t(count_state.m_state));
+        QueryState<int64_t> sum_state(act_Sum);
+        a.find(cond, act_Sum, value, 0, a.size(), 0, &sum_state);
+        CHECK_EQUAL(sum, sum_state.m_state);
+        QueryState<int64_t> first_state(act_ReturnFirst, 1);
+        a.find(cond, act_ReturnFirst, value, 0, a.size(), 0, &first_state);
+        CHECK_EQUAL(first, first_state.m_match_count ? size_t(first_state.m_state) : not_found);
+    };
+    auto greater = [](util::Optional<int64_t> v, int64_t value) {
+        return v && *v > value;
+    };
+    auto less = [](util::Optional<int64_t> v, int64_t value) {
+        return v && *v < value;
+    };
+    auto not_equal = [](util::Optional<int64_t> v, int64_t value) {
+        return !v || *v != value;
+    };
+
+    // Both small arrays, where the null value is above the values, and offset encoded ones
+    for (bool encode : {false, true}) {
+        for (int64_t range : {int64_t(100), int64_t(30000), int64_t(1) << 40}) {
+            a.clear();
+            for (size_t i = 0; i < 300; ++i) {
+                if (random.draw_int_mod(5) == 0)
+                    a.add(util::none);
+                else
+                    a.add(random.draw_int_mod(range));
+            }
+            if (encode)
+                a.encode_offsets();
+            for (int64_t value : {int64_t(-1), range / 3, range - 1, range, a.null_value() - 1}) {
+                check(cond_Greater, greater, value);
+                check(cond_Less, less, value);
+                check(cond_NotEqual, not_equal, value);
+                CHECK_EQUAL(a.find_first<GreaterEqual>(value + 1), a.find_first<Greater>(value));
+                CHECK_EQUAL(a.find_first<LessEqual>(value - 1), a.find_first<Less>(value));
+            }
+        }
+    }
+
+    a.destroy();
+}
+
+TEST(ArrayIntNull_OffsetEncoding)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    ArrayIntNull a(Allocator::get_default());
+    a.create();
+
+    // The random null value of a 64 bit array is moved next to the other values before encoding
+    const int64_t base = 1600000000000;
+    std::vector<util::Optional<int64_t>> values;
+    for (size_t i = 0; i < 500; ++i) {
+        if (random.draw_int_mod(10) == 0)
+            values.push_back(util::none);
+        else
+            values.push_back(base + random.draw_int_mod(int64_t(1000000)));
+        a.add(values.back());
+    }
+    a.encode_offsets();
+    CHECK(a.is_offset_encoded());
+    CHECK_EQUAL(32, a.get_width());
+
+    int64_t sum = 0;
+    size_t count = 0;
+    size_t nulls = 0;
+    int64_t max = std::numeric_limits<int64_t>::min();
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQUAL(values[i], a.get(i));
+        CHECK_EQUAL(values[i], ArrayIntNull::get(a.get_header(), i));
+        if (values[i]) {
+            sum += *values[i];
+            max = std::max(max, *values[i]);
+            ++count;
+        }
+        else {
+            ++nulls;
+        }
+    }
+
+    QueryState<int64_t> sum_state(act_Sum);
+    a.find(cond_LeftNotNull, act_Sum, util::none, 0, a.size(), 0, &sum_state);
+    CHECK_EQUAL(sum, sum_state.m_state);
+    CHECK_EQUAL(count, sum_state.m_match_count);
+
+    QueryState<int64_t> max_state(act_Max);
+    a.find(cond_LeftNotNull, act_Max, util::none, 0, a.size(), 0, &max_state);
+    CHECK_EQUAL(max, max_state.m_state);
+    CHECK_EQUAL(count, max_state.m_match_count);
+
+    QueryState<int64_t> null_state(act_Count);
+    a.find(cond_Equal, act_Count, util::none, 0, a.size(), 0, &null_state);
+    CHECK_EQUAL(nulls, size_t(null_state.m_state));
+    CHECK_EQUAL(size_t(std::find(values.begin(), values.end(), values[1]) - values.begin()), a.find_first(values[1]));
+
+    // Setting a value that collides with the null value expands the array and picks another null value
+    int64_t null_value = a.null_value();
+    a.set(0, null_value);
+    values[0] = null_value;
+    CHECK(!a.is_offset_encoded());
+    CHECK_NOT_EQUAL(null_value, a.null_value());
+    for (size_t i = 0; i < values.size(); ++i)
+        CHECK_EQUAL(values[i], a.get(i));
+
+    a.destroy();
+}
+
+TEST(ArrayInteger_RunEncoding)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    ArrayInteger a(Allocator::get_default());
+    a.create();
+
+    // Runs of random length, some of them of values that need 16 bits
+    std::vector<int64_t> values;
+    while (values.size() < 5000) {
+        int64_t v = random.draw_int_mod(8) == 0 ? 1000 + random.draw_int_mod(10) : random.draw_int_mod(10);
+        size_t len = 1 + random.draw_int_mod(200);
+        for (size_t i = 0; i < len; ++i)
+            values.push_back(v);
+    }
+    for (auto v : values)
+        a.add(v);
+    size_t byte_size = a.get_byte_size();
+    a.encode_runs();
+    CHECK(a.is_run_encoded());
+    CHECK_EQUAL(values.size(), a.size());
+    CHECK_LESS(a.get_byte_size() * 10, byte_size);
+    // The header holds the number of elements and the byte size
+    CHECK_EQUAL(values.size(), Array::get_size_from_header(a.get_header()));
+    CHECK_EQUAL(a.get_byte_size(), Array::get_byte_size_from_header(a.get_header()));
+
+    std::vector<int64_t> range(values.size());
+    a.get_range(0, values.size(), range.data());
+    CHECK(range == values);
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQUAL(values[i], a.get(i));
+        CHECK_EQUAL(values[i], Array::get(a.get_header(), i));
+    }
+    int64_t chunk[8];
+    a.get_chunk(values.size() - 5, chunk);
+    for (size_t i = 0; i < 5; ++i)
+        CHECK_EQUAL(values[values.size() - 5 + i], chunk[i]);
+
+    auto check = [&](int cond, auto matches, int64_t value, size_t begin, size_t end) {
+        size_t count = 0;
+        int64_t sum = 0;
+        int64_t max = std::numeric_limits<int64_t>::min();
+        size_t first = not_found;
+        for (size_t i = begin; i < end; ++i) {
+            if (!matches(values[i], value))
+                continue;
+            ++count;
+            sum += values[i];
+            max = std::max(max, values[i]);
+            if (first == not_found)
+                first = i;
+        }
+        QueryState<int64_t> count_state(act_Count);
+        a.find(cond, act_Count, value, begin, end, 0, &count_state);
+        CHECK_EQUAL(count, size_t(count_state.m_state));
+        QueryState<int64_t> limited_state(act_Count, 10);
+        a.find(cond, act_Count, value, begin, end, 0, &limited_state);
+        CHECK_EQUAL(std::min(count, size_t(10)), size_t(limited_state.m_state));
+        QueryState<int64_t> sum_state(act_Sum);
+        a.find(cond, act_Sum, value, begin, end, 0, &sum_state);
+        CHECK_EQUAL(sum, sum_state.m_state);
+        CHECK_EQUAL(count, sum_state.m_match_count);
+        QueryState<int64_t> max_state(act_Max);
+        a.find(cond, act_Max, value, begin, end, 0, &max_state);
+        if (count)
+            CHECK_EQUAL(max, max_state.m_state);
+        CHECK_EQUAL(count, max_state.m_match_count);
+        QueryState<int64_t> first_state(act_ReturnFirst, 1);
+        a.find(cond, act_ReturnFirst, value, begin, end, 0, &first_state);
+        CHECK_EQUAL(first, first_state.m_match_count ? size_t(first_state.m_state) : not_found);
+    };
+    auto equal = [](int64_t v, int64_t value) {
+        return v == value;
+    };
+    auto not_equal = [](int64_t v, int64_t value) {
+        return v != value;
+    };
+    auto greater = [](int64_t v, int64_t value) {
+        return v > value;
+    };
+    auto less = [](int64_t v, int64_t value) {
+        return v < value;
+    };
+    for (int64_t value : {int64_t(-1), int64_t(0), int64_t(5), int64_t(1003), int64_t(2000)}) {
+        for (size_t begin : {size_t(0), size_t(77)}) {
+            size_t end = values.size() - begin;
+            check(cond_Equal, equal, value, begin, end);
+            check(cond_NotEqual, not_equal, value, begin, end);
+            check(cond_Greater, greater, value, begin, end);
+            check(cond_Less, less, value, begin, end);
+        }
+    }
+    CHECK_EQUAL(std::accumulate(values.begin(), values.end(), int64_t(0)), a.get_sum());
+    QueryState<int64_t> max_state(act_Max);
+    a.find(cond_None, act_Max, 0, 0, values.size(), 0, &max_state);
+    CHECK_EQUAL(*std::max_element(values.begin(), values.end()), max_state.m_state);
+
+    // Setting a value decodes the array
+    a.set(3, 70000);
+    values[3] = 70000;
+    CHECK(!a.is_run_encoded());
+    for (size_t i = 0; i < values.size(); ++i)
+        CHECK_EQUAL(values[i], a.get(i));
+
+    // Sorted values
+    a.clear();
+    for (int64_t v = 0; v < 100; ++v) {
+        for (int i = 0; i < 20; ++i)
+            a.add(v * 3);
+    }
+    a.encode_runs();
+    CHECK(a.is_run_encoded());
+    CHECK_EQUAL(0, a.lower_bound_int(-5));
+    CHECK_EQUAL(20 * 10, a.lower_bound_int(30));
+    CHECK_EQUAL(20 * 11, a.upper_bound_int(30));
+    CHECK_EQUAL(20 * 11, a.lower_bound_int(31));
+    CHECK_EQUAL(2000, a.upper_bound_int(297));
+
+    // Inserting decodes the array as well
+    a.insert(0, -1);
+    CHECK(!a.is_run_encoded());
+    CHECK_EQUAL(2001, a.size());
+    CHECK_EQUAL(-1, a.get(0));
+    CHECK_EQUAL(297, a.get(2000));
+
+    // Values without runs are left alone
+    a.clear();
+    for (int64_t v = 0; v < 1000; ++v)
+        a.add(v);
+    a.encode_runs();
+    CHECK(!a.is_run_encoded());
+
+    a.destroy();
+}
+
+TEST(ArrayIntNull_RunEncoding)
+{
+    ArrayIntNull a(Allocator::get_default());
+    a.create();
+
+    std::vector<util::Optional<int64_t>> values;
+    for (size_t i = 0; i < 3000; ++i) {
+        if (i % 1000 < 300)
+            values.push_back(util::none);
+        else
+            values.push_back(int64_t(i / 500) * 100000);
+        a.add(values.back());
+    }
+    a.encode_runs();
+    CHECK(a.is_run_encoded());
+    for (size_t i = 0; i < values.size(); ++i)
+        CHECK_EQUAL(values[i], a.get(i));
+
+    QueryState<int64_t> null_state(act_Count);
+    a.find(cond_Equal, act_Count, util::none, 0, a.size(), 0, &null_state);
+    CHECK_EQUAL(900, size_t(null_state.m_state));
+
+    QueryState<int64_t> equal_state(act_Count);
+    a.find(cond_Equal, act_Count, 200000, 0, a.size(), 0, &equal_state);
+    CHECK_EQUAL(200, size_t(equal_state.m_state));
+
+    QueryState<int64_t> not_equal_state(act_Count);
+    a.find(cond_NotEqual, act_Count, 200000, 0, a.size(), 0, &not_equal_state);
+    CHECK_EQUAL(2800, size_t(not_equal_state.m_state));
+
+    int64_t sum = 0;
+    for (auto& v : values)
+        sum += v ? *v : 0;
+    QueryState<int64_t> sum_state(act_Sum);
+    a.find(cond_LeftNotNull, act_Sum, util::none, 0, a.size(), 0, &sum_state);
+    CHECK_EQUAL(sum, sum_state.m_state);
+    CHECK_EQUAL(2100, sum_state.m_match_count);
+
+    QueryState<int64_t> min_state(act_Min);
+    a.find(cond_LeftNotNull, act_Min, util::none, 0, a.size(), 0, &min_state);
+    CHECK_EQUAL(0, min_state.m_state);
+    CHECK_EQUAL(300, min_state.m_minmax_index);
+
+    CHECK_EQUAL(1300, a.find_first(util::Optional<int64_t>(200000)));
+    CHECK_EQUAL(0, a.find_first(util::Optional<int64_t>()));
+    CHECK_EQUAL(1000, a.find_first(util::Optional<int64_t>(), 500));
+
+    // A value colliding with the null value picks another null value
+    int64_t null_value = a.null_value();
+    a.set(5, null_value);
+    values[5] = null_value;
+    CHECK(!a.is_run_encoded());
+    CHECK_NOT_EQUAL(null_value, a.null_value());
+    for (size_t i = 0; i < values.size(); ++i)
+        CHECK_EQUAL(values[i], a.get(i));
+
+    a.destroy();
+}
+
+TEST(ArrayIntNull_ValidityEncoding)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    ArrayIntNull a(Allocator::get_default());
+    ArrayIntNull b(Allocator::get_default());
+    a.create();
+    b.create();
+
+    // 'b' keeps the null value in front of the elements, so every search on 'a' must give the same result
+    auto check = [&](int cond, util::Optional<int64_t> value, size_t begin, size_t end) {
+        for (Action action : {act_Count, act_Sum, act_Min, act_Max, act_ReturnFirst}) {
+            QueryState<int64_t> state_a(action, action == act_ReturnFirst ? 1 : size_t(-1));
+            QueryState<int64_t> state_b(action, action == act_ReturnFirst ? 1 : size_t(-1));
+            a.find(cond, action, value, begin, end, 0, &state_a);
+            b.find(cond, action, value, begin, end, 0, &state_b);
+            CHECK_EQUAL(state_b.m_match_count, state_a.m_match_count);
+            if (state_b.m_match_count)
+                CHECK_EQUAL(state_b.m_state, state_a.m_state);
+        }
+    };
+
+    for (size_t null_ratio : {0, 2, 10}) {
+        a.clear();
+        b.clear();
+        for (size_t i = 0; i < 1000; ++i) {
+            util::Optional<int64_t> value;
+            if (null_ratio == 0 || random.draw_int_mod(null_ratio) != 0)
+                value = 1000 + int64_t(i / 50) * 10 + random.draw_int_mod(3);
+            a.add(value);
+            b.add(value);
+        }
+        a.encode_validity();
+        CHECK(a.is_validity_encoded());
+        a.verify();
+
+        for (size_t i = 0; i < a.size(); ++i)
+            CHECK_EQUAL(b.get(i), a.get(i));
+        int64_t values_a[200];
+        int64_t values_b[200];
+        CHECK_EQUAL(b.get_range(70, 270, values_b), a.get_range(70, 270, values_a));
+        CHECK(std::equal(values_a, values_a + 200, values_b));
+
+        for (util::Optional<int64_t> value : {util::Optional<int64_t>(), util::Optional<int64_t>(1101),
+                                              util::Optional<int64_t>(1000), util::Optional<int64_t>(5000)}) {
+            for (int cond : {cond_Equal, cond_NotEqual, cond_Greater, cond_Less}) {
+                check(cond, value, 0, a.size());
+                check(cond, value, 70, 937);
+            }
+            CHECK_EQUAL(b.find_first<GreaterEqual>(value, 13), a.find_first<GreaterEqual>(value, 13));
+            CHECK_EQUAL(b.find_first<LessEqual>(value, 13), a.find_first<LessEqual>(value, 13));
+        }
+        check(cond_LeftNotNull, util::none, 0, a.size());
+        check(cond_None, util::none, 5, 700);
+
+        // A modification expands the leaf again
+        a.set(500, 7);
+        b.set(500, 7);
+        a.insert(3, util::none);
+        b.insert(3, util::none);
+        CHECK(!a.is_validity_encoded());
+        CHECK_EQUAL(b.size(), a.size());
+        for (size_t i = 0; i < a.size(); ++i)
+            CHECK_EQUAL(b.get(i), a.get(i));
+    }
+
+    a.destroy_deep();
+    b.destroy();
+}
+
 TEST(ArrayRef_Basic)
 {
     ArrayRef a(Allocator::get_default());
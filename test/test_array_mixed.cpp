@@ -160,5 +160,90 @@ TEST(Mixed_Table)
     CHECK_EQUAL(obj1.get_any(col_data), Mixed("Hello"));
 }
 
+TEST(ArrayMixed_FindFirst)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    std::string str_values[] = {"", "Hello", "World"};
+    auto random_value = [&]() -> Mixed {
+        switch (random.draw_int<int>(0, 7)) {
+            case 0:
+                return Mixed();
+            case 1:
+                return Mixed(random.draw_int<int64_t>(-3, 3));
+            case 2:
+                return Mixed(int64_t(random.draw_int<int>(-2, 2)) << 40);
+            case 3:
+                return Mixed(bool(random.draw_int<int>(0, 1)));
+            case 4:
+                return Mixed(float(random.draw_int<int>(-1, 1)) * 0.5f);
+            case 5:
+                return Mixed(double(random.draw_int<int>(-1, 1)) * 0.5);
+            case 6:
+                return Mixed(0.0 * random.draw_int<int>(-1, 1)); // 0 or -0
+            default:
+                return Mixed(StringData(str_values[random.draw_int<int>(0, 2)]));
+        }
+    };
+
+    ArrayMixed arr(Allocator::get_default());
+    arr.create();
+    std::vector<Mixed> values;
+    for (size_t i = 0; i < 500; i++) {
+        values.push_back(random_value());
+        arr.add(values.back());
+    }
+    // Erasing entries leaves holes in the payload arrays
+    for (size_t i = 0; i < 50; i++) {
+        size_t ndx = random.draw_int<size_t>(0, values.size() - 1);
+        values.erase(values.begin() + ndx);
+        arr.erase(ndx);
+    }
+
+    auto brute_force = [&](Mixed needle, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (values[i].is_null() || needle.is_null()) {
+                if (values[i].is_null() && needle.is_null())
+                    return i;
+            }
+            else if (values[i].get_type() == needle.get_type() && values[i] == needle) {
+                return i;
+            }
+        }
+        return realm::npos;
+    };
+
+    for (size_t i = 0; i < 1000; i++) {
+        Mixed needle = random_value();
+        size_t begin = random.draw_int<size_t>(0, values.size());
+        size_t end = random.draw_int<size_t>(begin, values.size());
+        CHECK_EQUAL(arr.find_first(needle, begin, end), brute_force(needle, begin, end));
+    }
+    CHECK_EQUAL(arr.find_first(Mixed(int64_t(12345678901)), 0, values.size()), realm::npos);
+    CHECK_EQUAL(arr.find_first(Mixed(std::nan("")), 0, values.size()), realm::npos);
+
+    arr.destroy();
+}
+
+TEST(Mixed_Query)
+{
+    Table t;
+    auto col_data = t.add_column(type_OldMixed, "data");
+    t.create_object().set(col_data, Mixed(5));
+    t.create_object().set(col_data, Mixed("Hello"));
+    t.create_object().set(col_data, Mixed(5.0));
+    t.create_object().set(col_data, Mixed(int64_t(1) << 40));
+    t.create_object();
+    t.create_object().set(col_data, Mixed(5));
+
+    CHECK_EQUAL(t.where().equal(col_data, int64_t(5)).count(), 2);
+    CHECK_EQUAL(t.where().equal(col_data, 5.0).count(), 1);
+    CHECK_EQUAL(t.where().equal(col_data, int64_t(1) << 40).count(), 1);
+    CHECK_EQUAL(t.where().equal(col_data, "Hello").count(), 1);
+    CHECK_EQUAL(t.where().equal(col_data, null()).count(), 1);
+    CHECK_EQUAL(t.where().not_equal(col_data, int64_t(5)).count(), 4);
+    CHECK_EQUAL(t.where().not_equal(col_data, null()).count(), 5);
+    CHECK_THROW(t.where().greater(col_data, int64_t(5)), LogicError);
+}
+
 
 #endif // TEST_ARRAY_VARIANT
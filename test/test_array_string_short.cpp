@@ -20,6 +20,7 @@
 #ifdef TEST_ARRAY_STRING
 
 #include <realm/array_string_short.hpp>
+#include <realm/array_string.hpp>
 #include <realm/column_integer.hpp>
 
 #include "test.hpp"
@@ -693,6 +694,148 @@ TEST(ArrayString_Compare)
     b.destroy();
 }
 
+TEST(ArrayString_Dictionary)
+{
+    Allocator& alloc = Allocator::get_default();
+    ArrayString a(alloc);
+    a.create();
+
+    const char* values[] = {"active", "inactive", "pending"};
+    for (size_t i = 0; i < 300; ++i)
+        a.add(values[i % 3]);
+    a.set(7, "");
+    a.set(8, realm::null());
+
+    a.encode_dictionary();
+    CHECK(a.has_dictionary());
+    CHECK(ArrayString::has_dictionary(alloc.translate(a.get_ref())));
+    CHECK_NOT(Array::get_is_inner_bptree_node_from_header(alloc.translate(a.get_ref())));
+    CHECK_EQUAL(300, a.size());
+    CHECK_EQUAL("inactive", a.get(1));
+    CHECK_EQUAL("inactive", ArrayString::get(alloc.translate(a.get_ref()), 1, alloc));
+    CHECK(!a.is_null(7));
+    CHECK_EQUAL("", a.get(7));
+    CHECK(a.is_null(8));
+    CHECK(ArrayString::get(alloc.translate(a.get_ref()), 8, alloc).is_null());
+    CHECK_EQUAL(2, a.find_first("pending", 0, a.size()));
+    CHECK_EQUAL(7, a.find_first("", 0, a.size()));
+    CHECK_EQUAL(8, a.find_first(realm::null(), 0, a.size()));
+    CHECK_EQUAL(realm::not_found, a.find_first("deleted", 0, a.size()));
+
+    size_t key = a.find_dictionary_key("pending");
+    CHECK_NOT_EQUAL(realm::not_found, key);
+    CHECK_EQUAL(2, a.find_first_dictionary_key(key, 0, 300));
+    CHECK_EQUAL(11, a.find_first_dictionary_key(key, 9, 300));
+    CHECK_EQUAL(realm::not_found, a.find_dictionary_key("deleted"));
+
+    // Modifications keep the dictionary
+    a.set(0, "deleted");
+    a.insert(1, "archived");
+    a.erase(2);
+    CHECK(a.has_dictionary());
+    CHECK_EQUAL(300, a.size());
+    CHECK_EQUAL("deleted", a.get(0));
+    CHECK_EQUAL("archived", a.get(1));
+    CHECK_EQUAL("pending", a.get(2));
+    CHECK_EQUAL(1, a.find_first("archived", 0, a.size()));
+
+    // Unused values are dropped when encoding again
+    a.set(1, "active");
+    a.encode_dictionary();
+    CHECK(a.has_dictionary());
+    CHECK_EQUAL(realm::not_found, a.find_dictionary_key("archived"));
+    CHECK_EQUAL("deleted", a.get(0));
+    CHECK_EQUAL("active", a.get(1));
+
+    // Back to plain strings when most values are distinct
+    for (size_t i = 0; i < 300; ++i)
+        a.set(i, std::to_string(i));
+    a.encode_dictionary();
+    CHECK_NOT(a.has_dictionary());
+    CHECK_EQUAL(300, a.size());
+    CHECK_EQUAL("123", a.get(123));
+    CHECK_EQUAL(123, a.find_first("123", 0, a.size()));
+
+    a.destroy();
+}
+
+TEST(ArrayString_Compressed)
+{
+    Allocator& alloc = Allocator::get_default();
+    ArrayString a(alloc);
+    a.create();
+
+    const size_t nb_values = 200;
+    auto value = [](size_t i) {
+        return "https://www.example.com/products/category/" + std::to_string(i % 17) + "/item?id=" +
+               std::to_string(i);
+    };
+    std::vector<std::string> values;
+    for (size_t i = 0; i < nb_values; ++i)
+        values.push_back(value(i));
+    values[5] = "";
+    values[6] = "%";
+    for (size_t i = 0; i < nb_values; ++i)
+        a.add(values[i]);
+    a.set(7, realm::null());
+
+    a.compress();
+    CHECK(a.is_compressed());
+    CHECK_EQUAL(nb_values, a.size());
+    for (size_t i = 0; i < nb_values; ++i) {
+        if (i == 7) {
+            CHECK(a.is_null(i));
+            CHECK(a.get(i).is_null());
+        }
+        else {
+            CHECK_NOT(a.is_null(i));
+            CHECK_EQUAL(values[i], a.get(i));
+        }
+    }
+    CHECK(ArrayString::is_compressed(alloc.translate(a.get_ref())));
+
+    // Searching works on the compressed values
+    CHECK_EQUAL(42, a.find_first(values[42], 0, nb_values));
+    CHECK_EQUAL(realm::not_found, a.find_first(values[42], 43, nb_values));
+    CHECK_EQUAL(5, a.find_first("", 0, nb_values));
+    CHECK_EQUAL(6, a.find_first("%", 0, nb_values));
+    CHECK_EQUAL(7, a.find_first(realm::null(), 0, nb_values));
+    CHECK_EQUAL(realm::not_found, a.find_first("https://www.example.com/", 0, nb_values));
+
+    // Reading through a new accessor
+    {
+        ArrayString b(alloc);
+        b.init_from_ref(a.get_ref());
+        CHECK(b.is_compressed());
+        CHECK_EQUAL(values[199], b.get(199));
+    }
+
+    // Modifications turn the leaf into an ordinary one
+    a.set(0, "ftp://example.com");
+    CHECK_NOT(a.is_compressed());
+    CHECK_EQUAL("ftp://example.com", a.get(0));
+    CHECK_EQUAL(values[1], a.get(1));
+    CHECK(a.is_null(7));
+    CHECK_EQUAL(nb_values, a.size());
+
+    a.compress();
+    CHECK(a.is_compressed());
+    a.erase(1);
+    CHECK_NOT(a.is_compressed());
+    CHECK_EQUAL(nb_values - 1, a.size());
+    CHECK_EQUAL(values[2], a.get(1));
+
+    a.destroy();
+
+    // Short strings are not compressed
+    a.create();
+    for (size_t i = 0; i < nb_values; ++i)
+        a.add("aaaaaaaaaa");
+    a.compress();
+    CHECK_NOT(a.is_compressed());
+    a.destroy();
+}
+
 // Some internal testing for backwards compatibility between database file version 2 and 3
 TEST(ArrayString_Null2)
 {
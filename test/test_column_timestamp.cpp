@@ -23,10 +23,12 @@
 #include <realm/bplustree.hpp>
 #include <realm/array_timestamp.hpp>
 #include <realm/array_key.hpp>
+#include <realm/history.hpp>
 
 #include "test.hpp"
 
 using namespace realm;
+using test_util::unit_test::TestContext;
 
 
 // Test independence and thread-safety
@@ -293,6 +295,159 @@ TEST(TimestampColumn_FindFirst)
 }
 
 
+template <class Cond>
+void check_packed_find_first(TestContext& test_context, const ArrayTimestamp& packed,
+                             const ArrayTimestamp& plain, Timestamp value)
+{
+    size_t sz = plain.size();
+    for (size_t begin = 0; begin < sz; begin += 4) {
+        CHECK_EQUAL(plain.find_first<Cond>(value, begin, sz), packed.find_first<Cond>(value, begin, sz));
+        CHECK_EQUAL(plain.find_first<Cond>(value, 0, begin), packed.find_first<Cond>(value, 0, begin));
+    }
+}
+
+TEST(TimestampColumn_Packed)
+{
+    ArrayTimestamp plain(Allocator::get_default());
+    ArrayTimestamp packed(Allocator::get_default());
+    plain.create();
+    packed.create();
+
+    std::vector<Timestamp> values;
+    for (int i = 0; i < 50; ++i) {
+        if (i % 9 == 4)
+            values.push_back(Timestamp{});
+        else if (i % 2)
+            values.push_back(Timestamp(1600000000 + i / 3, (i % 5) * 100000000));
+        else
+            values.push_back(Timestamp(-i / 4, -(i % 3) * 1000));
+    }
+    for (auto& value : values) {
+        plain.add(value);
+        packed.add(value);
+    }
+    packed.pack();
+    CHECK(packed.is_packed());
+    packed.verify();
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQUAL(values[i], packed.get(i));
+        CHECK_EQUAL(values[i].is_null(), packed.is_null(i));
+    }
+
+    std::vector<Timestamp> needles = values;
+    needles.push_back(Timestamp(1600000005, 1));
+    needles.push_back(Timestamp(std::numeric_limits<int64_t>::max(), 0));
+    needles.push_back(Timestamp(std::numeric_limits<int64_t>::min(), 0));
+    for (auto& value : needles) {
+        check_packed_find_first<Equal>(test_context, packed, plain, value);
+        check_packed_find_first<NotEqual>(test_context, packed, plain, value);
+        check_packed_find_first<Less>(test_context, packed, plain, value);
+        check_packed_find_first<LessEqual>(test_context, packed, plain, value);
+        check_packed_find_first<Greater>(test_context, packed, plain, value);
+        check_packed_find_first<GreaterEqual>(test_context, packed, plain, value);
+    }
+
+    // Values in range are stored packed, others unpack the leaf
+    packed.set(3, Timestamp(12, 34));
+    packed.insert(0, Timestamp{});
+    packed.erase(1);
+    CHECK(packed.is_packed());
+    CHECK_EQUAL(Timestamp(12, 34), packed.get(3));
+    CHECK(packed.is_null(0));
+    Timestamp far_future(std::numeric_limits<int64_t>::max(), 0);
+    packed.add(far_future);
+    CHECK_NOT(packed.is_packed());
+    CHECK_EQUAL(far_future, packed.get(values.size()));
+    CHECK_EQUAL(Timestamp(12, 34), packed.get(3));
+    packed.pack();
+    CHECK_NOT(packed.is_packed());
+
+    Array::destroy_deep(plain.get_ref(), Allocator::get_default());
+    Array::destroy_deep(packed.get_ref(), Allocator::get_default());
+}
+
+TEST(TimestampColumn_PackedOnCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto t = wt->add_table("t");
+        col = t->add_column(type_Timestamp, "date", true);
+        for (int64_t i = 0; i < 1000; ++i)
+            t->create_object(ObjKey(i)).set(col, i % 10 ? Timestamp(1500000000 + i, int32_t(i)) : Timestamp{});
+        wt->commit();
+    }
+    auto rt = db->start_read();
+    auto t = rt->get_table("t");
+    CHECK_EQUAL(t->where().greater(col, Timestamp(1500000500, 0)).count(), 450);
+    CHECK_EQUAL(t->where().less_equal(col, Timestamp(1500000010, 10)).count(), 9);
+    CHECK_EQUAL(t->where().equal(col, Timestamp{}).count(), 100);
+    CHECK_EQUAL(t->where().not_equal(col, Timestamp(1500000001, 1)).count(), 999);
+    ConstObj obj = t->get_object(ObjKey(1));
+    CHECK_EQUAL(obj.get<Timestamp>(col), Timestamp(1500000001, 1));
+    CHECK_EQUAL(t->maximum_timestamp(col), Timestamp(1500000999, 999));
+}
+
+TEST(TimestampColumn_RepackedOnCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto t = wt->add_table("t");
+        col = t->add_column(type_Timestamp, "date", true);
+        // Less than a second apart, so the packed values fit in 32 bit offsets
+        for (int64_t i = 0; i < 1000; ++i)
+            t->create_object(ObjKey(i)).set(col, i % 10 ? Timestamp(1600000000, int32_t(i * 1000)) : Timestamp{});
+        wt->commit();
+    }
+    // Counts the leaves that are not packed with offset encoded values
+    auto count_plain_leaves = [&]() {
+        auto rt = db->start_read();
+        auto t = rt->get_table("t");
+        Allocator& alloc = t->get_alloc();
+        size_t nb_plain = 0;
+        t->traverse_clusters([&](const Cluster* cluster) {
+            ArrayTimestamp leaf(alloc);
+            cluster->init_leaf(col, &leaf);
+            Array top(alloc);
+            top.init_from_ref(leaf.get_ref());
+            Array values(alloc);
+            if (leaf.is_packed())
+                values.init_from_ref(top.get_as_ref(0));
+            if (!leaf.is_packed() || !values.is_offset_encoded())
+                ++nb_plain;
+            return false;
+        });
+        return nb_plain;
+    };
+    auto set_value = [&](Timestamp value) {
+        auto wt = db->start_write();
+        wt->get_table("t")->get_object(ObjKey(5)).set(col, value);
+        wt->commit();
+        auto rt = db->start_read();
+        CHECK_EQUAL(value, rt->get_table("t")->get_object(ObjKey(5)).get<Timestamp>(col));
+        rt->verify();
+    };
+    CHECK_EQUAL(0, count_plain_leaves());
+
+    set_value(Timestamp(1600000000, 999999999));
+    CHECK_EQUAL(0, count_plain_leaves());
+
+    // Only the leaf holding a value outside of the packed range is unpacked
+    set_value(Timestamp(std::numeric_limits<int64_t>::max(), 0));
+    CHECK_EQUAL(1, count_plain_leaves());
+
+    set_value(Timestamp(1600000000, 5));
+    CHECK_EQUAL(0, count_plain_leaves());
+}
+
+
 TEST(TimestampColumn_AddColumnAfterRows)
 {
     constexpr bool nullable = true;
@@ -23,6 +23,7 @@
 
 
 using namespace realm;
+using namespace realm::test_util;
 
 TEST(Decimal_Basics)
 {
@@ -340,3 +341,152 @@ TEST(Decimal_Aggregates)
         CHECK_EQUAL(table->minimum_decimal(col), Decimal128(1));
     }
 }
+
+TEST(Decimal_PackedArray)
+{
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    const char* needles[] = {"0",     "-0",   "1",      "1.5",   "1.50",   "-2.25", "0.005", "100",  "-100",
+                             "12.34", "1E30", "-1E30",  "1E-30", "9E18",   "-9E18", "NaN",   "+Inf", "-Inf",
+                             "0.01",  "-0.1", "999.99", "5E2",   "7.000",  "-7"};
+
+    // Cents, mixed exponents with nulls, and values that cannot be packed
+    for (int round = 0; round < 3; ++round) {
+        ArrayDecimal128 arr(Allocator::get_default());
+        arr.create();
+        std::vector<Decimal128> values;
+        for (int i = 0; i < 200; ++i) {
+            Decimal128 value;
+            int64_t coefficient = random.draw_int<int64_t>(-10000, 10000);
+            if (round == 0) {
+                value = Decimal128(Decimal128::Bid128{{uint64_t(std::abs(coefficient)), 0}}, -2, coefficient < 0);
+            }
+            else if (random.draw_int<int>(0, 9) == 0) {
+                value = Decimal128(realm::null());
+            }
+            else {
+                int exponent = random.draw_int<int>(-3, 1);
+                value = Decimal128(Decimal128::Bid128{{uint64_t(std::abs(coefficient)), 0}}, exponent,
+                                   coefficient < 0);
+            }
+            values.push_back(value);
+            arr.add(value);
+        }
+        if (round == 2)
+            arr.set(17, Decimal128("NaN"));
+        values[17] = arr.get(17);
+
+        arr.pack();
+        CHECK_EQUAL(arr.is_packed(), round < 2);
+        CHECK_EQUAL(arr.size(), values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            // The values must be restored bit by bit
+            CHECK_EQUAL(arr.get(i).raw()->w[0], values[i].raw()->w[0]);
+            CHECK_EQUAL(arr.get(i).raw()->w[1], values[i].raw()->w[1]);
+            CHECK_EQUAL(arr.is_null(i), values[i].is_null());
+        }
+
+        auto check_find = [&](auto cond, Decimal128 needle) {
+            for (int j = 0; j < 10; ++j) {
+                size_t begin = random.draw_int<size_t>(0, values.size());
+                size_t end = random.draw_int<size_t>(begin, values.size());
+                size_t expected = realm::npos;
+                for (size_t i = begin; i < end; ++i) {
+                    if (cond(values[i], needle, values[i].is_null(), needle.is_null())) {
+                        expected = i;
+                        break;
+                    }
+                }
+                CHECK_EQUAL(arr.find_first<decltype(cond)>(needle, begin, end), expected);
+            }
+        };
+        std::vector<Decimal128> needle_values = {Decimal128(realm::null()), values[3], values[100]};
+        for (auto str : needles)
+            needle_values.push_back(Decimal128(str));
+        for (auto needle : needle_values) {
+            check_find(Equal(), needle);
+            check_find(NotEqual(), needle);
+            check_find(Less(), needle);
+            check_find(LessEqual(), needle);
+            check_find(Greater(), needle);
+            check_find(GreaterEqual(), needle);
+        }
+
+        Decimal128 expected_sum(0);
+        size_t expected_count = 0;
+        size_t expected_min = realm::npos;
+        size_t expected_max = realm::npos;
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (values[i].is_nan())
+                continue;
+            expected_sum += values[i];
+            expected_count++;
+            if (expected_min == realm::npos || values[i] < values[expected_min])
+                expected_min = i;
+            if (expected_max == realm::npos || values[i] > values[expected_max])
+                expected_max = i;
+        }
+        if (round < 2) {
+            size_t count;
+            Decimal128 sum = arr.sum(count);
+            CHECK_EQUAL(sum, expected_sum);
+            CHECK_EQUAL(count, expected_count);
+        }
+        CHECK_EQUAL(arr.find_min(), expected_min);
+        CHECK_EQUAL(arr.find_max(), expected_max);
+
+        // Modifications unpack the leaf
+        arr.set(5, Decimal128("3.14159"));
+        values[5] = Decimal128("3.14159");
+        arr.erase(0);
+        values.erase(values.begin());
+        CHECK_NOT(arr.is_packed());
+        for (size_t i = 0; i < values.size(); ++i) {
+            CHECK_EQUAL(arr.get(i).raw()->w[0], values[i].raw()->w[0]);
+            CHECK_EQUAL(arr.get(i).raw()->w[1], values[i].raw()->w[1]);
+        }
+
+        arr.destroy();
+    }
+}
+
+TEST(Decimal_PackedQuery)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(path);
+    auto wt = db->start_write();
+    auto table = wt->add_table("Foo");
+    auto col = table->add_column(type_Decimal, "price", true);
+    for (int i = 0; i < 1000; i++) {
+        // Cents
+        std::string str = util::to_string(i / 100) + "." + util::to_string(i / 10 % 10) + util::to_string(i % 10);
+        table->create_object().set(col, Decimal128(str));
+    }
+    table->create_object();
+    wt->commit();
+
+    auto rt = db->start_read();
+    table = rt->get_table("Foo");
+
+    CHECK_EQUAL(table->where().equal(col, Decimal128("2.5")).count(), 1);
+    CHECK_EQUAL(table->where().equal(col, Decimal128("2.505")).count(), 0);
+    CHECK_EQUAL(table->where().not_equal(col, Decimal128("2.5")).count(), 1000);
+    CHECK_EQUAL(table->where().less(col, Decimal128("2.505")).count(), 251);
+    CHECK_EQUAL(table->where().less_equal(col, Decimal128(2)).count(), 201);
+    CHECK_EQUAL(table->where().greater(col, Decimal128("9.985")).count(), 1);
+    CHECK_EQUAL(table->where().greater_equal(col, Decimal128("1E20")).count(), 0);
+    CHECK_EQUAL(table->where().less(col, Decimal128("1E20")).count(), 1000);
+    CHECK_EQUAL(table->where().equal(col, realm::null()).count(), 1);
+    CHECK_EQUAL(table->count_decimal(col, Decimal128("0.10")), 1);
+    CHECK_EQUAL(table->sum_decimal(col), Decimal128("4995"));
+    CHECK_EQUAL(table->maximum_decimal(col), Decimal128("9.99"));
+    CHECK_EQUAL(table->minimum_decimal(col), Decimal128("0"));
+    CHECK_EQUAL(table->sum_decimal(col).to_string(), "4995.00");
+
+    // Writing to a packed leaf unpacks it
+    wt = db->start_write();
+    table = wt->get_table("Foo");
+    table->get_object(0).set(col, Decimal128("1E30"));
+    CHECK_EQUAL(table->maximum_decimal(col), Decimal128("1E30"));
+    CHECK_EQUAL(table->minimum_decimal(col), Decimal128("0.01"));
+    wt->commit();
+}
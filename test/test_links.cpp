@@ -20,6 +20,10 @@
 #ifdef TEST_LINKS
 
 
+#include <algorithm>
+#include <random>
+#include <set>
+
 #include <realm.hpp>
 #include <realm/util/file.hpp>
 #include <realm/array_key.hpp>
@@ -371,8 +375,8 @@ TEST(Links_Multi)
     // remove a row
     table2->remove_object(k0);
     CHECK_EQUAL(2, obj1.get_backlink_count(*table2, col_link));
-    CHECK_EQUAL(k2, obj1.get_backlink(*table2, col_link, 0));
-    CHECK_EQUAL(k1, obj1.get_backlink(*table2, col_link, 1));
+    CHECK_EQUAL(k1, obj1.get_backlink(*table2, col_link, 0));
+    CHECK_EQUAL(k2, obj1.get_backlink(*table2, col_link, 1));
 
     // add some more links and see that they get nullified when the target
     // is removed
@@ -1594,4 +1598,81 @@ TEST(Links_DetachedAccessor)
     CHECK_NOT(link_list.is_attached());
 }
 
+TEST(Links_ManyBacklinks)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    DBRef db = DB::create(*hist);
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    auto wt = db->start_write();
+    auto target = wt->add_table("target");
+    auto origin = wt->add_table("origin");
+    auto col_link = origin->add_column_link(type_Link, "link", *target);
+    auto col_list = origin->add_column_link(type_LinkList, "list", *target);
+    ObjKey target_key = target->create_object().get_key();
+
+    // Large keys that are added out of order
+    std::vector<ObjKey> origin_keys;
+    for (int64_t i = 0; i < 2000; i++)
+        origin_keys.push_back(ObjKey((int64_t(1) << 40) + i * 3));
+    std::shuffle(origin_keys.begin(), origin_keys.end(), std::mt19937(unsigned(random.draw_int<int>(0, 1000))));
+    std::multiset<ObjKey> expected;
+    for (auto key : origin_keys) {
+        origin->create_object(key).set(col_link, target_key);
+        expected.insert(key);
+    }
+    // Link lists may link to the same object more than once
+    ObjKey list_key = origin_keys[0];
+    auto list = origin->get_object(list_key).get_linklist(col_list);
+    list.add(target_key);
+    list.add(target_key);
+    std::multiset<ObjKey> expected_list = {list_key, list_key};
+
+    // Backlinks are ordered by key
+    auto check_backlinks = [&](ColKey col, const std::multiset<ObjKey>& keys) {
+        Obj target_obj = target->get_object(target_key);
+        CHECK_EQUAL(target_obj.get_backlink_count(*origin, col), keys.size());
+        size_t i = 0;
+        for (auto key : keys)
+            CHECK_EQUAL(target_obj.get_backlink(*origin, col, i++), key);
+    };
+    auto check = [&] {
+        check_backlinks(col_link, expected);
+        check_backlinks(col_list, expected_list);
+    };
+    check();
+    wt->commit_and_continue_as_read();
+    wt->verify();
+
+    // Remove links from the compacted lists
+    wt->promote_to_write();
+    for (size_t i = 1; i < origin_keys.size(); i += 2) {
+        origin->get_object(origin_keys[i]).set(col_link, null_key);
+        expected.erase(expected.find(origin_keys[i]));
+    }
+    list = origin->get_object(list_key).get_linklist(col_list);
+    list.remove(0);
+    expected_list.erase(expected_list.find(list_key));
+    check();
+    wt->commit_and_continue_as_read();
+    wt->verify();
+
+    wt->promote_to_write();
+    for (size_t i = 0; i < origin_keys.size(); i += 4) {
+        origin->remove_object(origin_keys[i]);
+        expected.erase(expected.find(origin_keys[i]));
+    }
+    expected_list.clear();
+    check();
+    wt->commit_and_continue_as_read();
+    wt->verify();
+
+    wt->promote_to_write();
+    target->remove_object(target_key);
+    for (auto o : *origin)
+        CHECK_NOT(o.get<ObjKey>(col_link));
+    wt->commit();
+}
+
 #endif // TEST_LINKS
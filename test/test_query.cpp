@@ -20,6 +20,7 @@
 #ifdef TEST_QUERY
 
 #include <cstdlib> // itoa()
+#include <functional>
 #include <limits>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include <realm/query_expression.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_expression.hpp>
+#include <realm/util/thread_pool.hpp>
 #include "test.hpp"
 #include "test_table_helper.hpp"
 
@@ -5390,4 +5392,678 @@ TEST(Query_AllocatorBug)
     CHECK_EQUAL(cnt, 421);
 }
 
+TEST(Query_Parallel)
+{
+    Group g;
+    auto origin = g.add_table("origin");
+    auto table = g.add_table("table");
+    auto col_origin_int = origin->add_column(type_Int, "int");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_int_null = table->add_column(type_Int, "int_null", true);
+    auto col_float = table->add_column(type_Float, "float");
+    auto col_double = table->add_column(type_Double, "double", true);
+    auto col_decimal = table->add_column(type_Decimal, "decimal");
+    auto col_str = table->add_column(type_String, "str");
+    auto col_link = table->add_column_link(type_Link, "link", *origin);
+
+    std::vector<ObjKey> origin_keys;
+    for (int i = 0; i < 10; ++i)
+        origin_keys.push_back(origin->create_object().set(col_origin_int, i).get_key());
+
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 10000; ++i) {
+        // Few distinct values, so that minimum and maximum have ties, and doubles that add up without rounding
+        auto obj = table->create_object();
+        obj.set(col_int, random.draw_int<int64_t>(-500, 500));
+        if (random.draw_int<int>(0, 9))
+            obj.set(col_int_null, random.draw_int<int64_t>(-500, 500));
+        obj.set(col_float, random.draw_int<int>(0, 100) / 4.0f);
+        if (random.draw_int<int>(0, 9))
+            obj.set(col_double, random.draw_int<int>(-100, 100) / 2.0);
+        obj.set(col_decimal, Decimal128(random.draw_int<int64_t>(0, 1000)));
+        obj.set(col_str, "str" + util::to_string(random.draw_int<int>(0, 9)));
+        obj.set(col_link, origin_keys[random.draw_int<size_t>(0, 9)]);
+    }
+    // Leave gaps in the keys
+    for (int i = 0; i < 1000; ++i) {
+        ObjKey key(random.draw_int<int64_t>(0, 9999));
+        if (table->is_valid(key))
+            table->remove_object(key);
+    }
+
+    auto pool = std::make_shared<ThreadPool>(4);
+    auto check = [&](Query serial) {
+        Query parallel = serial;
+        parallel.set_parallel(pool);
+
+        CHECK_EQUAL(parallel.count(), serial.count());
+        auto tv_serial = serial.find_all();
+        auto tv_parallel = parallel.find_all();
+        CHECK_EQUAL(tv_parallel.size(), tv_serial.size());
+        for (size_t i = 0; i < tv_serial.size() && i < tv_parallel.size(); ++i)
+            CHECK_EQUAL(tv_parallel.get_key(i), tv_serial.get_key(i));
+
+        CHECK_EQUAL(parallel.sum_int(col_int), serial.sum_int(col_int));
+        CHECK_EQUAL(parallel.sum_int(col_int_null), serial.sum_int(col_int_null));
+        CHECK_EQUAL(parallel.sum_float(col_float), serial.sum_float(col_float));
+        CHECK_EQUAL(parallel.sum_double(col_double), serial.sum_double(col_double));
+        CHECK_EQUAL(parallel.sum_decimal128(col_decimal), serial.sum_decimal128(col_decimal));
+        size_t count_serial = 0;
+        size_t count_parallel = 0;
+        CHECK_EQUAL(parallel.average_double(col_double, &count_parallel),
+                    serial.average_double(col_double, &count_serial));
+        CHECK_EQUAL(count_parallel, count_serial);
+
+        ObjKey key_serial;
+        ObjKey key_parallel;
+        CHECK_EQUAL(parallel.maximum_int(col_int, &key_parallel), serial.maximum_int(col_int, &key_serial));
+        CHECK_EQUAL(key_parallel, key_serial);
+        CHECK_EQUAL(parallel.minimum_int(col_int_null, &key_parallel), serial.minimum_int(col_int_null, &key_serial));
+        CHECK_EQUAL(key_parallel, key_serial);
+        CHECK_EQUAL(parallel.maximum_float(col_float, &key_parallel), serial.maximum_float(col_float, &key_serial));
+        CHECK_EQUAL(key_parallel, key_serial);
+        CHECK_EQUAL(parallel.minimum_double(col_double, &key_parallel),
+                    serial.minimum_double(col_double, &key_serial));
+        CHECK_EQUAL(key_parallel, key_serial);
+        CHECK_EQUAL(parallel.minimum_decimal128(col_decimal, &key_parallel),
+                    serial.minimum_decimal128(col_decimal, &key_serial));
+        CHECK_EQUAL(key_parallel, key_serial);
+
+        // Sorted results go through the table view, which keeps the thread pool
+        DescriptorOrdering ordering;
+        ordering.append_sort(SortDescriptor({{col_str}, {col_int}}, {true, false}));
+        auto sorted_serial = serial.find_all(ordering);
+        auto sorted_parallel = parallel.find_all(ordering);
+        CHECK_EQUAL(sorted_parallel.size(), sorted_serial.size());
+        for (size_t i = 0; i < sorted_serial.size() && i < sorted_parallel.size(); ++i)
+            CHECK_EQUAL(sorted_parallel.get_key(i), sorted_serial.get_key(i));
+
+        // A limit runs on the calling thread
+        CHECK_EQUAL(parallel.find_all(0, size_t(-1), 5).size(), serial.find_all(0, size_t(-1), 5).size());
+    };
+
+    check(table->where().greater(col_int, 100));
+    check(table->where().greater(col_int, 1000));
+    check(table->where().less(col_int, -200).Or().equal(col_str, "str3"));
+    check(table->where().Not().equal(col_int_null, realm::null()).less(col_double, 10.));
+    check(table->where().links_to(col_link, origin_keys[3]));
+    check(table->column<Int>(col_int) > table->column<Int>(col_int_null));
+    check(table->link(col_link).column<Int>(col_origin_int) > 6);
+
+    // Any number of threads gives the same result
+    for (size_t num_threads : {1, 2, 3, 16}) {
+        Query q = table->where().greater(col_int, 0).less(col_double, 20.);
+        size_t expected = q.count();
+        CHECK_EQUAL(q.set_parallel(num_threads).count(), expected);
+    }
+}
+
+TEST(Query_Statistics)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_int_indexed = table->add_column(type_Int, "int_indexed", true);
+    auto col_bool = table->add_column(type_Bool, "bool");
+    auto col_double = table->add_column(type_Double, "double");
+    auto col_date = table->add_column(type_Timestamp, "date", true);
+    auto col_str = table->add_column(type_String, "str");
+    auto col_oid = table->add_column(type_ObjectId, "oid");
+    table->add_search_index(col_int_indexed);
+    table->add_search_index(col_str);
+
+    std::vector<ObjectId> oids;
+    for (int i = 0; i < 10; ++i)
+        oids.push_back(ObjectId::gen());
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 5000; ++i) {
+        auto obj = table->create_object();
+        obj.set(col_int, random.draw_int<int64_t>(0, 1000));
+        // Mostly the same value, so that the index is not worth using for it
+        if (random.draw_int<int>(0, 9))
+            obj.set(col_int_indexed, random.draw_int<int>(0, 9) ? 7 : random.draw_int<int64_t>(0, 100));
+        obj.set(col_bool, random.draw_int<int>(0, 19) != 0);
+        obj.set(col_double, random.draw_int<int>(0, 1000) / 4.);
+        if (random.draw_int<int>(0, 4))
+            obj.set(col_date, Timestamp(random.draw_int<int64_t>(0, 100000), 0));
+        obj.set(col_str, random.draw_int<int>(0, 9) ? "common" : "str" + util::to_string(random.draw_int<int>(0, 99)));
+        obj.set(col_oid, oids[random.draw_int<size_t>(0, 9)]);
+    }
+
+    std::vector<std::function<Query()>> queries = {
+        [&] { return table->where().equal(col_int, 5).Or().equal(col_int, 500); },
+        [&] { return table->where().greater(col_int, 100).equal(col_bool, false); },
+        [&] { return table->where().equal(col_int_indexed, 7).less(col_int, 10); },
+        [&] { return table->where().equal(col_int_indexed, 50).less(col_double, 100.); },
+        [&] { return table->where().equal(col_int_indexed, realm::null()).equal(col_bool, true); },
+        [&] { return table->where().equal(col_str, "common").between(col_double, 10., 20.); },
+        [&] { return table->where().equal(col_str, "str42").greater_equal(col_int, 500); },
+        [&] { return table->where().equal(col_bool, true).less(col_date, Timestamp(10000, 0)); },
+        [&] { return table->where().equal(col_date, Timestamp()).equal(col_oid, oids[3]); },
+        [&] { return table->where().not_equal(col_oid, oids[5]).greater(col_double, 240.); },
+        [&] {
+            return table->where().equal(col_bool, true).group().less(col_int, 10).Or().equal(col_str, "str7").end_group();
+        },
+    };
+
+    std::vector<std::vector<ObjKey>> expected;
+    for (auto& query : queries) {
+        auto tv = query().find_all();
+        std::vector<ObjKey> keys;
+        for (size_t i = 0; i < tv.size(); ++i)
+            keys.push_back(tv.get_key(i));
+        expected.push_back(keys);
+    }
+
+    // The conditions may be evaluated in another order and without the index, but the results are the same
+    table->update_statistics();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        Query q = queries[i]();
+        CHECK_EQUAL(q.count(), expected[i].size());
+        CHECK_EQUAL(q.find(), expected[i].empty() ? ObjKey() : expected[i].front());
+        auto tv = q.find_all();
+        CHECK_EQUAL(tv.size(), expected[i].size());
+        for (size_t j = 0; j < tv.size() && j < expected[i].size(); ++j)
+            CHECK_EQUAL(tv.get_key(j), expected[i][j]);
+        CHECK_EQUAL(q.set_parallel(3).count(), expected[i].size());
+    }
+}
+
+TEST(Query_Profile)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    auto db = DB::create(*hist, DBOptions(crypt_key()));
+    auto wt = db->start_write();
+    auto table = wt->add_table("table");
+    auto col_int = table->add_column(type_Int, "int");
+    auto col_bool = table->add_column(type_Bool, "bool");
+    auto col_str = table->add_column(type_String, "str");
+    auto col_limit = table->add_column(type_Int, "limit");
+    table->add_search_index(col_str);
+    for (int i = 0; i < 5000; ++i) {
+        auto obj = table->create_object().set(col_int, i).set(col_bool, i % 2 == 0);
+        obj.set(col_str, i % 100 ? "common" : "rare").set(col_limit, 2500);
+    }
+    // Committing records the minimum and maximum of the clusters
+    wt->commit_and_continue_as_read();
+
+    auto profile = std::make_shared<QueryProfile>();
+    Query q = table->where().greater(col_int, 4000).equal(col_bool, true);
+    q.set_profile(profile);
+    size_t cnt = q.count();
+    CHECK_EQUAL(cnt, 499);
+    CHECK_EQUAL(profile->operation, "count");
+    CHECK_EQUAL(profile->description, q.get_description());
+    CHECK_EQUAL(profile->rows_matched, 499);
+    CHECK_NOT(profile->uses_index);
+    CHECK_NOT(profile->uses_view);
+    // Only the clusters holding values above 4000 are searched
+    CHECK_GREATER(profile->clusters_visited, 0);
+    CHECK_GREATER(profile->clusters_skipped, 0);
+    CHECK_EQUAL(profile->conditions.size(), 2);
+    size_t searches = 0;
+    for (auto& condition : profile->conditions) {
+        CHECK_LESS_EQUAL(condition.rows_matched, condition.rows_examined);
+        CHECK_LESS_EQUAL(condition.rows_examined, 5000);
+        CHECK_GREATER_EQUAL(condition.time.count(), 0);
+        searches += condition.searches;
+    }
+    CHECK_GREATER(searches, 0);
+    CHECK_EQUAL(profile->conditions[0].description, "int > 4000");
+    CHECK_EQUAL(profile->conditions[1].description, "bool == true");
+    CHECK_NOT_EQUAL(profile->to_string().find("int > 4000"), std::string::npos);
+
+    // A single condition examines all objects of the clusters searched
+    Query single = table->where().greater(col_int, 4000);
+    single.set_profile(profile);
+    auto tv = single.find_all();
+    CHECK_EQUAL(tv.size(), 999);
+    CHECK_EQUAL(profile->operation, "find_all");
+    CHECK_EQUAL(profile->rows_matched, 999);
+    CHECK_EQUAL(profile->conditions.size(), 1);
+    CHECK_EQUAL(profile->conditions[0].rows_matched, 999);
+    CHECK_GREATER_EQUAL(profile->conditions[0].rows_examined, 999);
+    CHECK_LESS(profile->conditions[0].rows_examined, 5000);
+
+    // The view keeps a copy of the query that records in the same profile
+    *profile = QueryProfile();
+    wt->promote_to_write();
+    table->create_object().set(col_int, 5000).set(col_bool, true);
+    tv.sync_if_needed();
+    CHECK_EQUAL(tv.size(), 1000);
+    CHECK_EQUAL(profile->operation, "find_all");
+    CHECK_EQUAL(profile->rows_matched, 1000);
+
+    CHECK_EQUAL(single.sum_int(col_int), (4001 + 5000) * 1000 / 2);
+    CHECK_EQUAL(profile->operation, "sum");
+    CHECK_EQUAL(profile->rows_matched, 1000);
+    single.average_int(col_int);
+    CHECK_EQUAL(profile->operation, "average");
+    CHECK_EQUAL(single.find(), table->get_object(4001).get_key());
+    CHECK_EQUAL(profile->operation, "find");
+    CHECK_EQUAL(profile->rows_matched, 1);
+
+    // Rare values are looked up in the search index, and the other conditions are tested on the objects found
+    Query indexed = table->where().equal(col_str, "rare").and_query(table->column<Int>(col_int) < table->column<Int>(col_limit));
+    indexed.set_profile(profile);
+    CHECK_EQUAL(indexed.count(), 25);
+    CHECK(profile->uses_index);
+    CHECK_EQUAL(profile->clusters_visited, 0);
+    CHECK_EQUAL(profile->rows_matched, 25);
+    CHECK_EQUAL(profile->conditions.size(), 2);
+    CHECK(profile->conditions[0].uses_index);
+    CHECK_NOT(profile->conditions[1].uses_index);
+    CHECK_EQUAL(profile->conditions[1].rows_examined, 50);
+    CHECK_EQUAL(profile->conditions[1].rows_matched, 25);
+
+    // Conditions grouped with Or() count as one
+    Query ored = table->where().equal(col_bool, false).group().less(col_int, 10).Or().greater(col_int, 4990).end_group();
+    ored.set_profile(profile);
+    CHECK_EQUAL(ored.count(), 10);
+    CHECK_EQUAL(profile->conditions.size(), 2);
+
+    // Queries restricted to a view test every object of it
+    Query restricted = table->where(&tv).equal(col_bool, false);
+    restricted.set_profile(profile);
+    CHECK_EQUAL(restricted.count(), 500);
+    CHECK(profile->uses_view);
+    CHECK_EQUAL(profile->clusters_visited, 0);
+    CHECK_EQUAL(profile->conditions.size(), 1);
+    CHECK_EQUAL(profile->conditions[0].rows_examined, 1000);
+    CHECK_EQUAL(profile->conditions[0].rows_matched, 500);
+
+    // A profiled query runs on the calling thread, where the conditions count their work
+    q.set_parallel(4);
+    CHECK_EQUAL(q.count(), 500);
+    CHECK_EQUAL(profile->rows_matched, 500);
+    CHECK_EQUAL(profile->conditions.size(), 2);
+
+    // Without a profile nothing is recorded
+    q.set_profile(nullptr);
+    CHECK_EQUAL(q.count(), 500);
+    CHECK_EQUAL(profile->rows_matched, 500);
+    CHECK_EQUAL(profile->operation, "count");
+}
+
+TEST(Query_CombinedConditions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    auto db = DB::create(*hist, DBOptions(crypt_key()));
+    auto wt = db->start_write();
+    auto table = wt->add_table("table");
+    auto col_small = table->add_column(type_Int, "small");
+    auto col_large = table->add_column(type_Int, "large");
+    auto col_null = table->add_column(type_Int, "null", true);
+    auto col_run = table->add_column(type_Int, "run");
+    auto col_bool = table->add_column(type_Bool, "bool", true);
+    table->add_search_index(col_null);
+    for (int64_t i = 0; i < 3000; ++i) {
+        auto obj = table->create_object().set(col_small, i % 10).set(col_large, i * 1000003 % 100000007 - 50000000);
+        obj.set(col_run, i / 300);
+        if (i % 7)
+            obj.set(col_null, i % 13);
+        if (i % 5)
+            obj.set(col_bool, i % 3 == 0);
+    }
+    wt->commit_and_continue_as_read();
+
+    auto check = [&](Query q, std::function<bool(const ConstObj&)> predicate) {
+        size_t expected = 0;
+        int64_t sum = 0;
+        ObjKey first;
+        for (size_t i = 0; i < table->size(); ++i) {
+            ConstObj obj = table->get_object(i);
+            if (predicate(obj)) {
+                if (!first)
+                    first = obj.get_key();
+                ++expected;
+                sum += obj.get<Int>(col_small);
+            }
+        }
+        CHECK_EQUAL(q.count(), expected);
+        CHECK_EQUAL(q.find_all().size(), expected);
+        CHECK_EQUAL(q.find(), first);
+        CHECK_EQUAL(q.sum_int(col_small), sum);
+    };
+    auto small = [&](const ConstObj& obj) {
+        return obj.get<Int>(col_small);
+    };
+    auto large = [&](const ConstObj& obj) {
+        return obj.get<Int>(col_large);
+    };
+    auto run = [&](const ConstObj& obj) {
+        return obj.get<Int>(col_run);
+    };
+    auto nullable = [&](const ConstObj& obj) {
+        return obj.get<util::Optional<Int>>(col_null);
+    };
+    auto boolean = [&](const ConstObj& obj) {
+        return obj.get<util::Optional<bool>>(col_bool);
+    };
+
+    Query q = table->where().greater(col_small, 5).less(col_large, 0).equal(col_run, 3);
+    CHECK_EQUAL(q.get_description(), "small > 5 and large < 0 and run == 3");
+    check(q, [&](const ConstObj& obj) {
+        return small(obj) > 5 && large(obj) < 0 && run(obj) == 3;
+    });
+    // The three conditions are evaluated together, but each counts its own work
+    auto profile = std::make_shared<QueryProfile>();
+    q.set_profile(profile);
+    size_t cnt = q.count();
+    CHECK_EQUAL(profile->conditions.size(), 3);
+    CHECK_EQUAL(profile->conditions[0].description, "small > 5");
+    CHECK_EQUAL(profile->conditions[1].description, "large < 0");
+    CHECK_EQUAL(profile->conditions[2].description, "run == 3");
+    size_t searches = 0;
+    for (auto& condition : profile->conditions) {
+        CHECK_LESS_EQUAL(condition.rows_matched, condition.rows_examined);
+        CHECK_GREATER_EQUAL(condition.rows_matched, cnt);
+        searches += condition.searches;
+    }
+    CHECK_GREATER(searches, 0);
+    q.set_profile(nullptr);
+
+    check(table->where().not_equal(col_null, 3).equal(col_bool, true).greater_equal(col_small, 2),
+          [&](const ConstObj& obj) {
+              return nullable(obj) != util::Optional<Int>(3) && boolean(obj) == util::Optional<bool>(true) &&
+                     small(obj) >= 2;
+          });
+    check(table->where().not_equal(col_bool, false).less_equal(col_null, 4).not_equal(col_small, 0),
+          [&](const ConstObj& obj) {
+              return boolean(obj) != util::Optional<bool>(false) && nullable(obj) && *nullable(obj) <= 4 &&
+                     small(obj) != 0;
+          });
+    // Null values, and a condition using the search index in between those evaluated together
+    check(table->where().equal(col_bool, null()).equal(col_null, null()).greater(col_small, 4).less(col_run, 7),
+          [&](const ConstObj& obj) {
+              return !boolean(obj) && !nullable(obj) && small(obj) > 4 && run(obj) < 7;
+          });
+    check(table->where().greater(col_small, 7).equal(col_bool, true).Or().less(col_small, 2).equal(col_run, 1),
+          [&](const ConstObj& obj) {
+              return (small(obj) > 7 && boolean(obj) == util::Optional<bool>(true)) ||
+                     (small(obj) < 2 && run(obj) == 1);
+          });
+    check(table->where().Not().group().greater(col_small, 5).less(col_large, 0).end_group().equal(col_run, 4),
+          [&](const ConstObj& obj) {
+              return !(small(obj) > 5 && large(obj) < 0) && run(obj) == 4;
+          });
+    check(table->where().greater(col_large, 0).group().equal(col_small, 3).not_equal(col_run, 2).end_group(),
+          [&](const ConstObj& obj) {
+              return large(obj) > 0 && small(obj) == 3 && run(obj) != 2;
+          });
+
+    // Restricted to a view, every object of it is tested on its own
+    TableView tv = table->where().less(col_run, 5).find_all();
+    Query restricted = table->where(&tv).greater(col_small, 3).equal(col_bool, true);
+    size_t expected = 0;
+    for (size_t i = 0; i < tv.size(); ++i) {
+        ConstObj obj = tv.get(i);
+        if (small(obj) > 3 && boolean(obj) == util::Optional<bool>(true))
+            ++expected;
+    }
+    CHECK_EQUAL(restricted.count(), expected);
+    CHECK_EQUAL(restricted.find_all().size(), expected);
+
+    // Copies of a query evaluate their own conditions
+    Query copy = q;
+    CHECK_EQUAL(copy.count(), q.count());
+    CHECK_EQUAL(copy.get_description(), q.get_description());
+
+    // A search index added after the query was built is used, rather than evaluating its condition with the others
+    Query indexed = table->where().equal(col_small, 3).greater(col_large, 0);
+    auto check_indexed = [&] {
+        check(indexed, [&](const ConstObj& obj) {
+            return small(obj) == 3 && large(obj) > 0;
+        });
+    };
+    check_indexed();
+    wt->promote_to_write();
+    table->add_search_index(col_small);
+    wt->commit_and_continue_as_read();
+    check_indexed();
+    profile = std::make_shared<QueryProfile>();
+    indexed.set_profile(profile);
+    indexed.find_all();
+    CHECK_EQUAL(profile->conditions.size(), 2);
+    CHECK(profile->conditions[0].uses_index);
+    CHECK_NOT(profile->conditions[1].uses_index);
+}
+
+TEST(Query_ExpressionBatches)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    auto db = DB::create(*hist, DBOptions(crypt_key()));
+    auto wt = db->start_write();
+    auto table = wt->add_table("table");
+    auto col_price = table->add_column(type_Double, "price");
+    auto col_qty = table->add_column(type_Int, "qty");
+    auto col_limit = table->add_column(type_Int, "limit", true);
+    auto col_float = table->add_column(type_Float, "float", true);
+    auto col_bool = table->add_column(type_Bool, "bool", true);
+    auto col_run = table->add_column(type_Int, "run");
+    for (int64_t i = 0; i < 2500; ++i) {
+        auto obj = table->create_object().set(col_price, (i % 97) * 1.5).set(col_qty, i % 31).set(col_run, i / 400);
+        if (i % 11)
+            obj.set(col_limit, i % 50);
+        if (i % 13)
+            obj.set(col_float, float(i % 17) / 2);
+        if (i % 7)
+            obj.set(col_bool, i % 3 == 0);
+    }
+    wt->commit_and_continue_as_read();
+
+    auto check = [&](Query q, std::function<bool(const ConstObj&)> predicate) {
+        size_t expected = 0;
+        ObjKey first;
+        for (size_t i = 0; i < table->size(); ++i) {
+            ConstObj obj = table->get_object(i);
+            if (predicate(obj)) {
+                if (!first)
+                    first = obj.get_key();
+                ++expected;
+            }
+        }
+        CHECK_EQUAL(q.count(), expected);
+        CHECK_EQUAL(q.find_all().size(), expected);
+        CHECK_EQUAL(q.find(), first);
+        // Tested row by row on the objects of a view
+        TableView all = table->where().find_all();
+        CHECK_EQUAL(table->where(&all).and_query(q).count(), expected);
+    };
+    auto price = [&](const ConstObj& obj) {
+        return obj.get<double>(col_price);
+    };
+    auto qty = [&](const ConstObj& obj) {
+        return obj.get<Int>(col_qty);
+    };
+    auto limit = [&](const ConstObj& obj) {
+        return obj.get<util::Optional<Int>>(col_limit);
+    };
+
+    check(table->column<Double>(col_price) * table->column<Int>(col_qty) > 1000., [&](const ConstObj& obj) {
+        return price(obj) * qty(obj) > 1000.;
+    });
+    // Comparisons with null never match, except for equality
+    check(table->column<Int>(col_qty) < table->column<Int>(col_limit), [&](const ConstObj& obj) {
+        return limit(obj) && qty(obj) < *limit(obj);
+    });
+    check(table->column<Int>(col_qty) == table->column<Int>(col_limit), [&](const ConstObj& obj) {
+        return limit(obj) && qty(obj) == *limit(obj);
+    });
+    check(table->column<Int>(col_limit) + 2 >= table->column<Int>(col_qty), [&](const ConstObj& obj) {
+        return limit(obj) && *limit(obj) + 2 >= qty(obj);
+    });
+    check(table->column<Int>(col_limit) * 2 < 10, [&](const ConstObj& obj) {
+        return limit(obj) && *limit(obj) * 2 < 10;
+    });
+    check(table->column<Int>(col_run) - table->column<Int>(col_qty) != 0, [&](const ConstObj& obj) {
+        return obj.get<Int>(col_run) - qty(obj) != 0;
+    });
+    check(table->column<Float>(col_float) * 2.f > table->column<Double>(col_price), [&](const ConstObj& obj) {
+        return !obj.is_null(col_float) && obj.get<float>(col_float) * 2.f > price(obj);
+    });
+    check(table->column<Bool>(col_bool) == true, [&](const ConstObj& obj) {
+        return obj.get<util::Optional<bool>>(col_bool) == util::Optional<bool>(true);
+    });
+    // The expression tests the matches of another condition
+    check(table->where().equal(col_qty, 5).and_query(table->column<Double>(col_price) * table->column<Int>(col_qty) >
+                                                     100.),
+          [&](const ConstObj& obj) {
+              return qty(obj) == 5 && price(obj) * 5 > 100.;
+          });
+
+    // Sums over the matches of an expression
+    Query q = table->column<Int>(col_qty) > table->column<Int>(col_run) * 5;
+    int64_t sum = 0;
+    for (size_t i = 0; i < table->size(); ++i) {
+        ConstObj obj = table->get_object(i);
+        if (qty(obj) > obj.get<Int>(col_run) * 5)
+            sum += limit(obj).value_or(0);
+    }
+    CHECK_EQUAL(q.sum_int(col_limit), sum);
+}
+
+TEST(Query_OrderedIndex)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::unique_ptr<Replication> hist(make_in_realm_history(path));
+    auto db = DB::create(*hist, DBOptions(crypt_key()));
+    auto wt = db->start_write();
+    auto table = wt->add_table("table");
+    // Every indexed column has a copy without an index to compare with
+    ColKey cols[5][2];
+    for (int i = 0; i < 2; ++i) {
+        std::string suffix = i ? "_plain" : "";
+        cols[0][i] = table->add_column(type_Timestamp, "time" + suffix);
+        cols[1][i] = table->add_column(type_Int, "num" + suffix, true);
+        cols[2][i] = table->add_column(type_Double, "double" + suffix, true);
+        cols[3][i] = table->add_column(type_String, "name" + suffix, true);
+        cols[4][i] = table->add_column(type_ObjectId, "oid" + suffix);
+    }
+    auto col_user = table->add_column(type_Int, "user");
+    for (auto& col : cols)
+        table->add_ordered_index(col[0]);
+    const int nb_rows = 5000;
+    for (int i = 0; i < nb_rows; ++i) {
+        auto obj = table->create_object().set(col_user, i % 10);
+        char buffer[25];
+        snprintf(buffer, sizeof(buffer), "%024x", i * 7919 % 10007);
+        for (int j = 0; j < 2; ++j) {
+            obj.set(cols[0][j], Timestamp(i * 7919 % 10007, i % 3));
+            if (i % 50)
+                obj.set(cols[1][j], int64_t(i * 31 % 200 - 100));
+            if (i % 40)
+                obj.set(cols[2][j], (i * 13 % 1000) / 8.0 - 60);
+            if (i % 30)
+                obj.set(cols[3][j], "s" + util::to_string(i * 17 % 500));
+            obj.set(cols[4][j], ObjectId(buffer));
+        }
+    }
+    wt->commit_and_continue_as_read();
+
+    auto profile = std::make_shared<QueryProfile>();
+    auto check = [&](std::function<Query(int)> make_query, bool uses_index) {
+        Query indexed = make_query(0);
+        Query plain = make_query(1);
+        indexed.set_profile(profile);
+        TableView tv = indexed.find_all();
+        CHECK_EQUAL(profile->uses_index, uses_index);
+        TableView expected = plain.find_all();
+        if (CHECK_EQUAL(tv.size(), expected.size())) {
+            for (size_t i = 0; i < tv.size(); ++i)
+                CHECK_EQUAL(tv.get_key(i), expected.get_key(i));
+        }
+        CHECK_EQUAL(indexed.count(), expected.size());
+        CHECK_EQUAL(indexed.find(), plain.find());
+    };
+    auto where = [&]() {
+        return table->where();
+    };
+
+    check([&](int j) { return where().greater_equal(cols[0][j], Timestamp(100, 0)).less(cols[0][j], Timestamp(200, 1)); },
+          true);
+    check([&](int j) { return where().greater(cols[0][j], Timestamp(9900, 1)).equal(col_user, 3); }, true);
+    check([&](int j) { return where().less(cols[0][j], Timestamp(9000, 0)); }, false);
+    check([&](int j) { return where().between(cols[1][j], 97, 99); }, true);
+    check([&](int j) { return where().equal(cols[1][j], realm::null()); }, true);
+    check([&](int j) { return where().greater(cols[1][j], 98).Or().less(cols[1][j], -99); }, false);
+    check([&](int j) { return where().less_equal(cols[2][j], -59.0); }, true);
+    check([&](int j) { return where().between(cols[2][j], 1.0, 3.0); }, true);
+    check([&](int j) { return where().greater(cols[2][j], 64.0).equal(cols[1][j], realm::null()); }, true);
+    check([&](int j) { return where().begins_with(cols[3][j], "s12"); }, true);
+    check([&](int j) { return where().equal(cols[3][j], "s7"); }, true);
+    check([&](int j) { return where().begins_with(cols[3][j], ""); }, false);
+    check([&](int j) { return where().greater(cols[4][j], ObjectId("000000000000000000002700")); }, true);
+
+    // A view sorted on an indexed column is built in the order of the index, with equal values in the same order
+    // as a sort leaves them
+    auto check_sorted = [&](std::function<Query(int)> make_query, size_t col, bool ascending, size_t limit,
+                            bool uses_index) {
+        TableView views[2];
+        for (int j = 0; j < 2; ++j) {
+            DescriptorOrdering ordering;
+            ordering.append_sort(SortDescriptor({{cols[col][j]}}, {ascending}));
+            if (limit)
+                ordering.append_limit(limit);
+            Query q = make_query(j);
+            q.set_profile(profile);
+            views[j] = q.find_all(ordering);
+            if (j == 0)
+                CHECK_EQUAL(profile->uses_index, uses_index);
+        }
+        if (CHECK_EQUAL(views[0].size(), views[1].size())) {
+            for (size_t i = 0; i < views[0].size(); ++i)
+                CHECK_EQUAL(views[0].get_key(i), views[1].get_key(i));
+        }
+    };
+    auto time_window = [&](int j) {
+        return where().greater_equal(cols[0][j], Timestamp(1000, 0)).less(cols[0][j], Timestamp(6000, 0));
+    };
+    check_sorted(time_window, 0, false, 0, true);
+    check_sorted(time_window, 0, false, 20, true);
+    check_sorted(time_window, 0, true, 0, true);
+    check_sorted([&](int j) { return where().less(cols[1][j], 0); }, 1, false, 0, true);
+    check_sorted([&](int) { return where(); }, 1, false, 0, true);
+    check_sorted([&](int) { return where(); }, 2, true, 0, true);
+    check_sorted([&](int) { return where().equal(col_user, 4); }, 4, false, 0, false);
+    // Strings are sorted by collation, which is not the order of the index
+    check_sorted([&](int) { return where(); }, 3, true, 0, false);
+
+    // Sorting a view that is in sync finds the matches of its query again, in the order of the index
+    for (bool ascending : {true, false}) {
+        TableView views[2];
+        for (int j = 0; j < 2; ++j) {
+            views[j] = time_window(j).find_all();
+            views[j].sort(cols[1][j], ascending);
+        }
+        if (CHECK_EQUAL(views[0].size(), views[1].size())) {
+            for (size_t i = 0; i < views[0].size(); ++i)
+                CHECK_EQUAL(views[0].get_key(i), views[1].get_key(i));
+        }
+    }
+
+    // The index is kept up to date by writes, and the views built with it by syncing
+    DescriptorOrdering ordering;
+    ordering.append_sort(SortDescriptor({{cols[0][0]}}, {false}));
+    TableView newest = time_window(0).find_all(ordering);
+    size_t size_before = newest.size();
+    wt->promote_to_write();
+    table->get_object(ObjKey(17)).set(cols[0][0], Timestamp(5999, 999));
+    ObjKey newest_key = table->create_object().set(cols[0][0], Timestamp(5999, 999)).get_key();
+    ObjKey oldest_key = table->create_object().set(cols[0][0], Timestamp(1000, 0)).get_key();
+    table->get_object(ObjKey(18)).remove();
+    wt->commit_and_continue_as_read();
+    newest.sync_if_needed();
+    CHECK_GREATER_EQUAL(newest.size(), size_before);
+    CHECK_EQUAL(newest.get_key(0), ObjKey(17));
+    CHECK_EQUAL(newest.get_key(1), newest_key);
+    CHECK_EQUAL(newest.get_key(newest.size() - 1), oldest_key);
+    for (size_t i = 1; i < newest.size(); ++i)
+        CHECK_GREATER_EQUAL(newest.get_object(i - 1).get<Timestamp>(cols[0][0]),
+                            newest.get_object(i).get<Timestamp>(cols[0][0]));
+}
+
 #endif // TEST_QUERY
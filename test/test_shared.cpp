@@ -4283,4 +4283,45 @@ TEST(Shared_ManyColumns)
     foo->create_object().set("Prop0", 500);
 }
 
+TEST(Shared_ReadAhead)
+{
+    // Traversals prefetch upcoming clusters and advise the OS about their pages.
+    // This must not change what is read, whether the file is encrypted or not,
+    // and whether the clusters were written by a previous commit or not.
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key());
+    options.read_ahead_clusters = 4;
+    DBRef db = DB::create(path, false, options);
+    const size_t nb_rows = 20000;
+
+    ColKey col_int;
+    ColKey col_str;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("foo");
+        col_int = table->add_column(type_Int, "int");
+        col_str = table->add_column(type_String, "str", true);
+        for (size_t i = 0; i < nb_rows; i++) {
+            table->create_object(ObjKey(i)).set(col_int, int64_t(i % 100)).set(col_str, i % 3 ? "abc" : "defg");
+        }
+        CHECK_EQUAL(table->where().equal(col_int, 7).count(), nb_rows / 100);
+        wt->commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("foo");
+        CHECK_EQUAL(table->where().equal(col_int, 7).count(), nb_rows / 100);
+        CHECK_EQUAL(table->where().equal(col_str, "defg").count(), (nb_rows + 2) / 3);
+        CHECK_EQUAL(table->sum_int(col_int), int64_t(nb_rows / 100 * 4950));
+
+        size_t i = 0;
+        for (auto o : *table) {
+            CHECK_EQUAL(o.get_key(), ObjKey(i));
+            CHECK_EQUAL(o.get<Int>(col_int), int64_t(i % 100));
+            i++;
+        }
+        CHECK_EQUAL(i, nb_rows);
+    }
+}
+
 #endif // TEST_SHARED
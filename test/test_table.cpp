@@ -5567,4 +5567,856 @@ TEST(Table_EmbeddedObjectPath)
 }
 
 
+// Runs the steps shared by the tests of what is encoded or summarized when a write transaction is committed. 'fill'
+// populates the table "table" of a new file, and 'check' is run on it once it is committed. Then 'modify' changes the
+// table in another write transaction, and 'check' is run on the modified table before and after the commit. Returns
+// the DB for the test to go on with.
+template <class Fill, class Check, class Modify>
+DBRef test_commit_and_reopen(const std::string& path, Fill fill, Check check, Modify modify)
+{
+    DBRef sg = DB::create(path);
+    {
+        auto wt = sg->start_write();
+        fill(*wt->add_table("table"));
+        wt->commit();
+    }
+    {
+        auto rt = sg->start_read();
+        check(rt->get_table("table"), false);
+    }
+    {
+        auto wt = sg->start_write();
+        TableRef table = wt->get_table("table");
+        modify(*table);
+        check(table, true);
+        wt->commit();
+    }
+    {
+        auto rt = sg->start_read();
+        check(rt->get_table("table"), true);
+        rt->verify();
+    }
+    return sg;
+}
+
+TEST(Table_OffsetEncodedIntColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const int64_t base = 1600000000000;
+    const int nb_rows = 2000;
+    ColKey col_int;
+    ColKey col_int_null;
+    auto fill = [&](Table& table) {
+        col_int = table.add_column(type_Int, "int");
+        col_int_null = table.add_column(type_Int, "int_null", true);
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(i)).set(col_int, base + i * 1000);
+            if (i % 10)
+                obj.set(col_int_null, base - i);
+        }
+    };
+    // A value far from the others
+    auto modify = [&](Table& table) {
+        table.get_object(ObjKey(5)).set(col_int, -1);
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        const int64_t changed = modified ? -1 : base + 5000;
+        CHECK_EQUAL(base + 1000, table->get_object(ObjKey(1)).get<Int>(col_int));
+        CHECK_EQUAL(changed, table->get_object(ObjKey(5)).get<Int>(col_int));
+        CHECK_EQUAL(base - 1, table->get_object(ObjKey(1)).get<util::Optional<Int>>(col_int_null));
+        CHECK_NOT(table->get_object(ObjKey(10)).get<util::Optional<Int>>(col_int_null));
+
+        CHECK_EQUAL(changed < base ? nb_rows - 1 : nb_rows, table->where().greater_equal(col_int, base).count());
+        CHECK_EQUAL(1, table->where().equal(col_int, base + 1000).count());
+        CHECK_EQUAL(nb_rows / 10, table->where().equal(col_int_null, null()).count());
+        CHECK_EQUAL(nb_rows - nb_rows / 10, table->where().less(col_int_null, base).count());
+        CHECK_EQUAL(base + (nb_rows - 1) * 1000, table->maximum_int(col_int));
+        CHECK_EQUAL(std::min(changed, base), table->minimum_int(col_int));
+        CHECK_EQUAL(base - (nb_rows - 1), table->minimum_int(col_int_null));
+
+        int64_t sum = changed - (base + 5000);
+        int64_t sum_null = 0;
+        for (int i = 0; i < nb_rows; ++i) {
+            sum += base + i * 1000;
+            if (i % 10)
+                sum_null += base - i;
+        }
+        CHECK_EQUAL(sum, table->sum_int(col_int));
+        CHECK_EQUAL(sum_null, table->sum_int(col_int_null));
+    };
+    test_commit_and_reopen(path, fill, check, modify);
+}
+
+
+TEST(Table_DictionaryEncodedStringColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const char* statuses[] = {"open", "closed", "pending", "rejected"};
+    const int nb_rows = 2000;
+    ColKey col_status;
+    ColKey col_name;
+    auto fill = [&](Table& table) {
+        col_status = table.add_column(type_String, "status", true);
+        col_name = table.add_column(type_String, "name");
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(i)).set(col_name, std::string("name ") + util::to_string(i));
+            if (i % 10)
+                obj.set(col_status, statuses[i % 4]);
+        }
+    };
+    // A value that is new to the leaf
+    auto modify = [&](Table& table) {
+        table.get_object(ObjKey(3)).set(col_status, "escalated");
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        StringData changed = modified ? "escalated" : "rejected";
+        CHECK_EQUAL("closed", table->get_object(ObjKey(1)).get<String>(col_status));
+        CHECK_EQUAL(changed, table->get_object(ObjKey(3)).get<String>(col_status));
+        CHECK(table->get_object(ObjKey(10)).get<String>(col_status).is_null());
+        CHECK_EQUAL("name 17", table->get_object(ObjKey(17)).get<String>(col_name));
+
+        size_t nb_open = 0;
+        for (int i = 0; i < nb_rows; ++i) {
+            if (i % 10 && i % 4 == 0)
+                nb_open++;
+        }
+        CHECK_EQUAL(nb_open, table->where().equal(col_status, "open").count());
+        CHECK_EQUAL(nb_rows / 10, table->where().equal(col_status, realm::null()).count());
+        CHECK_EQUAL(modified ? nb_rows / 4 - 1 : nb_rows / 4, table->where().equal(col_status, "rejected").count());
+        CHECK_EQUAL(modified ? 1 : nb_rows / 4, table->where().equal(col_status, changed).count());
+        CHECK_EQUAL(0, table->where().equal(col_status, "unknown").count());
+        CHECK_EQUAL(ObjKey(1), table->find_first_string(col_status, "closed"));
+        CHECK_EQUAL(1, table->where().equal(col_name, "name 17").count());
+    };
+    test_commit_and_reopen(path, fill, check, modify);
+}
+
+
+TEST(Table_CompressedStringColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    // Many leaves, which the table keeps decompressed until the transaction ends
+    const int nb_rows = 5000;
+    auto url = [](int i) {
+        return std::string("https://www.example.com/api/v2/customers/") + util::to_string(i % 50) + "/orders/" +
+               util::to_string(i);
+    };
+    ColKey col_url;
+    auto fill = [&](Table& table) {
+        col_url = table.add_column(type_String, "url", true);
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(i));
+            if (i % 100)
+                obj.set(col_url, url(i));
+        }
+    };
+    auto modify = [&](Table& table) {
+        table.get_object(ObjKey(3)).set(col_url, "ftp://example.com");
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        std::string changed = modified ? "ftp://example.com" : url(3);
+        CHECK_EQUAL(url(1), table->get_object(ObjKey(1)).get<String>(col_url));
+        CHECK_EQUAL(changed, table->get_object(ObjKey(3)).get<String>(col_url));
+        CHECK(table->get_object(ObjKey(100)).get<String>(col_url).is_null());
+
+        // Strings from different rows are valid at the same time
+        StringData a = table->get_object(ObjKey(1001)).get<String>(col_url);
+        StringData b = table->get_object(ObjKey(4999)).get<String>(col_url);
+        CHECK_EQUAL(url(1001), a);
+        CHECK_EQUAL(url(4999), b);
+
+        CHECK_EQUAL(1, table->where().equal(col_url, StringData(url(1234))).count());
+        CHECK_EQUAL(ObjKey(1234), table->find_first_string(col_url, url(1234)));
+        CHECK_EQUAL(modified ? 0 : 1, table->where().equal(col_url, StringData(url(3))).count());
+        CHECK_EQUAL(1, table->where().equal(col_url, StringData(changed)).count());
+        CHECK_EQUAL(nb_rows / 100, table->where().equal(col_url, realm::null()).count());
+        CHECK_EQUAL(nb_rows / 50, table->where().contains(col_url, "/customers/7/").count());
+        CHECK_EQUAL(modified ? nb_rows - nb_rows / 100 - 1 : nb_rows - nb_rows / 100,
+                    table->where().begins_with(col_url, "https://www.example.com/api/v2/customers/").count());
+
+        // Sorting compares strings read from all the leaves
+        ConstTableView sorted = table->get_sorted_view(col_url);
+        CHECK_EQUAL(nb_rows, sorted.size());
+        bool is_sorted = true;
+        for (size_t i = 1; i < sorted.size(); ++i) {
+            if (sorted.get_object(i).get<String>(col_url) < sorted.get_object(i - 1).get<String>(col_url))
+                is_sorted = false;
+        }
+        CHECK(is_sorted);
+        CHECK(sorted.get_object(0).get<String>(col_url).is_null());
+        std::string first = modified ? "ftp://example.com" : url(1050);
+        CHECK_EQUAL(first, sorted.get_object(nb_rows / 100).get<String>(col_url));
+        // The strings read before are still valid
+        CHECK_EQUAL(url(1001), a);
+        CHECK_EQUAL(url(4999), b);
+    };
+    test_commit_and_reopen(path, fill, check, modify);
+}
+
+
+TEST(Table_ZoneMaps)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    // An append only time series, so every cluster covers a separate range of times
+    const int nb_rows = 5000;
+    ColKey col_time, col_level, col_value, col_stamp;
+    auto fill = [&](Table& table) {
+        col_time = table.add_column(type_Int, "time");
+        col_level = table.add_column(type_Int, "level", true);
+        col_value = table.add_column(type_Double, "value", true);
+        col_stamp = table.add_column(type_Timestamp, "stamp", true);
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(i));
+            obj.set(col_time, 1000 + i);
+            obj.set(col_value, i * 0.5);
+            obj.set(col_stamp, Timestamp(i / 2, (i % 2) * 500000000));
+            if (i % 10)
+                obj.set(col_level, i % 7);
+        }
+    };
+    auto modify = [&](Table& table) {
+        // Summaries of modified clusters are not used before the commit
+        table.get_object(ObjKey(10)).set(col_time, 7000);
+        table.get_object(ObjKey(10)).set(col_value, -1.0);
+        CHECK_EQUAL(1, table.where().equal(col_time, 7000).count());
+        CHECK_EQUAL(1, table.where().less(col_value, 0.0).count());
+        table.get_object(ObjKey(10)).set(col_time, 1010);
+        table.get_object(ObjKey(10)).set(col_value, 5.0);
+        table.add_column(type_String, "name");
+
+        // The last row is replaced by one that extends the ranges
+        table.remove_object(ObjKey(4999));
+        table.create_object(ObjKey(nb_rows))
+            .set(col_time, 6000)
+            .set(col_level, 3)
+            .set(col_value, 2500.0)
+            .set(col_stamp, Timestamp(2500, 0));
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        if (!modified) {
+            size_t nb_summaries = 0;
+            table->traverse_clusters([&](const Cluster* cluster) {
+                Cluster::ColumnSummary summary;
+                if (cluster->get_column_summary(col_time, summary)) {
+                    CHECK_EQUAL(0, summary.null_count);
+                    CHECK_EQUAL(summary.max - summary.min, int64_t(cluster->node_size() - 1));
+                    ++nb_summaries;
+                }
+                CHECK(cluster->get_column_summary(col_stamp, summary));
+                return false;
+            });
+            CHECK_GREATER(nb_summaries, 1);
+        }
+
+        CHECK_EQUAL(1, table->where().equal(col_time, 1010).count());
+        CHECK_EQUAL(0, table->where().equal(col_time, 999).count());
+        CHECK_EQUAL(100, table->where().greater(col_time, 5899).count());
+        CHECK_EQUAL(4900, table->where().greater_equal(col_time, 1100).count());
+        CHECK_EQUAL(10, table->where().less(col_time, 1010).count());
+        CHECK_EQUAL(ObjKey(4000), table->where().equal(col_time, 5000).find());
+        CHECK_EQUAL(nb_rows - 1, table->where().not_equal(col_time, 1500).count());
+        CHECK_EQUAL(3999, table->where().greater(col_time, 1999).less(col_time, 5999).find_all().size());
+        CHECK_EQUAL(2999, table->where().less(col_time, 3000).maximum_int(col_time));
+        CHECK_EQUAL(modified ? 6000 : 5999, table->maximum_int(col_time));
+
+        CHECK_EQUAL(nb_rows / 10, table->where().equal(col_level, realm::null()).count());
+        CHECK_EQUAL(0, table->where().greater(col_level, 6).count());
+
+        CHECK_EQUAL(4, table->where().greater(col_value, 2497.5).count());
+        CHECK_EQUAL(0, table->where().less(col_value, 0.0).count());
+        CHECK_EQUAL(1, table->where().equal(col_value, 1000.0).count());
+
+        CHECK_EQUAL(2, table->where().greater(col_stamp, Timestamp(2498, 500000000)).count());
+        CHECK_EQUAL(1, table->where().equal(col_stamp, Timestamp(2000, 500000000)).count());
+        CHECK_EQUAL(2, table->where().less(col_stamp, Timestamp(1, 0)).count());
+        CHECK_EQUAL(nb_rows - 1, table->where().not_equal(col_stamp, Timestamp(7, 0)).count());
+    };
+    test_commit_and_reopen(path, fill, check, modify);
+}
+
+TEST(Table_BloomFilters)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const int nb_rows = 5000;
+    auto name = [](int i) {
+        return "user_" + util::to_string(i * 7919 % 100003);
+    };
+    auto oid = [](int i) {
+        char buffer[25];
+        snprintf(buffer, sizeof(buffer), "%024x", i * 104729);
+        return ObjectId(buffer);
+    };
+    ColKey col_name, col_oid, col_int;
+    auto fill = [&](Table& table) {
+        col_name = table.add_column(type_String, "name", true);
+        col_oid = table.add_column(type_ObjectId, "oid", true);
+        col_int = table.add_column(type_Int, "int");
+        CHECK_LOGIC_ERROR(table.add_bloom_filter(col_int), LogicError::illegal_combination);
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(i));
+            if (i % 100) {
+                obj.set(col_name, name(i));
+                obj.set(col_oid, oid(i));
+            }
+        }
+    };
+    // Filters are added to the existing clusters
+    auto modify = [&](Table& table) {
+        CHECK_NOT(table.has_bloom_filter(col_name));
+        table.add_bloom_filter(col_name);
+        table.add_bloom_filter(col_oid);
+        CHECK(table.has_bloom_filter(col_name));
+        CHECK(table.has_bloom_filter(col_oid));
+        CHECK_NOT(table.has_bloom_filter(col_int));
+        table.get_object(ObjKey(3)).set(col_name, "somebody");
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        std::string changed = modified ? "somebody" : name(3);
+        CHECK_EQUAL(ObjKey(1234), table->where().equal(col_name, StringData(name(1234))).find());
+        CHECK_EQUAL(0, table->where().equal(col_name, "nobody").count());
+        CHECK_EQUAL(1, table->where().equal(col_name, StringData(changed)).count());
+        CHECK_EQUAL(nb_rows / 100, table->where().equal(col_name, realm::null()).count());
+        CHECK_EQUAL(2, table->where()
+                           .equal(col_name, StringData(name(1)))
+                           .Or()
+                           .equal(col_name, StringData(name(4999)))
+                           .count());
+        CHECK_EQUAL(ObjKey(4321), table->where().equal(col_oid, oid(4321)).find());
+        CHECK_EQUAL(0, table->where().equal(col_oid, oid(nb_rows)).count());
+        CHECK_EQUAL(nb_rows / 100, table->where().equal(col_oid, realm::null()).count());
+        CHECK_EQUAL(nb_rows - 1, table->where().not_equal(col_oid, oid(1)).count());
+    };
+    DBRef sg = test_commit_and_reopen(path, fill, check, modify);
+
+    {
+        // Absent values are ruled out in almost all clusters, which keep the summaries of their other columns
+        auto rt = sg->start_read();
+        size_t nb_clusters = 0;
+        size_t nb_false_positives = 0;
+        rt->get_table("table")->traverse_clusters([&](const Cluster* cluster) {
+            ++nb_clusters;
+            Cluster::ColumnSummary summary;
+            CHECK(cluster->get_column_summary(col_int, summary));
+            for (int i = 0; i < 10; ++i) {
+                auto hash = Cluster::get_filter_hash(StringData("absent" + util::to_string(i)));
+                if (cluster->may_contain(col_name, hash))
+                    ++nb_false_positives;
+            }
+            return false;
+        });
+        CHECK_LESS(nb_false_positives, nb_clusters);
+    }
+    {
+        auto wt = sg->start_write();
+        TableRef table = wt->get_table("table");
+        table->remove_bloom_filter(col_name);
+        CHECK_NOT(table->has_bloom_filter(col_name));
+        wt->commit();
+    }
+    {
+        auto rt = sg->start_read();
+        ConstTableRef table = rt->get_table("table");
+        check(table, true);
+        table->traverse_clusters([&](const Cluster* cluster) {
+            CHECK(cluster->may_contain(col_name, Cluster::get_filter_hash(StringData("absent"))));
+            return false;
+        });
+        rt->verify();
+    }
+}
+
+TEST(Table_OrderedIndexes)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    const int nb_rows = 3000;
+    ColKey col_int, col_time, col_double, col_string, col_oid;
+    auto fill = [&](Table& table) {
+        col_int = table.add_column(type_Int, "int", true);
+        col_time = table.add_column(type_Timestamp, "time");
+        col_double = table.add_column(type_Double, "double", true);
+        col_string = table.add_column(type_String, "string", true);
+        col_oid = table.add_column(type_ObjectId, "oid");
+        ColKey col_bool = table.add_column(type_Bool, "bool");
+        ColKey col_list = table.add_column_list(type_Int, "list");
+        CHECK_LOGIC_ERROR(table.add_ordered_index(col_bool), LogicError::illegal_combination);
+        CHECK_LOGIC_ERROR(table.add_ordered_index(col_list), LogicError::illegal_combination);
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object();
+            if (i % 50)
+                obj.set(col_int, random.draw_int<int64_t>(-100, 100));
+            obj.set(col_time, Timestamp(random.draw_int<int64_t>(0, 100000), random.draw_int<int32_t>(0, 999)));
+            if (i % 40)
+                obj.set(col_double, random.draw_int<int>(-1000, 1000) / 8.0);
+            if (i % 30)
+                obj.set(col_string, "s" + util::to_string(random.draw_int<int>(0, 500)) + (i % 7 ? "" : "\xc3\xa5"));
+            char buffer[25];
+            snprintf(buffer, sizeof(buffer), "%024x", random.draw_int<int>(0, 1000000));
+            obj.set(col_oid, ObjectId(buffer));
+        }
+        // Objects added before the index are added in bulk, later ones one by one
+        table.add_ordered_index(col_int);
+        table.add_ordered_index(col_time);
+        table.add_ordered_index(col_double);
+        for (int i = 0; i < 100; ++i)
+            table.create_object().set(col_int, i).set(col_string, "late");
+        table.add_ordered_index(col_string);
+        table.add_ordered_index(col_oid);
+        table.add_ordered_index(col_oid);
+        CHECK(table.has_ordered_index(col_oid));
+        CHECK_NOT(table.has_ordered_index(col_bool));
+        CHECK_NOT(table.get_ordered_index(col_bool));
+    };
+
+    // Each index must hold every object, ordered by value and by key among equal values
+    auto check_index = [&](ConstTableRef table, ColKey col_key) {
+        auto index = table->get_ordered_index(col_key);
+        if (!CHECK(index))
+            return;
+        std::vector<std::pair<Mixed, ObjKey>> expected;
+        for (auto& obj : *table)
+            expected.emplace_back(obj.get_any(col_key), obj.get_key());
+        std::sort(expected.begin(), expected.end(), [](auto& a, auto& b) {
+            int cmp = OrderedIndex::compare(a.first, b.first);
+            return cmp < 0 || (cmp == 0 && a.second < b.second);
+        });
+        if (!CHECK_EQUAL(index->size(), expected.size()))
+            return;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (!CHECK_EQUAL(index->get(i), expected[i].second))
+                return;
+        }
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        for (auto col_key : {col_int, col_time, col_double, col_string, col_oid})
+            check_index(table, col_key);
+        if (modified)
+            return;
+
+        // Strings are ordered by their bytes, and those with a common prefix are adjacent
+        auto index = table->get_ordered_index(col_string);
+        Mixed last = index->get_value(index->size() - 1);
+        CHECK(last.get<StringData>().begins_with("s9"));
+        for (auto& obj : *table)
+            CHECK_GREATER_EQUAL(OrderedIndex::compare(last, obj.get_any(col_string)), 0);
+        ValueRange range;
+        range.set_prefix("s12");
+        auto positions = index->find_range(range);
+        size_t count = 0;
+        for (auto& obj : *table) {
+            if (obj.get<String>(col_string).begins_with("s12"))
+                ++count;
+        }
+        CHECK_EQUAL(positions.second - positions.first, count);
+        CHECK(index->get_value(positions.first).get_string().begins_with("s12"));
+    };
+    auto modify = [&](Table& table) {
+        for (int i = 0; i < 500; ++i) {
+            Obj obj = table.get_object(size_t(random.draw_int_mod(table.size())));
+            switch (i % 6) {
+                case 0:
+                    obj.set(col_int, random.draw_int<int64_t>(-100, 100));
+                    obj.set(col_string, "s" + util::to_string(random.draw_int<int>(0, 500)));
+                    break;
+                case 1:
+                    if (!obj.is_null(col_int))
+                        obj.add_int(col_int, 1000);
+                    obj.set_null(col_double);
+                    break;
+                case 2:
+                    obj.set_null(col_int);
+                    obj.set_null(col_string);
+                    obj.set(col_time, Timestamp(random.draw_int<int64_t>(0, 100000), 0));
+                    break;
+                case 3:
+                    obj.set(col_double, random.draw_int<int>(-1000, 1000) / 8.0);
+                    obj.set(col_oid, ObjectId::gen());
+                    break;
+                case 4:
+                    obj.remove();
+                    break;
+                case 5:
+                    table.create_object().set(col_time, Timestamp(i, i));
+                    break;
+            }
+        }
+    };
+    DBRef sg = test_commit_and_reopen(path, fill, check, modify);
+
+    {
+        auto wt = sg->start_write();
+        TableRef table = wt->get_table("table");
+        table->remove_ordered_index(col_double);
+        CHECK_NOT(table->has_ordered_index(col_double));
+        table->remove_column(col_time);
+        CHECK(table->has_ordered_index(col_int));
+        col_oid = table->set_nullability(col_oid, true, false);
+        CHECK(table->has_ordered_index(col_oid));
+        check_index(table, col_oid);
+        check_index(table, col_string);
+        table->clear();
+        CHECK_EQUAL(table->get_ordered_index(col_int)->size(), 0);
+        table->create_object().set(col_int, 5);
+        check_index(table, col_int);
+        check_index(table, col_oid);
+        wt->commit();
+    }
+    {
+        auto rt = sg->start_read();
+        rt->verify();
+    }
+}
+
+TEST(Table_GetValues)
+{
+    SHARED_GROUP_TEST_PATH(path);
+
+    // Enough objects for several clusters, and both plain and encoded leaves
+    const size_t nb_rows = 3000;
+    ColKey col_int, col_int_null, col_double, col_float_null, col_bool_null, col_date;
+    auto fill = [&](Table& table) {
+        col_int = table.add_column(type_Int, "int");
+        col_int_null = table.add_column(type_Int, "int_null", true);
+        col_double = table.add_column(type_Double, "double");
+        col_float_null = table.add_column(type_Float, "float_null", true);
+        col_bool_null = table.add_column(type_Bool, "bool_null", true);
+        col_date = table.add_column(type_Timestamp, "date");
+        for (size_t i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(int64_t(i)));
+            obj.set(col_int, int64_t(i * 3) - 1000);
+            obj.set(col_double, i / 4.0);
+            obj.set(col_date, Timestamp(int64_t(i), 7));
+            if (i % 7) {
+                obj.set(col_int_null, int64_t(i));
+                obj.set(col_float_null, float(i) / 2);
+                obj.set(col_bool_null, i % 2 == 0);
+            }
+        }
+    };
+    // A value in the middle of a leaf, and a null where there was a value
+    auto modify = [&](Table& table) {
+        table.get_object(ObjKey(1500)).set(col_int, int64_t(7));
+        table.get_object(ObjKey(1501)).set_null(col_int_null);
+    };
+    auto check_range = [&](ConstTableRef table, bool modified, size_t begin, size_t count) {
+        std::vector<int64_t> ints(count);
+        std::vector<double> doubles(count);
+        std::vector<float> floats(count);
+        std::unique_ptr<bool[]> bool_values(new bool[count]);
+        std::vector<Timestamp> dates(count);
+        std::vector<uint64_t> validity((count + 63) / 64);
+
+        table->get_values(col_int, begin, count, ints.data(), validity.data());
+        table->get_values(col_double, begin, count, doubles.data());
+        table->get_values(col_date, begin, count, dates.data());
+        for (size_t i = 0; i < count; ++i) {
+            size_t ndx = begin + i;
+            CHECK_EQUAL(modified && ndx == 1500 ? 7 : int64_t(ndx * 3) - 1000, ints[i]);
+            CHECK_EQUAL(ndx / 4.0, doubles[i]);
+            CHECK_EQUAL(Timestamp(int64_t(ndx), 7), dates[i]);
+            CHECK(validity[i / 64] & (uint64_t(1) << (i % 64)));
+        }
+
+        table->get_values(col_int_null, begin, count, ints.data(), validity.data());
+        for (size_t i = 0; i < count; ++i) {
+            size_t ndx = begin + i;
+            bool valid = (validity[i / 64] >> (i % 64)) & 1;
+            CHECK_EQUAL(ndx % 7 != 0 && !(modified && ndx == 1501), valid);
+            CHECK_EQUAL(valid ? int64_t(ndx) : 0, ints[i]);
+        }
+        table->get_values(col_float_null, begin, count, floats.data(), validity.data());
+        for (size_t i = 0; i < count; ++i) {
+            size_t ndx = begin + i;
+            bool valid = (validity[i / 64] >> (i % 64)) & 1;
+            CHECK_EQUAL(ndx % 7 != 0, valid);
+            CHECK_EQUAL(valid ? float(ndx) / 2 : 0.0f, floats[i]);
+        }
+        table->get_values(col_bool_null, begin, count, bool_values.get(), validity.data());
+        for (size_t i = 0; i < count; ++i) {
+            size_t ndx = begin + i;
+            bool valid = (validity[i / 64] >> (i % 64)) & 1;
+            CHECK_EQUAL(ndx % 7 != 0, valid);
+            CHECK_EQUAL(valid && ndx % 2 == 0, bool_values[i]);
+        }
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        check_range(table, modified, 0, nb_rows);
+        check_range(table, modified, 999, 1002);
+        check_range(table, modified, 1500, 2);
+        check_range(table, modified, nb_rows - 1, 1);
+        check_range(table, modified, 17, 0);
+
+        double d;
+        CHECK_LOGIC_ERROR(table->get_values(col_int, 0, 1, &d), LogicError::type_mismatch);
+        int64_t v;
+        CHECK_LOGIC_ERROR(table->get_values(col_int, nb_rows, 1, &v), LogicError::row_index_out_of_range);
+    };
+    test_commit_and_reopen(path, fill, check, modify);
+}
+
+
+TEST(Table_RunEncodedColumns)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const int nb_rows = 3000;
+    ColKey col_tenant;
+    ColKey col_region;
+    ColKey col_archived;
+    ColKey col_flag;
+    auto fill = [&](Table& table) {
+        col_tenant = table.add_column(type_Int, "tenant_id");
+        col_region = table.add_column(type_Int, "region", true);
+        col_archived = table.add_column(type_Bool, "is_archived");
+        col_flag = table.add_column(type_Bool, "flag", true);
+        for (int i = 0; i < nb_rows; ++i) {
+            Obj obj = table.create_object(ObjKey(i)).set(col_tenant, 1000 + i / 100);
+            obj.set(col_archived, i < nb_rows / 2);
+            if (i % 500 >= 100) {
+                obj.set(col_region, i / 500);
+                obj.set(col_flag, i % 1000 < 500);
+            }
+        }
+    };
+    // Breaking up a run
+    auto modify = [&](Table& table) {
+        table.get_object(ObjKey(1234)).set(col_tenant, 7);
+    };
+    auto check = [&](ConstTableRef table, bool modified) {
+        const int64_t changed = modified ? 7 : 1012;
+        CHECK_EQUAL(1000, table->get_object(ObjKey(0)).get<Int>(col_tenant));
+        CHECK_EQUAL(changed, table->get_object(ObjKey(1234)).get<Int>(col_tenant));
+        CHECK_EQUAL(1029, table->get_object(ObjKey(nb_rows - 1)).get<Int>(col_tenant));
+        CHECK_NOT(table->get_object(ObjKey(550)).get<util::Optional<Int>>(col_region));
+        CHECK_EQUAL(1, table->get_object(ObjKey(700)).get<util::Optional<Int>>(col_region));
+        CHECK(table->get_object(ObjKey(1)).get<Bool>(col_archived));
+        CHECK_NOT(table->get_object(ObjKey(nb_rows - 1)).get<Bool>(col_archived));
+
+        CHECK_EQUAL(modified ? 99 : 100, table->where().equal(col_tenant, 1012).count());
+        CHECK_EQUAL(modified ? nb_rows - 99 : nb_rows - 100, table->where().not_equal(col_tenant, 1012).count());
+        CHECK_EQUAL(nb_rows - 2000, table->where().greater(col_tenant, 1019).count());
+        CHECK_EQUAL(ObjKey(1200), table->where().equal(col_tenant, 1012).find());
+        CHECK_EQUAL(nb_rows / 2, table->where().equal(col_archived, true).count());
+        CHECK_EQUAL(nb_rows / 2, table->where().not_equal(col_archived, true).count());
+        CHECK_EQUAL(ObjKey(nb_rows / 2), table->where().equal(col_archived, false).find());
+        CHECK_EQUAL(nb_rows / 5, table->where().equal(col_region, null()).count());
+        CHECK_EQUAL(400, table->where().equal(col_region, 3).count());
+        CHECK_EQUAL(nb_rows / 5, table->where().equal(col_flag, null()).count());
+        CHECK_EQUAL(1200, table->where().equal(col_flag, true).count());
+        CHECK_EQUAL(1200, table->where().equal(col_flag, false).count());
+
+        int64_t sum = changed - 1012;
+        int64_t sum_region = 0;
+        for (int i = 0; i < nb_rows; ++i) {
+            sum += 1000 + i / 100;
+            if (i % 500 >= 100)
+                sum_region += i / 500;
+        }
+        CHECK_EQUAL(sum, table->sum_int(col_tenant));
+        CHECK_EQUAL(sum_region, table->sum_int(col_region));
+        CHECK_EQUAL(sum, table->where().sum_int(col_tenant));
+        CHECK_EQUAL(std::max(changed, int64_t(1029)), table->maximum_int(col_tenant));
+        CHECK_EQUAL(std::min(changed, int64_t(1000)), table->minimum_int(col_tenant));
+        CHECK_EQUAL(5, table->maximum_int(col_region));
+    };
+    test_commit_and_reopen(path, fill, check, modify);
+}
+
+TEST(Table_ClusterSize)
+{
+    const size_t nb_rows = 20000;
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+
+    for (size_t cluster_size : {Table::max_cluster_size, Table::min_cluster_size}) {
+        SHARED_GROUP_TEST_PATH(path);
+        std::set<int64_t> keys;
+        ColKey col_int;
+        auto fill = [&](Table& table) {
+            col_int = table.add_column(type_Int, "int");
+            CHECK_EQUAL(table.get_cluster_size(), size_t(1) << ClusterTree::default_node_shift_factor);
+            CHECK_LOGIC_ERROR(table.set_cluster_size(100), LogicError::illegal_combination);
+            CHECK_LOGIC_ERROR(table.set_cluster_size(Table::max_cluster_size * 2), LogicError::illegal_combination);
+            table.set_cluster_size(cluster_size);
+
+            for (size_t i = 0; i < nb_rows; i++) {
+                table.create_object(ObjKey(i)).set(col_int, int64_t(i % 100));
+                keys.insert(i);
+            }
+            CHECK_LOGIC_ERROR(table.set_cluster_size(1024), LogicError::illegal_combination);
+        };
+        // Random erasure and insertion take the tree through splits and merges
+        auto modify = [&](Table& table) {
+            for (int i = 0; i < 15000; i++) {
+                int64_t k = random.draw_int_mod(4 * nb_rows);
+                if (keys.count(k)) {
+                    table.remove_object(ObjKey(k));
+                    keys.erase(k);
+                }
+                else {
+                    table.create_object(ObjKey(k)).set(col_int, k % 100);
+                    keys.insert(k);
+                }
+            }
+        };
+        auto check = [&](ConstTableRef table, bool) {
+            CHECK_EQUAL(table->get_cluster_size(), cluster_size);
+            CHECK_EQUAL(table->size(), keys.size());
+            size_t num_leaves = 0;
+            size_t num_objects = 0;
+            table->traverse_clusters([&](const Cluster* cluster) {
+                CHECK_LESS_EQUAL(cluster->node_size(), cluster_size);
+                num_leaves++;
+                num_objects += cluster->node_size();
+                return false;
+            });
+            CHECK_EQUAL(num_objects, keys.size());
+            // Sequential inserts fill the leaves, erasure merges them again
+            CHECK_LESS_EQUAL(num_leaves, 4 * keys.size() / cluster_size + 2);
+
+            auto it = keys.begin();
+            for (auto o : *table) {
+                CHECK_EQUAL(o.get_key().value, *it);
+                CHECK_EQUAL(o.get<Int>(col_int), *it % 100);
+                ++it;
+            }
+            CHECK_EQUAL(table->where().equal(col_int, 7).count(),
+                        size_t(std::count_if(keys.begin(), keys.end(), [](int64_t k) {
+                            return k % 100 == 7;
+                        })));
+        };
+        test_commit_and_reopen(path, fill, check, modify);
+    }
+}
+
+TEST(Table_ColumnStatistics)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const size_t nb_rows = 20000;
+    ColKey col_int;
+
+    auto fill = [&](Table& table) {
+        col_int = table.add_column(type_Int, "int");
+        auto col_int_null = table.add_column(type_Int, "int_null", true);
+        auto col_bool = table.add_column(type_Bool, "bool");
+        auto col_double = table.add_column(type_Double, "double");
+        auto col_date = table.add_column(type_Timestamp, "date");
+        auto col_str = table.add_column(type_String, "str");
+        auto col_oid = table.add_column(type_ObjectId, "oid");
+        auto col_bin = table.add_column(type_Binary, "bin");
+        CHECK_NOT(table.has_statistics());
+
+        for (size_t i = 0; i < nb_rows; i++) {
+            auto obj = table.create_object();
+            obj.set(col_int, int64_t(i / 20));
+            if (i % 5)
+                obj.set(col_int_null, int64_t(i));
+            obj.set(col_bool, i % 19 != 0);
+            obj.set(col_double, double(i) / nb_rows);
+            obj.set(col_date, Timestamp(int64_t(i) * 60, 0));
+            obj.set(col_str, "str" + util::to_string(i % 7));
+            obj.set(col_oid, ObjectId::gen());
+        }
+
+        ColumnStatistics statistics;
+        CHECK_NOT(table.get_column_statistics(col_int, statistics));
+        table.update_statistics();
+        CHECK(table.has_statistics());
+        CHECK_NOT(table.get_column_statistics(col_bin, statistics));
+
+        CHECK(table.get_column_statistics(col_int, statistics));
+        CHECK_EQUAL(statistics.get_num_objects(), nb_rows);
+        CHECK_EQUAL(statistics.get_num_nulls(), 0);
+        CHECK_EQUAL(statistics.get_num_distinct(), 1000);
+        CHECK_APPROXIMATELY_EQUAL(statistics.less_fraction(250, false), 0.25, 0.05);
+        CHECK_APPROXIMATELY_EQUAL(statistics.greater_fraction(250, true), 0.75, 0.05);
+        CHECK_APPROXIMATELY_EQUAL(statistics.equal_fraction(7), 0.001, 0.1);
+        CHECK_EQUAL(statistics.equal_fraction(-1), 0);
+        CHECK_EQUAL(statistics.less_fraction(-1, true), 0);
+        CHECK_EQUAL(statistics.greater_fraction(1000, false), 0);
+
+        CHECK(table.get_column_statistics(col_int_null, statistics));
+        CHECK_APPROXIMATELY_EQUAL(statistics.null_fraction(), 0.2, 0.01);
+        // Unique values are estimated from a sample of half the table
+        CHECK_GREATER(statistics.get_num_distinct(), nb_rows * 8 / 10 * 2 / 3);
+        CHECK_LESS_EQUAL(statistics.get_num_distinct(), nb_rows * 8 / 10);
+        CHECK_APPROXIMATELY_EQUAL(statistics.less_fraction(nb_rows / 2, false), 0.4, 0.05);
+
+        // The frequent value fills most buckets of the histogram
+        CHECK(table.get_column_statistics(col_bool, statistics));
+        CHECK_EQUAL(statistics.get_num_distinct(), 2);
+        CHECK_APPROXIMATELY_EQUAL(statistics.equal_fraction(1), 0.95, 0.05);
+        CHECK_APPROXIMATELY_EQUAL(statistics.equal_fraction(0), 0.05, 0.5);
+
+        CHECK(table.get_column_statistics(col_double, statistics));
+        CHECK_APPROXIMATELY_EQUAL(statistics.less_fraction(0.1, true), 0.1, 0.1);
+        CHECK(table.get_column_statistics(col_date, statistics));
+        CHECK_APPROXIMATELY_EQUAL(statistics.greater_fraction(nb_rows * 60 * 0.9, false), 0.1, 0.1);
+
+        CHECK(table.get_column_statistics(col_str, statistics));
+        CHECK_NOT(statistics.has_histogram());
+        CHECK_EQUAL(statistics.get_num_distinct(), 7);
+        CHECK_APPROXIMATELY_EQUAL(statistics.equal_fraction(), 1.0 / 7, 0.01);
+        CHECK_LESS(statistics.less_fraction(0, false), 0);
+        CHECK(table.get_column_statistics(col_oid, statistics));
+        CHECK_GREATER(statistics.get_num_distinct(), nb_rows * 2 / 3);
+    };
+    // Few modifications leave the statistics as they are, even if they touch every cluster
+    auto modify = [&](Table& table) {
+        for (size_t i = 0; i < nb_rows; i += 100)
+            table.get_object(i).set(col_int, 5000);
+        table.create_object().set(col_int, 5000);
+    };
+    // The statistics are stored with the table
+    auto check = [&](ConstTableRef table, bool) {
+        ColumnStatistics statistics;
+        CHECK(table->get_column_statistics(col_int, statistics));
+        CHECK_EQUAL(statistics.get_num_objects(), nb_rows);
+        CHECK_EQUAL(statistics.get_num_distinct(), 1000);
+        CHECK_EQUAL(statistics.equal_fraction(5000), 0);
+    };
+    DBRef sg = test_commit_and_reopen(path, fill, check, modify);
+
+    {
+        // Modifying more than a tenth of the objects brings them up to date
+        {
+            auto wt = sg->start_write();
+            TableRef table = wt->get_table("table");
+            for (size_t i = 0; i < nb_rows / 8; ++i)
+                table->get_object(i).set(col_int, 5000);
+            wt->commit();
+        }
+        auto rt = sg->start_read();
+        ConstTableRef table = rt->get_table("table");
+        ColumnStatistics statistics;
+        CHECK(table->get_column_statistics(table->get_column_key("int"), statistics));
+        CHECK_EQUAL(statistics.get_num_objects(), nb_rows + 1);
+        CHECK_APPROXIMATELY_EQUAL(statistics.equal_fraction(5000), 0.125, 0.25);
+    }
+    {
+        // So does clearing the table
+        auto wt = sg->start_write();
+        TableRef table = wt->get_table("table");
+        table->clear();
+        wt->commit();
+        auto rt = sg->start_read();
+        ConstTableRef read_table = rt->get_table("table");
+        ColumnStatistics statistics;
+        CHECK(read_table->get_column_statistics(read_table->get_column_key("int"), statistics));
+        CHECK_EQUAL(statistics.get_num_objects(), 0);
+        CHECK_EQUAL(statistics.get_num_distinct(), 0);
+    }
+    {
+        auto wt = sg->start_write();
+        TableRef table = wt->get_table("table");
+        table->remove_statistics();
+        CHECK_NOT(table->has_statistics());
+        ColumnStatistics statistics;
+        CHECK_NOT(table->get_column_statistics(table->get_column_key("int"), statistics));
+        wt->commit();
+        auto rt = sg->start_read();
+        CHECK_NOT(rt->get_table("table")->has_statistics());
+        rt->verify();
+    }
+}
+
 #endif // TEST_TABLE
@@ -28,6 +28,7 @@
 #include <realm.hpp>
 
 #include "util/misc.hpp"
+#include "util/random.hpp"
 
 #include "test.hpp"
 #include "test_table_helper.hpp"
@@ -2931,4 +2932,94 @@ TEST(TableView_TimestampMaxRemoveRow)
     CHECK_EQUAL(tv.maximum_timestamp(col_date), Timestamp(8, 0));
 }
 
+TEST(TableView_Selection)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_double = table.add_column(type_Double, "double");
+    auto col_date = table.add_column(type_Timestamp, "date");
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 3000; ++i) {
+        Obj obj = table.create_object();
+        if (random.draw_int_mod(20))
+            obj.set(col_int, random.draw_int<int64_t>(0, 999));
+        obj.set(col_double, random.draw_int<int>(-100, 100) / 4.0);
+        obj.set(col_date, Timestamp(random.draw_int<int64_t>(0, 10000), 0));
+    }
+
+    auto check = [&](Query q) {
+        // A limit makes the view hold the keys
+        TableView keys = q.find_all(0, size_t(-1), table.size());
+        TableView selection = q.find_all();
+        CHECK(!keys.uses_selection());
+        CHECK_EQUAL(selection.uses_selection(), !keys.is_empty());
+        CHECK_EQUAL(selection.size(), keys.size());
+        for (size_t i = 0; i < keys.size() && i < selection.size(); ++i) {
+            CHECK_EQUAL(selection.get_key(i), keys.get_key(i));
+            CHECK_EQUAL(selection.find_by_source_ndx(keys.get_key(i)), i);
+        }
+
+        CHECK_EQUAL(selection.sum_int(col_int), keys.sum_int(col_int));
+        CHECK_EQUAL(selection.sum_double(col_double), keys.sum_double(col_double));
+        size_t count_keys = 0;
+        size_t count_selection = 0;
+        CHECK_EQUAL(selection.average_int(col_int, &count_selection), keys.average_int(col_int, &count_keys));
+        CHECK_EQUAL(count_selection, count_keys);
+        ObjKey key_keys;
+        ObjKey key_selection;
+        CHECK_EQUAL(selection.maximum_int(col_int, &key_selection), keys.maximum_int(col_int, &key_keys));
+        CHECK_EQUAL(key_selection, key_keys);
+        CHECK_EQUAL(selection.minimum_double(col_double, &key_selection),
+                    keys.minimum_double(col_double, &key_keys));
+        CHECK_EQUAL(key_selection, key_keys);
+        CHECK_EQUAL(selection.maximum_timestamp(col_date), keys.maximum_timestamp(col_date));
+        CHECK_EQUAL(selection.count_int(col_int, 500), keys.count_int(col_int, 500));
+        CHECK_EQUAL(selection.count_double(col_double, 0.0), keys.count_double(col_double, 0.0));
+    };
+
+    // Most of the table, a few objects per cluster, nothing and everything
+    check(table.where().less(col_int, 900));
+    check(table.where().equal(col_int, 500));
+    check(table.where().greater(col_int, 1000));
+    check(table.where());
+
+    // Gaps in the keys
+    for (int i = 0; i < 500; ++i) {
+        ObjKey key(random.draw_int<int64_t>(0, 2999));
+        if (table.is_valid(key))
+            table.remove_object(key);
+    }
+    check(table.where().less(col_int, 900));
+    check(table.where().equal(col_int, 500));
+
+    // Removed objects are left out of aggregates until the view is synchronized
+    TableView tv = table.where().greater_equal(col_double, 0.0).find_all();
+    CHECK(tv.uses_selection());
+    size_t size = tv.size();
+    double sum = tv.sum_double(col_double);
+    ObjKey removed = tv.get_key(10);
+    double removed_value = table.get_object(removed).get<double>(col_double);
+    table.remove_object(removed);
+    CHECK_EQUAL(tv.size(), size);
+    CHECK(!tv.is_obj_valid(10));
+    CHECK_EQUAL(tv.sum_double(col_double), sum - removed_value);
+    tv.sync_if_needed();
+    CHECK(tv.uses_selection());
+    CHECK_EQUAL(tv.size(), size - 1);
+
+    // Removing through the view and sorting it turn the selection into keys
+    ObjKey next = tv.get_key(11);
+    tv.remove(10);
+    CHECK(!tv.uses_selection());
+    CHECK_EQUAL(tv.size(), size - 2);
+    CHECK_EQUAL(tv.get_key(10), next);
+    tv = table.where().greater_equal(col_double, 0.0).find_all();
+    CHECK(tv.uses_selection());
+    tv.sort(col_double);
+    CHECK(!tv.uses_selection());
+    CHECK_EQUAL(tv.size(), size - 2);
+    for (size_t i = 1; i < tv.size(); ++i)
+        CHECK_LESS_EQUAL(tv.get(i - 1).get<double>(col_double), tv.get(i).get<double>(col_double));
+}
+
 #endif // TEST_TABLE_VIEW
@@ -38,6 +38,7 @@
 #include <realm/utilities.hpp>
 #include <realm/util/features.h>
 #include <realm/util/thread.hpp>
+#include <realm/util/thread_pool.hpp>
 #include <realm/util/interprocess_condvar.hpp>
 #include <realm/util/interprocess_mutex.hpp>
 
@@ -1018,6 +1019,68 @@ TEST_IF(Thread_CondvarAtomicWaitUnlock, !running_with_valgrind && TEST_DURATION
     }
 }
 
+TEST(Thread_ThreadPool)
+{
+    ThreadPool pool(4);
+    CHECK_EQUAL(pool.get_num_threads(), 4);
+
+    // Every task runs exactly once, also when there are fewer tasks than threads, and when the tasks take very
+    // different amounts of time, so that threads steal from each other
+    for (size_t num_tasks : {0, 1, 3, 4, 100, 1000}) {
+        std::vector<std::atomic<int>> runs(num_tasks);
+        std::vector<std::atomic<int>> busy(pool.get_num_threads());
+        std::atomic<bool> overlap{false};
+        pool.run(num_tasks, [&](size_t task_ndx, size_t thread_ndx) {
+            if (busy[thread_ndx]++ != 0)
+                overlap = true;
+            if (task_ndx % 17 == 0)
+                millisleep(1);
+            ++runs[task_ndx];
+            --busy[thread_ndx];
+        });
+        CHECK_NOT(overlap);
+        for (size_t i = 0; i < num_tasks; ++i)
+            CHECK_EQUAL(runs[i], 1);
+    }
+
+    // The first exception is rethrown, and the pool can be used again after it
+    CHECK_THROW(pool.run(100,
+                         [&](size_t task_ndx, size_t) {
+                             if (task_ndx == 42)
+                                 throw std::runtime_error("task failed");
+                         }),
+                std::runtime_error);
+    std::atomic<size_t> sum{0};
+    pool.run(100, [&](size_t task_ndx, size_t) {
+        sum += task_ndx;
+    });
+    CHECK_EQUAL(sum.load(), 4950u);
+
+    // Batches from several threads share the pool
+    sum = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 10; ++j) {
+                pool.run(10, [&](size_t task_ndx, size_t) {
+                    sum += task_ndx;
+                });
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    CHECK_EQUAL(sum.load(), 4u * 10 * 45);
+
+    // A pool for one thread runs everything on the calling thread
+    ThreadPool single(1);
+    auto caller = std::this_thread::get_id();
+    single.run(10, [&](size_t, size_t thread_ndx) {
+        CHECK_EQUAL(thread_ndx, 0);
+        CHECK(std::this_thread::get_id() == caller);
+    });
+}
+
 #ifdef _WIN32
 TEST(Thread_Win32InterprocessBackslashes)
 {
@@ -1707,6 +1707,71 @@ TEST(Upgrade_FixColumnKeys)
     DB::create(*hist)->start_read()->verify();
 }
 
+TEST(Upgrade_Database_20_21)
+{
+    using gf = _impl::GroupFriend;
+    SHARED_GROUP_TEST_PATH(path);
+    // A group that has never been committed holds no encoded leaves, so writing it and changing the version in the
+    // header gives a file of format 20
+    {
+        Group g;
+        auto table = g.add_table("table");
+        auto col = table->add_column(type_Int, "int");
+        table->add_column(type_String, "string");
+        for (int i = 0; i < 1000; ++i)
+            table->create_object().set(col, i % 10);
+        g.write(path);
+    }
+    auto get_header_format = [&]() {
+        File f(path);
+        char header[24];
+        f.read(header);
+        return std::make_pair(int(header[20]), int(header[21]));
+    };
+    {
+        CHECK_EQUAL(get_header_format().first, 21);
+        File f(path, File::mode_Update);
+        f.seek(20);
+        const char format[2] = {20, 20};
+        f.write(format);
+    }
+
+    // A group opened from the file keeps the format, and does not add to the file what format 20 cannot hold
+    {
+        Group g(path, nullptr, Group::mode_ReadWrite);
+        CHECK_EQUAL(gf::get_file_format_version(g), 20);
+        auto table = g.get_table("table");
+        auto col = table->get_column_key("int");
+        CHECK_LOGIC_ERROR(table->add_bloom_filter(table->get_column_key("string")), LogicError::illegal_combination);
+        auto empty_table = g.add_table("empty");
+        CHECK_LOGIC_ERROR(empty_table->set_cluster_size(Table::max_cluster_size), LogicError::illegal_combination);
+        CHECK_LOGIC_ERROR(table->add_ordered_index(col), LogicError::illegal_combination);
+        CHECK_LOGIC_ERROR(table->update_statistics(), LogicError::illegal_combination);
+        for (int i = 0; i < 1000; ++i)
+            table->create_object().set(col, i % 10);
+        g.commit();
+        CHECK_EQUAL(gf::get_file_format_version(g), 20);
+    }
+    CHECK(get_header_format() == std::make_pair(20, 20));
+
+    // Opening it through a DB upgrades it
+    {
+        DBRef db = DB::create(path);
+        auto rt = db->start_read();
+        CHECK_EQUAL(gf::get_file_format_version(*rt), 21);
+        rt->verify();
+        auto table = rt->get_table("table");
+        auto col = table->get_column_key("int");
+        CHECK_EQUAL(table->size(), 2000);
+        CHECK_EQUAL(table->sum_int(col), 2 * 4500);
+        auto wt = db->start_write();
+        wt->get_table("table")->add_ordered_index(col);
+        wt->commit();
+    }
+    auto format = get_header_format();
+    CHECK(format.first == 21 || format.second == 21);
+}
+
 /*
 TEST(Upgrade_bug)
 {